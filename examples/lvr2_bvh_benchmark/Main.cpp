@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "lvr2/util/Synthetic.hpp"
+#include "lvr2/io/MeshBuffer.hpp"
+#include "lvr2/io/Timestamp.hpp"
+#include "lvr2/geometry/BaseVector.hpp"
+#include "lvr2/geometry/Normal.hpp"
+#include "lvr2/algorithm/raycasting/BVHRaycaster.hpp"
+
+using namespace lvr2;
+
+using PointType = BaseVector<float>;
+using NormalType = Normal<float>;
+
+/**
+ * @brief Measures the throughput of BVHRaycaster::castRays for the given rays
+ */
+void benchmark(
+    BVHRaycaster<PointType, NormalType>& raycaster,
+    const PointType& origin,
+    const std::vector<NormalType>& directions,
+    const std::string& name)
+{
+    std::vector<PointType> intersections;
+    std::vector<uint8_t> hits;
+
+    auto start = std::chrono::steady_clock::now();
+    raycaster.castRays(origin, directions, intersections, hits);
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    size_t numHits = 0;
+    for (auto hit : hits)
+    {
+        numHits += hit;
+    }
+
+    std::cout << timestamp << name << ": " << directions.size() << " rays, " << numHits << " hits, "
+              << seconds << " s, " << directions.size() / seconds / 1e6 << " MRays/s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    // usage: lvr2_example_bvh_benchmark [num_triangles] [scan_width] [scan_height]
+    size_t numTriangles = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    int scanWidth = argc > 2 ? std::stoi(argv[2]) : 3600;
+    int scanHeight = argc > 3 ? std::stoi(argv[3]) : 1000;
+
+    // a uv sphere has about 2 * long * lat triangles
+    int resolution = static_cast<int>(std::sqrt(numTriangles / 2.0));
+    MeshBufferPtr mesh = synthetic::genSphere(resolution, resolution);
+    std::cout << timestamp << "Generated sphere with " << mesh->numFaces() << " triangles" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    BVHRaycaster<PointType, NormalType> raycaster(mesh);
+    auto end = std::chrono::steady_clock::now();
+    std::cout << timestamp << "Built BVH in " << std::chrono::duration<double>(end - start).count()
+              << " s" << std::endl;
+
+    // regular scan pattern of a terrestrial laser scanner, slightly off the center of the sphere
+    PointType origin(0.1f, -0.2f, 0.05f);
+    std::vector<NormalType> scanDirections;
+    scanDirections.reserve(static_cast<size_t>(scanWidth) * scanHeight);
+    for (int v = 0; v < scanHeight; v++)
+    {
+        float elevation = -M_PI / 3.0 + (2.0 * M_PI / 3.0) * v / scanHeight;
+        for (int h = 0; h < scanWidth; h++)
+        {
+            float azimuth = 2.0 * M_PI * h / scanWidth;
+            scanDirections.push_back(NormalType(
+                std::cos(elevation) * std::cos(azimuth),
+                std::cos(elevation) * std::sin(azimuth),
+                std::sin(elevation)
+            ));
+        }
+    }
+    benchmark(raycaster, origin, scanDirections, "Scan pattern");
+
+    // the same number of incoherent rays
+    std::mt19937 rng(42);
+    std::normal_distribution<float> normal;
+    std::vector<NormalType> randomDirections;
+    randomDirections.reserve(scanDirections.size());
+    for (size_t i = 0; i < scanDirections.size(); i++)
+    {
+        randomDirections.push_back(NormalType(normal(rng), normal(rng), normal(rng)));
+    }
+    benchmark(raycaster, origin, randomDirections, "Random directions");
+
+    return 0;
+}
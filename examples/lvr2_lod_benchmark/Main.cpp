@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "lvr2/io/PointBuffer.hpp"
+#include "lvr2/io/PointCloudLOD.hpp"
+#include "lvr2/io/PointCloudLODBuilder.hpp"
+#include "lvr2/io/PointStream.hpp"
+#include "lvr2/io/Timestamp.hpp"
+
+using namespace lvr2;
+
+/**
+ * @brief Samples n points from a synthetic city: a wavy ground plane with box shaped buildings
+ */
+PointBufferPtr genCityPoints(size_t n, float extent)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    floatArr points(new float[n * 3]);
+    ucharArr colors(new unsigned char[n * 3]);
+    for (size_t i = 0; i < n; i++)
+    {
+        float x = uniform(rng) * extent;
+        float y = uniform(rng) * extent;
+        float z = 2.0f * std::sin(x * 0.05f) * std::cos(y * 0.05f);
+
+        // Every fourth point lies on the wall of a building on a 50 m grid
+        if (i % 4 == 0)
+        {
+            float height = 10.0f + 20.0f * uniform(rng);
+            float side = uniform(rng) * 20.0f;
+            if (uniform(rng) < 0.5f)
+            {
+                x = std::floor(x / 50.0f) * 50.0f + side;
+            }
+            else
+            {
+                y = std::floor(y / 50.0f) * 50.0f + side;
+            }
+            z += uniform(rng) * height;
+        }
+
+        points[3 * i + 0] = x;
+        points[3 * i + 1] = y;
+        points[3 * i + 2] = z;
+        colors[3 * i + 0] = static_cast<unsigned char>(z * 8);
+        colors[3 * i + 1] = 128;
+        colors[3 * i + 2] = 255 - static_cast<unsigned char>(z * 8);
+    }
+
+    PointBufferPtr buffer(new PointBuffer(points, n));
+    buffer->setColorArray(colors, n);
+    return buffer;
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    // usage: lvr2_example_lod_benchmark [num_points | cloud.lod] [point_budget]
+    std::string input = argc > 1 ? argv[1] : "10000000";
+    size_t budget = argc > 2 ? std::stoul(argv[2]) : 2000000;
+
+    std::string filename = input;
+    if (input.find_first_not_of("0123456789") == std::string::npos)
+    {
+        size_t n = std::stoul(input);
+        PointBufferPtr buffer = genCityPoints(n, 1000.0f);
+        PointBufferStream stream(buffer);
+
+        filename = "lod_benchmark.lod";
+        auto start = std::chrono::steady_clock::now();
+        PointCloudLODBuilder builder(".", n / 8 + 1);
+        builder.build(stream, filename);
+        std::cout << timestamp << "Build: " << secondsSince(start) << " s for " << n << " points" << std::endl;
+    }
+
+    // Baseline: load every point, as a viewer without level of detail does
+    auto start = std::chrono::steady_clock::now();
+    PointCloudLOD all(filename);
+    std::vector<size_t> nodes(all.numNodes());
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        nodes[i] = i;
+    }
+    PointBufferPtr allPoints = all.load(nodes);
+    std::cout << timestamp << "Load all: " << secondsSince(start) << " s, "
+              << allPoints->numPoints() << " points" << std::endl;
+    allPoints.reset();
+
+    // Open, select the nodes for a camera above the cloud and stream them
+    start = std::chrono::steady_clock::now();
+    PointCloudLOD lod(filename);
+    const LODNode& root = lod.node(0);
+    Vector3f camera = root.min + Vector3f(0.5f, 0.5f, 0.3f) * root.size;
+    std::vector<size_t> selected = lod.selectNodes(camera, 1.0f, 1080.0f, 2.0f, budget);
+    PointBufferPtr view = lod.load(selected);
+    std::cout << timestamp << "Load view: " << secondsSince(start) << " s, "
+              << selected.size() << " of " << lod.numNodes() << " nodes, "
+              << view->numPoints() << " points" << std::endl;
+
+    // Overview of the coarsest levels
+    start = std::chrono::steady_clock::now();
+    PointBufferPtr overview = lod.load(lod.selectNodes(budget));
+    std::cout << timestamp << "Load overview: " << secondsSince(start) << " s, "
+              << overview->numPoints() << " points" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "lvr2/io/ModelFactory.hpp"
+#include "lvr2/io/PointBuffer.hpp"
+#include "lvr2/io/Timestamp.hpp"
+#include "lvr2/geometry/BaseVector.hpp"
+#include "lvr2/reconstruction/AdaptiveKSearchSurface.hpp"
+#include "lvr2/reconstruction/CpuSurface.hpp"
+
+using namespace lvr2;
+
+using Vec = BaseVector<float>;
+
+/**
+ * @brief Samples n points uniformly from a sphere with the given radius
+ */
+PointBufferPtr genSpherePoints(size_t n, float radius)
+{
+    std::mt19937 rng(42);
+    std::normal_distribution<float> normal;
+
+    floatArr points(new float[n * 3]);
+    for (size_t i = 0; i < n; i++)
+    {
+        float x = normal(rng);
+        float y = normal(rng);
+        float z = normal(rng);
+        float s = radius / std::sqrt(x * x + y * y + z * z);
+        points[3 * i + 0] = x * s;
+        points[3 * i + 1] = y * s;
+        points[3 * i + 2] = z * s;
+    }
+    return PointBufferPtr(new PointBuffer(points, n));
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    // usage: lvr2_example_normals_benchmark [num_points | cloud.ply] [kn] [ki]
+    PointBufferPtr buffer;
+    std::string input = argc > 1 ? argv[1] : "1000000";
+    if (input.find_first_not_of("0123456789") == std::string::npos)
+    {
+        buffer = genSpherePoints(std::stoul(input), 10.0f);
+    }
+    else
+    {
+        buffer = ModelFactory::readModel(input)->m_pointCloud;
+    }
+    int kn = argc > 2 ? std::stoi(argv[2]) : 10;
+    int ki = argc > 3 ? std::stoi(argv[3]) : 10;
+
+    size_t numPoints = buffer->numPoints();
+    floatArr points = buffer->getPointArray();
+    std::cout << timestamp << "Estimating normals for " << numPoints << " points, kn = "
+              << kn << ", ki = " << ki << std::endl;
+
+    // LBKdTree on the CPU
+    auto start = std::chrono::steady_clock::now();
+    CpuSurface cpuSurface(points, numPoints);
+    double buildTime = secondsSince(start);
+
+    cpuSurface.setKn(kn);
+    cpuSurface.setKi(ki);
+    cpuSurface.setFlippoint(0.0f, 0.0f, 0.0f);
+
+    start = std::chrono::steady_clock::now();
+    cpuSurface.calculateNormals();
+    double normalTime = secondsSince(start);
+
+    floatArr cpuNormals(new float[numPoints * 3]);
+    cpuSurface.getNormals(cpuNormals);
+    std::cout << timestamp << "CpuSurface: tree " << buildTime << " s, normals "
+              << normalTime << " s" << std::endl;
+
+    // FLANN based reference
+    PointBufferPtr reference(new PointBuffer(points, numPoints));
+    start = std::chrono::steady_clock::now();
+    AdaptiveKSearchSurface<Vec> surface(reference, "FLANN", kn, ki, kn);
+    buildTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    surface.calculateSurfaceNormals();
+    normalTime = secondsSince(start);
+    std::cout << timestamp << "AdaptiveKSearchSurface: tree " << buildTime << " s, normals "
+              << normalTime << " s" << std::endl;
+
+    // Both surfaces orient their normals differently, so compare the
+    // unoriented angle between them
+    floatArr refNormals = reference->getNormalArray();
+    size_t agree = 0;
+    for (size_t i = 0; i < numPoints; i++)
+    {
+        float dot = cpuNormals[3 * i + 0] * refNormals[3 * i + 0]
+                  + cpuNormals[3 * i + 1] * refNormals[3 * i + 1]
+                  + cpuNormals[3 * i + 2] * refNormals[3 * i + 2];
+        if (std::abs(dot) > std::cos(10.0 * M_PI / 180.0))
+        {
+            agree++;
+        }
+    }
+    std::cout << timestamp << 100.0 * agree / numPoints
+              << "% of the normals agree within 10 degrees" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include "lvr2/io/MeshBuffer.hpp"
+#include "lvr2/io/ObjIO.hpp"
+#include "lvr2/io/Timestamp.hpp"
+#include "lvr2/texture/Material.hpp"
+
+using namespace lvr2;
+
+/**
+ * @brief Creates a wavy n x n grid mesh with colors, normals, texture coordinates
+ *        and four color materials that are assigned to consecutive faces
+ */
+MeshBufferPtr genGridMesh(size_t n)
+{
+    size_t numVertices = n * n;
+    size_t numFaces = 2 * (n - 1) * (n - 1);
+
+    floatArr vertices(new float[3 * numVertices]);
+    floatArr normals(new float[3 * numVertices]);
+    floatArr texcoords(new float[2 * numVertices]);
+    ucharArr colors(new unsigned char[3 * numVertices]);
+    for (size_t y = 0; y < n; y++)
+    {
+        for (size_t x = 0; x < n; x++)
+        {
+            size_t i = y * n + x;
+            float z = 3.0f * std::sin(x * 0.01f) * std::cos(y * 0.013f);
+            vertices[3 * i + 0] = x * 0.1f;
+            vertices[3 * i + 1] = y * 0.1f;
+            vertices[3 * i + 2] = z;
+            normals[3 * i + 0] = -0.3f * std::cos(x * 0.01f);
+            normals[3 * i + 1] = 0.39f * std::sin(y * 0.013f);
+            normals[3 * i + 2] = 1.0f;
+            texcoords[2 * i + 0] = x / float(n);
+            texcoords[2 * i + 1] = y / float(n);
+            colors[3 * i + 0] = x % 256;
+            colors[3 * i + 1] = y % 256;
+            colors[3 * i + 2] = (x + y) % 256;
+        }
+    }
+
+    indexArray faces(new unsigned int[3 * numFaces]);
+    indexArray faceMaterials(new unsigned int[numFaces]);
+    size_t f = 0;
+    for (size_t y = 0; y + 1 < n; y++)
+    {
+        for (size_t x = 0; x + 1 < n; x++)
+        {
+            unsigned int i = y * n + x;
+            unsigned int quad[6] = {i, i + 1, i + (unsigned int)n, i + 1, i + (unsigned int)n + 1, i + (unsigned int)n};
+            for (int k = 0; k < 2; k++, f++)
+            {
+                faces[3 * f + 0] = quad[3 * k + 0];
+                faces[3 * f + 1] = quad[3 * k + 1];
+                faces[3 * f + 2] = quad[3 * k + 2];
+                faceMaterials[f] = 4 * f / numFaces;
+            }
+        }
+    }
+
+    MeshBufferPtr mesh(new MeshBuffer);
+    mesh->setVertices(vertices, numVertices);
+    mesh->setVertexNormals(normals);
+    mesh->setVertexColors(colors);
+    mesh->setTextureCoordinates(texcoords);
+    mesh->setFaceIndices(faces, numFaces);
+    mesh->setFaceMaterialIndices(faceMaterials);
+
+    for (int i = 0; i < 4; i++)
+    {
+        Material m;
+        m.m_color = boost::optional<Rgb8Color>({(unsigned char)(60 * i), 128, 255});
+        mesh->getMaterials().push_back(m);
+    }
+    return mesh;
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Compares two arrays and reports the number of entries that differ by more than eps
+ */
+template<typename T>
+size_t compare(const std::string& name, const T* a, const T* b, size_t n, double eps = 0.0)
+{
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (std::abs((double)a[i] - (double)b[i]) > eps)
+        {
+            mismatches++;
+        }
+    }
+    std::cout << timestamp << name << ": " << (mismatches ? "MISMATCH " : "ok ")
+              << "(" << mismatches << " of " << n << " differ)" << std::endl;
+    return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+    // usage: lvr2_example_obj_benchmark [grid_size]
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 2000;
+
+    MeshBufferPtr mesh = genGridMesh(n);
+    std::string filename = "obj_benchmark.obj";
+
+    auto start = std::chrono::steady_clock::now();
+    ObjIO writer;
+    writer.setModel(ModelPtr(new Model(mesh)));
+    writer.save(filename);
+    double writeTime = secondsSince(start);
+    double megabytes = boost::filesystem::file_size(filename) / (1024.0 * 1024.0);
+    std::cout << timestamp << "Write: " << writeTime << " s, " << megabytes / writeTime << " MB/s" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    ObjIO reader;
+    ModelPtr model = reader.read(filename);
+    double readTime = secondsSince(start);
+    std::cout << timestamp << "Read: " << readTime << " s, " << megabytes / readTime << " MB/s" << std::endl;
+
+    // Round trip: everything but the flipped texture coordinates has to be bit exact
+    MeshBufferPtr result = model->m_mesh;
+    size_t w;
+    size_t errors = 0;
+    if (result->numVertices() != mesh->numVertices() || result->numFaces() != mesh->numFaces())
+    {
+        std::cout << timestamp << "MISMATCH: Read " << result->numVertices() << " vertices and "
+                  << result->numFaces() << " faces" << std::endl;
+        return 1;
+    }
+    size_t numVertices = mesh->numVertices();
+    size_t numFaces = mesh->numFaces();
+    errors += compare("Vertices", mesh->getVertices().get(), result->getVertices().get(), 3 * numVertices);
+    errors += compare("Normals", mesh->getVertexNormals().get(), result->getVertexNormals().get(), 3 * numVertices);
+    errors += compare("Colors", mesh->getVertexColors(w).get(), result->getVertexColors(w).get(), 3 * numVertices);
+    errors += compare("Texture coordinates", mesh->getTextureCoordinates().get(),
+                      result->getTextureCoordinates().get(), 2 * numVertices, 1e-6);
+    errors += compare("Faces", mesh->getFaceIndices().get(), result->getFaceIndices().get(), 3 * numFaces);
+    errors += compare("Face materials", mesh->getFaceMaterialIndices().get(),
+                      result->getFaceMaterialIndices().get(), numFaces);
+
+    return errors ? 1 : 0;
+}
@@ -14,8 +14,9 @@
 
 #include "lvr2/algorithm/raycasting/RaycasterBase.hpp"
 
-// LVR2 internal raycaster that is always available
+// LVR2 internal raycasters that are always available
 #include "lvr2/algorithm/raycasting/BVHRaycaster.hpp"
+#include "lvr2/algorithm/raycasting/CPURaycaster.hpp"
 
 #if defined LVR2_USE_OPENCL
 #include "lvr2/algorithm/raycasting/CLRaycaster.hpp"
@@ -432,6 +433,38 @@ double realTest(RaycasterBasePtr<PointType, NormalType> rc, size_t num_rays=9845
     return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
 }
 
+double visibilityTest(CPURaycaster<PointType, NormalType>& rc, size_t num_rays=984543)
+{
+    PointType origin = {0.0,0.0,0.0};
+    std::vector<PointType > targets(num_rays);
+
+    for(int i=0; i<num_rays; i++)
+    {
+        targets[i].x = floatInRange(-2.0, 2.0);
+        targets[i].y = floatInRange(-2.0, 2.0);
+        targets[i].z = floatInRange(-2.0, 2.0);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> visible;
+
+    rc.visible(origin, targets, visible);
+    auto end = std::chrono::steady_clock::now();
+
+    int num_visible = 0;
+    for(int i=0; i<visible.size(); i++)
+    {
+        if(visible[i])
+        {
+            num_visible++;
+        }
+    }
+
+    std::cout << "visible: " << num_visible << std::endl;
+
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+}
+
 int main(int argc, char** argv)
 {
     int num_rays = 1000000;
@@ -448,6 +481,15 @@ int main(int argc, char** argv)
         raycaster.reset(new BVHRaycaster<PointType, NormalType>(buffer));
         std::cout << realTest(raycaster, num_rays) << " ms" << std::endl;
 
+        // CPU test with tiled batches
+        std::cout << "Testing CPURaycaster" << std::endl;
+        auto cpuRaycaster = std::make_shared<CPURaycaster<PointType, NormalType> >(buffer);
+        raycaster = cpuRaycaster;
+        std::cout << realTest(raycaster, num_rays) << " ms" << std::endl;
+
+        std::cout << "Testing CPURaycaster visibility (any hit)" << std::endl;
+        std::cout << visibilityTest(*cpuRaycaster, num_rays) << " ms" << std::endl;
+
         // GPU test
         #if defined LVR2_USE_OPENCL
         std::cout << "Testing CLRaycaster" << std::endl;
@@ -0,0 +1,159 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+// lvr2 includes
+#include "lvr2/io/MeshBuffer.hpp"
+#include "lvr2/io/Model.hpp"
+#include "lvr2/io/ModelFactory.hpp"
+#include "lvr2/texture/TextureAtlas.hpp"
+
+using namespace lvr2;
+
+namespace fs = boost::filesystem;
+
+/**
+ * @brief Generates a mesh of many small textured quads, similar to the
+ *        output of the texturizer for a mesh with many planar clusters.
+ */
+MeshBufferPtr genMesh(size_t numClusters)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> size(4, 64);
+
+    floatArr vertices(new float[numClusters * 4 * 3]);
+    floatArr texCoords(new float[numClusters * 4 * 2]);
+    indexArray faces(new unsigned int[numClusters * 2 * 3]);
+    indexArray faceMaterials(new unsigned int[numClusters * 2]);
+
+    std::vector<Material> materials;
+    std::vector<Texture> textures;
+
+    // default material
+    Material m;
+    m.m_color = std::array<unsigned char, 3>{0, 0, 0};
+    materials.push_back(m);
+
+    for (size_t i = 0; i < numClusters; i++)
+    {
+        float x = i % 1000;
+        float y = i / 1000;
+
+        float quad[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+        for (size_t j = 0; j < 4; j++)
+        {
+            vertices[(4 * i + j) * 3 + 0] = x + quad[j][0];
+            vertices[(4 * i + j) * 3 + 1] = y + quad[j][1];
+            vertices[(4 * i + j) * 3 + 2] = 0;
+            texCoords[(4 * i + j) * 2 + 0] = quad[j][0];
+            texCoords[(4 * i + j) * 2 + 1] = quad[j][1];
+        }
+
+        unsigned int base = 4 * i;
+        unsigned int quadFaces[6] = {base, base + 1, base + 2, base, base + 2, base + 3};
+        std::copy(quadFaces, quadFaces + 6, faces.get() + 6 * i);
+
+        Texture tex(i, size(rng), size(rng), 3, 1, 1.0);
+        for (size_t k = 0; k < tex.m_width * tex.m_height * 3; k++)
+        {
+            tex.m_data[k] = rng() % 256;
+        }
+        textures.push_back(std::move(tex));
+
+        Material texMaterial;
+        texMaterial.m_texture = TextureHandle(i);
+        texMaterial.m_color = std::array<unsigned char, 3>{255, 255, 255};
+        materials.push_back(texMaterial);
+
+        faceMaterials[2 * i] = materials.size() - 1;
+        faceMaterials[2 * i + 1] = materials.size() - 1;
+    }
+
+    MeshBufferPtr mesh(new MeshBuffer);
+    mesh->setVertices(vertices, numClusters * 4);
+    mesh->setFaceIndices(faces, numClusters * 2);
+    mesh->setTextureCoordinates(texCoords);
+    mesh->setFaceMaterialIndices(faceMaterials);
+    mesh->setMaterials(materials);
+    mesh->setTextures(textures);
+    mesh->addIntAtomic(1, "mesh_save_textures");
+    mesh->addIntAtomic(2, "mesh_texture_image_extension");
+
+    return mesh;
+}
+
+size_t directorySize(const fs::path& dir)
+{
+    size_t size = 0;
+    for (fs::directory_iterator it(dir); it != fs::directory_iterator(); ++it)
+    {
+        if (fs::is_regular_file(it->path()))
+        {
+            size += fs::file_size(it->path());
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Writes the mesh into the given directory and reads it back.
+ *        ObjIO writes materials and textures into the working directory.
+ */
+void benchmark(const std::string& name, MeshBufferPtr mesh, const fs::path& dir)
+{
+    fs::path cwd = fs::current_path();
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    fs::current_path(dir);
+
+    size_t numTextures = mesh->getTextures().size();
+
+    auto start = std::chrono::steady_clock::now();
+    ModelFactory::saveModel(ModelPtr(new Model(mesh)), "mesh.obj");
+    auto saved = std::chrono::steady_clock::now();
+    ModelPtr model = ModelFactory::readModel("mesh.obj");
+    auto loaded = std::chrono::steady_clock::now();
+
+    fs::current_path(cwd);
+
+    std::cout << name << ": " << numTextures << " textures, "
+              << directorySize(dir) / 1024 << " KiB, save "
+              << std::chrono::duration<double>(saved - start).count() << " s, load "
+              << std::chrono::duration<double>(loaded - saved).count() << " s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && std::string(argv[1]) == "--help")
+    {
+        std::cout << "Usage: " << argv[0] << " [mesh.obj|num_clusters] [page_size]" << std::endl;
+        return 0;
+    }
+
+    std::string input = argc > 1 ? argv[1] : "20000";
+    unsigned short pageSize = argc > 2 ? std::stoi(argv[2]) : 4096;
+
+    auto load = [&]()
+    {
+        if (fs::exists(input))
+        {
+            return ModelFactory::readModel(input)->m_mesh;
+        }
+        return genMesh(std::stoul(input));
+    };
+
+    benchmark("per cluster", load(), "atlas_bench_clusters");
+
+    MeshBufferPtr atlasMesh = load();
+    auto start = std::chrono::steady_clock::now();
+    TextureAtlas(pageSize).apply(*atlasMesh);
+    auto packed = std::chrono::steady_clock::now();
+    std::cout << "packing: " << std::chrono::duration<double>(packed - start).count() << " s" << std::endl;
+
+    benchmark("atlas", atlasMesh, "atlas_bench_pages");
+
+    return 0;
+}
@@ -44,6 +44,7 @@
 #include "lvr2/io/ChunkIO.hpp"
 #include "lvr2/io/Model.hpp"
 #include "lvr2/types/Channel.hpp"
+#include "lvr2/types/ChannelView.hpp"
 
 namespace lvr2
 {
@@ -127,7 +128,42 @@ class ChunkManager
      */
     inline std::size_t hashValue(int i, int j, int k) const
     {
-        return i * m_amount.y * m_amount.z + j * m_amount.z + k;
+        return hashValue(i, j, k, m_amount);
+    }
+
+    /**
+     * @brief Calculates the hash value for the given index triple in a grid with the given
+     * amount of chunks per axis
+     *
+     * @param i index of x-axis
+     * @param j index of y-axis
+     * @param k index of z-axis
+     * @param amount amount of chunks along each axis
+     * @return hash value
+     */
+    static inline std::size_t hashValue(std::size_t i,
+                                        std::size_t j,
+                                        std::size_t k,
+                                        const BaseVector<std::size_t>& amount)
+    {
+        return i * amount.y * amount.z + j * amount.z + k;
+    }
+
+    /**
+     * @brief returns the grid coordinates of the chunk that contains the given point
+     *
+     * @param vec point of which we want the grid coordinates
+     * @param origin minimum corner of the grid
+     * @param chunkSize side length of the chunks
+     * @return the grid coordinates as a BaseVector
+     */
+    static inline BaseVector<int> cellCoordinates(const BaseVector<float>& vec,
+                                                  const BaseVector<float>& origin,
+                                                  float chunkSize)
+    {
+        BaseVector<float> tmpVec = (vec - origin) / chunkSize;
+        return BaseVector<int>(
+            static_cast<int>(tmpVec.x), static_cast<int>(tmpVec.y), static_cast<int>(tmpVec.z));
     }
 
     /**
@@ -233,25 +269,21 @@ class ChunkManager
         std::vector<std::unordered_map<std::size_t, std::size_t>>& areaVertexIndices);
 
     /**
-     * @brief applies given filter arrays to one channel
+     * @brief applies given filters to one channel
      *
-     * @tparam T Type of channels contents
-     * @param vertexFilter filter array for vertices
-     * @param faceFilter filter array for faces
-     * @param numVertices amount of vertices after filtering
-     * @param numFaces amount of faces after filtering
-     * @param meshBuffer original mesh
+     * @param vertexIndices indices of the vertices that pass the filters
+     * @param faceIndices indices of the faces that pass the filters
+     * @param numVertices amount of vertices before filtering
+     * @param numFaces amount of faces before filtering
      * @param originalChannel channel to filter
      *
-     * @return a new filtered channel
+     * @return the filtered channel, or the original one if nothing was filtered
      */
-    template <typename T>
     MultiChannelMap::val_type
-    applyChannelFilter(const std::vector<bool>& vertexFilter,
-                       const std::vector<bool>& faceFilter,
+    applyChannelFilter(ChannelIndicesPtr vertexIndices,
+                       ChannelIndicesPtr faceIndices,
                        const size_t numVertices,
                        const size_t numFaces,
-                       const MeshBufferPtr meshBuffer,
                        const MultiChannelMap::val_type& originalChannel) const;
 
     // bounding box of the entire chunked model
@@ -157,8 +157,31 @@ BoundingRectangle<typename BaseVecT::CoordType> calculateBoundingRectangle(
 template<typename BaseVecT, typename Pred>
 ClusterBiMap<FaceHandle> clusterGrowing(const BaseMesh<BaseVecT>& mesh, Pred pred);
 
+/**
+ * @brief Parallel algorithm which generates clusters of connected faces based on union-find.
+ *
+ * In contrast to `clusterGrowing`, the predicate is evaluated once for every pair of adjacent faces
+ * (in parallel) and two faces end up in the same cluster if they are connected by a chain of accepted pairs.
+ * Hence the predicate has to be symmetric and doesn't get to see a reference face of the cluster.
+ *
+ * Cluster handles are assigned in the order of the first face of each cluster in `mesh.faces()` and the faces of
+ * a cluster are stored in ascending handle order, so the result doesn't depend on the number of threads. If the
+ * predicate describes an equivalence relation (e.g. "always true"), the clusters and their handles are the same
+ * as the ones `clusterGrowing` produces, only the order of the faces within a cluster may differ.
+ *
+ * @tparam Pred a predicate with the parameters (FaceHandle faceH, FaceHandle neighbourH) which returns true, if
+ *         both adjacent faces belong to the same cluster. It is called concurrently from multiple threads.
+ */
+template<typename BaseVecT, typename Pred>
+ClusterBiMap<FaceHandle> parallelClusterGrowing(const BaseMesh<BaseVecT>& mesh, Pred pred);
+
 /**
  * @brief Algorithm which generates plane clusters from the given mesh.
+ *
+ * Every face is compared to the first face of its cluster. This relation isn't transitive, so the region growing
+ * itself stays serial to produce the same clusters as `clusterGrowing`. Only the normals and neighbours of all faces
+ * are gathered in parallel beforehand.
+ *
  * @param minSinAngle `1 - minSinAngle` is the allowed difference between the sin of the angle of the starting
  *                    face and all other faces in one cluster.
  */
@@ -225,6 +248,20 @@ Plane<BaseVecT> calcRegressionPlaneRANSAC(
     const int num_samples = 10
 );
 
+/**
+ * @brief Calcs a regression plane for the given cluster, drawing the RANSAC samples from the given
+ *        random generator
+ */
+template<typename BaseVecT, typename RandomGenerator>
+Plane<BaseVecT> calcRegressionPlaneRANSAC(
+    const BaseMesh<BaseVecT>& mesh,
+    const Cluster<FaceHandle>& cluster,
+    const FaceMap<Normal<typename BaseVecT::CoordType>>& normals,
+    const int num_iterations,
+    const int num_samples,
+    RandomGenerator& generator
+);
+
 /// Calcs a regression plane for the given cluster
 template<typename BaseVecT>
 Plane<BaseVecT> calcRegressionPlanePCA(
@@ -250,6 +287,10 @@ DenseClusterMap<Plane<BaseVecT>> calcRegressionPlanes(
 
 /**
  * @brief Calcs regression planes for all cluster in clusters
+ *
+ * The planes are fitted in parallel. Every cluster draws its samples from its own random generator, seeded with
+ * the cluster handle, so the planes don't depend on the number of threads.
+ *
  * @param minClusterSize minimum size for clusters (number of faces) for which a regression plane should be generated
  * @return map from cluster handle to its regression plane (clusterH -> Plane)
  */
@@ -272,7 +313,12 @@ void dragToRegressionPlane(
     FaceMap<Normal<typename BaseVecT::CoordType>>& normals
 );
 
-/// Drags all points from the given clusters into their regression planes
+/**
+ * @brief Drags all points from the given clusters into their regression planes
+ *
+ * The vertices are processed in parallel. A vertex shared by several clusters is dragged into their planes in
+ * the order of the cluster handles, which gives the same positions as dragging the clusters one after another.
+ */
 template<typename BaseVecT>
 void dragToRegressionPlanes(
     BaseMesh<BaseVecT>& mesh,
@@ -46,10 +46,12 @@
 #include "lvr2/io/Timestamp.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <complex>
 #include <sstream>
 #include <cmath>
 #include <limits>
+#include <random>
 #include <unordered_set>
 
 using std::unordered_set;
@@ -63,7 +65,7 @@ template<typename BaseVecT>
 void removeDanglingCluster(BaseMesh<BaseVecT>& mesh, size_t sizeThreshold)
 {
     // Do cluster growing without a predicate, so cluster will consist of connected faces
-    auto clusterSet = clusterGrowing(mesh, [](auto referenceFaceH, auto currentFaceH)
+    auto clusterSet = parallelClusterGrowing(mesh, [](auto faceH, auto neighbourH)
     {
         return true;
     });
@@ -432,6 +434,111 @@ ClusterBiMap<FaceHandle> clusterGrowing(const BaseMesh<BaseVecT>& mesh, Pred pre
     return clusters;
 }
 
+template<typename BaseVecT, typename Pred>
+ClusterBiMap<FaceHandle> parallelClusterGrowing(const BaseMesh<BaseVecT>& mesh, Pred pred)
+{
+    const size_t numFaceIndices = mesh.nextFaceIndex();
+
+    // Union-find forest over the face indices. A root always has the smallest
+    // face index of its tree, so the roots don't depend on the order in which
+    // the threads merge trees.
+    vector<std::atomic<Index>> parent(numFaceIndices);
+    #pragma omp parallel for
+    for (size_t i = 0; i < numFaceIndices; i++)
+    {
+        parent[i].store(static_cast<Index>(i), std::memory_order_relaxed);
+    }
+
+    auto find = [&](Index i)
+    {
+        Index p = parent[i].load(std::memory_order_relaxed);
+        while (p != i)
+        {
+            // Path halving. If another thread changed the parent in the
+            // meantime, the CAS fails, which is fine: both values are
+            // ancestors of i.
+            Index grandParent = parent[p].load(std::memory_order_relaxed);
+            parent[i].compare_exchange_weak(p, grandParent, std::memory_order_relaxed);
+            i = p;
+            p = parent[i].load(std::memory_order_relaxed);
+        }
+        return i;
+    };
+
+    auto unite = [&](Index a, Index b)
+    {
+        while (true)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+            {
+                return;
+            }
+            if (a > b)
+            {
+                std::swap(a, b);
+            }
+
+            // Link the root with the larger index below the other one. This
+            // only succeeds if b is still a root.
+            Index expected = b;
+            if (parent[b].compare_exchange_strong(expected, a, std::memory_order_relaxed))
+            {
+                return;
+            }
+        }
+    };
+
+    // Evaluate the predicate for every pair of adjacent faces. The edges are
+    // collected from the iterator, since not every index below
+    // nextEdgeIndex() is a distinct edge (a HalfEdgeMesh accepts the index of
+    // either half edge).
+    vector<EdgeHandle> edges;
+    edges.reserve(mesh.numEdges());
+    for (auto eH: mesh.edges())
+    {
+        edges.push_back(eH);
+    }
+
+    #pragma omp parallel for schedule(dynamic, 4096)
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        auto faces = mesh.getFacesOfEdge(edges[i]);
+        if (faces[0] && faces[1] && pred(faces[0].unwrap(), faces[1].unwrap()))
+        {
+            unite(faces[0].unwrap().idx(), faces[1].unwrap().idx());
+        }
+    }
+
+    // Flatten the forest
+    #pragma omp parallel for
+    for (size_t i = 0; i < numFaceIndices; i++)
+    {
+        parent[i].store(find(static_cast<Index>(i)), std::memory_order_relaxed);
+    }
+
+    // Build the clusters. Since a root is the first face of its cluster in
+    // mesh.faces(), the clusters are created in the same order as in
+    // clusterGrowing.
+    ClusterBiMap<FaceHandle> clusters;
+    clusters.reserve(mesh.numFaces());
+    DenseFaceMap<ClusterHandle> clusterOfRoot;
+    clusterOfRoot.reserve(numFaceIndices);
+
+    for (auto faceH: mesh.faces())
+    {
+        FaceHandle rootH(parent[faceH.idx()].load(std::memory_order_relaxed));
+        if (rootH == faceH)
+        {
+            clusterOfRoot.insert(faceH, clusters.createCluster());
+        }
+        clusters.addToCluster(clusterOfRoot[rootH], faceH);
+    }
+
+    return clusters;
+}
+
 template<typename BaseVecT>
 ClusterBiMap<FaceHandle> planarClusterGrowing(
     const BaseMesh<BaseVecT>& mesh,
@@ -439,10 +546,82 @@ ClusterBiMap<FaceHandle> planarClusterGrowing(
     float minSinAngle
 )
 {
-    return clusterGrowing(mesh, [&](auto referenceFaceH, auto currentFaceH)
+    using CoordT = typename BaseVecT::CoordType;
+
+    vector<FaceHandle> faces;
+    faces.reserve(mesh.numFaces());
+    for (auto faceH: mesh.faces())
     {
-        return normals[currentFaceH].dot(normals[referenceFaceH]) > minSinAngle;
-    });
+        faces.push_back(faceH);
+    }
+
+    // Gather the normals and neighbours of all faces in parallel, so the
+    // serial walk below only reads from plain arrays. The neighbours are
+    // stored in the order getNeighboursOfFace() returns them, which keeps
+    // the walk identical to clusterGrowing().
+    const size_t numFaceIndices = mesh.nextFaceIndex();
+    const Index noFace = std::numeric_limits<Index>::max();
+
+    vector<Normal<CoordT>> faceNormals(numFaceIndices);
+    vector<Index> neighbours(numFaceIndices * 3, noFace);
+
+    #pragma omp parallel
+    {
+        vector<FaceHandle> faceNeighbours;
+
+        #pragma omp for schedule(dynamic, 4096)
+        for (size_t i = 0; i < faces.size(); i++)
+        {
+            Index idx = faces[i].idx();
+            faceNormals[idx] = normals[faces[i]];
+
+            faceNeighbours.clear();
+            mesh.getNeighboursOfFace(faces[i], faceNeighbours);
+            for (size_t j = 0; j < faceNeighbours.size() && j < 3; j++)
+            {
+                neighbours[idx * 3 + j] = faceNeighbours[j].idx();
+            }
+        }
+    }
+
+    ClusterBiMap<FaceHandle> clusters;
+    vector<bool> visited(numFaceIndices, false);
+    vector<Index> stack;
+
+    for (auto faceH: faces)
+    {
+        if (visited[faceH.idx()])
+        {
+            continue;
+        }
+
+        const Normal<CoordT>& referenceNormal = faceNormals[faceH.idx()];
+        auto cluster = clusters.createCluster();
+        stack.push_back(faceH.idx());
+
+        while (!stack.empty())
+        {
+            Index current = stack.back();
+            stack.pop_back();
+
+            if (!visited[current] && faceNormals[current].dot(referenceNormal) > minSinAngle)
+            {
+                clusters.addToCluster(cluster, FaceHandle(current));
+                visited[current] = true;
+
+                for (size_t j = 0; j < 3; j++)
+                {
+                    Index neighbour = neighbours[current * 3 + j];
+                    if (neighbour != noFace && !visited[neighbour])
+                    {
+                        stack.push_back(neighbour);
+                    }
+                }
+            }
+        }
+    }
+
+    return clusters;
 }
 
 template<typename BaseVecT>
@@ -529,18 +708,31 @@ DenseClusterMap<Plane<BaseVecT>> calcRegressionPlanes(
     size_t defaultClusterThreshold = 10 * log(mesh.numFaces());
     size_t minClusterThresholdSize = max(static_cast<size_t>(minClusterSize), defaultClusterThreshold);
 
-    // For all clusters in cluster map
+    // Collect all clusters that are large enough to get a plane
+    vector<ClusterHandle> planarClusters;
     for (auto clusterH: clusters)
     {
-        // Get current cluster
-        auto cluster = clusters[clusterH];
-        if (cluster.handles.size() > minClusterThresholdSize)
+        if (clusters[clusterH].handles.size() > minClusterThresholdSize)
         {
-            // Calc regression plane for current cluster and add to cluster map: cluster -> plane
-            planes.insert(clusterH, calcRegressionPlanePCA(mesh, cluster, normals));
+            planarClusters.push_back(clusterH);
         }
     }
 
+    // Calc regression planes in parallel, largest clusters are the most
+    // expensive ones, but dynamic scheduling takes care of that.
+    vector<Plane<BaseVecT>> clusterPlanes(planarClusters.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < planarClusters.size(); i++)
+    {
+        clusterPlanes[i] = calcRegressionPlanePCA(mesh, clusters[planarClusters[i]], normals);
+    }
+
+    // Add planes to cluster map: cluster -> plane
+    for (size_t i = 0; i < planarClusters.size(); i++)
+    {
+        planes.insert(planarClusters[i], clusterPlanes[i]);
+    }
+
     return planes;
 }
 
@@ -558,18 +750,39 @@ DenseClusterMap<Plane<BaseVecT>> calcRegressionPlanesRANSAC(
     size_t defaultClusterThreshold = 10 * log(mesh.numFaces());
     size_t minClusterThresholdSize = max(static_cast<size_t>(minClusterSize), defaultClusterThreshold);
 
-    // For all clusters in cluster map
+    // Collect all clusters that are large enough to get a plane
+    vector<ClusterHandle> planarClusters;
     for (auto clusterH: clusters)
     {
-        // Get current cluster
-        auto cluster = clusters[clusterH];
-        if (cluster.handles.size() > minClusterThresholdSize)
+        if (clusters[clusterH].handles.size() > minClusterThresholdSize)
         {
-            // Calc regression plane for current cluster and add to cluster map: cluster -> plane
-            planes.insert(clusterH, calcRegressionPlaneRANSAC(mesh, cluster, normals, iterations, samples));
+            planarClusters.push_back(clusterH);
         }
     }
 
+    // Calc regression planes in parallel. Each cluster gets its own generator
+    // seeded with its handle, so the result doesn't depend on the scheduling.
+    vector<Plane<BaseVecT>> clusterPlanes(planarClusters.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < planarClusters.size(); i++)
+    {
+        std::minstd_rand generator(planarClusters[i].idx() + 1);
+        clusterPlanes[i] = calcRegressionPlaneRANSAC(
+            mesh,
+            clusters[planarClusters[i]],
+            normals,
+            iterations,
+            samples,
+            generator
+        );
+    }
+
+    // Add planes to cluster map: cluster -> plane
+    for (size_t i = 0; i < planarClusters.size(); i++)
+    {
+        planes.insert(planarClusters[i], clusterPlanes[i]);
+    }
+
     return planes;
 }
 
@@ -667,6 +880,20 @@ Plane<BaseVecT> calcRegressionPlaneRANSAC(
     const int num_iterations,
     const int num_samples
 )
+{
+    std::minstd_rand generator(rand());
+    return calcRegressionPlaneRANSAC(mesh, cluster, normals, num_iterations, num_samples, generator);
+}
+
+template<typename BaseVecT, typename RandomGenerator>
+Plane<BaseVecT> calcRegressionPlaneRANSAC(
+    const BaseMesh<BaseVecT>& mesh,
+    const Cluster<FaceHandle>& cluster,
+    const FaceMap<Normal<typename BaseVecT::CoordType>>& normals,
+    const int num_iterations,
+    const int num_samples,
+    RandomGenerator& generator
+)
 {
     float error_limit = 0.01; // dynamically voxelsize / 100
     Plane<BaseVecT> best_plane;
@@ -710,6 +937,9 @@ Plane<BaseVecT> calcRegressionPlaneRANSAC(
     const size_t num_cluster_vertices = vertices.size();
     const size_t num_cluster_faces = cluster.size();
 
+    std::uniform_int_distribution<size_t> faceDist(0, num_cluster_faces - 1);
+    std::uniform_int_distribution<int> cornerDist(0, 2);
+
     for(int i=0; i<num_iterations; i++)
     {
         Plane<BaseVecT> plane;
@@ -723,8 +953,8 @@ Plane<BaseVecT> calcRegressionPlaneRANSAC(
         // build avg plane of RANSAC samples
         for(int j=0; j<num_samples; j++)
         {
-            const FaceHandle& faceHandle = cluster.handles[rand() % num_cluster_faces];
-            plane.pos += mesh.getVertexPositionsOfFace(faceHandle)[rand() % 3];
+            const FaceHandle& faceHandle = cluster.handles[faceDist(generator)];
+            plane.pos += mesh.getVertexPositionsOfFace(faceHandle)[cornerDist(generator)];
             plane.normal += normals[faceHandle];
         }
 
@@ -826,11 +1056,56 @@ void dragToRegressionPlanes(
     FaceMap<Normal<typename BaseVecT::CoordType>>& normals
 )
 {
-    // For all clusters in cluster map
+    // Dragging the clusters one after another moves a vertex once for every
+    // face of a planar cluster it belongs to, cluster by cluster in handle
+    // order. We replay exactly that per vertex, so every vertex is only
+    // touched by one thread.
+    const size_t numVertexIndices = mesh.nextVertexIndex();
+
+    #pragma omp parallel
+    {
+        vector<FaceHandle> faces;
+        vector<ClusterHandle> faceClusters;
+
+        #pragma omp for schedule(dynamic, 4096)
+        for (size_t i = 0; i < numVertexIndices; i++)
+        {
+            VertexHandle vH(i);
+            if (!mesh.containsVertex(vH))
+            {
+                continue;
+            }
+
+            faces.clear();
+            faceClusters.clear();
+            mesh.getFacesOfVertex(vH, faces);
+            for (auto faceH: faces)
+            {
+                auto clusterH = clusters.getClusterOf(faceH);
+                if (clusterH && planes.containsKey(clusterH.unwrap()))
+                {
+                    faceClusters.push_back(clusterH.unwrap());
+                }
+            }
+            std::sort(faceClusters.begin(), faceClusters.end());
+
+            auto& pos = mesh.getVertexPosition(vH);
+            for (auto clusterH: faceClusters)
+            {
+                const auto& plane = planes[clusterH];
+                auto distance = plane.distance(pos);
+                pos -= plane.normal * distance;
+            }
+        }
+    }
+
     for (auto clusterH: planes)
     {
-        // Drag all vertices of current cluster into regression plane
-        dragToRegressionPlane(mesh, clusters[clusterH], planes[clusterH], normals);
+        const auto& plane = planes[clusterH];
+        for (auto faceH: clusters[clusterH].handles)
+        {
+            normals[faceH] = plane.normal;
+        }
     }
 }
 
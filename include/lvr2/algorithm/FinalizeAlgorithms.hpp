@@ -48,6 +48,7 @@
 #include "lvr2/util/ClusterBiMap.hpp"
 #include "lvr2/texture/Texture.hpp"
 #include "lvr2/texture/Material.hpp"
+#include "lvr2/texture/TextureAtlas.hpp"
 #include "lvr2/algorithm/ClusterPainter.hpp"
 
 #include "lvr2/io/ObjIO.hpp"
@@ -140,6 +141,14 @@ public:
      */
     void setMaterializerResult(const MaterializerResult<BaseVecT>& materializerResult);
 
+    /**
+     * Packs the generated textures into atlas pages at the end of apply. Without an atlas, each textured
+     * cluster keeps its own texture.
+     *
+     * @param atlas the atlas configuration
+     */
+    void setTextureAtlas(const TextureAtlas& atlas);
+
     /**
      * Converts the given BaseMesh into a MeshBuffer and adds further data (e.g. colors, normals) if set
      *
@@ -167,6 +176,9 @@ private:
 
     // Materials and textures
     boost::optional<const MaterializerResult<BaseVecT>&> m_materializerResult;
+
+    // Texture atlas (optional)
+    boost::optional<TextureAtlas> m_textureAtlas;
 };
 
 } // namespace lvr2
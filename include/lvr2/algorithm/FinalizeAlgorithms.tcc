@@ -35,99 +35,177 @@
 #include <vector>
 #include <utility>
 #include <cmath>
+#include <algorithm>
+#include <numeric>
 
 #include "lvr2/algorithm/Materializer.hpp"
 
+#include "lvr2/config/lvropenmp.hpp"
+
 #include "lvr2/io/MeshBuffer.hpp"
 #include "lvr2/io/Progress.hpp"
 
+#include "lvr2/types/BufferPool.hpp"
 #include "lvr2/util/Util.hpp"
 
 namespace lvr2
 {
 
+namespace detail
+{
+
+/**
+ * @brief Collects all live handles with an index in [0, end) in ascending
+ *        index order.
+ *
+ * The index range is split into one block per thread. Each block counts its
+ * live handles, an exclusive prefix sum over these counts gives the output
+ * offset of every block and the blocks are then written in parallel.
+ */
+template<typename HandleT, typename ContainsFunc>
+std::vector<HandleT> collectLiveHandles(Index end, ContainsFunc contains)
+{
+    size_t numBlocks = std::max(OpenMPConfig::getNumThreads(), 1);
+    size_t blockSize = (static_cast<size_t>(end) + numBlocks - 1) / numBlocks;
+
+    std::vector<size_t> offsets(numBlocks + 1, 0);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < numBlocks; b++)
+    {
+        size_t first = std::min(b * blockSize, static_cast<size_t>(end));
+        size_t last = std::min(first + blockSize, static_cast<size_t>(end));
+        size_t count = 0;
+        for (size_t i = first; i < last; i++)
+        {
+            count += contains(HandleT(static_cast<Index>(i)));
+        }
+        offsets[b + 1] = count;
+    }
+
+    for (size_t b = 0; b < numBlocks; b++)
+    {
+        offsets[b + 1] += offsets[b];
+    }
+
+    std::vector<HandleT> handles(offsets[numBlocks], HandleT(0));
+
+    #pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < numBlocks; b++)
+    {
+        size_t first = std::min(b * blockSize, static_cast<size_t>(end));
+        size_t last = std::min(first + blockSize, static_cast<size_t>(end));
+        size_t out = offsets[b];
+        for (size_t i = first; i < last; i++)
+        {
+            HandleT handle(static_cast<Index>(i));
+            if (contains(handle))
+            {
+                handles[out++] = handle;
+            }
+        }
+    }
+
+    return handles;
+}
+
+} // namespace detail
+
 template<typename BaseVecT>
 MeshBufferPtr SimpleFinalizer<BaseVecT>::apply(const BaseMesh <BaseVecT>& mesh)
 {
-    // Create vertex and normal buffer
-    DenseVertexMap<size_t> idxMap;
-    idxMap.reserve(mesh.numVertices());
+    // Output positions of all vertices and faces. The handles are in the
+    // same order as the mesh iterators visit them.
+    auto vertexHandles = detail::collectLiveHandles<VertexHandle>(
+        mesh.nextVertexIndex(),
+        [&](VertexHandle vH) { return mesh.containsVertex(vH); });
+    auto faceHandles = detail::collectLiveHandles<FaceHandle>(
+        mesh.nextFaceIndex(),
+        [&](FaceHandle fH) { return mesh.containsFace(fH); });
+
+    size_t numVertices = vertexHandles.size();
+    size_t numFaces = faceHandles.size();
+
+    // Output index of each vertex, addressed by the handle index
+    vector<unsigned int> idxMap(mesh.nextVertexIndex());
 
-    vector<float> vertices;
-    vertices.reserve(mesh.numVertices() * 3);
+    // Create vertex, normal and color buffers
+    floatArr vertices = allocateArray<float>(numVertices * 3);
 
-    vector<float> normals;
+    floatArr normals;
     if (m_normalData)
     {
-        normals.reserve(mesh.numVertices() * 3);
+        normals = allocateArray<float>(numVertices * 3);
     }
 
-    vector<unsigned char> colors;
+    ucharArr colors;
     if (m_colorData)
     {
-        colors.reserve(mesh.numVertices() * 3);
+        colors = allocateArray<unsigned char>(numVertices * 3);
     }
 
     // for all vertices
-    size_t vertexCount = 0;
-    for (auto vH : mesh.vertices())
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numVertices; i++)
     {
+        VertexHandle vH = vertexHandles[i];
         auto point = mesh.getVertexPosition(vH);
 
         // add vertex positions to buffer
-        vertices.push_back(point.x);
-        vertices.push_back(point.y);
-        vertices.push_back(point.z);
+        vertices[i * 3 + 0] = point.x;
+        vertices[i * 3 + 1] = point.y;
+        vertices[i * 3 + 2] = point.z;
 
         if (m_normalData)
         {
             // add normal data to buffer if given
             auto normal = (*m_normalData)[vH];
-            normals.push_back(normal.getX());
-            normals.push_back(normal.getY());
-            normals.push_back(normal.getZ());
+            normals[i * 3 + 0] = normal.getX();
+            normals[i * 3 + 1] = normal.getY();
+            normals[i * 3 + 2] = normal.getZ();
         }
 
         if (m_colorData)
         {
             // add color data to buffer if given
-            colors.push_back(static_cast<unsigned char>((*m_colorData)[vH][0]));
-            colors.push_back(static_cast<unsigned char>((*m_colorData)[vH][1]));
-            colors.push_back(static_cast<unsigned char>((*m_colorData)[vH][2]));
+            const Rgb8Color& color = (*m_colorData)[vH];
+            colors[i * 3 + 0] = static_cast<unsigned char>(color[0]);
+            colors[i * 3 + 1] = static_cast<unsigned char>(color[1]);
+            colors[i * 3 + 2] = static_cast<unsigned char>(color[2]);
         }
 
         // Save index of vertex for face mapping
-        idxMap.insert(vH, vertexCount);
-        vertexCount++;
+        idxMap[vH.idx()] = i;
     }
 
     // Create face buffer
-    vector<unsigned int> faces;
-    faces.reserve(mesh.numFaces() * 3);
-    for (auto fH : mesh.faces())
+    indexArray faces = allocateArray<unsigned int>(numFaces * 3);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numFaces; i++)
     {
-        auto handles = mesh.getVerticesOfFace(fH);
-        for (auto handle : handles)
+        auto handles = mesh.getVerticesOfFace(faceHandles[i]);
+        for (size_t j = 0; j < 3; j++)
         {
             // add faces to buffer
-            faces.push_back(idxMap[handle]);
+            faces[i * 3 + j] = idxMap[handles[j].idx()];
         }
     }
 
     // create buffer object and pass values
     MeshBufferPtr buffer( new MeshBuffer );
 
-    buffer->setVertices(Util::convert_vector_to_shared_array(vertices), vertices.size() / 3);
-    buffer->setFaceIndices(Util::convert_vector_to_shared_array(faces), faces.size() / 3);
+    buffer->setVertices(vertices, numVertices);
+    buffer->setFaceIndices(faces, numFaces);
 
     if (m_normalData)
     {
-        buffer->setVertexNormals(Util::convert_vector_to_shared_array(normals));
+        buffer->setVertexNormals(normals);
     }
 
     if (m_colorData)
     {
-        buffer->setVertexColors(Util::convert_vector_to_shared_array(colors));
+        buffer->setVertexColors(colors);
     }
 
     return buffer;
@@ -176,142 +254,111 @@ void TextureFinalizer<BaseVecT>::setMaterializerResult(const MaterializerResult<
     m_materializerResult = matResult;
 }
 
-
 template<typename BaseVecT>
-MeshBufferPtr TextureFinalizer<BaseVecT>::apply(const BaseMesh<BaseVecT>& mesh)
+void TextureFinalizer<BaseVecT>::setTextureAtlas(const TextureAtlas& atlas)
 {
-    // Create vertex buffer and all buffers holding vertex attributes
-    vector<float> vertices;
-    vertices.reserve(mesh.numVertices() * 3 * 2);
+    m_textureAtlas = atlas;
+}
 
-    vector<float> normals;
-    if (m_vertexNormals)
-    {
-        normals.reserve(mesh.numVertices() * 3 * 2);
-    }
 
-    vector<unsigned char> colors;
-    if (m_clusterColors)
-    {
-        colors.reserve(mesh.numVertices() * 3 * 2);
-    }
-
-    // Create buffer and variables for texturizing
-    bool useTextures = false;
-    if (m_materializerResult && m_materializerResult.get().m_textures)
+template<typename BaseVecT>
+MeshBufferPtr TextureFinalizer<BaseVecT>::apply(const BaseMesh<BaseVecT>& mesh)
+{
+    vector<ClusterHandle> clusterHandles;
+    clusterHandles.reserve(m_cluster.numCluster());
+    for (auto clusterH: m_cluster)
     {
-        useTextures = true;
+        clusterHandles.push_back(clusterH);
     }
-    vector<float> texCoords;
-    vector<Material> materials;
-    vector<unsigned int> faceMaterials;
-    vector<unsigned int> clusterMaterials;
-    vector<Texture> textures;
-    vector<vector<unsigned int>> clusterFaceIndices;
-    size_t clusterCount = 0;
-    size_t faceCount = 0;
-
-    // Global material index will be used for indexing materials in the faceMaterialIndexBuffer
-    // The basic material will have the index 0
-    unsigned int globalMaterialIndex = 1;
-    // Create default material
-    unsigned char defaultR = 0, defaultG = 0, defaultB = 0;
-    Material m;
-    std::array<unsigned char, 3> arr = {defaultR, defaultG, defaultB};
-    m.m_color = std::move(arr);
-    materials.push_back(m);
-    // This map remembers which texture and material are associated with each other
-    std::map<int, unsigned int> textureMaterialMap; // Stores the ID of the material for each textureIndex
-    textureMaterialMap[-1] = 0; // texIndex -1 => no texture => default material with index 0
-
-    std::map<Rgb8Color, int> colorMaterialMap;
-
-    // Create face buffer
-    vector<unsigned int> faces;
-    faces.reserve(mesh.numFaces() * 3);
+    size_t numClusters = clusterHandles.size();
 
-    // This counter is used to determine the index of a newly inserted vertex
-    size_t vertexCount = 0;
+    // Each cluster gets its own copy of the vertices of its faces. The
+    // vertices of a cluster are stored in the order of their first use and
+    // the faces refer to them by their index within the cluster.
+    vector<vector<VertexHandle>> clusterVertices(numClusters);
+    vector<vector<unsigned int>> clusterFaces(numClusters);
 
     string comment = timestamp.getElapsedTime() + "Finalizing mesh ";
-    ProgressBar progress(m_cluster.numCluster(), comment);
+    ProgressBar progress(numClusters * 2, comment);
 
-    // Loop over all clusters
-    for (auto clusterH: m_cluster)
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (size_t c = 0; c < numClusters; c++)
     {
         // This map remembers which vertex we already inserted and at what
         // position. This is important to create the face map.
-        SparseVertexMap<size_t> idxMap;
+        SparseVertexMap<unsigned int> idxMap;
 
-        // Vector for storing indices of created faces
-        vector<unsigned int> faceIndices;
-
-        ++progress;
-
-        auto& cluster = m_cluster.getCluster(clusterH);
+        auto& cluster = m_cluster.getCluster(clusterHandles[c]);
+        auto& vertexList = clusterVertices[c];
+        auto& faceList = clusterFaces[c];
+        faceList.reserve(cluster.handles.size() * 3);
 
         // Loop over all faces of the cluster
         for (auto faceH: cluster.handles)
         {
             for (auto vertexH: mesh.getVerticesOfFace(faceH))
             {
-                // Check if we already inserted this vertex. If not...
+                // Check if we already inserted this vertex. If not, assign
+                // the next index of this cluster to it
                 if (!idxMap.containsKey(vertexH))
                 {
-                    // ... insert it into the buffers (with all its attributes)
-                    auto point = mesh.getVertexPosition(vertexH);
-
-                    vertices.push_back(point.x);
-                    vertices.push_back(point.y);
-                    vertices.push_back(point.z);
-
-                    if (m_vertexNormals)
-                    {
-                        auto normal = (*m_vertexNormals)[vertexH];
-                        normals.push_back(normal.getX());
-                        normals.push_back(normal.getY());
-                        normals.push_back(normal.getZ());
-                    }
-
-                    // If individual vertex colors are present: use these
-                    if (m_vertexColors)
-                    {
-                        colors.push_back(static_cast<unsigned char>((*m_vertexColors)[vertexH][0]));
-                        colors.push_back(static_cast<unsigned char>((*m_vertexColors)[vertexH][1]));
-                        colors.push_back(static_cast<unsigned char>((*m_vertexColors)[vertexH][2]));
-                    }
-                    else if (m_clusterColors)
-                    {
-                        // else: use cluster colors if present
-                        colors.push_back(static_cast<unsigned char>((*m_clusterColors)[clusterH][0]));
-                        colors.push_back(static_cast<unsigned char>((*m_clusterColors)[clusterH][1]));
-                        colors.push_back(static_cast<unsigned char>((*m_clusterColors)[clusterH][2]));
-                    } // else: no colors
-
-                    // Save index of vertex for face mapping
-                    idxMap.insert(vertexH, vertexCount);
-                    vertexCount++;
+                    idxMap.insert(vertexH, vertexList.size());
+                    vertexList.push_back(vertexH);
                 }
-
-                // At this point we know that the vertex is certainly in the
-                // map (and the buffers).
-                faces.push_back(idxMap[vertexH]);
+                faceList.push_back(idxMap[vertexH]);
             }
-            faceIndices.push_back(faceCount++);
         }
 
-        clusterFaceIndices.push_back(faceIndices);
+        ++progress;
+    }
 
-        // When using textures,
-        // For each cluster:
-        if (m_materializerResult)
-        {
-            // This map remembers which vertices were already visited for materials and textures
-            // Each vertex must be visited exactly once
-            SparseVertexMap<size_t> vertexVisitedMap;
-            size_t vertexVisitCount = 0;
+    // Exclusive prefix sums give the position of each cluster's vertices
+    // and faces in the output buffers
+    vector<size_t> vertexOffsets(numClusters + 1, 0);
+    vector<size_t> faceOffsets(numClusters + 1, 0);
+    for (size_t c = 0; c < numClusters; c++)
+    {
+        vertexOffsets[c + 1] = vertexOffsets[c] + clusterVertices[c].size();
+        faceOffsets[c + 1] = faceOffsets[c] + clusterFaces[c].size() / 3;
+    }
+    size_t numVertices = vertexOffsets[numClusters];
+    size_t numFaces = faceOffsets[numClusters];
+
+    // Create buffer and variables for texturizing
+    bool useTextures = false;
+    if (m_materializerResult && m_materializerResult.get().m_textures)
+    {
+        useTextures = true;
+    }
+    vector<Material> materials;
+    vector<unsigned int> clusterMaterials;
+    vector<Texture> textures;
 
-            Material m = m_materializerResult.get().m_clusterMaterials.get(clusterH).get();
+    // The material indices depend on the order in which the clusters are
+    // visited, so they are assigned sequentially before the buffers are
+    // filled.
+    if (m_materializerResult)
+    {
+        clusterMaterials.resize(numClusters);
+
+        // Global material index will be used for indexing materials in the faceMaterialIndexBuffer
+        // The basic material will have the index 0
+        unsigned int globalMaterialIndex = 1;
+        // Create default material
+        unsigned char defaultR = 0, defaultG = 0, defaultB = 0;
+        Material m;
+        std::array<unsigned char, 3> arr = {defaultR, defaultG, defaultB};
+        m.m_color = std::move(arr);
+        materials.push_back(m);
+        // This map remembers which texture and material are associated with each other
+        std::map<int, unsigned int> textureMaterialMap; // Stores the ID of the material for each textureIndex
+        textureMaterialMap[-1] = 0; // texIndex -1 => no texture => default material with index 0
+
+        std::map<Rgb8Color, int> colorMaterialMap;
+
+        for (size_t c = 0; c < numClusters; c++)
+        {
+            Material m = m_materializerResult.get().m_clusterMaterials.get(clusterHandles[c]).get();
             bool clusterHasTextures = static_cast<bool>(m.m_texture); // optional
             bool clusterHasColor = static_cast<bool>(m.m_color); // optional
 
@@ -347,14 +394,14 @@ MeshBufferPtr TextureFinalizer<BaseVecT>::apply(const BaseMesh<BaseVecT>& mesh)
             else if (clusterHasColor)
             {
                 // Else: does this face have a color?
-                Rgb8Color c = m.m_color.get();
-                if (colorMaterialMap.count(c))
+                Rgb8Color color = m.m_color.get();
+                if (colorMaterialMap.count(color))
                 {
-                    materialIndex = colorMaterialMap[c];
+                    materialIndex = colorMaterialMap[color];
                 }
                 else
                 {
-                    colorMaterialMap[c] = globalMaterialIndex;
+                    colorMaterialMap[color] = globalMaterialIndex;
                     materials.push_back(m);
                     materialIndex = globalMaterialIndex;
                     globalMaterialIndex++;
@@ -365,68 +412,134 @@ MeshBufferPtr TextureFinalizer<BaseVecT>::apply(const BaseMesh<BaseVecT>& mesh)
                 materialIndex = 0;
             }
 
-            clusterMaterials.push_back(materialIndex);
+            clusterMaterials[c] = materialIndex;
+        }
+    }
+
+    // Create vertex and face buffers and all buffers holding attributes
+    floatArr vertices = allocateArray<float>(numVertices * 3);
+    indexArray faces = allocateArray<unsigned int>(numFaces * 3);
+
+    floatArr normals;
+    if (m_vertexNormals)
+    {
+        normals = allocateArray<float>(numVertices * 3);
+    }
+
+    ucharArr colors;
+    if (m_clusterColors || m_vertexColors)
+    {
+        colors = allocateArray<unsigned char>(numVertices * 3);
+    }
+
+    floatArr texCoords;
+    indexArray faceMaterials;
+    if (m_materializerResult)
+    {
+        texCoords = allocateArray<float>(numVertices * 2);
+        faceMaterials = allocateArray<unsigned int>(numFaces);
+    }
+
+    // Every cluster writes into its own range of the buffers
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (size_t c = 0; c < numClusters; c++)
+    {
+        ClusterHandle clusterH = clusterHandles[c];
+        const auto& vertexList = clusterVertices[c];
+        const auto& faceList = clusterFaces[c];
+        size_t vertexOffset = vertexOffsets[c];
+        size_t faceOffset = faceOffsets[c];
 
+        for (size_t i = 0; i < vertexList.size(); i++)
+        {
+            VertexHandle vertexH = vertexList[i];
+            size_t out = vertexOffset + i;
 
+            auto point = mesh.getVertexPosition(vertexH);
+            vertices[out * 3 + 0] = point.x;
+            vertices[out * 3 + 1] = point.y;
+            vertices[out * 3 + 2] = point.z;
 
-            // For each face in cluster:
-            // Materials
-            for (auto faceH : cluster.handles)
+            if (m_vertexNormals)
             {
+                auto normal = (*m_vertexNormals)[vertexH];
+                normals[out * 3 + 0] = normal.getX();
+                normals[out * 3 + 1] = normal.getY();
+                normals[out * 3 + 2] = normal.getZ();
+            }
 
-                faceMaterials.push_back(materialIndex);
+            // If individual vertex colors are present: use these
+            if (m_vertexColors)
+            {
+                const Rgb8Color& color = (*m_vertexColors)[vertexH];
+                colors[out * 3 + 0] = static_cast<unsigned char>(color[0]);
+                colors[out * 3 + 1] = static_cast<unsigned char>(color[1]);
+                colors[out * 3 + 2] = static_cast<unsigned char>(color[2]);
+            }
+            else if (m_clusterColors)
+            {
+                // else: use cluster colors if present
+                const Rgb8Color& color = (*m_clusterColors)[clusterH];
+                colors[out * 3 + 0] = static_cast<unsigned char>(color[0]);
+                colors[out * 3 + 1] = static_cast<unsigned char>(color[1]);
+                colors[out * 3 + 2] = static_cast<unsigned char>(color[2]);
+            } // else: no colors
+
+            if (m_materializerResult)
+            {
+                auto& vertexTexCoords = m_materializerResult.get().m_vertexTexCoords;
+                bool vertexHasTexCoords = vertexTexCoords.is_initialized()
+                                          ? static_cast<bool>(vertexTexCoords.get().get(vertexH))
+                                          : false;
 
-                // For each vertex in face:
-                for (auto vertexH : mesh.getVerticesOfFace(faceH))
+                if (useTextures && vertexHasTexCoords)
                 {
-                    if (!vertexVisitedMap.containsKey(vertexH))
-                    {
-                        auto& vertexTexCoords = m_materializerResult.get().m_vertexTexCoords;
-                        bool vertexHasTexCoords = vertexTexCoords.is_initialized()
-                                                  ? static_cast<bool>(vertexTexCoords.get().get(vertexH))
-                                                  : false;
-
-                        if (useTextures && vertexHasTexCoords)
-                        {
-                            // Use tex coord vertex map to find texture coords
-                            const TexCoords coords = m_materializerResult.get()
-                                .m_vertexTexCoords.get()
-                                .get(vertexH).get()
-                                .getTexCoords(clusterH);
-
-                            texCoords.push_back(coords.u);
-                            texCoords.push_back(coords.v);
-                            texCoords.push_back(0.0);
-                        } else {
-                            // Cluster does not have a texture, use default coords
-                            // Every vertex needs an entry in this buffer,
-                            // This is why 0's are inserted
-                            texCoords.push_back(0.0);
-                            texCoords.push_back(0.0);
-                            texCoords.push_back(0.0);
-                        }
-                        vertexVisitedMap.insert(vertexH, vertexVisitCount);
-                        vertexVisitCount++;
-                    }
+                    // Use tex coord vertex map to find texture coords
+                    const TexCoords coords = vertexTexCoords.get()
+                        .get(vertexH).get()
+                        .getTexCoords(clusterH);
+
+                    texCoords[out * 2 + 0] = coords.u;
+                    texCoords[out * 2 + 1] = coords.v;
+                }
+                else
+                {
+                    // Cluster does not have a texture, use default coords
+                    // Every vertex needs an entry in this buffer,
+                    // This is why 0's are inserted
+                    texCoords[out * 2 + 0] = 0.0;
+                    texCoords[out * 2 + 1] = 0.0;
                 }
             }
         }
+
+        for (size_t i = 0; i < faceList.size(); i++)
+        {
+            faces[faceOffset * 3 + i] = vertexOffset + faceList[i];
+        }
+
+        if (m_materializerResult)
+        {
+            std::fill_n(faceMaterials.get() + faceOffset, faceList.size() / 3, clusterMaterials[c]);
+        }
+
+        ++progress;
     }
 
     cout << endl;
 
     MeshBufferPtr buffer = MeshBufferPtr( new MeshBuffer );
-    buffer->setVertices(Util::convert_vector_to_shared_array(vertices), vertices.size() / 3);
-    buffer->setFaceIndices(Util::convert_vector_to_shared_array(faces), faces.size() / 3);
+    buffer->setVertices(vertices, numVertices);
+    buffer->setFaceIndices(faces, numFaces);
 
     if (m_vertexNormals)
     {
-        buffer->setVertexNormals(Util::convert_vector_to_shared_array(normals));
+        buffer->setVertexNormals(normals);
     }
 
     if (m_clusterColors || m_vertexColors)
     {
-        buffer->setVertexColors(Util::convert_vector_to_shared_array(colors));
+        buffer->setVertexColors(colors);
     }
 
     if (m_materializerResult)
@@ -436,24 +549,24 @@ MeshBufferPtr TextureFinalizer<BaseVecT>::apply(const BaseMesh<BaseVecT>& mesh)
         mats.insert(mats.end(), materials.begin(), materials.end());
         texts.insert(texts.end(), textures.begin(), textures.end());
 
-        buffer->setFaceMaterialIndices(Util::convert_vector_to_shared_array(faceMaterials));
+        buffer->setFaceMaterialIndices(faceMaterials);
         buffer->addIndexChannel(Util::convert_vector_to_shared_array(clusterMaterials), "cluster_material_indices", clusterMaterials.size(), 1);
+        buffer->setTextureCoordinates(texCoords);
 
-        // convert from 3 floats per vertex to 2...
-        floatArr texCoordsArr = floatArr( new float[(texCoords.size() / 3) * 2] );
-
-        for (size_t i = 0; i < texCoords.size() / 3; i++)
+        // TODO TALK TO THOMAS
+        for (size_t c = 0; c < numClusters; c++)
         {
-            texCoordsArr[i*2 + 0] = texCoords[i*3 + 0];
-            texCoordsArr[i*2 + 1] = texCoords[i*3 + 1];
+            size_t clusterNumFaces = faceOffsets[c + 1] - faceOffsets[c];
+            indexArray faceIndices = allocateArray<unsigned int>(clusterNumFaces);
+            std::iota(faceIndices.get(), faceIndices.get() + clusterNumFaces, faceOffsets[c]);
+
+            std::string cluster_name = "cluster" + std::to_string(c) + "_face_indices";
+            buffer->addIndexChannel(faceIndices, cluster_name, clusterNumFaces, 1);
         }
-        buffer->setTextureCoordinates(texCoordsArr);
 
-        // TODO TALK TO THOMAS
-        for (size_t i = 0; i < clusterFaceIndices.size(); i++)
+        if (m_textureAtlas && useTextures)
         {
-            std::string cluster_name = "cluster" + std::to_string(i) + "_face_indices";
-            buffer->addIndexChannel(Util::convert_vector_to_shared_array(clusterFaceIndices[i]), cluster_name, clusterFaceIndices[i].size(), 1);
+            m_textureAtlas->apply(*buffer);
         }
     }
 
@@ -33,9 +33,12 @@
 #define LVR2_ALGORITHM_GEOMETRYALGORITHMS_H_
 
 #include "lvr2/geometry/BaseMesh.hpp"
+#include "lvr2/geometry/CompactMesh.hpp"
 #include "lvr2/attrmaps/AttrMaps.hpp"
 #include "lvr2/geometry/Handles.hpp"
+#include <cstdint>
 #include <list>
+#include <unordered_map>
 
 namespace lvr2
 {
@@ -81,17 +84,134 @@ void visitLocalVertexNeighborhood(
     VisitorF visitor
 );
 
+/**
+ * @brief Reusable working memory for `visitLocalVertexNeighborhood`.
+ *
+ * Keeping one instance per thread avoids allocating a fresh visited set for
+ * every single vertex. After each search only the bits of the vertices that
+ * were actually visited are reset, so a search costs time proportional to the
+ * size of the neighborhood and not to the size of the mesh.
+ */
+struct LocalNeighborhoodScratch
+{
+    /// One bit per vertex index, set while the vertex is part of the current search
+    vector<uint64_t> visited;
+
+    /// Vertices that still have to be expanded
+    vector<VertexHandle> stack;
+
+    /// Vertices whose visited bit has to be reset after the search
+    vector<VertexHandle> touched;
+
+    /// Direct neighbors of the vertex that is currently expanded
+    vector<VertexHandle> directNeighbors;
+};
+
+/**
+ * @brief Same as `visitLocalVertexNeighborhood` above, but uses the given
+ *        scratch memory instead of allocating its own.
+ *
+ * The scratch memory grows on demand and can be reused for any number of
+ * searches on the same thread.
+ */
+template <typename BaseVecT, typename VisitorF>
+void visitLocalVertexNeighborhood(
+    const BaseMesh<BaseVecT>& mesh,
+    VertexHandle vH,
+    double radius,
+    LocalNeighborhoodScratch& scratch,
+    VisitorF visitor
+);
+
+/**
+ * @brief Defines which vertices form the local neighborhood of a vertex.
+ */
+enum class NeighborhoodMode
+{
+    /// All vertices that are connected to the vertex via a path that stays
+    /// within the radius (see `visitLocalVertexNeighborhood`).
+    Connected,
+
+    /// All vertices within the euclidean radius, looked up in a uniform grid.
+    /// This is considerably cheaper on dense meshes, but also includes
+    /// vertices of surface parts that are not connected to the vertex.
+    Radius
+};
+
+/**
+ * @brief Uniform grid over the vertex positions of a mesh that answers
+ *        fixed radius queries.
+ *
+ * The vertices are sorted by cell, so the vertices of one cell are stored
+ * contiguously together with their positions. The grid keeps a reference to
+ * the mesh and has to be rebuilt when vertices are added, moved or removed.
+ */
+template<typename BaseVecT>
+class VertexRadiusGrid
+{
+public:
+
+    /**
+     * @brief Builds the grid.
+     *
+     * @param mesh      The mesh whose vertices are indexed
+     * @param cellSize  The edge length of a grid cell. Queries are the
+     *                  cheapest if the radius is about the cell size. A
+     *                  cell size <= 0 is replaced by the extent of the
+     *                  mesh, since queries with such a radius are empty.
+     */
+    VertexRadiusGrid(const BaseMesh<BaseVecT>& mesh, double cellSize);
+
+    /**
+     * @brief Calls `visitor` for every vertex that is closer than `radius`
+     *        to `vH`, except `vH` itself. Nothing is visited for a radius
+     *        <= 0.
+     */
+    template<typename VisitorF>
+    void visitNeighbors(VertexHandle vH, double radius, VisitorF visitor) const;
+
+private:
+
+    using CellKey = uint64_t;
+
+    /// Returns the key of the cell with the given integer coordinates
+    CellKey cellKey(int64_t x, int64_t y, int64_t z) const;
+
+    /// Returns the integer cell coordinate for the given world coordinate
+    int64_t cellIndex(typename BaseVecT::CoordType c, typename BaseVecT::CoordType min) const;
+
+    const BaseMesh<BaseVecT>& m_mesh;
+
+    double m_cellSize;
+
+    BaseVecT m_min;
+
+    /// The vertices, sorted by cell
+    vector<VertexHandle> m_handles;
+
+    /// The positions of the vertices in m_handles
+    vector<BaseVecT> m_positions;
+
+    /// Range [first, second) in m_handles for each non-empty cell
+    std::unordered_map<CellKey, std::pair<size_t, size_t>> m_cells;
+};
+
 /**
  * @brief   Calculate the height difference value for each vertex of the given BaseMesh.
  *
  * @param mesh      The given BaseMesh for calculating vertex height differences.
  * @param radius    The radius which defines the border of the local neighborhood.
+ * @param mode      How the local neighborhood is determined.
  *
  * @return  A map filled with <Vertex, float>-entries, storing the height difference value
  *          of each vertex.
  */
 template<typename BaseVecT>
-DenseVertexMap<float> calcVertexHeightDifferences(const BaseMesh<BaseVecT>& mesh, double radius);
+DenseVertexMap<float> calcVertexHeightDifferences(
+        const BaseMesh<BaseVecT>& mesh,
+        double radius,
+        NeighborhoodMode mode = NeighborhoodMode::Connected
+);
 
 /**
  * @brief Calculates the roughness for each vertex.
@@ -106,6 +226,7 @@ DenseVertexMap<float> calcVertexHeightDifferences(const BaseMesh<BaseVecT>& mesh
  *                  the neighborhood.
  * @param normals   The vertex normals of the given mesh as a map.
  *                  The normals are necessary in this function for delegating them to the submethods.
+ * @param mode      How the local neighborhood is determined.
  *
  * @return A map <vertex, float> filled with roughness values for each vertex.
  */
@@ -113,7 +234,8 @@ template<typename BaseVecT>
 DenseVertexMap<float> calcVertexRoughness(
         const BaseMesh<BaseVecT>& mesh,
         double radius,
-        const VertexMap<Normal<typename BaseVecT::CoordType>>& normals
+        const VertexMap<Normal<typename BaseVecT::CoordType>>& normals,
+        NeighborhoodMode mode = NeighborhoodMode::Connected
 );
 
 /**
@@ -162,6 +284,7 @@ DenseEdgeMap<float> calcVertexAngleEdges(
  * @param normals     The vertex normals of the given mesh.
  * @param roughness   The calculated roughness values for each vertex.
  * @param heightDiff  The calculated height difference values for each vertex.
+ * @param mode        How the local neighborhood is determined.
  */
 template<typename BaseVecT>
 void calcVertexRoughnessAndHeightDifferences(
@@ -169,7 +292,8 @@ void calcVertexRoughnessAndHeightDifferences(
         double radius,
         const VertexMap<Normal<typename BaseVecT::CoordType>>& normals,
         DenseVertexMap<float>& roughness,
-        DenseVertexMap<float>& heightDiff
+        DenseVertexMap<float>& heightDiff,
+        NeighborhoodMode mode = NeighborhoodMode::Connected
 );
 
 /**
@@ -204,6 +328,22 @@ bool Dijkstra(
     DenseVertexMap<float>& vertex_costs);
 
 
+/**
+ * @brief Calculates the angle between two vertex normals for each edge of the
+ *        compact mesh in parallel.
+ */
+template<typename BaseVecT>
+DenseEdgeMap<float> calcVertexAngleEdges(
+        const CompactMesh<BaseVecT>& mesh,
+        const VertexMap<Normal<typename BaseVecT::CoordType>>& normals
+);
+
+/**
+ * @brief Computes the length of each edge of the compact mesh in parallel.
+ */
+template<typename BaseVecT>
+DenseEdgeMap<float> calcVertexDistances(const CompactMesh<BaseVecT>& mesh);
+
 } // namespace lvr2
 
 #include "GeometryAlgorithms.tcc"
@@ -30,7 +30,9 @@
  */
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include <memory>
 #include <queue>
 
 #include "lvr2/attrmaps/AttrMaps.hpp"
@@ -62,89 +64,316 @@ void visitLocalVertexNeighborhood(
     VisitorF visitor
 )
 {
-    // Prepare values for the radius test
+    LocalNeighborhoodScratch scratch;
+    visitLocalVertexNeighborhood(mesh, vH, radius, scratch, visitor);
+}
+
+template <typename BaseVecT, typename VisitorF>
+void visitLocalVertexNeighborhood(
+    const BaseMesh<BaseVecT>& mesh,
+    VertexHandle vH,
+    double radius,
+    LocalNeighborhoodScratch& scratch,
+    VisitorF visitor
+)
+{
+    // The bitset has to cover every possible vertex index. It only grows, so
+    // the scratch can be reused for all vertices of the mesh.
+    const size_t numWords = (mesh.nextVertexIndex() + 63) / 64;
+    if (scratch.visited.size() < numWords)
+    {
+        scratch.visited.resize(numWords, 0);
+    }
+
+    auto& visited = scratch.visited;
+    auto& stack = scratch.stack;
+    auto& touched = scratch.touched;
+
+    auto isVisited = [&](VertexHandle h) {
+        return (visited[h.idx() >> 6] >> (h.idx() & 63)) & 1;
+    };
+    auto markVisited = [&](VertexHandle h) {
+        visited[h.idx() >> 6] |= uint64_t(1) << (h.idx() & 63);
+        touched.push_back(h);
+    };
+
     auto vPos = mesh.getVertexPosition(vH);
     const double radiusSquared = radius * radius;
 
-    // Store the vertices we want to expand. We reserve memory for 8 vertices
-    // already, since it's rather likely to have at least that many vertices
-    // in the stack. In the beginning, the stack only contains the original
-    // vertex we were given.
-    vector<VertexHandle> stack;
-    stack.reserve(8);
+    stack.clear();
+    touched.clear();
     stack.push_back(vH);
+    markVisited(vH);
 
-    // In this map we store whether or not we have already visited a vertex,
-    // where visiting means: calling the visitor with it and pushing it on
-    // the stack of vertices we still need to expand.
-    //
-    // It would be more appropriate to use a set instead of a map, but there
-    // are no attribute-sets...
-    SparseVertexMap<bool> visited(8, false);
-    visited.insert(vH, true);
-
-    // This vector is later used to store the neighbors of a vertex. It's
-    // created here to reduce the amount of heap allocations.
-    vector<VertexHandle> directNeighbors;
-
-    // As long as there are vertices we want to expand...
     while (!stack.empty())
     {
-        // Get the next vertex and remove it from the stack.
         auto curVH = stack.back();
         stack.pop_back();
 
-        // Expand current vertex: add visit its direct neighbors.
-        directNeighbors.clear();
-        mesh.getNeighboursOfVertex(curVH, directNeighbors);
-        for (auto newVH: directNeighbors)
+        scratch.directNeighbors.clear();
+        mesh.getNeighboursOfVertex(curVH, scratch.directNeighbors);
+        for (auto newVH: scratch.directNeighbors)
         {
-            // If this vertex is within the radius of the original vertex, we
-            // want to visit it later, thus pushing it onto the stack. But we
-            // only do that if we haven't visited the vertex before. We use
-            // `containsKey` here because we only insert `true` anyway.
+            if (isVisited(newVH))
+            {
+                continue;
+            }
             auto distSquared = mesh.getVertexPosition(newVH).squaredDistanceFrom(vPos);
-            if (!visited.containsKey(newVH) && distSquared < radiusSquared)
+            if (distSquared < radiusSquared)
             {
                 visitor(newVH);
                 stack.push_back(newVH);
-                visited.insert(newVH, true);
+                markVisited(newVH);
             }
         }
     }
+
+    // Reset only the bits we have set, the rest of the bitset is still zero
+    for (auto h: touched)
+    {
+        visited[h.idx() >> 6] = 0;
+    }
 }
 
-template <typename BaseVecT>
-DenseVertexMap<float> calcVertexHeightDifferences(const BaseMesh<BaseVecT>& mesh, double radius)
+template<typename BaseVecT>
+VertexRadiusGrid<BaseVecT>::VertexRadiusGrid(const BaseMesh<BaseVecT>& mesh, double cellSize)
+    : m_mesh(mesh), m_cellSize(cellSize)
 {
-    // We create a map to store a height-diff for each vertex. We preallocate
-    // memory for all vertices. This is not only an optimization, but more
-    // importantly to avoid multithreading crashes. The parallelized loop
-    // further down inserts into this data structure; if there is no free
-    // memory left, it will reallocate which will crash horribly when multiple
-    // threads are involved.
-    DenseVertexMap<float> heightDiff;
-    heightDiff.reserve(mesh.nextVertexIndex());
+    using CoordType = typename BaseVecT::CoordType;
+
+    m_handles.reserve(mesh.numVertices());
+    m_min = BaseVecT(
+        std::numeric_limits<CoordType>::max(),
+        std::numeric_limits<CoordType>::max(),
+        std::numeric_limits<CoordType>::max()
+    );
+    BaseVecT max(
+        std::numeric_limits<CoordType>::lowest(),
+        std::numeric_limits<CoordType>::lowest(),
+        std::numeric_limits<CoordType>::lowest()
+    );
+    for (auto vH: mesh.vertices())
+    {
+        auto pos = mesh.getVertexPosition(vH);
+        m_min.x = std::min(m_min.x, pos.x);
+        m_min.y = std::min(m_min.y, pos.y);
+        m_min.z = std::min(m_min.z, pos.z);
+        max.x = std::max(max.x, pos.x);
+        max.y = std::max(max.y, pos.y);
+        max.z = std::max(max.z, pos.z);
+        m_handles.push_back(vH);
+    }
 
-    // Output
-    string msg = timestamp.getElapsedTime() + "Computing height differences...";
-    ProgressBar progress(mesh.numVertices(), msg);
-    ++progress;
+    // A cell size of zero would divide by zero. Such a grid can only be
+    // queried with a radius of zero, which finds nothing, so a single cell
+    // spanning all vertices is as good as any other grid.
+    if (!(m_cellSize > 0))
+    {
+        double extent = m_handles.empty()
+            ? 0.0 : std::max({max.x - m_min.x, max.y - m_min.y, max.z - m_min.z});
+        m_cellSize = extent > 0 ? extent : 1.0;
+    }
+
+    // Compute the cell of every vertex and sort the vertices by it
+    vector<std::pair<CellKey, VertexHandle>> keyed(m_handles.size(), {0, VertexHandle(0)});
+    #pragma omp parallel for
+    for (size_t i = 0; i < m_handles.size(); i++)
+    {
+        auto pos = mesh.getVertexPosition(m_handles[i]);
+        keyed[i] = {
+            cellKey(cellIndex(pos.x, m_min.x), cellIndex(pos.y, m_min.y), cellIndex(pos.z, m_min.z)),
+            m_handles[i]
+        };
+    }
+    std::sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first || (a.first == b.first && a.second.idx() < b.second.idx());
+    });
 
-    // Calculate height difference for each vertex
+    m_positions.resize(keyed.size());
     #pragma omp parallel for
-    for (size_t i = 0; i < mesh.nextVertexIndex(); i++)
+    for (size_t i = 0; i < keyed.size(); i++)
     {
-        auto vH = VertexHandle(i);
-        if (!mesh.containsVertex(vH))
+        m_handles[i] = keyed[i].second;
+        m_positions[i] = mesh.getVertexPosition(keyed[i].second);
+    }
+
+    size_t first = 0;
+    for (size_t i = 1; i <= keyed.size(); i++)
+    {
+        if (i == keyed.size() || keyed[i].first != keyed[first].first)
         {
-            continue;
+            m_cells.emplace(keyed[first].first, std::make_pair(first, i));
+            first = i;
         }
+    }
+}
+
+template<typename BaseVecT>
+typename VertexRadiusGrid<BaseVecT>::CellKey VertexRadiusGrid<BaseVecT>::cellKey(
+    int64_t x,
+    int64_t y,
+    int64_t z
+) const
+{
+    // 21 bits per axis. Coordinates beyond that wrap around, which only
+    // merges far apart cells. The distance test in visitNeighbors() filters
+    // the additional vertices.
+    const uint64_t mask = (uint64_t(1) << 21) - 1;
+    return (uint64_t(x) & mask) | ((uint64_t(y) & mask) << 21) | ((uint64_t(z) & mask) << 42);
+}
+
+template<typename BaseVecT>
+int64_t VertexRadiusGrid<BaseVecT>::cellIndex(
+    typename BaseVecT::CoordType c,
+    typename BaseVecT::CoordType min
+) const
+{
+    return static_cast<int64_t>(std::floor((c - min) / m_cellSize));
+}
+
+template<typename BaseVecT>
+template<typename VisitorF>
+void VertexRadiusGrid<BaseVecT>::visitNeighbors(VertexHandle vH, double radius, VisitorF visitor) const
+{
+    if (!(radius > 0))
+    {
+        return;
+    }
+
+    auto center = m_mesh.getVertexPosition(vH);
+    const double radiusSquared = radius * radius;
+    const int64_t reach = static_cast<int64_t>(std::ceil(radius / m_cellSize));
+
+    const int64_t cx = cellIndex(center.x, m_min.x);
+    const int64_t cy = cellIndex(center.y, m_min.y);
+    const int64_t cz = cellIndex(center.z, m_min.z);
+
+    for (int64_t x = cx - reach; x <= cx + reach; x++)
+    {
+        for (int64_t y = cy - reach; y <= cy + reach; y++)
+        {
+            for (int64_t z = cz - reach; z <= cz + reach; z++)
+            {
+                auto it = m_cells.find(cellKey(x, y, z));
+                if (it == m_cells.end())
+                {
+                    continue;
+                }
+                for (size_t i = it->second.first; i < it->second.second; i++)
+                {
+                    if (m_handles[i] != vH && m_positions[i].squaredDistanceFrom(center) < radiusSquared)
+                    {
+                        visitor(m_handles[i]);
+                    }
+                }
+            }
+        }
+    }
+}
 
+/**
+ * @brief Inserts `value` for every vertex of the mesh.
+ *
+ * Afterwards the map holds a slot for every vertex, so the slots can be
+ * overwritten concurrently by different threads without any locking.
+ */
+template<typename BaseVecT, typename ValueT>
+void fillDenseVertexMap(const BaseMesh<BaseVecT>& mesh, DenseVertexMap<ValueT>& map, const ValueT& value)
+{
+    map.clear();
+    map.reserve(mesh.nextVertexIndex());
+    for (auto vH: mesh.vertices())
+    {
+        map.insert(vH, value);
+    }
+}
+
+/**
+ * @brief Calls `kernel(vH, visit)` in parallel for every vertex of the mesh.
+ *
+ * `visit(visitor)` calls `visitor` for every vertex in the local neighborhood
+ * of `vH`, as defined by `mode`. Every thread uses its own neighborhood
+ * scratch memory, so there is no locking involved apart from the progress
+ * bar, which is only updated every few thousand vertices.
+ */
+template<typename BaseVecT, typename KernelF>
+void forEachLocalVertexNeighborhood(
+    const BaseMesh<BaseVecT>& mesh,
+    double radius,
+    NeighborhoodMode mode,
+    ProgressBar* progress,
+    KernelF kernel
+)
+{
+    std::unique_ptr<VertexRadiusGrid<BaseVecT>> grid;
+    if (mode == NeighborhoodMode::Radius)
+    {
+        grid = std::make_unique<VertexRadiusGrid<BaseVecT>>(mesh, radius);
+    }
+
+    const size_t progressStep = 4096;
+    const size_t numIndices = mesh.nextVertexIndex();
+
+    #pragma omp parallel
+    {
+        LocalNeighborhoodScratch scratch;
+        size_t done = 0;
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (size_t i = 0; i < numIndices; i++)
+        {
+            auto vH = VertexHandle(i);
+            if (!mesh.containsVertex(vH))
+            {
+                continue;
+            }
+
+            kernel(vH, [&](auto visitor) {
+                if (grid)
+                {
+                    grid->visitNeighbors(vH, radius, visitor);
+                }
+                else
+                {
+                    visitLocalVertexNeighborhood(mesh, vH, radius, scratch, visitor);
+                }
+            });
+
+            if (progress && ++done == progressStep)
+            {
+                *progress += done;
+                done = 0;
+            }
+        }
+
+        if (progress && done)
+        {
+            *progress += done;
+        }
+    }
+}
+
+template <typename BaseVecT>
+DenseVertexMap<float> calcVertexHeightDifferences(
+    const BaseMesh<BaseVecT>& mesh,
+    double radius,
+    NeighborhoodMode mode
+)
+{
+    // Every vertex gets its slot before the parallel loop, so the loop only
+    // overwrites existing values and doesn't need any synchronization.
+    DenseVertexMap<float> heightDiff;
+    fillDenseVertexMap(mesh, heightDiff, 0.0f);
+
+    // Output
+    string msg = timestamp.getElapsedTime() + "Computing height differences...";
+    ProgressBar progress(mesh.numVertices(), msg);
+
+    forEachLocalVertexNeighborhood(mesh, radius, mode, &progress, [&](auto vH, auto visit) {
         float minHeight = std::numeric_limits<float>::max();
         float maxHeight = std::numeric_limits<float>::lowest();
 
-        visitLocalVertexNeighborhood(mesh, vH, radius, [&](auto neighbor) {
+        visit([&](auto neighbor) {
             auto curPos = mesh.getVertexPosition(neighbor);
 
             if (curPos.z < minHeight)
@@ -158,12 +387,8 @@ DenseVertexMap<float> calcVertexHeightDifferences(const BaseMesh<BaseVecT>& mesh
         });
 
         // Calculate the final height difference
-        #pragma omp critical
-        {
-            heightDiff.insert(vH, maxHeight - minHeight);
-            ++progress;
-        }
-    }
+        heightDiff[vH] = maxHeight - minHeight;
+    });
 
     return heightDiff;
 }
@@ -209,52 +434,35 @@ template<typename BaseVecT>
 DenseVertexMap<float> calcVertexRoughness(
     const BaseMesh<BaseVecT>& mesh,
     double radius,
-    const VertexMap<Normal<typename BaseVecT::CoordType>>& normals
+    const VertexMap<Normal<typename BaseVecT::CoordType>>& normals,
+    NeighborhoodMode mode
 )
 {
-    // We create a map to store the roughness for each vertex. We preallocate
-    // memory for all vertices. This is not only an optimization, but more
-    // importantly to avoid multithreading crashes. The parallelized loop
-    // further down inserts into this data structure; if there is no free
-    // memory left, it will reallocate which will crash horribly when multiple
-    // threads are involved.
+    // Every vertex gets its slot before the parallel loop, so the loop only
+    // overwrites existing values and doesn't need any synchronization.
     DenseVertexMap<float> roughness;
-    roughness.reserve(mesh.nextVertexIndex());
+    fillDenseVertexMap(mesh, roughness, 0.0f);
 
-    auto averageAngles = calcAverageVertexAngles(mesh, normals);
+    const auto averageAngles = calcAverageVertexAngles(mesh, normals);
 
     // Output
     string msg = timestamp.getElapsedTime() + "Computing roughness";
     ProgressBar progress(mesh.numVertices(), msg);
-    ++progress;
-
-    // Calculate roughness for each vertex
-    #pragma omp parallel for
-    for (size_t i = 0; i < mesh.nextVertexIndex(); i++)
-    {
-        auto vH = VertexHandle(i);
-        if (!mesh.containsVertex(vH))
-        {
-            continue;
-        }
 
+    forEachLocalVertexNeighborhood(mesh, radius, mode, &progress, [&](auto vH, auto visit) {
         float sum = 0.0;
         size_t count = 0;
 
-        visitLocalVertexNeighborhood(mesh, vH, radius, [&](auto neighbor) {
+        visit([&](auto neighbor) {
             sum += averageAngles[neighbor];
             count += 1;
         });
 
-        #pragma omp critical
-        {
-            // Calculate the final roughness
-            roughness.insert(vH, count ? sum / count : 0);
-            ++progress;
-        }
-    }
-    return roughness;
+        // Calculate the final roughness
+        roughness[vH] = count ? sum / count : 0;
+    });
 
+    return roughness;
 }
 
 template<typename BaseVecT>
@@ -263,34 +471,25 @@ void calcVertexRoughnessAndHeightDifferences(
     double radius,
     const VertexMap<Normal<typename BaseVecT::CoordType>>& normals,
     DenseVertexMap<float>& roughness,
-    DenseVertexMap<float>& heightDiff
+    DenseVertexMap<float>& heightDiff,
+    NeighborhoodMode mode
 )
 {
-    // Reserving memory in those maps is important to avoid multi threading
-    // related crashes.
-    roughness.clear();
-    roughness.reserve(mesh.nextVertexIndex());
-    heightDiff.clear();
-    heightDiff.reserve(mesh.nextVertexIndex());
+    // Both maps get a slot for every vertex before the parallel loop, so the
+    // loop only overwrites existing values.
+    fillDenseVertexMap(mesh, roughness, 0.0f);
+    fillDenseVertexMap(mesh, heightDiff, 0.0f);
 
-    auto averageAngles = calcAverageVertexAngles(mesh, normals);
+    const auto averageAngles = calcAverageVertexAngles(mesh, normals);
 
     // Calculate roughness and height difference for each vertex
-    #pragma omp parallel for
-    for (size_t i = 0; i < mesh.nextVertexIndex(); i++)
-    {
-        auto vH = VertexHandle(i);
-        if (!mesh.containsVertex(vH))
-        {
-            continue;
-        }
-
+    forEachLocalVertexNeighborhood(mesh, radius, mode, nullptr, [&](auto vH, auto visit) {
         double sum = 0.0;
         uint32_t count = 0;
         float minHeight = std::numeric_limits<float>::max();
         float maxHeight = std::numeric_limits<float>::lowest();
 
-        visitLocalVertexNeighborhood(mesh, vH, radius, [&](auto neighbor) {
+        visit([&](auto neighbor) {
             sum += averageAngles[neighbor];
             count += 1;
 
@@ -306,11 +505,11 @@ void calcVertexRoughnessAndHeightDifferences(
         });
 
         // Calculate the final roughness
-        roughness.insert(vH, count ? sum / count : 0);
+        roughness[vH] = count ? sum / count : 0;
 
         // Calculate the final height difference
-        heightDiff.insert(vH, maxHeight - minHeight);
-    }
+        heightDiff[vH] = maxHeight - minHeight;
+    });
 }
 
 template<typename BaseVecT>
@@ -426,4 +625,48 @@ bool Dijkstra(
 
 }
 
+template<typename BaseVecT>
+DenseEdgeMap<float> calcVertexAngleEdges(
+    const CompactMesh<BaseVecT>& mesh,
+    const VertexMap<Normal<typename BaseVecT::CoordType>>& normals
+)
+{
+    DenseEdgeMap<float> edgeAngle;
+    edgeAngle.reserve(mesh.nextEdgeIndex());
+    for (auto eH: mesh.edges())
+    {
+        edgeAngle.insert(eH, 0);
+    }
+
+    const auto& edges = mesh.edges();
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        auto& vertices = mesh.getVerticesOfEdge(edges[i]);
+        float angle = acos(normals[vertices[0]].dot(normals[vertices[1]]));
+        edgeAngle[edges[i]] = isnan(angle) ? 0 : angle;
+    }
+    return edgeAngle;
+}
+
+template<typename BaseVecT>
+DenseEdgeMap<float> calcVertexDistances(const CompactMesh<BaseVecT>& mesh)
+{
+    DenseEdgeMap<float> distances;
+    distances.reserve(mesh.nextEdgeIndex());
+    for (auto eH: mesh.edges())
+    {
+        distances.insert(eH, 0);
+    }
+
+    const auto& edges = mesh.edges();
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        auto& vertices = mesh.getVerticesOfEdge(edges[i]);
+        distances[edges[i]] = mesh.getVertexPosition(vertices[0]).distance(mesh.getVertexPosition(vertices[1]));
+    }
+    return distances;
+}
+
 } // namespace lvr2
@@ -36,14 +36,18 @@
 #define LVR2_ALGORITHM_IMAGETEXTURIZER_HPP
 
 #include "lvr2/algorithm/Texturizer.hpp"
+#include "lvr2/algorithm/raycasting/RaycasterBase.hpp"
 #include "lvr2/geometry/Normal.hpp"
 
 #include "lvr2/io/ScanprojectIO.hpp"
 #include "lvr2/geometry/Matrix4.hpp"
+#include "lvr2/texture/ImageCache.hpp"
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgcodecs.hpp>
 
+#include <mutex>
+
 namespace lvr2
 {
 
@@ -51,9 +55,19 @@ namespace lvr2
 template<typename BaseVecT>
 struct ImageData 
 {
-    cv::Mat data;
+    /// id of the image in the image cache
+    size_t image_id;
+    int rows;
+    int cols;
+    /// camera position and viewing direction in riegl coordinates
     BaseVecT  pos;
     BaseVecT  dir;
+    /// camera position in mesh coordinates
+    BaseVecT  mesh_pos;
+    /// half opening angle of a cone containing the view frustum
+    float half_fov;
+    /// focal length in pixels
+    float focal_length;
     Matrix4<BaseVecT> project_to_image_transform;
     float distortion_params[6];
     float intrinsic_params[4];
@@ -63,6 +77,13 @@ struct ImageData
 /**
  * @brief A texturizer that uses images instead of pointcloud colors for creating the textures
  *        for meshes.
+ *
+ * Images are only decoded when a cluster needs them and are kept in an LRU cache with a memory
+ * budget (see setImageMemoryLimit()). For every cluster, the cameras whose view cone contains the
+ * cluster are ranked once by the resolution they provide for it. Each texel takes its color from
+ * the best ranked image that sees it. If a raycaster is set, texels hidden from a camera by other
+ * parts of the mesh are skipped for that camera. Clusters which aren't seen by any camera are
+ * colored from the point cloud like in the Texturizer.
  */
 template<typename BaseVecT>
 class ImageTexturizer : public Texturizer<BaseVecT> 
@@ -70,6 +91,8 @@ class ImageTexturizer : public Texturizer<BaseVecT>
 
 public:
 
+    using NormalT = Normal<typename BaseVecT::CoordType>;
+
     /**
      * @brief constructor
      */
@@ -80,6 +103,7 @@ public:
     ) : Texturizer<BaseVecT>(texelSize, minClusterSize, maxClusterSize)
     {
         image_data_initialized = false;
+        image_data_loaded = false;
     }
 
     /**
@@ -93,37 +117,76 @@ public:
     }
 
     /**
-     * @brief Generates a Texture for a given Rectangle
+     * @brief Limits the memory used for decoded images
+     *
+     * The limit is soft: every thread computing a texture holds on to the
+     * image it currently reads from, even if the cache has dropped it
+     * already. The actual usage may exceed the limit by one image per thread.
+     *
+     * @param bytes Maximum number of bytes, 0 for no limit
+     */
+    void setImageMemoryLimit(size_t bytes)
+    {
+        image_cache.setMemoryLimit(bytes);
+    }
+
+    /**
+     * @brief Sets a raycaster on the mesh which is texturized. It is used to test whether
+     *        texels are hidden from a camera. Without a raycaster, no occlusion tests are done.
+     */
+    void setRaycaster(RaycasterBasePtr<BaseVecT, NormalT> raycaster)
+    {
+        this->raycaster = raycaster;
+    }
+
+    /**
+     * @brief Computes a texture for a given rectangle from the images of the scan project
+     *
+     * The images are loaded on first use. This method may be called concurrently for
+     * different clusters.
      *
      * @param index The newly created texture will get this index.
      *
-     * @param surface Unused in this Texturizer
+     * @param surface Only used for clusters which aren't seen by any image
      *
-     * @param boudingRect The texture will be generated for this rectangle
+     * @param boundingRect The texture will be generated for this rectangle
      *
-     * @return Returns a handle for the newly created texture.
+     * @return The generated texture
      */
-    TextureHandle generateTexture(
+    Texture computeTexture(
         int index,
         const PointsetSurface<BaseVecT>& surface,
-        const BoundingRectangle<BaseVecT>& boundingRect
-    );
+        const BoundingRectangle<typename BaseVecT::CoordType>& boundingRect
+    ) const override;
 
 private:
     /// @cond internal
     Scanproject project;
 
-    bool image_data_initialized;
-    std::vector<ImageData<BaseVecT> > images;
+    mutable std::mutex init_mutex;
+    mutable bool image_data_loaded;
+    mutable bool image_data_initialized;
+    mutable std::vector<ImageData<BaseVecT> > images;
+    mutable ImageCache image_cache;
 
-    void init_image_data();
+    RaycasterBasePtr<BaseVecT, NormalT> raycaster;
+
+    void init_image_data() const;
+
+    std::vector<size_t> select_views(const BoundingRectangle<typename BaseVecT::CoordType>& boundingRect) const;
+
+    bool project_to_image(BaseVecT pos, const ImageData<BaseVecT> &img, int &ud, int &vd) const;
+
+    bool occluded(const BaseVecT &meshPos, const ImageData<BaseVecT> &img) const;
 
     template<typename ValueType>
-    void undistorted_to_distorted_uv(ValueType &u, ValueType &v, const ImageData<BaseVecT> &img);
+    void undistorted_to_distorted_uv(ValueType &u, ValueType &v, const ImageData<BaseVecT> &img) const;
+
+    bool point_behind_camera(BaseVecT pos, const ImageData<BaseVecT> &image_data) const;
 
-    bool exclude_image(BaseVecT pos, const ImageData<BaseVecT> &image_data);
+    static BaseVecT to_riegl(const BaseVecT &pos);
 
-    bool point_behind_camera(BaseVecT pos, const ImageData<BaseVecT> &image_data);
+    static BaseVecT from_riegl(const BaseVecT &pos);
     /// @endcond
 };
 
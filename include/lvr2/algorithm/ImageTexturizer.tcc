@@ -25,23 +25,30 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "lvr2/util/Util.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
 namespace lvr2
 {
 
 template<typename BaseVecT>
-bool ImageTexturizer<BaseVecT>::exclude_image(BaseVecT pos, const ImageData<BaseVecT> &image_data)
+BaseVecT ImageTexturizer<BaseVecT>::to_riegl(const BaseVecT &pos)
 {
-    if (point_behind_camera(pos, image_data)) {
-        return true;
-    }
-
-    // @TODO raytracing for objects between point and camera...
+    return Util::slam6d_to_riegl_point(pos);
+}
 
-    return false;
+template<typename BaseVecT>
+BaseVecT ImageTexturizer<BaseVecT>::from_riegl(const BaseVecT &pos)
+{
+    // inverse of Util::slam6d_to_riegl_point
+    return BaseVecT(-pos.y * 100.0, pos.z * 100.0, pos.x * 100.0);
 }
 
 template<typename BaseVecT>
-bool ImageTexturizer<BaseVecT>::point_behind_camera(BaseVecT pos, const ImageData<BaseVecT> &image_data)
+bool ImageTexturizer<BaseVecT>::point_behind_camera(BaseVecT pos, const ImageData<BaseVecT> &image_data) const
 {
     BaseVecT norm = image_data.pos - pos;
     norm.normalize();
@@ -53,101 +60,243 @@ bool ImageTexturizer<BaseVecT>::point_behind_camera(BaseVecT pos, const ImageDat
 }
 
 template<typename BaseVecT>
-TextureHandle ImageTexturizer<BaseVecT>::generateTexture(
+bool ImageTexturizer<BaseVecT>::project_to_image(
+    BaseVecT pos,
+    const ImageData<BaseVecT> &img,
+    int &ud,
+    int &vd
+) const
+{
+    if (point_behind_camera(pos, img))
+    {
+        return false;
+    }
+
+    pos = img.project_to_image_transform * pos;
+
+    float u = (float) img.rows - pos[0]/pos[2];
+    float v = pos[1]/pos[2];
+
+    undistorted_to_distorted_uv(u, v, img);
+
+    // @TODO option to do bilinear filtering aswell for pixel selection...
+    ud = (int) (u + 0.5);
+    vd = (int) (v + 0.5);
+
+    return ud >= 0 && ud < img.rows && vd >= 0 && vd < img.cols;
+}
+
+template<typename BaseVecT>
+bool ImageTexturizer<BaseVecT>::occluded(const BaseVecT &meshPos, const ImageData<BaseVecT> &img) const
+{
+    if (!raycaster)
+    {
+        return false;
+    }
+
+    BaseVecT toPoint = meshPos - img.mesh_pos;
+    float distance = toPoint.length();
+    if (distance <= 0)
+    {
+        return false;
+    }
+
+    BaseVecT hit;
+    if (!raycaster->castRay(img.mesh_pos, NormalT(toPoint), hit))
+    {
+        return false;
+    }
+
+    // the texel lies on the bounding rectangle, not exactly on the mesh
+    float tolerance = std::max(2 * this->m_texelSize, 0.01f * distance);
+    return (hit - img.mesh_pos).length() < distance - tolerance;
+}
+
+template<typename BaseVecT>
+std::vector<size_t> ImageTexturizer<BaseVecT>::select_views(
+    const BoundingRectangle<typename BaseVecT::CoordType>& boundingRect
+) const
+{
+    float extentA = boundingRect.m_maxDistA - boundingRect.m_minDistA;
+    float extentB = boundingRect.m_maxDistB - boundingRect.m_minDistB;
+
+    BaseVecT center = boundingRect.m_supportVector
+        + boundingRect.m_vec1 * ((boundingRect.m_minDistA + boundingRect.m_maxDistA) / 2)
+        + boundingRect.m_vec2 * ((boundingRect.m_minDistB + boundingRect.m_maxDistB) / 2);
+
+    // corners and center as samples for the coverage test
+    std::vector<BaseVecT> samples = {center};
+    for (float a : {boundingRect.m_minDistA, boundingRect.m_maxDistA})
+    {
+        for (float b : {boundingRect.m_minDistB, boundingRect.m_maxDistB})
+        {
+            samples.push_back(to_riegl(boundingRect.m_supportVector + boundingRect.m_vec1 * a + boundingRect.m_vec2 * b));
+        }
+    }
+
+    center = to_riegl(center);
+    samples[0] = center;
+    float radius = std::sqrt(extentA * extentA + extentB * extentB) / 2 / 100.0;
+    BaseVecT normal = to_riegl(BaseVecT(boundingRect.m_normal.x, boundingRect.m_normal.y, boundingRect.m_normal.z));
+
+    std::vector<size_t> views;
+    std::vector<float> scores(images.size(), 0);
+
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        const ImageData<BaseVecT> &img = images[i];
+
+        // cheap test of the bounding sphere against the view cone of the camera
+        BaseVecT toCenter = center - img.pos;
+        float distance = toCenter.length();
+        if (distance > radius)
+        {
+            float cosAngle = toCenter.dot(img.dir) / (distance * img.dir.length());
+            float angle = std::acos(std::max(-1.0f, std::min(1.0f, cosAngle)));
+            if (angle - std::asin(radius / distance) > img.half_fov)
+            {
+                continue;
+            }
+        }
+
+        bool covered = false;
+        int ud, vd;
+        for (const BaseVecT &sample : samples)
+        {
+            if (project_to_image(sample, img, ud, vd))
+            {
+                covered = true;
+                break;
+            }
+        }
+
+        if (!covered)
+        {
+            continue;
+        }
+
+        // pixels per unit length on the cluster, including foreshortening
+        float viewCos = distance > 0 ? std::abs(toCenter.dot(normal)) / distance : 1.0f;
+        scores[i] = viewCos * img.focal_length / std::max(distance, 1e-6f);
+        views.push_back(i);
+    }
+
+    std::stable_sort(views.begin(), views.end(), [&](size_t a, size_t b)
+    {
+        return scores[a] > scores[b];
+    });
+
+    return views;
+}
+
+template<typename BaseVecT>
+Texture ImageTexturizer<BaseVecT>::computeTexture(
     int index,
     const PointsetSurface<BaseVecT>& surface,
-    const BoundingRectangle<BaseVecT>& boundingRect
-)
+    const BoundingRectangle<typename BaseVecT::CoordType>& boundingRect
+) const
 {
+    // load image data if not already done
+    {
+        std::lock_guard<std::mutex> lock(init_mutex);
+        if (!image_data_loaded)
+        {
+            this->init_image_data();
+            image_data_loaded = true;
+        }
+    }
+
+    std::vector<size_t> views;
+    if (image_data_initialized)
+    {
+        views = select_views(boundingRect);
+    }
+
+    if (views.empty())
+    {
+        return Texturizer<BaseVecT>::computeTexture(index, surface, boundingRect);
+    }
+
     // Calculate the texture size
     unsigned short int sizeX = ceil((boundingRect.m_maxDistA - boundingRect.m_minDistA) / this->m_texelSize);
     unsigned short int sizeY = ceil((boundingRect.m_maxDistB - boundingRect.m_minDistB) / this->m_texelSize);
 
     // Create texture
     Texture texture(index, sizeX, sizeY, 3, 1, this->m_texelSize);
+    std::fill(texture.m_data, texture.m_data + sizeX * sizeY * 3, 0);
 
-    // load images if not already done
-    if (!image_data_initialized)
-    {
-        this->init_image_data();
-    }
+    // Texels which already got a color from a better view
+    std::vector<bool> done(sizeX * sizeY, false);
 
-    if (image_data_initialized)
+    // Go through the views from best to worst, so only the image of one
+    // view is held at a time. Each texel still gets the color of the best
+    // view that sees it.
+    for (size_t i = 0; i < views.size(); i++)
     {
-        for (int y = 0; y < sizeY; y++)
+        const ImageData<BaseVecT> &img_data = images[views[i]];
+
+        // fetched from the cache when the first texel projects into it
+        cv::Mat image;
+        bool unreadable = false;
+
+        for (int y = 0; y < sizeY && !unreadable; y++)
         {
-            for (int x = 0; x < sizeX; x++)
+            for (int x = 0; x < sizeX && !unreadable; x++)
             {
+                if (done[y * sizeX + x])
+                {
+                    continue;
+                }
 
                 BaseVecT currentPos =
                     boundingRect.m_supportVector
                     + boundingRect.m_vec1 * (x * this->m_texelSize + boundingRect.m_minDistA - this->m_texelSize / 2.0)
                     + boundingRect.m_vec2 * (y * this->m_texelSize + boundingRect.m_minDistB - this->m_texelSize / 2.0);
 
-                for (const ImageData<BaseVecT> &img_data : images)
-                {
-                    // transforming from slam6D coords to riegl coords
-                    BaseVecT pos(currentPos.z/100.0, -currentPos.x/100.0, currentPos.y/100.0);
-
-                    if (exclude_image(pos, img_data))
-                        continue;
-
-                    pos = img_data.project_to_image_transform * pos;
-
-                    float u = (float) img_data.data.rows - pos[0]/pos[2];
-                    float v = pos[1]/pos[2];
-
-                    undistorted_to_distorted_uv(u, v, img_data);
+                BaseVecT pos = to_riegl(currentPos);
 
-                    // @TODO option to do bilinear filtering aswell for pixel selection...
-                    int ud = (int) (u + 0.5);
-                    int vd = (int) (v + 0.5);
+                int ud, vd;
+                if (!project_to_image(pos, img_data, ud, vd) || occluded(currentPos, img_data))
+                {
+                    continue;
+                }
 
-                    if (ud >= 0 && ud < img_data.data.rows && vd >= 0 && vd < img_data.data.cols)
+                if (image.empty())
+                {
+                    image = image_cache.get(img_data.image_id);
+                    if (image.empty())
                     {
-                        // using template keyword because elsewise < would be interpreted as less
-                        // than operator
-                        const cv::Vec3b color = img_data.data.template at<cv::Vec3b>(ud, vd);
-
-                        // this works as well...
-                        //const cv::Vec3b color = ((cv::Mat) (img_data.data)).at<cv::Vec3b>(ud, vd);
-
-                        // and this as well...
-                        //const cv::Mat &bla = img_data.data;
-                        //const cv::Vec3b color = bla.at<cv::Vec3b>(ud, vd);
+                        // try the next view
+                        unreadable = true;
+                        continue;
+                    }
+                }
 
+                // The size used for the projection comes from the file
+                // header and may differ from the decoded image
+                if (ud >= image.rows || vd >= image.cols)
+                {
+                    continue;
+                }
 
-                        // OpenCV saves colors in BGR order
-                        uint8_t r = color[2], g = color[1], b = color[0];
+                const cv::Vec3b color = image.template at<cv::Vec3b>(ud, vd);
 
-                        texture.m_data[(sizeX * y + x) * 3 + 0] = r;
-                        texture.m_data[(sizeX * y + x) * 3 + 1] = g;
-                        texture.m_data[(sizeX * y + x) * 3 + 2] = b;
-                        break;
-                    }
-                }
-            }
-        }
-    }
-    else
-    {
-        for (int y = 0; y < sizeY; y++)
-        {
-            for (int x = 0; x < sizeX; x++)
-            {
-                texture.m_data[(sizeX * y + x) * 3 + 0] = 0;
-                texture.m_data[(sizeX * y + x) * 3 + 1] = 0;
-                texture.m_data[(sizeX * y + x) * 3 + 2] = 0;
+                // Rows are stored bottom up like in Texturizer::computeTexture,
+                // OpenCV saves colors in BGR order
+                size_t texel = ((sizeY - y - 1) * sizeX + x) * 3;
+                texture.m_data[texel + 0] = color[2];
+                texture.m_data[texel + 1] = color[1];
+                texture.m_data[texel + 2] = color[0];
+                done[y * sizeX + x] = true;
             }
         }
-
     }
 
-    return this->m_textures.push(texture);
+    return texture;
 }
 
 template<typename BaseVecT>
-void ImageTexturizer<BaseVecT>::init_image_data()
+void ImageTexturizer<BaseVecT>::init_image_data() const
 {
     // orthogonal projection matrix is the same for every image
     for (const ScanPosition &pos : project.scans)
@@ -156,11 +305,12 @@ void ImageTexturizer<BaseVecT>::init_image_data()
         {
             ImageData<BaseVecT> image_data;
 
-            //load image
-            image_data.data = cv::imread(img.image_file.string(), CV_LOAD_IMAGE_COLOR);
+            // the size is read from the file header, the image itself is only
+            // decoded when a texture needs it
+            image_data.image_id = image_cache.addFile(img.image_file);
 
-            // skip image if we weren't able to load it
-            if (image_data.data.empty())
+            // skip image if we weren't able to read it
+            if (!image_cache.imageSize(image_data.image_id, image_data.rows, image_data.cols))
             {
                 continue;
             }
@@ -176,7 +326,7 @@ void ImageTexturizer<BaseVecT>::init_image_data()
             }
 
             //calculate transformation matrix
-            Intrinsicsd pro;
+            Intrinsicsd pro = Intrinsicsd::Identity();
             double* projection = pro.data();
             projection[0] = img.intrinsic_params[0];
             projection[5] = img.intrinsic_params[1];
@@ -191,16 +341,22 @@ void ImageTexturizer<BaseVecT>::init_image_data()
             transform = transform * orientation.inverse();
             transform = transform * img.extrinsic_transform;
             Transformd transform_inverse = transform.inverse();
-            transform_inverse.transpose();
 
             //caluclate cam direction and cam pos for image in project space
-            BaseVecT cam_pos = {0.0f, 0.0f, 0.0f};
-            Normal<BaseVecT> cam_dir = {0.0f, 0.0f, 1.0f};
+            BaseVecT cam_pos(0.0f, 0.0f, 0.0f);
+            NormalT cam_dir(0.0f, 0.0f, 1.0f);
             cam_pos = transform_inverse * cam_pos;
             cam_dir = transform_inverse * cam_dir;
 
             image_data.pos = cam_pos;
-            image_data.dir = cam_dir;
+            image_data.dir = BaseVecT(cam_dir.x, cam_dir.y, cam_dir.z);
+            image_data.mesh_pos = from_riegl(cam_pos);
+
+            // cone around the view frustum, with some slack for the lens distortion
+            float focal = std::min(img.intrinsic_params[0], img.intrinsic_params[1]);
+            float halfDiagonal = std::sqrt((float) image_data.rows * image_data.rows + (float) image_data.cols * image_data.cols) / 2;
+            image_data.focal_length = focal;
+            image_data.half_fov = focal > 0 ? std::min(1.25f * std::atan(halfDiagonal / focal), (float) M_PI) : (float) M_PI;
 
             // transform from project space to image space incl orthogonal projection
             image_data.project_to_image_transform = transform * pro;
@@ -215,6 +371,8 @@ void ImageTexturizer<BaseVecT>::init_image_data()
     {
         image_data_initialized = true;
     }
+
+    std::cout << timestamp << "Found " << images.size() << " images for texturizing" << std::endl;
 }
 
 template<typename BaseVecT>
@@ -222,7 +380,7 @@ template<typename ValueType>
 void ImageTexturizer<BaseVecT>::undistorted_to_distorted_uv(
     ValueType &u,
     ValueType &v,
-    const ImageData<BaseVecT> &img)
+    const ImageData<BaseVecT> &img) const
 {
     ValueType x, y, ud, vd, r_2, r_4, r_6, r_8, fx, fy, Cx, Cy, k1, k2, k3, k4, p1, p2;
 
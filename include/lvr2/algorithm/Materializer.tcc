@@ -37,6 +37,10 @@
 #include "lvr2/algorithm/FinalizeAlgorithms.hpp"
 #include <opencv2/features2d.hpp>
 
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
 
 namespace lvr2
 {
@@ -73,6 +77,8 @@ void Materializer<BaseVecT>::saveTextures()
 template<typename BaseVecT>
 MaterializerResult<BaseVecT> Materializer<BaseVecT>::generateMaterials()
 {
+    using CoordT = typename BaseVecT::CoordType;
+
     string msg = timestamp.getElapsedTime() + "Generating materials ";
     ProgressBar progress(m_cluster.numCluster(), msg);
 
@@ -85,20 +91,19 @@ MaterializerResult<BaseVecT> Materializer<BaseVecT>::generateMaterials()
     // Counters used for texturizing
     int numClustersTooSmall = 0;
     int numClustersTooLarge = 0;
-    int textureCount = 0;
-    int clusterCount = 0;
 
-    // For all clusters ...
+    // Decide for each cluster whether it gets a plain color or a texture.
+    // Textures are indexed in cluster order, so the result does not depend
+    // on the order in which the clusters are processed below.
+    std::vector<ClusterHandle> colorClusters;
+    std::vector<ClusterHandle> textureClusters;
+
     for (auto clusterH : m_cluster)
     {
-        ++progress;
-
-
         // Get number of faces in cluster
         const Cluster<FaceHandle>& cluster = m_cluster.getCluster(clusterH);
         int numFacesInCluster = cluster.handles.size();
 
-
         if (!m_texturizer
             || (m_texturizer && numFacesInCluster < m_texturizer.get().m_texMinClusterSize
                 && m_texturizer.get().m_texMinClusterSize != 0)
@@ -122,161 +127,219 @@ MaterializerResult<BaseVecT> Materializer<BaseVecT>::generateMaterials()
                     numClustersTooLarge++;
                 }
             }
+            colorClusters.push_back(clusterH);
+        }
+        else
+        {
+            textureClusters.push_back(clusterH);
+        }
+    }
+
+    // Plain color materials
+    std::vector<Material> colorMaterials(colorClusters.size());
 
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < colorClusters.size(); i++)
+    {
+        const Cluster<FaceHandle>& cluster = m_cluster.getCluster(colorClusters[i]);
 
-            // Calculate (a sorta-kinda not really) median value
-            std::map<Rgb8Color, int> colorMap;
-            int maxColorCount = 0;
-            Rgb8Color mostUsedColor;
+        // Calculate (a sorta-kinda not really) median value
+        std::map<Rgb8Color, int> colorMap;
+        int maxColorCount = 0;
+        Rgb8Color mostUsedColor;
 
-            // For each face ...
-            for (auto faceH : cluster.handles)
+        // For each face ...
+        for (auto faceH : cluster.handles)
+        {
+            // Calculate color of centroid
+            Rgb8Color color = calcColorForFaceCentroid(m_mesh, m_surface, faceH);
+            if (colorMap.count(color))
             {
-                // Calculate color of centroid
-                Rgb8Color color = calcColorForFaceCentroid(m_mesh, m_surface, faceH);
-                if (colorMap.count(color))
-                {
-                    colorMap[color]++;
-                }
-                else
-                {
-                    colorMap[color] = 1;
-                }
-                if (colorMap[color] > maxColorCount)
-                {
-                    mostUsedColor = color;
-                }
+                colorMap[color]++;
             }
+            else
+            {
+                colorMap[color] = 1;
+            }
+            if (colorMap[color] > maxColorCount)
+            {
+                mostUsedColor = color;
+            }
+        }
 
-            // Create material and save in map
-            Material material;
-            std::array<unsigned char, 3> arr = {
-                static_cast<uint8_t>(mostUsedColor[0]),
-                static_cast<uint8_t>(mostUsedColor[1]),
-                static_cast<uint8_t>(mostUsedColor[2])
-            };
+        // Create material
+        Material material;
+        std::array<unsigned char, 3> arr = {
+            static_cast<uint8_t>(mostUsedColor[0]),
+            static_cast<uint8_t>(mostUsedColor[1]),
+            static_cast<uint8_t>(mostUsedColor[2])
+        };
 
-            material.m_color =  std::move(arr);
-              clusterMaterials.insert(clusterH, material);
+        material.m_color = std::move(arr);
+        colorMaterials[i] = material;
 
-        }
-        else
+        ++progress;
+    }
+
+    for (size_t i = 0; i < colorClusters.size(); i++)
+    {
+        clusterMaterials.insert(colorClusters[i], colorMaterials[i]);
+    }
+
+    if (!m_texturizer)
+    {
+        cout << endl;
+        return MaterializerResult<BaseVecT>(clusterMaterials);
+    }
+
+    Texturizer<BaseVecT>& texturizer = m_texturizer.get();
+    const size_t numTextures = textureClusters.size();
+
+    // Process the largest clusters first to keep all threads busy
+    std::vector<size_t> order(numTextures);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+    {
+        return m_cluster.getCluster(textureClusters[a]).handles.size()
+            > m_cluster.getCluster(textureClusters[b]).handles.size();
+    });
+
+    // Bounding rectangles and texels of all texture clusters
+    std::vector<boost::optional<BoundingRectangle<CoordT>>> boundingRects(numTextures);
+    std::vector<Texture> textures(numTextures);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t j = 0; j < numTextures; j++)
+    {
+        size_t i = order[j];
+        ClusterHandle clusterH = textureClusters[i];
+
+        // Contour
+        std::vector<VertexHandle> contour = calculateClusterContourVertices(
+            clusterH,
+            m_mesh,
+            m_cluster
+        );
+
+        // Bounding rectangle
+        boundingRects[i] = calculateBoundingRectangle(
+            contour,
+            m_mesh,
+            m_cluster.getCluster(clusterH),
+            m_normals,
+            texturizer.m_texelSize,
+            clusterH
+        );
+
+        // Create texture
+        textures[i] = texturizer.computeTexture(i, m_surface, boundingRects[i].get());
+
+        ++progress;
+    }
+
+    // Store textures in cluster order
+    std::vector<TextureHandle> textureHandles;
+    textureHandles.reserve(numTextures);
+    for (size_t i = 0; i < numTextures; i++)
+    {
+        textureHandles.push_back(texturizer.addTexture(std::move(textures[i])));
+    }
+    textures.clear();
+
+    // Keypoints and texture coordinates
+    std::vector<std::vector<BaseVecT>> features(numTextures);
+    std::vector<cv::Mat> descriptors(numTextures);
+    std::vector<std::vector<std::pair<VertexHandle, TexCoords>>> texCoords(numTextures);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t j = 0; j < numTextures; j++)
+    {
+        size_t i = order[j];
+        TextureHandle texH = textureHandles[i];
+        const BoundingRectangle<CoordT>& boundingRect = boundingRects[i].get();
+
+        std::vector<cv::KeyPoint> keypoints;
+        cv::Ptr<cv::AKAZE> detector = cv::AKAZE::create();
+        texturizer.findKeyPointsInTexture(texH,
+                boundingRect, detector, keypoints, descriptors[i]);
+        features[i] = texturizer.keypoints23d(keypoints, boundingRect, texH);
+
+        // Find unique vertices in cluster
+        std::unordered_set<VertexHandle> verticesOfCluster;
+        for (auto faceH : m_cluster.getCluster(textureClusters[i]).handles)
         {
-            // Textures
-
-            // Contour
-            std::vector<VertexHandle> contour = calculateClusterContourVertices(
-                clusterH,
-                m_mesh,
-                m_cluster
-            );
-
-            // Bounding rectangle
-            BoundingRectangle<typename BaseVecT::CoordType> boundingRect = calculateBoundingRectangle(
-                contour,
-                m_mesh,
-                cluster,
-                m_normals,
-                m_texturizer.get().m_texelSize,
-                clusterH
-            );
-
-
-            // Create texture
-            TextureHandle texH = m_texturizer.get().generateTexture(
-                textureCount,
-                m_surface,
-                boundingRect
-            );
-
-            std::vector<cv::KeyPoint> keypoints;
-            cv::Mat descriptors;
-            cv::Ptr<cv::AKAZE> detector = cv::AKAZE::create();
-            m_texturizer.get().findKeyPointsInTexture(texH,
-                    boundingRect, detector, keypoints, descriptors);
-            std::vector<BaseVecT> features3d =
-                m_texturizer.get().keypoints23d(keypoints, boundingRect, texH);
-
-            // Transform descriptor from matrix row to float vector
-            for (unsigned int row = 0; row < features3d.size(); ++row)
+            for (auto vertexH : m_mesh.getVerticesOfFace(faceH))
             {
-                keypoints_map[features3d[row]] =
-                    std::vector<float>(descriptors.ptr(row), descriptors.ptr(row) + descriptors.cols);
+                verticesOfCluster.insert(vertexH);
+                // (doesnt insert duplicate vertices)
             }
+        }
 
-            // Create material with default color and insert into face map
-            Material material;
-            material.m_texture = texH;
-            std::array<unsigned char, 3> arr = {255, 255, 255};
+        // Calculate tex coords for each unique vertex in this cluster
+        for (auto vertexH : verticesOfCluster)
+        {
+            texCoords[i].emplace_back(vertexH, texturizer.calculateTexCoords(
+                texH,
+                boundingRect,
+                m_mesh.getVertexPosition(vertexH)
+            ));
+        }
+    }
 
-            material.m_color = std::move(arr);            
-              clusterMaterials.insert(clusterH, material);
+    // Merge per cluster results
+    for (size_t i = 0; i < numTextures; i++)
+    {
+        ClusterHandle clusterH = textureClusters[i];
 
-            // Calculate tex coords
-            // Insert material into face map for each face
-            // Find unique vertices in cluster
-            std::unordered_set<VertexHandle> verticesOfCluster;
-            for (auto faceH : cluster.handles)
+        // Transform descriptor from matrix row to float vector
+        for (unsigned int row = 0; row < features[i].size(); ++row)
+        {
+            keypoints_map[features[i][row]] =
+                std::vector<float>(descriptors[i].ptr(row), descriptors[i].ptr(row) + descriptors[i].cols);
+        }
+
+        // Create material with default color and insert into face map
+        Material material;
+        material.m_texture = textureHandles[i];
+        std::array<unsigned char, 3> arr = {255, 255, 255};
+
+        material.m_color = std::move(arr);
+        clusterMaterials.insert(clusterH, material);
+
+        // Insert tex coords into result map
+        for (auto& vertexCoords : texCoords[i])
+        {
+            VertexHandle vertexH = vertexCoords.first;
+            if (vertexTexCoords.get(vertexH))
             {
-                for (auto vertexH : m_mesh.getVerticesOfFace(faceH))
-                {
-                    verticesOfCluster.insert(vertexH);
-                    // (doesnt insert duplicate vertices)
-                }
+                vertexTexCoords.get(vertexH).get().push(clusterH, vertexCoords.second);
             }
-            // For each unique vertex in this cluster
-            for (auto vertexH : verticesOfCluster)
+            else
             {
-                // Calculate tex coords
-                TexCoords texCoords = m_texturizer.get().calculateTexCoords(
-                    texH,
-                    boundingRect,
-                    m_mesh.getVertexPosition(vertexH)
-                );
-
-                // Insert into result map
-                if (vertexTexCoords.get(vertexH))
-                {
-                    vertexTexCoords.get(vertexH).get().push(clusterH, texCoords);
-                }
-                else
-                {
-                    ClusterTexCoordMapping mapping;
-                    mapping.push(clusterH, texCoords);
-                    vertexTexCoords.insert(vertexH, mapping);
-                }
+                ClusterTexCoordMapping mapping;
+                mapping.push(clusterH, vertexCoords.second);
+                vertexTexCoords.insert(vertexH, mapping);
             }
-
-            textureCount++;
         }
     }
 
     cout << endl;
 
     // Write result
-    if (m_texturizer)
-    {
-
-        cout << timestamp << "Skipped " << (numClustersTooSmall+numClustersTooLarge)
-        << " clusters while generating textures" << endl;
-
-        cout << timestamp << "(" << numClustersTooSmall << " below threshold, "
-        << numClustersTooLarge << " above limit, " << m_cluster.numCluster() << " total)" << endl;
+    cout << timestamp << "Skipped " << (numClustersTooSmall+numClustersTooLarge)
+    << " clusters while generating textures" << endl;
 
-        cout << timestamp << "Generated " << textureCount << " textures" << endl;
+    cout << timestamp << "(" << numClustersTooSmall << " below threshold, "
+    << numClustersTooLarge << " above limit, " << m_cluster.numCluster() << " total)" << endl;
 
-        return MaterializerResult<BaseVecT>(
-            clusterMaterials,
-            m_texturizer.get().getTextures(),
-            vertexTexCoords,
-            keypoints_map
-        );
-    }
-    else
-    {
-        return MaterializerResult<BaseVecT>(clusterMaterials);
-    }
+    cout << timestamp << "Generated " << numTextures << " textures" << endl;
 
+    return MaterializerResult<BaseVecT>(
+        clusterMaterials,
+        texturizer.getTextures(),
+        vertexTexCoords,
+        keypoints_map
+    );
 }
 
 
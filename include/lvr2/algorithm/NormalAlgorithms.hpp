@@ -39,6 +39,7 @@
 #define LVR2_ALGORITHM_NORMALALGORITHMS_H_
 
 #include "lvr2/geometry/BaseMesh.hpp"
+#include "lvr2/geometry/CompactMesh.hpp"
 #include "lvr2/util/Cluster.hpp"
 #include "lvr2/util/ClusterBiMap.hpp"
 #include "lvr2/geometry/Normal.hpp"
@@ -109,6 +110,44 @@ DenseVertexMap<Normal<typename BaseVecT::CoordType>> calcVertexNormals(
     const FaceMap<Normal<typename BaseVecT::CoordType>>& normals
 );
 
+/**
+ * @brief Calculates a normal for each face of the compact mesh in parallel.
+ *
+ * Same as the `BaseMesh` version: faces with zero area get the dummy normal
+ * (0, 0, 1).
+ */
+template<typename BaseVecT>
+DenseFaceMap<Normal<typename BaseVecT::CoordType>> calcFaceNormals(const CompactMesh<BaseVecT>& mesh);
+
+/**
+ * @brief Calculates a normal for each vertex of the compact mesh in parallel.
+ *
+ * Same as the `BaseMesh` version: the normals of the adjacent faces are
+ * averaged, vertices without a usable average get the default normal
+ * (0, 0, 1). The faces are summed up in index order, so the result may differ
+ * from the `BaseMesh` version in the last bits.
+ */
+template<typename BaseVecT>
+DenseVertexMap<Normal<typename BaseVecT::CoordType>> calcVertexNormals(
+    const CompactMesh<BaseVecT>& mesh,
+    const FaceMap<Normal<typename BaseVecT::CoordType>>& normals
+);
+
+/**
+ * @brief Calculates a normal for each vertex of the compact mesh in parallel.
+ *
+ * Same as the `BaseMesh` version with a surface: vertices without a usable
+ * average of their face normals get the normal of the nearest point of the
+ * point cloud. The faces are summed up in index order, so the result may
+ * differ from the `BaseMesh` version in the last bits.
+ */
+template<typename BaseVecT>
+DenseVertexMap<Normal<typename BaseVecT::CoordType>> calcVertexNormals(
+    const CompactMesh<BaseVecT>& mesh,
+    const FaceMap<Normal<typename BaseVecT::CoordType>>& normals,
+    const PointsetSurface<BaseVecT>& surface
+);
+
 } // namespace lvr2
 
 #include "lvr2/algorithm/NormalAlgorithms.tcc"
@@ -177,4 +177,145 @@ DenseVertexMap<Normal<typename BaseVecT::CoordType>> calcVertexNormals(
     return normalMap;
 }
 
+template <typename BaseVecT>
+DenseFaceMap<Normal<typename BaseVecT::CoordType>> calcFaceNormals(const CompactMesh<BaseVecT>& mesh)
+{
+    using NormalT = Normal<typename BaseVecT::CoordType>;
+
+    // Insert the dummy normal for every face first, so the parallel loop only
+    // overwrites existing values
+    DenseFaceMap<NormalT> out;
+    out.reserve(mesh.nextFaceIndex());
+    for (auto faceH: mesh.faces())
+    {
+        out.insert(faceH, NormalT(0, 0, 1));
+    }
+
+    const auto& faces = mesh.faces();
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < faces.size(); i++)
+    {
+        if (auto normal = getFaceNormal(mesh.getVertexPositionsOfFace(faces[i])))
+        {
+            out[faces[i]] = *normal;
+        }
+    }
+    return out;
+}
+
+template<typename BaseVecT>
+DenseVertexMap<Normal<typename BaseVecT::CoordType>> calcVertexNormals(
+    const CompactMesh<BaseVecT>& mesh,
+    const FaceMap<Normal<typename BaseVecT::CoordType>>& normals
+)
+{
+    using NormalT = Normal<typename BaseVecT::CoordType>;
+
+    DenseVertexMap<NormalT> normalMap;
+    normalMap.reserve(mesh.nextVertexIndex());
+    for (auto vH: mesh.vertices())
+    {
+        normalMap.insert(vH, NormalT(0, 0, 1));
+    }
+
+    const auto& vertices = mesh.vertices();
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        // Average normal over all connected faces
+        BaseVecT v(0, 0, 0);
+        for (auto faceH: mesh.getFacesOfVertex(vertices[i]))
+        {
+            v += normals[faceH];
+        }
+
+        // Keep the default normal for vertices without faces or with
+        // opposing face normals
+        if (v.length2() != 0)
+        {
+            normalMap[vertices[i]] = NormalT(v.normalized());
+        }
+    }
+
+    return normalMap;
+}
+
+template<typename BaseVecT>
+DenseVertexMap<Normal<typename BaseVecT::CoordType>> calcVertexNormals(
+    const CompactMesh<BaseVecT>& mesh,
+    const FaceMap<Normal<typename BaseVecT::CoordType>>& normals,
+    const PointsetSurface<BaseVecT>& surface
+)
+{
+    using NormalT = Normal<typename BaseVecT::CoordType>;
+
+    DenseVertexMap<NormalT> normalMap;
+    normalMap.reserve(mesh.nextVertexIndex());
+    for (auto vH: mesh.vertices())
+    {
+        normalMap.insert(vH, NormalT(0, 0, 1));
+    }
+
+    // Average the normals of the adjacent faces in parallel and remember the
+    // vertices without a usable average
+    const auto& vertices = mesh.vertices();
+    vector<uint8_t> needsFallback(vertices.size(), 0);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        BaseVecT v(0, 0, 0);
+        for (auto faceH: mesh.getFacesOfVertex(vertices[i]))
+        {
+            v += normals[faceH];
+        }
+
+        if (v.length2() != 0)
+        {
+            normalMap[vertices[i]] = NormalT(v.normalized());
+        }
+        else
+        {
+            needsFallback[i] = 1;
+        }
+    }
+
+    // Fall back to the normal of the nearest point of the point cloud
+    FloatChannelOptional pointNormals;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        if (!needsFallback[i])
+        {
+            continue;
+        }
+
+        if (!pointNormals)
+        {
+            // The panic is justified here: in the process of creating the
+            // mesh, normals have to be estimated. These normals are
+            // written to the point buffer.
+            if (!surface.pointBuffer()->hasNormals())
+            {
+                panic("the point buffer needs normals!");
+            }
+            pointNormals = surface.pointBuffer()->getFloatChannel("normals");
+            if (!pointNormals)
+            {
+                panic("no normal for point found!");
+            }
+        }
+
+        vector<size_t> pointIdx;
+        surface.searchTree()->kSearch(mesh.getVertexPosition(vertices[i]), 1, pointIdx);
+        if (pointIdx.empty())
+        {
+            panic("no near point found!");
+        }
+        NormalT normal = (*pointNormals)[pointIdx[0]];
+        normalMap[vertices[i]] = normal;
+    }
+
+    return normalMap;
+}
+
 } // namespace lvr2
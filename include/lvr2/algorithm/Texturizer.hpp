@@ -148,6 +148,46 @@ public:
         const BoundingRectangle<typename BaseVecT::CoordType>& boundingRect
     );
 
+    /**
+     * @brief Computes the texels of a texture without storing it in the texturizer
+     *
+     * The texture is processed in square tiles of texels. For each tile, one nearest neighbor query around the
+     * tile center yields a candidate set that is guaranteed to contain the nearest points of all texels in the
+     * tile. The texels of a tile are then resolved against these candidates in scanline order, seeding each
+     * search with the neighbors of the previous texel. If more than one neighbor is used per texel (see
+     * setTexelNeighbors()), their colors are averaged in the same pass.
+     *
+     * This method does not modify the texturizer, so it may be called concurrently for different clusters.
+     * Use addTexture() to store the result.
+     *
+     * @param index The index the texture will get
+     * @param surface The point cloud
+     * @param boundingRect The bounding rectangle of the cluster
+     *
+     * @return The generated texture
+     */
+    virtual Texture computeTexture(
+        int index,
+        const PointsetSurface<BaseVecT>& surface,
+        const BoundingRectangle<typename BaseVecT::CoordType>& boundingRect
+    ) const;
+
+    /**
+     * @brief Stores a texture, e.g. one that was created with computeTexture()
+     *
+     * @param texture The texture
+     *
+     * @return Texture handle of the stored texture
+     */
+    TextureHandle addTexture(Texture&& texture);
+
+    /**
+     * @brief Sets the number of nearest points whose colors are averaged for each texel
+     *
+     * @param k Number of neighbors, defaults to 1 (color of the closest point)
+     */
+    void setTexelNeighbors(int k);
+
     /**
      * @brief Calculate texture coordinates for a given 3D point in a texture
      *
@@ -192,6 +232,9 @@ public:
 
 protected:
 
+    /// Number of nearest points that are averaged for each texel
+    int m_texelNeighbors;
+
     /// StableVector, that contains all generated textures with texture handles
     StableVector<TextureHandle, Texture> m_textures;
 
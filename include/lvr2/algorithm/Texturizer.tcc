@@ -40,6 +40,13 @@
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include <omp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
 
 namespace lvr2
 {
@@ -52,7 +59,8 @@ Texturizer<BaseVecT>::Texturizer(
 ) :
     m_texelSize(texelSize),
     m_texMinClusterSize(texMinClusterSize),
-    m_texMaxClusterSize(texMaxClusterSize)
+    m_texMaxClusterSize(texMaxClusterSize),
+    m_texelNeighbors(1)
 {
 }
 
@@ -131,6 +139,37 @@ TextureHandle Texturizer<BaseVecT>::generateTexture(
     const BoundingRectangle<typename BaseVecT::CoordType>& boundingRect
 )
 {
+    return addTexture(computeTexture(index, surface, boundingRect));
+}
+
+template<typename BaseVecT>
+TextureHandle Texturizer<BaseVecT>::addTexture(Texture&& texture)
+{
+    return m_textures.push(std::move(texture));
+}
+
+template<typename BaseVecT>
+void Texturizer<BaseVecT>::setTexelNeighbors(int k)
+{
+    m_texelNeighbors = std::max(k, 1);
+}
+
+template<typename BaseVecT>
+Texture Texturizer<BaseVecT>::computeTexture(
+    int index,
+    const PointsetSurface<BaseVecT>& surface,
+    const BoundingRectangle<typename BaseVecT::CoordType>& boundingRect
+) const
+{
+    using CoordT = typename BaseVecT::CoordType;
+
+    // Edge length of the texel tiles that share one candidate query
+    const int tileSize = 16;
+
+    // Upper bound for the candidate set of a tile. Tiles that would need
+    // more candidates (e.g. very sparse regions next to dense ones) fall
+    // back to one query per texel
+    const int maxTileCandidates = 4096;
 
     // Calculate the texture size
     unsigned short int sizeX = ceil((boundingRect.m_maxDistA - boundingRect.m_minDistA) / m_texelSize);
@@ -138,73 +177,218 @@ TextureHandle Texturizer<BaseVecT>::generateTexture(
 
     // Create texture
     Texture texture(index, sizeX, sizeY, 3, 1, m_texelSize);
+    std::fill(texture.m_data, texture.m_data + sizeX * sizeY * 3, 0);
+
+    PointBufferPtr buffer = surface.pointBuffer();
+    FloatChannelOptional points = buffer->getFloatChannel("points");
+    UCharChannelOptional colors = buffer->getUCharChannel("colors");
+
+    if (!points || !colors)
+    {
+        return texture;
+    }
 
-    string comment = timestamp.getElapsedTime() + "Computing texture pixels ";
-    ProgressBar progress(sizeX * sizeY, comment);
+    const float* pts = points->dataPtr().get();
+    const unsigned char* rgb = colors->dataPtr().get();
+    const size_t colorWidth = colors->width();
+    const int k = m_texelNeighbors;
 
-    if (surface.pointBuffer()->hasColors())
+    // Position of the texel (x, y) in 3D. Fractional coordinates are
+    // used for the tile centers.
+    auto texelPosition = [&](CoordT x, CoordT y)
     {
-        UCharChannel colors = *(surface.pointBuffer()->getUCharChannel("colors"));
+        return boundingRect.m_supportVector
+            + boundingRect.m_vec1 * (x * m_texelSize + boundingRect.m_minDistA - m_texelSize / 2.0)
+            + boundingRect.m_vec2 * (y * m_texelSize + boundingRect.m_minDistB - m_texelSize / 2.0);
+    };
 
-        // For each texel find the color of the nearest point
-        #pragma omp parallel for schedule(dynamic,1) collapse(2)
-        for (int y = 0; y < sizeY; y++)
+    auto pointDistance = [&](const BaseVecT& p, size_t idx)
+    {
+        const float* q = pts + 3 * idx;
+        CoordT dx = p.x - q[0];
+        CoordT dy = p.y - q[1];
+        CoordT dz = p.z - q[2];
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    };
+
+    auto writeTexel = [&](int x, int y, const size_t* neighbors, size_t n)
+    {
+        // Sum up in int to prevent overflows when averaging
+        unsigned int r = 0, g = 0, b = 0;
+        for (size_t i = 0; i < n; i++)
         {
-            for (int x = 0; x < sizeX; x++)
-            {
-                int k = 1; // k-nearest-neighbors
+            const unsigned char* c = rgb + colorWidth * neighbors[i];
+            r += c[0];
+            g += c[1];
+            b += c[2];
+        }
 
-                vector<size_t> cv;
+        if (n > 0)
+        {
+            size_t pos = (sizeY - y - 1) * (sizeX * 3) + 3 * x;
+            texture.m_data[pos + 0] = r / n;
+            texture.m_data[pos + 1] = g / n;
+            texture.m_data[pos + 2] = b / n;
+        }
+    };
 
-                BaseVecT currentPos =
-                    boundingRect.m_supportVector
-                    + boundingRect.m_vec1 * (x * m_texelSize + boundingRect.m_minDistA - m_texelSize / 2.0)
-                    + boundingRect.m_vec2 * (y * m_texelSize + boundingRect.m_minDistB - m_texelSize / 2.0);
+    const int tilesX = (sizeX + tileSize - 1) / tileSize;
+    const int tilesY = (sizeY + tileSize - 1) / tileSize;
+    const int numTiles = tilesX * tilesY;
 
-                surface.searchTree()->kSearch(currentPos, k, cv);
+    // Tiles are only distributed among threads if we are not already
+    // running in parallel on cluster level
+    #pragma omp parallel for schedule(dynamic) if(!omp_in_parallel())
+    for (int tile = 0; tile < numTiles; tile++)
+    {
+        const int x0 = (tile % tilesX) * tileSize;
+        const int y0 = (tile / tilesX) * tileSize;
+        const int x1 = std::min<int>(x0 + tileSize, sizeX);
+        const int y1 = std::min<int>(y0 + tileSize, sizeY);
+
+        // Center of the tile and maximum distance of a texel to it
+        BaseVecT center = texelPosition((x0 + x1 - 1) / 2.0, (y0 + y1 - 1) / 2.0);
+        CoordT tileRadius = m_texelSize * std::sqrt(
+            CoordT((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0))) / 2.0;
+
+        // Candidates sorted by their distance to the tile center
+        std::vector<std::pair<CoordT, size_t>> candidates;
+        std::vector<size_t> indices;
+        std::vector<CoordT> distances;
+
+        // The k nearest points of a texel p lie within distance
+        // d_k(center) + |p - center| of p, so all of them are within
+        // d_k(center) + 2 * tileRadius of the center. Grow the query
+        // until it covers that radius.
+        bool complete = false;
+        int numQuery = std::max(4 * k, 32);
+        while (true)
+        {
+            int found = surface.searchTree()->kSearch(center, numQuery, indices, distances);
+            found = std::min<int>(found, indices.size());
 
-                uint8_t r = 0, g = 0, b = 0;
+            candidates.clear();
+            for (int i = 0; i < found; i++)
+            {
+                candidates.emplace_back(pointDistance(center, indices[i]), indices[i]);
+            }
+            std::sort(candidates.begin(), candidates.end());
 
-                for (size_t pointIdx : cv)
-                {
-                    auto cur_color = colors[pointIdx];
-                    r += cur_color[0];
-                    g += cur_color[1];
-                    b += cur_color[2];
-                }
+            if (found < numQuery)
+            {
+                // We got the whole point cloud
+                complete = true;
+                break;
+            }
 
-                r /= k;
-                g /= k;
-                b /= k;
+            CoordT coverRadius = candidates[std::min(k, found) - 1].first + 2 * tileRadius;
+            if (candidates.back().first > coverRadius)
+            {
+                complete = true;
+                break;
+            }
 
-                texture.m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x + 0] = r;
-                texture.m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x + 1] = g;
-                texture.m_data[(sizeY - y - 1) * (sizeX * 3) + 3 * x + 2] = b;
+            if (numQuery >= maxTileCandidates)
+            {
+                break;
+            }
+            numQuery *= 2;
+        }
 
-                ++progress;
+        if (!complete)
+        {
+            for (int y = y0; y < y1; y++)
+            {
+                for (int x = x0; x < x1; x++)
+                {
+                    int found = surface.searchTree()->kSearch(texelPosition(x, y), k, indices, distances);
+                    writeTexel(x, y, indices.data(), std::min<size_t>(found, indices.size()));
+                }
             }
+            continue;
         }
-        std::cout << std::endl;
-    }
-    else
-    {
-        for (int i = 0; i < sizeX * sizeY; i++)
+
+        if (candidates.empty())
         {
-            texture.m_data[i] = 0;
+            continue;
+        }
+
+        // k nearest neighbors of the current texel, sorted by distance
+        std::vector<std::pair<CoordT, size_t>> nearest;
+        std::vector<size_t> previous;
+        std::vector<size_t> neighbors;
+        nearest.reserve(k + 1);
+
+        for (int y = y0; y < y1; y++)
+        {
+            previous.clear();
+            for (int x = x0; x < x1; x++)
+            {
+                BaseVecT p = texelPosition(x, y);
+                CoordT centerDist = p.distance(center);
+
+                // Walk along the scanline: the neighbors of the previous
+                // texel give an upper bound for the k-th distance of this one
+                CoordT bound = std::numeric_limits<CoordT>::max();
+                if (previous.size() == static_cast<size_t>(k))
+                {
+                    bound = 0;
+                    for (size_t idx : previous)
+                    {
+                        bound = std::max(bound, pointDistance(p, idx));
+                    }
+                }
+
+                nearest.clear();
+                for (const auto& candidate : candidates)
+                {
+                    CoordT limit = nearest.size() == static_cast<size_t>(k)
+                        ? std::min(bound, nearest.back().first) : bound;
+
+                    // Triangle inequality: all remaining candidates are
+                    // at least this far away from p
+                    if (candidate.first - centerDist > limit)
+                    {
+                        break;
+                    }
+
+                    CoordT d = pointDistance(p, candidate.second);
+                    if (d <= limit)
+                    {
+                        auto it = std::upper_bound(
+                            nearest.begin(),
+                            nearest.end(),
+                            std::make_pair(d, candidate.second)
+                        );
+                        nearest.insert(it, std::make_pair(d, candidate.second));
+                        if (nearest.size() > static_cast<size_t>(k))
+                        {
+                            nearest.pop_back();
+                        }
+                    }
+                }
+
+                neighbors.clear();
+                for (const auto& n : nearest)
+                {
+                    neighbors.push_back(n.second);
+                }
+                writeTexel(x, y, neighbors.data(), neighbors.size());
+                previous = neighbors;
+            }
         }
     }
 
-    return m_textures.push(texture);
+    return texture;
 }
 
-
 template<typename BaseVecT>
 void Texturizer<BaseVecT>::findKeyPointsInTexture(const TextureHandle texH,
         const BoundingRectangle<typename BaseVecT::CoordType>& boundingRect,
         const cv::Ptr<cv::Feature2D>& detector,
         std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors)
 {
-    const Texture texture = m_textures[texH];
+    const Texture& texture = m_textures[texH];
     if (texture.m_height <= 32 && texture.m_width <= 32)
     {
         return;
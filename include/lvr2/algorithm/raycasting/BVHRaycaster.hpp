@@ -37,15 +37,20 @@
 #ifndef LVR2_ALGORITHM_RAYCASTING_BVHRAYCASTER
 #define LVR2_ALGORITHM_RAYCASTING_BVHRAYCASTER
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
 
 #include "lvr2/io/MeshBuffer.hpp"
 #include "lvr2/geometry/BaseVector.hpp"
 #include "lvr2/geometry/BVH.hpp"
 #include "lvr2/algorithm/raycasting/RaycasterBase.hpp"
+#include "lvr2/algorithm/raycasting/SimdFloat4.hpp"
 
 #define EPSILON 0.0000001
 #define PI 3.14159265
-#define BVH_STACK_SIZE 128
+#define BVH_STACK_SIZE 256
 
 namespace lvr2
 {
@@ -53,7 +58,8 @@ namespace lvr2
 
 
 /**
- *  @brief BVHRaycaster: CPU version of BVH Raycasting: WIP
+ *  @brief BVHRaycaster: CPU version of BVH Raycasting. Traverses the 4-wide representation of the BVH
+ *         with SIMD box tests and traces coherent rays in packets of four.
  */
 template<typename PointT, typename NormalT>
 class BVHRaycaster : public RaycasterBase<PointT, NormalT > {
@@ -111,129 +117,116 @@ public:
 protected:
     BVHTree<PointT> m_bvh;
 
-private:
-
+    // Number of stack entries needed to traverse the wide BVH
+    size_t m_stackSize;
 
-    /**
-     * @brief Calculates the squared distance of two vectors
-     * @param a First vector
-     * @param b Second vector
-     * @return The square distance
-     */
-    inline float distanceSquare(const PointT& a, const PointT& b) const
-    {
-        return fabs((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z));
-    }
+    // Entry of the traversal stack: a node of the wide BVH, the rays that visit it and the distance where they enter it
+    struct StackEntry {
+        uint32_t node;
+        int rayMask;
+        float tNear;
+    };
 
     /**
-     * @brief Calculates whether a ray intersects a box
-     * @param origin    The origin of the ray
-     * @param ray       The ray
-     * @param boxPtr    A pointer to the box data
-     * @return          A boolean indicating whether the ray hits the box
+     * @brief Intersects one ray with a triangle. Updates the closest hit, if the triangle is closer.
+     *
+     * @param tri       16 floats of precomputed intersection data of the triangle
+     * @param origin    Origin of the ray
+     * @param dir       Direction of the ray
+     * @param best      Distance of the closest hit so far
+     * @param hit       Position of the closest hit so far
+     * @return          Whether the triangle is the new closest hit
      */
-    bool rayIntersectsBox(PointT origin, Ray ray, const float* boxPtr);
+    static bool intersectTriangle(const float* tri, const float* origin, const float* dir, float& best, float* hit);
 
     /**
-     * @brief Calculates the closest intersection of a raycast into a scene of triangles, given a bounding volume hierarchy
+     * @brief Traverses the wide BVH with one ray
      *
-     * @param clBVHindicesOrTriLists        Compressed BVH Node data, that stores for each node, whether it is a leaf node
-     *                                      and triangle indices lists for leaf nodes and the indices of their child nodes
-     *                                      for inner nodes
-     * @param origin                        Origin of the ray
-     * @param ray                           Direction of the ray
-     * @param clBVHlimits                   3d upper and lower limits for each bounding box in the BVH
-     * @param clTriangleIntersectionData    Precomputed intersection data for each triangle
-     * @param clTriIdxList                  List of triangle indices
-     * @return The TriangleIntersectionResult, containing information about the triangle intersection
+     * @param origin    Origin of the ray
+     * @param dir       Direction of the ray
+     * @param anyHit    Stop at the first hit instead of searching the closest one
+     * @param stack     Traversal stack with at least m_stackSize entries
+     * @param dist      In: only hits closer than this are reported. Out: distance of the hit along the ray
+     * @param triangle  Index of the hit triangle in the BVH
+     * @param hit       Position of the hit
+     * @return          Whether a triangle was hit
      */
-    TriangleIntersectionResult intersectTrianglesBVH(
-        const unsigned int* clBVHindicesOrTriLists,
-        PointT origin,
-        Ray ray,
-        const float* clBVHlimits,
-        const float* clTriangleIntersectionData,
-        const unsigned int* clTriIdxList
-    );
+    bool traverseRay(
+        const float* origin,
+        const float* dir,
+        bool anyHit,
+        StackEntry* stack,
+        float& dist,
+        uint32_t& triangle,
+        float* hit
+    ) const;
 
     /**
-     * @brief Casts one ray from one origin into a scene of triangles, given a bounding volume hierarchy
+     * @brief Traverses the wide BVH with a packet of up to four coherent rays. Boxes and triangles are
+     *        tested for all rays of the packet at once.
      *
-     * @param rays_origin                   Origins of the rays
-     * @param rays                          Forward directions of each pose
-     * @param clBVHindicesOrTriLists        Compressed BVH Node data, that stores for each node, whether it is a leaf node
-     *                                      and triangle indices lists for leaf nodes and the indices of their child nodes
-     *                                      for inner nodes
-     * @param clBVHlimits                   3d upper and lower limits for each bounding box in the BVH
-     * @param clTriangleIntersectionData    Precomputed intersection data for each triangle
-     * @param clTriIdxList                  List of triangle indices
-     * @param result                        Result point positions
-     * @param result_hits                   Result hits, where for each ray is stored whether it has hit a triangle
+     * @param origins       Origins of the rays
+     * @param originStride  Number of floats between two origins, 0 if all rays share one origin
+     * @param dirs          Directions of the rays
+     * @param numRays       Number of rays in the packet, at most 4
+     * @param anyHit        Stop each ray at its first hit instead of searching the closest one
+     * @param stack         Traversal stack with at least m_stackSize entries
+     * @param dist          In: only hits closer than this are reported. Out: distances of the hits
+     * @param triangle      Indices of the hit triangles in the BVH
+     * @param hit           Positions of the hits, three floats per ray
+     * @return              Bit mask of the rays, that hit a triangle
      */
-    void cast_rays_one_one(
-        const float* ray_origin,
-        const float* rays,
-        const unsigned int* clBVHindicesOrTriLists,
-        const float* clBVHlimits,
-        const float* clTriangleIntersectionData,
-        const unsigned int* clTriIdxList,
-        float* result,
-        uint8_t* result_hits
-    );
+    int traversePacket(
+        const float* origins,
+        size_t originStride,
+        const float* dirs,
+        int numRays,
+        bool anyHit,
+        StackEntry* stack,
+        float* dist,
+        uint32_t* triangle,
+        float* hit
+    ) const;
 
     /**
-     * @brief Casts multiple rays from one origin into a scene of triangles, given a bounding volume hierarchy
+     * @brief Casts multiple rays in parallel. Groups of four neighbouring rays with nearly the same
+     *        direction and the same origin are traced as packets, all others one by one. Every thread
+     *        reuses one traversal stack for all of its rays.
      *
-     * @param rays_origin                   Origins of the rays
-     * @param rays                          Forward directions of each pose
-     * @param clBVHindicesOrTriLists        Compressed BVH Node data, that stores for each node, whether it is a leaf node
-     *                                      and triangle indices lists for leaf nodes and the indices of their child nodes
-     *                                      for inner nodes
-     * @param clBVHlimits                   3d upper and lower limits for each bounding box in the BVH
-     * @param clTriangleIntersectionData    Precomputed intersection data for each triangle
-     * @param clTriIdxList                  List of triangle indices
-     * @param result                        Result point positions
-     * @param result_hits                   Result hits, where for each ray is stored whether it has hit a triangle
+     * @param origins       Origins of the rays
+     * @param originStride  Number of floats between two origins, 0 if all rays share one origin
+     * @param rays          Directions of the rays
+     * @param num_rays      Number of rays
+     * @param maxDist       Maximum distance for each ray, may be nullptr
+     * @param anyHit        Stop each ray at its first hit instead of searching the closest one
+     * @param tileSize      Number of consecutive rays that are handed to a thread at once
+     * @param store         Called as store(rayIndex, hit, distance, triangle, position) for each ray
      */
-
-    void cast_rays_one_multi(
-        const float* ray_origin,
+    template<typename StoreFunc>
+    void traceRays(
+        const float* origins,
+        size_t originStride,
         const float* rays,
         size_t num_rays,
-        const unsigned int* clBVHindicesOrTriLists,
-        const float* clBVHlimits,
-        const float* clTriangleIntersectionData,
-        const unsigned int* clTriIdxList,
-        float* result,
-        uint8_t* result_hits
-    );
+        const float* maxDist,
+        bool anyHit,
+        size_t tileSize,
+        StoreFunc store
+    ) const;
+
+private:
 
     /**
-     * @brief Casts multiple rays from multiple origins into a scene of triangles, given a bounding volume hierarchy
-     *
-     * @param rays_origin                   Origins of the rays
-     * @param rays                          Forward directions of each pose
-     * @param clBVHindicesOrTriLists        Compressed BVH Node data, that stores for each node, whether it is a leaf node
-     *                                      and triangle indices lists for leaf nodes and the indices of their child nodes
-     *                                      for inner nodes
-     * @param clBVHlimits                   3d upper and lower limits for each bounding box in the BVH
-     * @param clTriangleIntersectionData    Precomputed intersection data for each triangle
-     * @param clTriIdxList                  List of triangle indices
-     * @param result                        Result point positions
-     * @param result_hits                   Result hits, where for each ray is stored whether it has hit a triangle
+     * @brief Casts multiple rays and stores the closest hits in the arrays used by castRays
      */
-    void cast_rays_multi_multi(
-        const float* ray_origin,
+    void cast_rays(
+        const float* origins,
+        size_t originStride,
         const float* rays,
         size_t num_rays,
-        const unsigned int* clBVHindicesOrTriLists,
-        const float* clBVHlimits,
-        const float* clTriangleIntersectionData,
-        const unsigned int* clTriIdxList,
         float* result,
         uint8_t* result_hits
-    );
-
+    ) const;
 
 };
 
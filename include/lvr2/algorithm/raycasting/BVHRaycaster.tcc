@@ -32,10 +32,33 @@ template <typename PointT, typename NormalT>
 BVHRaycaster<PointT, NormalT>::BVHRaycaster(const MeshBufferPtr mesh)
 :RaycasterBase<PointT, NormalT>(mesh)
 ,m_bvh(mesh)
+,m_stackSize(BVH_STACK_SIZE)
 {
-    
+    // every node on the path to the deepest leaf leaves at most three siblings on the stack
+    const auto& nodes = m_bvh.getWideNodes();
+    size_t depth = 0;
+    std::vector<std::pair<uint32_t, size_t>> todo;
+    if (!nodes.empty())
+    {
+        todo.push_back({0, 1});
+    }
+    while (!todo.empty())
+    {
+        auto current = todo.back();
+        todo.pop_back();
+        depth = std::max(depth, current.second);
+        for (int i = 0; i < 4; i++)
+        {
+            if (!(nodes[current.first].counts[i] & 0x80000000))
+            {
+                todo.push_back({nodes[current.first].children[i], current.second + 1});
+            }
+        }
+    }
+    m_stackSize = std::max(m_stackSize, 3 * depth + 4);
 }
 
+
 template <typename PointT, typename NormalT>
 bool BVHRaycaster<PointT, NormalT>::castRay(
     const PointT& origin,
@@ -44,29 +67,31 @@ bool BVHRaycaster<PointT, NormalT>::castRay(
 )
 {
     // Cast one ray from one origin
-    std::vector<uint8_t> tmp(1);
-
     const float *origin_f = reinterpret_cast<const float*>(&origin.x);
     const float *direction_f = reinterpret_cast<const float*>(&direction.x);
-    const unsigned int* clBVHindicesOrTriLists = m_bvh.getIndexesOrTrilists().data();
-    const float* clBVHlimits = m_bvh.getLimits().data();
-    const float* clTriangleIntersectionData = m_bvh.getTrianglesIntersectionData().data();
-    const unsigned int* clTriIdxList = m_bvh.getTriIndexList().data();
     float* result = reinterpret_cast<float*>(&intersection.x);
-    uint8_t* result_hits = tmp.data();
 
-    cast_rays_one_one(origin_f, 
-        direction_f, 
-        clBVHindicesOrTriLists,
-        clBVHlimits,
-        clTriangleIntersectionData,
-        clTriIdxList,
-        result,
-        result_hits);
+    // only allocate, if the tree is too deep for the default stack
+    StackEntry localStack[BVH_STACK_SIZE];
+    std::vector<StackEntry> heapStack;
+    StackEntry* stack = localStack;
+    if (m_stackSize > BVH_STACK_SIZE)
+    {
+        heapStack.resize(m_stackSize);
+        stack = heapStack.data();
+    }
 
-    bool success = tmp[0];
+    float dist = std::numeric_limits<float>::max();
+    uint32_t triangle;
+    if (traverseRay(origin_f, direction_f, false, stack, dist, triangle, result))
+    {
+        return true;
+    }
 
-    return success;
+    result[0] = 0;
+    result[1] = 0;
+    result[2] = 0;
+    return false;
 }
 
 template <typename PointT, typename NormalT>
@@ -77,32 +102,18 @@ void BVHRaycaster<PointT, NormalT>::castRays(
     std::vector<uint8_t>& hits
 )
 {
+    // Cast multiple rays from one origin
     intersections.resize(directions.size());
     hits.resize(directions.size());
 
-
-    const float *origin_f = reinterpret_cast<const float*>(&origin.x);
-    const float *direction_f = reinterpret_cast<const float*>(directions.data());
-    const unsigned int* clBVHindicesOrTriLists = m_bvh.getIndexesOrTrilists().data();
-    const float* clBVHlimits = m_bvh.getLimits().data();
-    const float* clTriangleIntersectionData = m_bvh.getTrianglesIntersectionData().data();
-    const unsigned int* clTriIdxList = m_bvh.getTriIndexList().data();
-    float* result = reinterpret_cast<float*>(intersections.data());
-    uint8_t* result_hits = hits.data();
-
-    size_t num_rays = directions.size();
-
-    cast_rays_one_multi(origin_f, 
-        direction_f, 
-        num_rays,
-        clBVHindicesOrTriLists,
-        clBVHlimits,
-        clTriangleIntersectionData,
-        clTriIdxList,
-        result,
-        result_hits);
-
-    // Cast multiple rays from one origin
+    cast_rays(
+        reinterpret_cast<const float*>(&origin.x),
+        0,
+        reinterpret_cast<const float*>(directions.data()),
+        directions.size(),
+        reinterpret_cast<float*>(intersections.data()),
+        hits.data()
+    );
 }
 
 template <typename PointT, typename NormalT>
@@ -113,380 +124,452 @@ void BVHRaycaster<PointT, NormalT>::castRays(
     std::vector<uint8_t>& hits
 )
 {
+    // Cast multiple rays from multiple origins
     intersections.resize(directions.size());
     hits.resize(directions.size());
 
-    const float *origin_f = reinterpret_cast<const float*>(origins.data());
-    const float *direction_f = reinterpret_cast<const float*>(directions.data());
-    const unsigned int* clBVHindicesOrTriLists = m_bvh.getIndexesOrTrilists().data();
-    const float* clBVHlimits = m_bvh.getLimits().data();
-    const float* clTriangleIntersectionData = m_bvh.getTrianglesIntersectionData().data();
-    const unsigned int* clTriIdxList = m_bvh.getTriIndexList().data();
-    float* result = reinterpret_cast<float*>(intersections.data());
-    uint8_t* result_hits = hits.data();
-
-    size_t num_rays = directions.size();
-
-    cast_rays_multi_multi(origin_f, 
-        direction_f, 
-        num_rays,
-        clBVHindicesOrTriLists,
-        clBVHlimits,
-        clTriangleIntersectionData,
-        clTriIdxList,
-        result,
-        result_hits);
-
+    cast_rays(
+        reinterpret_cast<const float*>(origins.data()),
+        3,
+        reinterpret_cast<const float*>(directions.data()),
+        directions.size(),
+        reinterpret_cast<float*>(intersections.data()),
+        hits.data()
+    );
 }
 
 
 // PRIVATE FUNCTIONS
 template <typename PointT, typename NormalT>
-bool BVHRaycaster<PointT, NormalT>::rayIntersectsBox(
-    PointT origin,
-    Ray ray,
-    const float* boxPtr)
+bool BVHRaycaster<PointT, NormalT>::intersectTriangle(
+    const float* tri,
+    const float* origin,
+    const float* dir,
+    float& best,
+    float* hit)
 {
-    const float* limitsX2 = boxPtr;
-    const float* limitsY2 = boxPtr+2;
-    const float* limitsZ2 = boxPtr+4;
-
-    float tmin, tmax, tymin, tymax, tzmin, tzmax;
-
-    tmin =  (limitsX2[    ray.rayDirSign.x] - origin.x) * ray.invDir.x;
-    tmax =  (limitsX2[1 - ray.rayDirSign.x] - origin.x) * ray.invDir.x;
-    tymin = (limitsY2[    ray.rayDirSign.y] - origin.y) * ray.invDir.y;
-    tymax = (limitsY2[1 - ray.rayDirSign.y] - origin.y) * ray.invDir.y;
-
-    // std::cout << "Statisics: " << std::endl;
-    // std::cout << tmin << std::endl;
-    // std::cout << tmax << std::endl;
-    // std::cout << tymin << std::endl;
-    // std::cout << tymax << std::endl;
-    // std::cout << std::endl;
-
-    if ((tmin > tymax) || (tymin > tmax))
-    {
-        return false;
-    }
-    if (tymin >tmin)
+    float k = tri[0] * dir[0] + tri[1] * dir[1] + tri[2] * dir[2];
+    if (k == 0.0f)
     {
-        tmin = tymin;
+        return false; // this triangle is parallel to the ray -> ignore it
     }
-    if (tymax < tmax)
+    float s = (tri[3] - (tri[0] * origin[0] + tri[1] * origin[1] + tri[2] * origin[2])) / k;
+    if (s <= static_cast<float>(EPSILON) || !(s < best))
     {
-        tmax = tymax;
+        return false; // this triangle is "behind" the origin or farther away than the closest hit
     }
 
-    tzmin = (limitsZ2[    ray.rayDirSign.z] - origin.z) * ray.invDir.z;
-    tzmax = (limitsZ2[1 - ray.rayDirSign.z] - origin.z) * ray.invDir.z;
+    float p[3] = {dir[0] * s + origin[0], dir[1] * s + origin[1], dir[2] * s + origin[2]};
 
-    if ((tmin > tzmax) || (tzmin > tmax))
-    {
-        return false;
-    }
-    if (tzmin > tmin)
+    // check if the intersection with the triangle's plane is inside the triangle
+    for (int e = 4; e < 16; e += 4)
     {
-        tmin = tzmin;
-    }
-    if (tzmax < tmax)
-    {
-        tmax = tzmax;
+        if (tri[e] * p[0] + tri[e + 1] * p[1] + tri[e + 2] * p[2] - tri[e + 3] < 0.0f)
+        {
+            return false;
+        }
     }
 
+    best = s;
+    hit[0] = p[0];
+    hit[1] = p[1];
+    hit[2] = p[2];
     return true;
 }
 
 template <typename PointT, typename NormalT>
-typename BVHRaycaster<PointT, NormalT>::TriangleIntersectionResult BVHRaycaster<PointT, NormalT>::intersectTrianglesBVH(
-    const unsigned int* clBVHindicesOrTriLists,
-    PointT origin,
-    Ray ray,
-    const float* clBVHlimits,
-    const float* clTriangleIntersectionData,
-    const unsigned int* clTriIdxList
-)
+bool BVHRaycaster<PointT, NormalT>::traverseRay(
+    const float* origin,
+    const float* dir,
+    bool anyHit,
+    StackEntry* stack,
+    float& dist,
+    uint32_t& triangle,
+    float* hit) const
 {
+    const auto& nodes = m_bvh.getWideNodes();
+    if (nodes.empty())
+    {
+        return false;
+    }
+    const float* triData = m_bvh.getTrianglesIntersectionData().data();
+    const uint32_t* triIdx = m_bvh.getTriIndexList().data();
 
-    int tid_scale = 4;
-    int bvh_limits_scale = 2;
-
-    TriangleIntersectionResult result;
-    result.hit = false;
-    unsigned int pBestTriId = 0;
-    float bestTriDist = std::numeric_limits<float>::max();
+    // precompute ray values to speed up the box tests
+    const Float4 ox(origin[0]), oy(origin[1]), oz(origin[2]);
+    const Float4 ix(1.0f / dir[0]), iy(1.0f / dir[1]), iz(1.0f / dir[2]);
+    const Float4 zero(0.0f);
 
-    unsigned int stack[BVH_STACK_SIZE];
+    float& best = dist;
+    bool found = false;
 
-    int stackId = 0;
-    stack[stackId++] = 0;
-    PointT hitpoint;
+    size_t stackId = 0;
+    stack[stackId++] = {0, 1, 0.0f};
 
-    // while stack is not empty
     while (stackId)
     {
-        
-        unsigned int boxId = stack[stackId - 1];
+        const StackEntry entry = stack[--stackId];
+        if (entry.tNear > best)
+        {
+            continue; // a closer triangle was found after this node was pushed
+        }
+
+        const typename BVHTree<PointT>::WideNode& node = nodes[entry.node];
+
+        // slab test against all four children at once
+        Float4 tx0 = (Float4::load(node.bounds[0]) - ox) * ix;
+        Float4 tx1 = (Float4::load(node.bounds[1]) - ox) * ix;
+        Float4 ty0 = (Float4::load(node.bounds[2]) - oy) * iy;
+        Float4 ty1 = (Float4::load(node.bounds[3]) - oy) * iy;
+        Float4 tz0 = (Float4::load(node.bounds[4]) - oz) * iz;
+        Float4 tz1 = (Float4::load(node.bounds[5]) - oz) * iz;
+
+        Float4 tNear = max(max(min(tx0, tx1), min(ty0, ty1)), max(min(tz0, tz1), zero));
+        Float4 tFar = min(min(max(tx0, tx1), max(ty0, ty1)), min(max(tz0, tz1), Float4(best)));
+        int mask = le(tNear, tFar);
+        if (!mask)
+        {
+            continue;
+        }
 
-        stackId--;
+        float tNearChild[4];
+        tNear.store(tNearChild);
 
-        // the first bit of the data of a bvh node indicates whether it is a leaf node, by performing a bitwise and
-        // with 0x80000000 all other bits are set to zero and the value of that one bit can be checked
-        if (!(clBVHindicesOrTriLists[4 * boxId + 0] & 0x80000000)) // inner node
+        // intersect leaves right away, sort inner children by distance, the farthest first
+        StackEntry inner[4];
+        int numInner = 0;
+        for (int i = 0; i < 4; i++)
         {
-            
-            // if ray intersects inner node, push indices of left and right child nodes on the stack
-            if (rayIntersectsBox(origin, ray, &clBVHlimits[bvh_limits_scale * 3 * boxId]))
+            if (!(mask & (1 << i)))
             {
-                stack[stackId++] = clBVHindicesOrTriLists[4 * boxId + 1];
-                stack[stackId++] = clBVHindicesOrTriLists[4 * boxId + 2];
+                continue;
+            }
 
-                // return if stack size is exceeded
-                if ( stackId > BVH_STACK_SIZE)
+            if (node.counts[i] & 0x80000000)
+            {
+                uint32_t start = node.children[i];
+                uint32_t end = start + (node.counts[i] & 0x7fffffff);
+                for (uint32_t t = start; t < end; t++)
+                {
+                    if (intersectTriangle(triData + 16 * triIdx[t], origin, dir, best, hit))
+                    {
+                        found = true;
+                        triangle = triIdx[t];
+                        if (anyHit)
+                        {
+                            return true;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                StackEntry child = {node.children[i], 1, tNearChild[i]};
+                int j = numInner++;
+                while (j > 0 && inner[j - 1].tNear < child.tNear)
                 {
-                    printf("BVH stack size exceeded!\n");
-                    result.hit = 0;
-                    return result;
+                    inner[j] = inner[j - 1];
+                    j--;
                 }
+                inner[j] = child;
             }
         }
-        else // leaf node
+
+        for (int j = 0; j < numInner; j++)
+        {
+            stack[stackId++] = inner[j];
+        }
+    }
+
+    return found;
+}
+
+template <typename PointT, typename NormalT>
+int BVHRaycaster<PointT, NormalT>::traversePacket(
+    const float* origins,
+    size_t originStride,
+    const float* dirs,
+    int numRays,
+    bool anyHit,
+    StackEntry* stack,
+    float* dist,
+    uint32_t* triangle,
+    float* hit) const
+{
+    const auto& nodes = m_bvh.getWideNodes();
+    if (nodes.empty())
+    {
+        return 0;
+    }
+    const float* triData = m_bvh.getTrianglesIntersectionData().data();
+    const uint32_t* triIdx = m_bvh.getTriIndexList().data();
+
+    // one lane per ray, unused lanes repeat the first ray and are masked out
+    float lanes[7][4];
+    for (int i = 0; i < 4; i++)
+    {
+        int r = i < numRays ? i : 0;
+        for (int j = 0; j < 3; j++)
+        {
+            lanes[j][i] = origins[r * originStride + j];
+            lanes[j + 3][i] = dirs[r * 3 + j];
+        }
+        lanes[6][i] = dist[r];
+    }
+
+    const Float4 ox = Float4::load(lanes[0]), oy = Float4::load(lanes[1]), oz = Float4::load(lanes[2]);
+    const Float4 dx = Float4::load(lanes[3]), dy = Float4::load(lanes[4]), dz = Float4::load(lanes[5]);
+    const Float4 one(1.0f);
+    const Float4 ix = one / dx, iy = one / dy, iz = one / dz;
+    const Float4 zero(0.0f);
+    const Float4 eps(static_cast<float>(EPSILON));
+
+    Float4 best = Float4::load(lanes[6]);
+    Float4 hx(0.0f), hy(0.0f), hz(0.0f);
+    int hitMask = 0;
+
+    // rays, that are finished with an any hit query
+    int done = 0;
+
+    size_t stackId = 0;
+    stack[stackId++] = {0, (1 << numRays) - 1, 0.0f};
+
+    while (stackId)
+    {
+        const StackEntry entry = stack[--stackId];
+
+        // drop the rays, that found a closer triangle after this node was pushed
+        int rays = entry.rayMask & le(Float4(entry.tNear), best) & ~done;
+        if (!rays)
+        {
+            continue;
+        }
+
+        const typename BVHTree<PointT>::WideNode& node = nodes[entry.node];
+
+        StackEntry inner[4];
+        int numInner = 0;
+        for (int c = 0; c < 4; c++)
         {
-            
-            // iterate over all triangles in this leaf node
-            for (
-                unsigned int i = clBVHindicesOrTriLists[4 * boxId + 3];
-                i < (clBVHindicesOrTriLists[4 * boxId + 3] + (clBVHindicesOrTriLists[4* boxId + 0] & 0x7fffffff));
-                i++
-            )
+            if (node.counts[c] == 0x80000000)
             {
-                unsigned int idx = clTriIdxList[i];
-                const float* normal = clTriangleIntersectionData + tid_scale * 4 * idx;
+                continue; // unused slot
+            }
 
-                float k = normal[0] * ray.dir[0] + normal[1] * ray.dir[1] + normal[2] * ray.dir[2];
-                if (k == 0.0f)
-                {
-                    continue; // this triangle is parallel to the ray -> ignore it
-                }
-                float s = (normal[3] - (normal[0] * origin[0] + normal[1] * origin[1] + normal[2] * origin[2])  ) / k;
-                if (s <= 0.0f)
-                {
-                    continue; // this triangle is "behind" the origin
-                }
-                if (s <= EPSILON)
-                {
-                    continue; // epsilon
-                }
-                PointT hit = ray.dir * s;
-                hit += origin;
-
-                // ray triangle intersection
-                // check if the intersection with the triangle's plane is inside the triangle
-                const float* ee1 = clTriangleIntersectionData + tid_scale * 4 * idx + tid_scale*1;
-                float kt1 = ee1[0] * hit[0] + ee1[1] * hit[1] + ee1[2] * hit[2] - ee1[3];
-                if (kt1 < 0.0f)
-                {
-                    continue;
-                }
-                const float* ee2 = clTriangleIntersectionData + tid_scale * 4 * idx + tid_scale * 2;
-                float kt2 = ee2[0] * hit[0] + ee2[1] * hit[1] + ee2[2] * hit[2] - ee2[3];
-                if (kt2 < 0.0f)
-                {
-                    continue;
-                }
-                const float* ee3 = clTriangleIntersectionData + tid_scale * 4 * idx + tid_scale * 3;
-                float kt3 = ee3[0] * hit[0] + ee3[1] * hit[1] + ee3[2] * hit[2] - ee3[3];
-                if (kt3 < 0.0f)
+            // slab test of all rays against this child
+            Float4 tx0 = (Float4(node.bounds[0][c]) - ox) * ix;
+            Float4 tx1 = (Float4(node.bounds[1][c]) - ox) * ix;
+            Float4 ty0 = (Float4(node.bounds[2][c]) - oy) * iy;
+            Float4 ty1 = (Float4(node.bounds[3][c]) - oy) * iy;
+            Float4 tz0 = (Float4(node.bounds[4][c]) - oz) * iz;
+            Float4 tz1 = (Float4(node.bounds[5][c]) - oz) * iz;
+
+            Float4 tNear = max(max(min(tx0, tx1), min(ty0, ty1)), max(min(tz0, tz1), zero));
+            Float4 tFar = min(min(max(tx0, tx1), max(ty0, ty1)), min(max(tz0, tz1), best));
+            int childRays = le(tNear, tFar) & rays;
+            if (!childRays)
+            {
+                continue;
+            }
+
+            if (node.counts[c] & 0x80000000)
+            {
+                // intersect all triangles of the leaf with all rays, that hit its box
+                uint32_t start = node.children[c];
+                uint32_t end = start + (node.counts[c] & 0x7fffffff);
+                for (uint32_t t = start; t < end; t++)
                 {
-                    continue;
-                }
+                    const float* tri = triData + 16 * triIdx[t];
+                    const Float4 nx(tri[0]), ny(tri[1]), nz(tri[2]);
+
+                    Float4 k = nx * dx + ny * dy + nz * dz;
+                    Float4 s = (Float4(tri[3]) - (nx * ox + ny * oy + nz * oz)) / k;
+                    int m = childRays & neq(k, zero) & gt(s, eps) & lt(s, best);
+                    if (!m)
+                    {
+                        continue;
+                    }
+
+                    Float4 px = dx * s + ox;
+                    Float4 py = dy * s + oy;
+                    Float4 pz = dz * s + oz;
+                    for (int e = 4; e < 16 && m; e += 4)
+                    {
+                        Float4 kt = Float4(tri[e]) * px + Float4(tri[e + 1]) * py + Float4(tri[e + 2]) * pz
+                            - Float4(tri[e + 3]);
+                        m &= ge(kt, zero);
+                    }
+                    if (!m)
+                    {
+                        continue;
+                    }
 
-                // ray intersects triangle, "hit" is the coordinate of the intersection
+                    best = select(m, s, best);
+                    hx = select(m, px, hx);
+                    hy = select(m, py, hy);
+                    hz = select(m, pz, hz);
+                    hitMask |= m;
+                    for (int i = 0; i < 4; i++)
+                    {
+                        if (m & (1 << i))
+                        {
+                            triangle[i] = triIdx[t];
+                        }
+                    }
+
+                    if (anyHit)
+                    {
+                        done |= m;
+                        childRays &= ~m;
+                        if (!childRays)
+                        {
+                            break;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                // the packet enters the child at the nearest entry point of its rays
+                float tNearLanes[4];
+                tNear.store(tNearLanes);
+                float childNear = std::numeric_limits<float>::max();
+                for (int i = 0; i < 4; i++)
                 {
-                    // check if this intersection closer than others
-                    // use quadratic distance for comparison to save some root calculations
-                    float hitZ = distanceSquare(origin, hit);
-                    if (hitZ < bestTriDist)
+                    if (childRays & (1 << i))
                     {
-                        bestTriDist = hitZ;
-                        pBestTriId = idx;
-                        result.hit = true;
-                        hitpoint = hit;
+                        childNear = std::min(childNear, tNearLanes[i]);
                     }
                 }
 
+                StackEntry child = {node.children[c], childRays, childNear};
+                int j = numInner++;
+                while (j > 0 && inner[j - 1].tNear < child.tNear)
+                {
+                    inner[j] = inner[j - 1];
+                    j--;
+                }
+                inner[j] = child;
             }
         }
-    }
-
-    result.pBestTriId = pBestTriId ;
-    result.pointHit = hitpoint;
-    result.hitDist = sqrt(bestTriDist);
-
-    return result;
-}
 
-template <typename PointT, typename NormalT>
-void BVHRaycaster<PointT, NormalT>::cast_rays_one_one(
-        const float* ray_origin,
-        const float* rays,
-        const unsigned int* clBVHindicesOrTriLists,
-        const float* clBVHlimits,
-        const float* clTriangleIntersectionData,
-        const unsigned int* clTriIdxList,
-        float* result,
-        uint8_t* result_hits
-    )
-{
-     // get direction and origin of the ray for the current pose
-    NormalT ray_d = {rays[0], rays[1], rays[2]};
-    PointT ray_o = {ray_origin[0], ray_origin[1], ray_origin[2]};
-
-    // initialize result memory with zeros
-    result[0] = 0;
-    result[1] = 0;
-    result[2] = 0;
-    result_hits[0] = 0;
-
-    // precompute ray values to speed up intersection calculation
-    Ray ray;
-    ray.dir = ray_d;
-    ray.invDir = NormalT(1.0 / ray_d.x, 1.0 / ray_d.y, 1.0 / ray_d.z);
-    ray.rayDirSign.x = ray.invDir.x < 0;
-    ray.rayDirSign.y = ray.invDir.y < 0;
-    ray.rayDirSign.z = ray.invDir.z < 0;
-
-    // intersect all triangles stored in the BVH
-    TriangleIntersectionResult resultBVH = intersectTrianglesBVH(
-        clBVHindicesOrTriLists,
-        ray_o,
-        ray,
-        clBVHlimits,
-        clTriangleIntersectionData,
-        clTriIdxList
-    );
+        for (int j = 0; j < numInner; j++)
+        {
+            stack[stackId++] = inner[j];
+        }
+    }
 
-    // if a triangle was hit, store the calculated hit point in the result at the current id
-    if (resultBVH.hit)
+    float bestLanes[4], px[4], py[4], pz[4];
+    best.store(bestLanes);
+    hx.store(px);
+    hy.store(py);
+    hz.store(pz);
+    for (int i = 0; i < numRays; i++)
     {
-        result[0] = resultBVH.pointHit.x;
-        result[1] = resultBVH.pointHit.y;
-        result[2] = resultBVH.pointHit.z;
-        result_hits[0] = 1;
+        if (hitMask & (1 << i))
+        {
+            dist[i] = bestLanes[i];
+            hit[i * 3] = px[i];
+            hit[i * 3 + 1] = py[i];
+            hit[i * 3 + 2] = pz[i];
+        }
     }
 
+    return hitMask;
 }
 
 template <typename PointT, typename NormalT>
-void BVHRaycaster<PointT, NormalT>::cast_rays_one_multi(
-        const float* ray_origin,
-        const float* rays,
-        size_t num_rays,
-        const unsigned int* clBVHindicesOrTriLists,
-        const float* clBVHlimits,
-        const float* clTriangleIntersectionData,
-        const unsigned int* clTriIdxList,
-        float* result,
-        uint8_t* result_hits
-    )
+template <typename StoreFunc>
+void BVHRaycaster<PointT, NormalT>::traceRays(
+    const float* origins,
+    size_t originStride,
+    const float* rays,
+    size_t num_rays,
+    const float* maxDist,
+    bool anyHit,
+    size_t tileSize,
+    StoreFunc store) const
 {
-     // get direction and origin of the ray for the current pose
-    PointT ray_o(ray_origin[0], ray_origin[1], ray_origin[2]);
+    // rays of one packet may diverge by about 25 degrees
+    const float minCos = 0.9f;
+    const long num_packets = static_cast<long>((num_rays + 3) / 4);
+    const long packetsPerTile = std::max<long>(1, static_cast<long>(tileSize / 4));
 
-    #pragma omp parallel for
-    for(size_t i=0; i< num_rays; i++)
+    #pragma omp parallel
     {
-        NormalT ray_d(rays[i*3], rays[i*3+1], rays[i*3+2]);
-        // initialize result memory with zeros
-        result[i*3] = 0;
-        result[i*3+1] = 0;
-        result[i*3+2] = 0;
-        result_hits[i] = 0;
-
-        // precompute ray values to speed up intersection calculation
-        Ray ray;
-        ray.dir = ray_d;
-        ray.invDir = NormalT(1.0 / ray_d.x, 1.0 / ray_d.y, 1.0 / ray_d.z);
-        ray.rayDirSign.x = ray.invDir.x < 0;
-        ray.rayDirSign.y = ray.invDir.y < 0;
-        ray.rayDirSign.z = ray.invDir.z < 0;
-
-        // intersect all triangles stored in the BVH
-        TriangleIntersectionResult resultBVH = intersectTrianglesBVH(
-            clBVHindicesOrTriLists,
-            ray_o,
-            ray,
-            clBVHlimits,
-            clTriangleIntersectionData,
-            clTriIdxList
-        );
-
-        // if a triangle was hit, store the calculated hit point in the result at the current id
-        if (resultBVH.hit)
+        std::vector<StackEntry> stack(m_stackSize);
+
+        #pragma omp for schedule(dynamic, packetsPerTile)
+        for (long p = 0; p < num_packets; p++)
         {
-            result[i*3] = resultBVH.pointHit.x;
-            result[i*3+1] = resultBVH.pointHit.y;
-            result[i*3+2] = resultBVH.pointHit.z;
-            result_hits[i] = 1;
+            size_t first = static_cast<size_t>(p) * 4;
+            int n = static_cast<int>(std::min<size_t>(4, num_rays - first));
+            const float* o = origins + first * originStride;
+            const float* d = rays + first * 3;
+
+            // regular scan patterns produce neighbouring rays with nearly the same direction
+            bool coherent = n > 1;
+            for (int i = 1; i < n && coherent; i++)
+            {
+                const float* oi = o + i * originStride;
+                const float* di = d + i * 3;
+                float dot = d[0] * di[0] + d[1] * di[1] + d[2] * di[2];
+                float len = std::sqrt(
+                    (d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) * (di[0] * di[0] + di[1] * di[1] + di[2] * di[2])
+                );
+                coherent = dot >= minCos * len && oi[0] == o[0] && oi[1] == o[1] && oi[2] == o[2];
+            }
+
+            float dist[4];
+            uint32_t triangle[4] = {0, 0, 0, 0};
+            float hit[12] = {0};
+            for (int i = 0; i < n; i++)
+            {
+                dist[i] = maxDist ? maxDist[first + i] : std::numeric_limits<float>::max();
+            }
+
+            int hitMask = 0;
+            if (coherent)
+            {
+                hitMask = traversePacket(o, originStride, d, n, anyHit, stack.data(), dist, triangle, hit);
+            }
+            else
+            {
+                for (int i = 0; i < n; i++)
+                {
+                    if (traverseRay(o + i * originStride, d + i * 3, anyHit, stack.data(), dist[i], triangle[i], hit + i * 3))
+                    {
+                        hitMask |= 1 << i;
+                    }
+                }
+            }
+
+            for (int i = 0; i < n; i++)
+            {
+                store(first + i, (hitMask & (1 << i)) != 0, dist[i], triangle[i], hit + i * 3);
+            }
         }
     }
 }
 
-
 template <typename PointT, typename NormalT>
-void BVHRaycaster<PointT, NormalT>::cast_rays_multi_multi(
-        const float* ray_origin,
-        const float* rays,
-        size_t num_rays,
-        const unsigned int* clBVHindicesOrTriLists,
-        const float* clBVHlimits,
-        const float* clTriangleIntersectionData,
-        const unsigned int* clTriIdxList,
-        float* result,
-        uint8_t* result_hits
-    )
+void BVHRaycaster<PointT, NormalT>::cast_rays(
+    const float* origins,
+    size_t originStride,
+    const float* rays,
+    size_t num_rays,
+    float* result,
+    uint8_t* result_hits) const
 {
-     // get direction and origin of the ray for the current pose
-    #pragma omp parallel for
-    for(size_t i=0; i< num_rays; i++)
+    traceRays(origins, originStride, rays, num_rays, nullptr, false, 256,
+        [result, result_hits](size_t i, bool hit, float, uint32_t, const float* pos)
     {
-        NormalT ray_d(rays[i*3], rays[i*3+1], rays[i*3+2]);
-        PointT ray_o(ray_origin[i*3], ray_origin[i*3+1], ray_origin[i*3+2]);
-
-        // initialize result memory with zeros
-        result[i*3] = 0;
-        result[i*3+1] = 0;
-        result[i*3+2] = 0;
-        result_hits[i] = 0;
-
-        // precompute ray values to speed up intersection calculation
-        Ray ray;
-        ray.dir = ray_d;
-        ray.invDir = NormalT(1.0 / ray_d.x, 1.0 / ray_d.y, 1.0 / ray_d.z);
-        ray.rayDirSign.x = ray.invDir.x < 0;
-        ray.rayDirSign.y = ray.invDir.y < 0;
-        ray.rayDirSign.z = ray.invDir.z < 0;
-
-        // intersect all triangles stored in the BVH
-        TriangleIntersectionResult resultBVH = intersectTrianglesBVH(
-            clBVHindicesOrTriLists,
-            ray_o,
-            ray,
-            clBVHlimits,
-            clTriangleIntersectionData,
-            clTriIdxList
-        );
-
-        // if a triangle was hit, store the calculated hit point in the result at the current id
-        if (resultBVH.hit)
-        {
-            result[i*3] = resultBVH.pointHit.x;
-            result[i*3+1] = resultBVH.pointHit.y;
-            result[i*3+2] = resultBVH.pointHit.z;
-            result_hits[i] = 1;
-        }
-    }
-
+        // store the calculated hit point in the result at the current id, zeros otherwise
+        result[i * 3] = hit ? pos[0] : 0;
+        result[i * 3 + 1] = hit ? pos[1] : 0;
+        result[i * 3 + 2] = hit ? pos[2] : 0;
+        result_hits[i] = hit;
+    });
 }
 
-} // namespace lvr2
\ No newline at end of file
+} // namespace lvr2
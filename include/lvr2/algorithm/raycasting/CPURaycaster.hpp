@@ -0,0 +1,184 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * CPURaycaster.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#pragma once
+#ifndef LVR2_ALGORITHM_RAYCASTING_CPURAYCASTER
+#define LVR2_ALGORITHM_RAYCASTING_CPURAYCASTER
+
+#include <vector>
+
+#include "lvr2/algorithm/raycasting/BVHRaycaster.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @struct RayHits
+ * @brief Results of a batch of rays in structure of arrays layout
+ */
+struct RayHits
+{
+    /// Coordinates of the hit points, zero for rays without a hit
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    /// Distance of the hit along the ray (in units of the direction length)
+    std::vector<float> distance;
+
+    /// Index of the hit face in the mesh buffer
+    std::vector<uint32_t> faceId;
+
+    /// 1, if the ray hit a face, 0 otherwise
+    std::vector<uint8_t> hit;
+
+    void resize(size_t n)
+    {
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+        distance.resize(n);
+        faceId.resize(n);
+        hit.resize(n);
+    }
+
+    size_t size() const
+    {
+        return hit.size();
+    }
+};
+
+/**
+ * @brief Multithreaded CPU raycaster for large ray batches. The rays are split into tiles of consecutive
+ *        rays, that are distributed dynamically to the threads. Each thread reuses one traversal stack
+ *        for all of its tiles. Besides the RaycasterBase interface it returns hits in structure of arrays
+ *        buffers including the hit faces and answers any hit queries for visibility checks.
+ */
+template<typename PointT, typename NormalT>
+class CPURaycaster : public BVHRaycaster<PointT, NormalT>
+{
+public:
+    /**
+     * @brief Constructor: Builds the BVH of the mesh
+     *
+     * @param mesh      The mesh to cast rays into
+     * @param tileSize  Number of consecutive rays, that are handed to a thread at once
+     */
+    CPURaycaster(const MeshBufferPtr mesh, size_t tileSize = 1024);
+
+    void castRays(
+        const PointT& origin,
+        const std::vector<NormalT >& directions,
+        std::vector<PointT >& intersections,
+        std::vector<uint8_t>& hits
+    ) override;
+
+    void castRays(
+        const std::vector<PointT >& origins,
+        const std::vector<NormalT >& directions,
+        std::vector<PointT >& intersections,
+        std::vector<uint8_t>& hits
+    ) override;
+
+    /**
+     * @brief Casts multiple rays from one origin and stores the closest hits
+     */
+    void castRays(
+        const PointT& origin,
+        const std::vector<NormalT >& directions,
+        RayHits& hits
+    );
+
+    /**
+     * @brief Casts multiple rays from multiple origins and stores the closest hits
+     */
+    void castRays(
+        const std::vector<PointT >& origins,
+        const std::vector<NormalT >& directions,
+        RayHits& hits
+    );
+
+    /**
+     * @brief Checks whether any face is hit closer than maxDistance. Stops at the first hit.
+     */
+    bool occluded(const PointT& origin, const NormalT& direction, float maxDistance);
+
+    /**
+     * @brief Checks for each ray whether any face is hit closer than its maximum distance
+     *
+     * @param origins       Origins of the rays
+     * @param directions    Directions of the rays
+     * @param maxDistances  Maximum distance for each ray
+     * @param occluded      1 for each ray, that hit a face closer than its maximum distance, 0 otherwise
+     */
+    void occluded(
+        const std::vector<PointT >& origins,
+        const std::vector<NormalT >& directions,
+        const std::vector<float>& maxDistances,
+        std::vector<uint8_t>& occluded
+    );
+
+    /**
+     * @brief Checks for each target whether it can be seen from the origin. Faces closer than
+     *        0.1 % of the distance in front of the target do not occlude it.
+     */
+    void visible(
+        const PointT& origin,
+        const std::vector<PointT >& targets,
+        std::vector<uint8_t>& visible
+    );
+
+    /**
+     * @brief Sets the number of consecutive rays, that are handed to a thread at once
+     */
+    void setTileSize(size_t tileSize) { m_tileSize = tileSize; }
+
+    size_t getTileSize() const { return m_tileSize; }
+
+private:
+    using StackEntry = typename BVHRaycaster<PointT, NormalT>::StackEntry;
+
+    /**
+     * @brief Casts the rays and stores the closest hits in the given buffer
+     */
+    void castRaysSoA(const float* origins, size_t originStride, const float* rays, size_t num_rays, RayHits& hits);
+
+    size_t m_tileSize;
+};
+
+} // namespace lvr2
+
+#include "lvr2/algorithm/raycasting/CPURaycaster.tcc"
+
+#endif // LVR2_ALGORITHM_RAYCASTING_CPURAYCASTER
@@ -0,0 +1,216 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * CPURaycaster.tcc
+ *
+ *  @date 19.10.2026
+ */
+
+#include <cmath>
+#include <limits>
+
+namespace lvr2
+{
+
+template <typename PointT, typename NormalT>
+CPURaycaster<PointT, NormalT>::CPURaycaster(const MeshBufferPtr mesh, size_t tileSize)
+:BVHRaycaster<PointT, NormalT>(mesh)
+,m_tileSize(tileSize)
+{
+
+}
+
+template <typename PointT, typename NormalT>
+void CPURaycaster<PointT, NormalT>::castRays(
+    const PointT& origin,
+    const std::vector<NormalT >& directions,
+    std::vector<PointT >& intersections,
+    std::vector<uint8_t>& hits
+)
+{
+    intersections.resize(directions.size());
+    hits.resize(directions.size());
+
+    this->traceRays(
+        reinterpret_cast<const float*>(&origin.x), 0,
+        reinterpret_cast<const float*>(directions.data()), directions.size(),
+        nullptr, false, m_tileSize,
+        [&](size_t i, bool hit, float, uint32_t, const float* pos)
+    {
+        intersections[i] = hit ? PointT(pos[0], pos[1], pos[2]) : PointT(0, 0, 0);
+        hits[i] = hit;
+    });
+}
+
+template <typename PointT, typename NormalT>
+void CPURaycaster<PointT, NormalT>::castRays(
+    const std::vector<PointT >& origins,
+    const std::vector<NormalT >& directions,
+    std::vector<PointT >& intersections,
+    std::vector<uint8_t>& hits
+)
+{
+    intersections.resize(directions.size());
+    hits.resize(directions.size());
+
+    this->traceRays(
+        reinterpret_cast<const float*>(origins.data()), 3,
+        reinterpret_cast<const float*>(directions.data()), directions.size(),
+        nullptr, false, m_tileSize,
+        [&](size_t i, bool hit, float, uint32_t, const float* pos)
+    {
+        intersections[i] = hit ? PointT(pos[0], pos[1], pos[2]) : PointT(0, 0, 0);
+        hits[i] = hit;
+    });
+}
+
+template <typename PointT, typename NormalT>
+void CPURaycaster<PointT, NormalT>::castRays(
+    const PointT& origin,
+    const std::vector<NormalT >& directions,
+    RayHits& hits
+)
+{
+    castRaysSoA(
+        reinterpret_cast<const float*>(&origin.x), 0,
+        reinterpret_cast<const float*>(directions.data()), directions.size(),
+        hits
+    );
+}
+
+template <typename PointT, typename NormalT>
+void CPURaycaster<PointT, NormalT>::castRays(
+    const std::vector<PointT >& origins,
+    const std::vector<NormalT >& directions,
+    RayHits& hits
+)
+{
+    castRaysSoA(
+        reinterpret_cast<const float*>(origins.data()), 3,
+        reinterpret_cast<const float*>(directions.data()), directions.size(),
+        hits
+    );
+}
+
+template <typename PointT, typename NormalT>
+void CPURaycaster<PointT, NormalT>::castRaysSoA(
+    const float* origins,
+    size_t originStride,
+    const float* rays,
+    size_t num_rays,
+    RayHits& hits)
+{
+    hits.resize(num_rays);
+    const std::vector<uint32_t>& faceIndices = this->m_bvh.getFaceIndices();
+
+    this->traceRays(origins, originStride, rays, num_rays, nullptr, false, m_tileSize,
+        [&](size_t i, bool hit, float dist, uint32_t triangle, const float* pos)
+    {
+        hits.x[i] = hit ? pos[0] : 0;
+        hits.y[i] = hit ? pos[1] : 0;
+        hits.z[i] = hit ? pos[2] : 0;
+        hits.distance[i] = hit ? dist : std::numeric_limits<float>::infinity();
+        hits.faceId[i] = hit ? faceIndices[triangle] : std::numeric_limits<uint32_t>::max();
+        hits.hit[i] = hit;
+    });
+}
+
+template <typename PointT, typename NormalT>
+bool CPURaycaster<PointT, NormalT>::occluded(
+    const PointT& origin,
+    const NormalT& direction,
+    float maxDistance)
+{
+    // only allocate, if the tree is too deep for the default stack
+    StackEntry localStack[BVH_STACK_SIZE];
+    std::vector<StackEntry> heapStack;
+    StackEntry* stack = localStack;
+    if (this->m_stackSize > BVH_STACK_SIZE)
+    {
+        heapStack.resize(this->m_stackSize);
+        stack = heapStack.data();
+    }
+
+    float hit[3];
+    uint32_t triangle;
+    return this->traverseRay(
+        reinterpret_cast<const float*>(&origin.x),
+        reinterpret_cast<const float*>(&direction.x),
+        true, stack, maxDistance, triangle, hit
+    );
+}
+
+template <typename PointT, typename NormalT>
+void CPURaycaster<PointT, NormalT>::occluded(
+    const std::vector<PointT >& origins,
+    const std::vector<NormalT >& directions,
+    const std::vector<float>& maxDistances,
+    std::vector<uint8_t>& occluded)
+{
+    occluded.resize(directions.size());
+
+    this->traceRays(
+        reinterpret_cast<const float*>(origins.data()), 3,
+        reinterpret_cast<const float*>(directions.data()), directions.size(),
+        maxDistances.data(), true, m_tileSize,
+        [&](size_t i, bool hit, float, uint32_t, const float*)
+    {
+        occluded[i] = hit;
+    });
+}
+
+template <typename PointT, typename NormalT>
+void CPURaycaster<PointT, NormalT>::visible(
+    const PointT& origin,
+    const std::vector<PointT >& targets,
+    std::vector<uint8_t>& visible)
+{
+    // unnormalized directions: the targets are at distance 1 along their rays
+    std::vector<float> directions(targets.size() * 3);
+    std::vector<float> maxDistances(targets.size(), 0.999f);
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        directions[i * 3] = targets[i].x - origin.x;
+        directions[i * 3 + 1] = targets[i].y - origin.y;
+        directions[i * 3 + 2] = targets[i].z - origin.z;
+    }
+
+    visible.resize(targets.size());
+
+    this->traceRays(
+        reinterpret_cast<const float*>(&origin.x), 0,
+        directions.data(), targets.size(),
+        maxDistances.data(), true, m_tileSize,
+        [&](size_t i, bool hit, float, uint32_t, const float*)
+    {
+        visible[i] = !hit;
+    });
+}
+
+} // namespace lvr2
@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * ScanPattern.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#pragma once
+#ifndef LVR2_ALGORITHM_RAYCASTING_SCANPATTERN
+#define LVR2_ALGORITHM_RAYCASTING_SCANPATTERN
+
+#include <cstddef>
+
+namespace lvr2
+{
+
+/**
+ * @brief Ray directions of a simulated laser scanner in its local frame (x forward, z up).
+ *
+ * The rays are ordered column by column like the measurements of a rotating terrestrial scanner:
+ * all vertical angles of one horizontal angle follow each other. Neighbouring rays are therefore
+ * nearly parallel, which the raycasters exploit by tracing them as packets. The directions are
+ * computed on demand, so even very dense patterns need no memory.
+ */
+class ScanPattern
+{
+public:
+    /**
+     * @brief Spherical grid of a terrestrial scanner, e.g. a Riegl VZ series device
+     *
+     * @param hMin  First horizontal angle in degrees
+     * @param hMax  End of the horizontal range in degrees (exclusive)
+     * @param hRes  Horizontal resolution in degrees
+     * @param vMin  Lowest vertical angle in degrees, 0 is the horizon
+     * @param vMax  Highest vertical angle in degrees (inclusive)
+     * @param vRes  Vertical resolution in degrees
+     */
+    static ScanPattern spherical(float hMin, float hMax, float hRes, float vMin, float vMax, float vRes);
+
+    /**
+     * @brief Profile of a line scanner. The single scan line lies in the x-z plane of the scanner.
+     *
+     * @param fovMin    First angle of the line in degrees, 0 is the x axis
+     * @param fovMax    Last angle of the line in degrees (inclusive)
+     * @param res       Angular resolution in degrees
+     */
+    static ScanPattern line(float fovMin, float fovMax, float res);
+
+    /// Number of rays of one scan
+    size_t size() const { return m_numColumns * m_numRows; }
+
+    /// Number of horizontal angles
+    size_t numColumns() const { return m_numColumns; }
+
+    /// Number of vertical angles
+    size_t numRows() const { return m_numRows; }
+
+    /**
+     * @brief Computes the normalized direction of the i-th ray
+     */
+    void direction(size_t i, float* dir) const;
+
+    /**
+     * @brief Computes the normalized directions of the rays [first, first + count) in parallel
+     *
+     * @param dirs Output array with 3 * count floats
+     */
+    void directions(size_t first, size_t count, float* dirs) const;
+
+private:
+    ScanPattern(float hMin, float hStep, size_t numColumns, float vMin, float vStep, size_t numRows);
+
+    // angles in radians
+    float m_hMin;
+    float m_hStep;
+    size_t m_numColumns;
+
+    float m_vMin;
+    float m_vStep;
+    size_t m_numRows;
+};
+
+} // namespace lvr2
+
+#endif // LVR2_ALGORITHM_RAYCASTING_SCANPATTERN
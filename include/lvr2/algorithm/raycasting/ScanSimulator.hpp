@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * ScanSimulator.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#pragma once
+#ifndef LVR2_ALGORITHM_RAYCASTING_SCANSIMULATOR
+#define LVR2_ALGORITHM_RAYCASTING_SCANSIMULATOR
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "lvr2/io/MeshBuffer.hpp"
+#include "lvr2/io/PointBuffer.hpp"
+#include "lvr2/types/MatrixTypes.hpp"
+#include "lvr2/algorithm/raycasting/CPURaycaster.hpp"
+#include "lvr2/algorithm/raycasting/ScanPattern.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief Simulates laser scans of a mesh from a batch of scanner poses.
+ *
+ * The rays of each scan are cast in chunks of a fixed size. The hits of a chunk are converted into
+ * a PointBuffer in the local frame of the scanner with normals (pointing towards the scanner) and
+ * the indices of the hit faces in the "face_ids" channel. Each chunk is handed to a callback, e.g.
+ * ChunkedScanWriter::write, in a background thread while the next chunk is cast. At most one chunk
+ * waits for the callback, so memory usage is bounded by the chunk size and not by the scan size.
+ */
+template<typename PointT, typename NormalT>
+class ScanSimulator
+{
+public:
+
+    /// Receives the hits of one chunk of the scan with the given number
+    using ChunkCallback = std::function<void(size_t scanNr, const Transformf& pose, PointBufferPtr chunk)>;
+
+    /**
+     * @brief Builds the BVH of the mesh and computes its face normals
+     *
+     * @param mesh      The mesh to scan
+     * @param pattern   The scan pattern used for all poses
+     */
+    ScanSimulator(const MeshBufferPtr mesh, const ScanPattern& pattern);
+
+    /**
+     * @brief Simulates one scan for each pose
+     *
+     * @param poses     Scanner poses (scanner to world)
+     * @param callback  Receives the hits chunk by chunk
+     *
+     * @return Total number of hits
+     */
+    size_t simulate(const std::vector<Transformf>& poses, ChunkCallback callback);
+
+    /// Sets the number of rays that are cast at once, at least 1
+    void setChunkSize(size_t numRays) { m_chunkSize = std::max<size_t>(numRays, 1); }
+
+    /// Hits farther away than this are discarded
+    void setMaxRange(float range) { m_maxRange = range; }
+
+    /// Number of rays cast by the last call of simulate()
+    size_t numRays() const { return m_numRays; }
+
+    /// Rays per second of the raycasting in the last call of simulate()
+    double raysPerSecond() const { return m_rayTime > 0 ? m_numRays / m_rayTime : 0.0; }
+
+private:
+
+    /**
+     * @brief Casts the rays [first, first + count) of the pattern from the given pose
+     */
+    PointBufferPtr castChunk(const Transformf& pose, size_t first, size_t count);
+
+    CPURaycaster<PointT, NormalT> m_raycaster;
+    ScanPattern m_pattern;
+
+    // normalized face normals, 3 floats per face
+    std::vector<float> m_faceNormals;
+
+    size_t m_chunkSize;
+    float m_maxRange;
+
+    // buffers reused by all chunks
+    std::vector<float> m_localDirections;
+    std::vector<NormalT> m_directions;
+    RayHits m_hits;
+
+    // statistics
+    size_t m_numRays;
+    double m_rayTime;
+};
+
+} // namespace lvr2
+
+#include "lvr2/algorithm/raycasting/ScanSimulator.tcc"
+
+#endif // LVR2_ALGORITHM_RAYCASTING_SCANSIMULATOR
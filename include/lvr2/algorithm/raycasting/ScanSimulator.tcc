@@ -0,0 +1,184 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * ScanSimulator.tcc
+ *
+ *  @date 19.10.2026
+ */
+
+#include <chrono>
+#include <future>
+#include <limits>
+
+#include "lvr2/io/Progress.hpp"
+#include "lvr2/io/Timestamp.hpp"
+
+namespace lvr2
+{
+
+template<typename PointT, typename NormalT>
+ScanSimulator<PointT, NormalT>::ScanSimulator(const MeshBufferPtr mesh, const ScanPattern& pattern)
+    : m_raycaster(mesh)
+    , m_pattern(pattern)
+    , m_chunkSize(1 << 20)
+    , m_maxRange(std::numeric_limits<float>::max())
+    , m_numRays(0)
+    , m_rayTime(0.0)
+{
+    floatArr vertices = mesh->getVertices();
+    indexArray faces = mesh->getFaceIndices();
+    size_t numFaces = mesh->numFaces();
+
+    m_faceNormals.resize(numFaces * 3);
+
+    #pragma omp parallel for
+    for (long i = 0; i < static_cast<long>(numFaces); i++)
+    {
+        Eigen::Map<const Vector3f> a(vertices.get() + faces[i * 3] * 3);
+        Eigen::Map<const Vector3f> b(vertices.get() + faces[i * 3 + 1] * 3);
+        Eigen::Map<const Vector3f> c(vertices.get() + faces[i * 3 + 2] * 3);
+        Eigen::Map<Vector3f>(m_faceNormals.data() + i * 3) = (b - a).cross(c - a).normalized();
+    }
+}
+
+template<typename PointT, typename NormalT>
+size_t ScanSimulator<PointT, NormalT>::simulate(const std::vector<Transformf>& poses, ChunkCallback callback)
+{
+    m_numRays = 0;
+    m_rayTime = 0.0;
+
+    size_t raysPerScan = m_pattern.size();
+    size_t chunksPerScan = (raysPerScan + m_chunkSize - 1) / m_chunkSize;
+    size_t numHits = 0;
+
+    std::string comment = timestamp.getElapsedTime() + "Simulating scans ";
+    ProgressBar progress(poses.size() * chunksPerScan, comment);
+
+    // the callback of the previous chunk runs while the next chunk is cast
+    std::future<void> pending;
+
+    for (size_t scanNr = 0; scanNr < poses.size(); scanNr++)
+    {
+        for (size_t first = 0; first < raysPerScan; first += m_chunkSize)
+        {
+            PointBufferPtr chunk = castChunk(poses[scanNr], first, std::min(m_chunkSize, raysPerScan - first));
+            numHits += chunk->numPoints();
+
+            if (pending.valid())
+            {
+                pending.get();
+            }
+            const Transformf& pose = poses[scanNr];
+            pending = std::async(std::launch::async, [&callback, scanNr, &pose, chunk]()
+            {
+                callback(scanNr, pose, chunk);
+            });
+
+            ++progress;
+        }
+    }
+
+    if (pending.valid())
+    {
+        pending.get();
+    }
+    std::cout << std::endl;
+
+    std::cout << timestamp << "Cast " << m_numRays << " rays (" << numHits << " hits) at "
+              << raysPerSecond() / 1e6 << " MRays/s" << std::endl;
+
+    return numHits;
+}
+
+template<typename PointT, typename NormalT>
+PointBufferPtr ScanSimulator<PointT, NormalT>::castChunk(const Transformf& pose, size_t first, size_t count)
+{
+    const Rotationf R = pose.block<3, 3>(0, 0);
+    const Vector3f t = pose.block<3, 1>(0, 3);
+
+    // transform the directions of the pattern into the world frame
+    m_localDirections.resize(count * 3);
+    m_directions.resize(count);
+    m_pattern.directions(first, count, m_localDirections.data());
+
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < static_cast<long>(count); i++)
+    {
+        Vector3f d = R * Eigen::Map<const Vector3f>(m_localDirections.data() + i * 3);
+        m_directions[i] = NormalT(d.x(), d.y(), d.z());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    m_raycaster.castRays(PointT(t.x(), t.y(), t.z()), m_directions, m_hits);
+    auto end = std::chrono::steady_clock::now();
+
+    m_numRays += count;
+    m_rayTime += std::chrono::duration<double>(end - start).count();
+
+    // compact the hits and transform them into the scanner frame
+    size_t numHits = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        numHits += m_hits.hit[i] && m_hits.distance[i] <= m_maxRange;
+    }
+
+    floatArr points(new float[numHits * 3]);
+    floatArr normals(new float[numHits * 3]);
+    indexArray faceIds(new unsigned int[numHits]);
+
+    const Rotationf Rt = R.transpose();
+    size_t j = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!m_hits.hit[i] || m_hits.distance[i] > m_maxRange)
+        {
+            continue;
+        }
+
+        Vector3f p = Rt * (Vector3f(m_hits.x[i], m_hits.y[i], m_hits.z[i]) - t);
+        Vector3f n = Rt * Eigen::Map<const Vector3f>(m_faceNormals.data() + m_hits.faceId[i] * 3);
+
+        // normals point towards the scanner
+        if (n.dot(Eigen::Map<const Vector3f>(m_localDirections.data() + i * 3)) > 0)
+        {
+            n = -n;
+        }
+
+        Eigen::Map<Vector3f>(points.get() + j * 3) = p;
+        Eigen::Map<Vector3f>(normals.get() + j * 3) = n;
+        faceIds[j] = m_hits.faceId[i];
+        j++;
+    }
+
+    PointBufferPtr chunk(new PointBuffer(points, normals, numHits));
+    chunk->addIndexChannel(faceIds, "face_ids", numHits, 1);
+    return chunk;
+}
+
+} // namespace lvr2
@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * SimdFloat4.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#pragma once
+#ifndef LVR2_ALGORITHM_RAYCASTING_SIMDFLOAT4
+#define LVR2_ALGORITHM_RAYCASTING_SIMDFLOAT4
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace lvr2
+{
+
+/**
+ * @brief Four floats that are processed together. Uses one SSE register if available and
+ *        falls back to plain scalar code otherwise.
+ *
+ * Comparisons return a bit mask with bit i set, if the comparison is true for lane i.
+ */
+struct Float4
+{
+#if defined(__SSE2__)
+    __m128 v;
+
+    Float4() {}
+    Float4(__m128 x) : v(x) {}
+    explicit Float4(float f) : v(_mm_set1_ps(f)) {}
+    Float4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+
+    static Float4 load(const float* p) { return Float4(_mm_loadu_ps(p)); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+
+    friend Float4 operator+(const Float4& a, const Float4& b) { return _mm_add_ps(a.v, b.v); }
+    friend Float4 operator-(const Float4& a, const Float4& b) { return _mm_sub_ps(a.v, b.v); }
+    friend Float4 operator*(const Float4& a, const Float4& b) { return _mm_mul_ps(a.v, b.v); }
+    friend Float4 operator/(const Float4& a, const Float4& b) { return _mm_div_ps(a.v, b.v); }
+
+    friend Float4 min(const Float4& a, const Float4& b) { return _mm_min_ps(a.v, b.v); }
+    friend Float4 max(const Float4& a, const Float4& b) { return _mm_max_ps(a.v, b.v); }
+
+    friend int lt(const Float4& a, const Float4& b) { return _mm_movemask_ps(_mm_cmplt_ps(a.v, b.v)); }
+    friend int le(const Float4& a, const Float4& b) { return _mm_movemask_ps(_mm_cmple_ps(a.v, b.v)); }
+    friend int gt(const Float4& a, const Float4& b) { return _mm_movemask_ps(_mm_cmpgt_ps(a.v, b.v)); }
+    friend int ge(const Float4& a, const Float4& b) { return _mm_movemask_ps(_mm_cmpge_ps(a.v, b.v)); }
+    friend int neq(const Float4& a, const Float4& b) { return _mm_movemask_ps(_mm_cmpneq_ps(a.v, b.v)); }
+
+    /// Lanes with their bit set in mask are taken from a, the others from b
+    friend Float4 select(int mask, const Float4& a, const Float4& b)
+    {
+        const __m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+        __m128i m = _mm_and_si128(_mm_set1_epi32(mask), bits);
+        __m128 sel = _mm_castsi128_ps(_mm_cmpeq_epi32(m, bits));
+        return _mm_or_ps(_mm_and_ps(sel, a.v), _mm_andnot_ps(sel, b.v));
+    }
+#else
+    float v[4];
+
+    Float4() {}
+    explicit Float4(float f) : v{f, f, f, f} {}
+    Float4(float a, float b, float c, float d) : v{a, b, c, d} {}
+
+    static Float4 load(const float* p) { return Float4(p[0], p[1], p[2], p[3]); }
+    void store(float* p) const { for (int i = 0; i < 4; i++) p[i] = v[i]; }
+
+    template<typename Op>
+    static Float4 apply(const Float4& a, const Float4& b, Op op)
+    {
+        return Float4(op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]), op(a.v[3], b.v[3]));
+    }
+
+    template<typename Op>
+    static int compare(const Float4& a, const Float4& b, Op op)
+    {
+        int mask = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            mask |= op(a.v[i], b.v[i]) ? (1 << i) : 0;
+        }
+        return mask;
+    }
+
+    friend Float4 operator+(const Float4& a, const Float4& b) { return apply(a, b, [](float x, float y) { return x + y; }); }
+    friend Float4 operator-(const Float4& a, const Float4& b) { return apply(a, b, [](float x, float y) { return x - y; }); }
+    friend Float4 operator*(const Float4& a, const Float4& b) { return apply(a, b, [](float x, float y) { return x * y; }); }
+    friend Float4 operator/(const Float4& a, const Float4& b) { return apply(a, b, [](float x, float y) { return x / y; }); }
+
+    // same operand order as the SSE instructions: the second operand is returned if either is NaN
+    friend Float4 min(const Float4& a, const Float4& b) { return apply(a, b, [](float x, float y) { return x < y ? x : y; }); }
+    friend Float4 max(const Float4& a, const Float4& b) { return apply(a, b, [](float x, float y) { return x > y ? x : y; }); }
+
+    friend int lt(const Float4& a, const Float4& b) { return compare(a, b, [](float x, float y) { return x < y; }); }
+    friend int le(const Float4& a, const Float4& b) { return compare(a, b, [](float x, float y) { return x <= y; }); }
+    friend int gt(const Float4& a, const Float4& b) { return compare(a, b, [](float x, float y) { return x > y; }); }
+    friend int ge(const Float4& a, const Float4& b) { return compare(a, b, [](float x, float y) { return x >= y; }); }
+    friend int neq(const Float4& a, const Float4& b) { return compare(a, b, [](float x, float y) { return x != y; }); }
+
+    /// Lanes with their bit set in mask are taken from a, the others from b
+    friend Float4 select(int mask, const Float4& a, const Float4& b)
+    {
+        Float4 r;
+        for (int i = 0; i < 4; i++)
+        {
+            r.v[i] = (mask & (1 << i)) ? a.v[i] : b.v[i];
+        }
+        return r;
+    }
+#endif
+};
+
+} // namespace lvr2
+
+#endif // LVR2_ALGORITHM_RAYCASTING_SIMDFLOAT4
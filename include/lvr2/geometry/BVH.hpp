@@ -36,6 +36,9 @@
 
 #include <vector>
 #include <memory>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
 
 #include "lvr2/geometry/BoundingBox.hpp"
 #include "lvr2/geometry/Normal.hpp"
@@ -52,8 +55,8 @@ namespace lvr2
  *
  * This class generates a BVHTree from the given triangle mesh represented by vertices and faces. AABB are used as
  * bounding volumes. The Tree Contains inner nodes and leaf nodes. The leaf nodes are grouped into inner nodes using
- * the surface area heuristic. The tree is represented in two ways: the normal tree structure and the cache friendly
- * index representation.
+ * a binned surface area heuristic. The tree is represented in three ways: the normal tree structure, the cache friendly
+ * index representation of the binary tree and a 4-wide version of it for SIMD traversal on the CPU.
  *
  * @tparam BaseVecT
  */
@@ -121,6 +124,36 @@ public:
      */
     const vector<float>& getTrianglesIntersectionData() const;
 
+    /**
+     * @return Index of the mesh face for each triangle. Malformed faces are skipped during construction, so the
+     *         triangle indices used in the tree may differ from the face indices.
+     */
+    const vector<uint32_t>& getFaceIndices() const;
+
+    /**
+     * @brief Node of the 4-wide representation of the tree
+     *
+     * The bounds of the four children are stored as structure of arrays, so that one SIMD register holds
+     * the same limit of all four children. Unused slots have all limits set to +infinity, so every slab test
+     * against them fails.
+     */
+    struct WideNode
+    {
+        /// minX, maxX, minY, maxY, minZ, maxZ of the four children
+        float bounds[6][4];
+
+        /// Index in getWideNodes() for inner children, start index in getTriIndexList() for leaves
+        uint32_t children[4];
+
+        /// 1st bit set for leaves (and unused slots), the rest of the bits is the number of triangles
+        uint32_t counts[4];
+    };
+
+    /**
+     * @return The tree collapsed into nodes with up to four children each. The first node is the root.
+     */
+    const vector<WideNode>& getWideNodes() const;
+
 private:
 
     // Internal triangle representation
@@ -145,14 +178,80 @@ private:
         BoundingBox<BaseVecT> bb;
     };
 
-    // Internal AABB representation
-    struct AABB {
-        BoundingBox<BaseVecT> bb;
+    // Plain float AABB used during construction, cheaper to merge than BoundingBox
+    struct Bounds {
+        float min[3];
+        float max[3];
+
+        Bounds()
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                min[i] = std::numeric_limits<float>::max();
+                max[i] = std::numeric_limits<float>::lowest();
+            }
+        }
+
+        void expand(const Bounds& o)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                min[i] = std::min(min[i], o.min[i]);
+                max[i] = std::max(max[i], o.max[i]);
+            }
+        }
+
+        void expand(const float* p)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                min[i] = std::min(min[i], p[i]);
+                max[i] = std::max(max[i], p[i]);
+            }
+        }
+
+        float centroid(int axis) const
+        {
+            return 0.5f * (min[axis] + max[axis]);
+        }
+
+        // Half of the surface area, which is all the SAH needs
+        float halfArea() const
+        {
+            if (min[0] > max[0])
+            {
+                return 0.0f;
+            }
+            float dx = max[0] - min[0];
+            float dy = max[1] - min[1];
+            float dz = max[2] - min[2];
+            return dx * dy + dy * dz + dz * dx;
+        }
+    };
 
-        // Triangles corresponding to this AABB
-        vector<size_t> triangles;
+    // SAH bin
+    struct Bin {
+        Bounds bounds;
+        size_t count = 0;
     };
 
+    // Number of SAH bins per axis
+    static constexpr int NumBins = 16;
+
+    // Bin of a centroid along the given axis
+    static int binIndex(const Bounds& centroidBounds, int axis, float centroid)
+    {
+        float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+        int b = static_cast<int>(NumBins * ((centroid - centroidBounds.min[axis]) / extent));
+        return std::min(std::max(b, 0), NumBins - 1);
+    }
+
+    // Nodes with more primitives are always split
+    static constexpr size_t MaxLeafSize = 8;
+
+    // Nodes with more primitives are binned / split in parallel
+    static constexpr size_t ParallelThreshold = 1 << 16;
+
     // Abstract tree node
     struct BVHNode {
         BoundingBox<BaseVecT> bb;
@@ -190,6 +289,11 @@ private:
     vector<float> m_limits;
     vector<uint32_t> m_indexesOrTrilists;
     vector<float> m_trianglesIntersectionData;
+    vector<WideNode> m_wideNodes;
+    vector<uint32_t> m_faceIndices;
+
+    // construction only: bounds of each triangle in m_triangles
+    vector<Bounds> m_primBounds;
 
     /**
      * @brief Builds the tree without it's cache friendly representation. Utilizes the buildTreeRecursive method.
@@ -215,14 +319,45 @@ private:
     );
 
     /**
-     * @brief Recursive method to build the tree.
+     * @brief Builds the tree over all triangles in m_triangles
      *
-     * @param work The current work queue to generate the tree from
-     * @param depth The current depth of the tree
+     * @return Root node of the tree
+     */
+    BVHNodePtr buildTreeFromTriangles();
+
+    /**
+     * @brief Recursive method to build the tree with a binned surface area heuristic.
+     *
+     * @param prims Indices of the triangles of the current node, reordered in place
+     * @param count Number of triangles of the current node
      *
      * @return Root node of the current tree
      */
-    BVHNodePtr buildTreeRecursive(vector<AABB>& work, uint32_t depth = 0);
+    BVHNodePtr buildTreeRecursive(uint32_t* prims, size_t count);
+
+    /**
+     * @brief Decides whether to split the given triangles and creates the leaf or inner node
+     */
+    BVHNodePtr splitNode(uint32_t* prims, size_t count, const Bounds& bounds, const Bounds& centroidBounds);
+
+    /**
+     * @brief Computes the bounds and the centroid bounds of the given triangles
+     */
+    void computeBounds(const uint32_t* prims, size_t count, Bounds& bounds, Bounds& centroidBounds) const;
+
+    /**
+     * @brief Sorts the given triangles into NumBins bins per axis based on their centroids
+     */
+    void binPrimitives(
+        const uint32_t* prims, size_t count,
+        const Bounds& centroidBounds,
+        Bin (&bins)[3][NumBins]
+    ) const;
+
+    /**
+     * @brief Creates a leaf node for the given triangles
+     */
+    BVHNodePtr createLeaf(const uint32_t* prims, size_t count);
 
     /**
      * @brief Creates the cache friendly representation of the tree. Needs the tree itself!
@@ -238,6 +373,18 @@ private:
      */
     void createCFTreeRecursive(BVHNodePtr currentNode, uint32_t& idxBoxes);
 
+    /**
+     * @brief Collapses the cache friendly binary tree into m_wideNodes
+     */
+    void createWideTree();
+
+    /**
+     * @brief Creates the wide node for the binary node with the given index
+     *
+     * @return Index of the created node in m_wideNodes
+     */
+    uint32_t createWideTreeRecursive(uint32_t binaryIdx);
+
     /**
      * @brief Converts the precalculated triangle intersection data to a SIMD friendly structure
      */
@@ -33,6 +33,8 @@
  */
 
 #include <limits>
+#include <algorithm>
+#include <iostream>
 
 using std::make_unique;
 using std::transform;
@@ -90,9 +92,9 @@ typename BVHTree<BaseVecT>::BVHNodePtr BVHTree<BaseVecT>::buildTree(
     const vector<uint32_t>& faces
 )
 {
-    vector<AABB> work;
-    work.reserve(faces.size() / 3);
     m_triangles.reserve(faces.size() / 3);
+    m_primBounds.reserve(faces.size() / 3);
+    m_faceIndices.reserve(faces.size() / 3);
 
     BoundingBox<BaseVecT> outerBb;
 
@@ -169,25 +171,23 @@ typename BVHTree<BaseVecT>::BVHNodePtr BVHTree<BaseVecT>::buildTree(
         triangle.e3 = Normal<typename BaseVecT::CoordType>(triangle.normal.cross(vc3));
         triangle.d3 = triangle.e3.dot(point3);
 
-        // Create AABB and add current triangle (face) to it
-        AABB aabb;
-        aabb.bb = faceBb;
-        aabb.triangles.push_back(m_triangles.size());
+        // Remember the bounds of the current triangle (face) for the tree construction
+        Bounds primBounds;
+        primBounds.min[0] = faceBb.getMin().x;
+        primBounds.min[1] = faceBb.getMin().y;
+        primBounds.min[2] = faceBb.getMin().z;
+        primBounds.max[0] = faceBb.getMax().x;
+        primBounds.max[1] = faceBb.getMax().y;
+        primBounds.max[2] = faceBb.getMax().z;
+        m_primBounds.push_back(primBounds);
         m_triangles.push_back(triangle);
+        m_faceIndices.push_back(static_cast<uint32_t>(i / 3));
 
         outerBb.expand(faceBb);
-        work.push_back(aabb);
     }
 
-    // Create the tree recursively from the list of AABBs
-
-    BVHTree<BaseVecT>::BVHNodePtr out;
-
-    #pragma omp parallel
-    #pragma omp single nowait
-    out = buildTreeRecursive(work);
-    
-    std::cout << "end building." << std::endl;
+    // Create the tree recursively from the triangle bounds
+    BVHTree<BaseVecT>::BVHNodePtr out = buildTreeFromTriangles();
     out->bb = outerBb;
 
     return out;
@@ -200,9 +200,9 @@ typename BVHTree<BaseVecT>::BVHNodePtr BVHTree<BaseVecT>::buildTree(
     const indexArray faces, size_t n_faces
 )
 {
-    vector<AABB> work;
-    work.reserve(n_faces);
     m_triangles.reserve(n_faces);
+    m_primBounds.reserve(n_faces);
+    m_faceIndices.reserve(n_faces);
 
     BoundingBox<BaseVecT> outerBb;
     // Iterate over all faces and create an AABB for all of them
@@ -279,226 +279,285 @@ typename BVHTree<BaseVecT>::BVHNodePtr BVHTree<BaseVecT>::buildTree(
         triangle.e3 = Normal<typename BaseVecT::CoordType>(triangle.normal.cross(vc3));
         triangle.d3 = triangle.e3.dot(point3);
 
-        // Create AABB and add current triangle (face) to it
-        AABB aabb;
-        aabb.bb = faceBb;
-        aabb.triangles.push_back(m_triangles.size());
+        // Remember the bounds of the current triangle (face) for the tree construction
+        Bounds primBounds;
+        primBounds.min[0] = faceBb.getMin().x;
+        primBounds.min[1] = faceBb.getMin().y;
+        primBounds.min[2] = faceBb.getMin().z;
+        primBounds.max[0] = faceBb.getMax().x;
+        primBounds.max[1] = faceBb.getMax().y;
+        primBounds.max[2] = faceBb.getMax().z;
+        m_primBounds.push_back(primBounds);
         m_triangles.push_back(triangle);
+        m_faceIndices.push_back(static_cast<uint32_t>(i / 3));
 
         outerBb.expand(faceBb);
-        work.push_back(aabb);
     }
 
 
-    // Create the tree recursively from the list of AABBs
+    // Create the tree recursively from the triangle bounds
+    BVHTree<BaseVecT>::BVHNodePtr out = buildTreeFromTriangles();
+    out->bb = outerBb;
+
+    return out;
+}
+
+template<typename BaseVecT>
+typename BVHTree<BaseVecT>::BVHNodePtr BVHTree<BaseVecT>::buildTreeFromTriangles()
+{
+    vector<uint32_t> prims(m_triangles.size());
+    for (size_t i = 0; i < prims.size(); i++)
+    {
+        prims[i] = static_cast<uint32_t>(i);
+    }
+
     BVHTree<BaseVecT>::BVHNodePtr out;
+
     #pragma omp parallel
     #pragma omp single nowait
-    out = buildTreeRecursive(work);
+    out = buildTreeRecursive(prims.data(), prims.size());
 
-    out->bb = outerBb;
+    // the triangle bounds are only needed during construction
+    vector<Bounds>().swap(m_primBounds);
 
     return out;
 }
 
 template<typename BaseVecT>
-typename BVHTree<BaseVecT>::BVHNodePtr BVHTree<BaseVecT>::buildTreeRecursive(vector<AABB>& work, uint32_t depth)
+void BVHTree<BaseVecT>::computeBounds(
+    const uint32_t* prims, size_t count,
+    Bounds& bounds, Bounds& centroidBounds) const
 {
-    // terminate recursion, if work size is small enough
-    if (work.size() < 4)
+    if (count < ParallelThreshold)
     {
-        // Create a leaf node and add all remaining triangles into it
-        auto leaf = make_unique<BVHLeaf>();
-        for (auto aabb: work)
+        for (size_t i = 0; i < count; i++)
         {
-            leaf->triangles.reserve(aabb.triangles.size());
-            for (auto triangle: aabb.triangles)
-            {
-                leaf->triangles.push_back(triangle);
-            }
+            const Bounds& b = m_primBounds[prims[i]];
+            float centroid[3] = {b.centroid(0), b.centroid(1), b.centroid(2)};
+            bounds.expand(b);
+            centroidBounds.expand(centroid);
         }
-        return move(leaf);
+        return;
     }
 
-    // divide node into smaller nodes
-    BoundingBox<BaseVecT> bb;
-    for (auto aabb: work)
+    // large nodes: reduce chunks of the triangles in parallel tasks
+    const size_t chunkSize = ParallelThreshold / 4;
+    const size_t numChunks = (count + chunkSize - 1) / chunkSize;
+    vector<Bounds> chunkBounds(numChunks);
+    vector<Bounds> chunkCentroidBounds(numChunks);
+
+    for (size_t c = 0; c < numChunks; c++)
     {
-        bb.expand(aabb.bb);
+        #pragma omp task shared(chunkBounds, chunkCentroidBounds)
+        computeBounds(
+            prims + c * chunkSize, std::min(chunkSize, count - c * chunkSize),
+            chunkBounds[c], chunkCentroidBounds[c]
+        );
     }
+    #pragma omp taskwait
 
-    // SAH, surface area heuristic calculation
-    float minCost =
-        work.size() * (bb.getXSize() * bb.getYSize() + bb.getYSize() * bb.getZSize() + bb.getZSize() * bb.getXSize());
-
-    auto bestSplit = numeric_limits<typename BaseVecT::CoordType>::max();
-    int bestAxis = -1;
-
-    // try all 3 axises X = 0, Y = 1, Z = 2
-    for (uint8_t j = 0; j < 3; j++)
+    for (size_t c = 0; c < numChunks; c++)
     {
-        auto axis = j;
-        float start, stop, step;
-
-        if (axis == 0)
-        {
-            start = bb.getMin().x;
-            stop = bb.getMax().x;
-        }
-        else if(axis == 1)
-        {
-            start = bb.getMin().y;
-            stop = bb.getMax().y;
-        }
-        else
-        {
-            start = bb.getMin().z;
-            stop = bb.getMax().z;
-        }
+        bounds.expand(chunkBounds[c]);
+        centroidBounds.expand(chunkCentroidBounds[c]);
+    }
+}
 
-        if (fabs(stop - start) < 1e-4)
+template<typename BaseVecT>
+void BVHTree<BaseVecT>::binPrimitives(
+    const uint32_t* prims, size_t count,
+    const Bounds& centroidBounds,
+    Bin (&bins)[3][NumBins]) const
+{
+    if (count < ParallelThreshold)
+    {
+        // Axes on which all centroids lie in one plane can't be split and
+        // would divide by a zero extent in binIndex()
+        bool splittable[3];
+        for (int axis = 0; axis < 3; axis++)
         {
-            // bb side along this axis too short, we must move to a different axis
-            continue;
+            splittable[axis] = centroidBounds.max[axis] > centroidBounds.min[axis];
         }
 
-        step = (stop - start) / (1024.0f / (depth + 1.0f));
-
-        for (float testSplit = start + step; testSplit < stop - step; testSplit += step)
+        for (size_t i = 0; i < count; i++)
         {
-            // create left and right bb
-            BoundingBox<BaseVecT> lBb;
-            BoundingBox<BaseVecT> rBb;
-
-            int countLeft = 0, countRight = 0;
-
-            for (size_t i = 0; i < work.size(); i++)
+            const Bounds& b = m_primBounds[prims[i]];
+            for (int axis = 0; axis < 3; axis++)
             {
-                auto& v = work[i];
-
-                float value;
-                if (axis == 0)
-                {
-                    value = v.bb.getCentroid().x;
-                }
-                else if (axis == 1)
-                {
-                    value = v.bb.getCentroid().y;
-                }
-                else
-                {
-                    value = v.bb.getCentroid().z;
-                }
-
-                if (value < testSplit)
-                {
-                    lBb.expand(v.bb);
-                    countLeft++;
-                }
-                else
+                if (!splittable[axis])
                 {
-                    rBb.expand(v.bb);
-                    countRight++;
+                    continue;
                 }
+                Bin& bin = bins[axis][binIndex(centroidBounds, axis, b.centroid(axis))];
+                bin.bounds.expand(b);
+                bin.count++;
             }
+        }
+        return;
+    }
 
-            // Skipt to small values
-            if (countLeft <= 1 || countRight <= 1)
-            {
-                continue;
-            }
+    // large nodes: bin chunks of the triangles in parallel tasks and merge the bins afterwards
+    struct BinSet
+    {
+        Bin bins[3][NumBins];
+    };
 
-            // Calc surface for left and right box
-            float surfaceLeft =
-                lBb.getXSize() * lBb.getYSize() + lBb.getYSize() * lBb.getZSize() + lBb.getZSize() * lBb.getXSize();
-            float surfaceRight =
-                lBb.getXSize() * rBb.getYSize() + rBb.getYSize() * rBb.getZSize() + rBb.getZSize() * rBb.getXSize();
+    const size_t chunkSize = ParallelThreshold / 4;
+    const size_t numChunks = (count + chunkSize - 1) / chunkSize;
+    vector<BinSet> chunkBins(numChunks);
 
-            // Check if new best split was found
-            float totalCost = surfaceLeft * countLeft + surfaceRight * countRight;
-            if (totalCost < minCost)
-            {
-                minCost = totalCost;
-                bestSplit = testSplit;
-                bestAxis = axis;
-            }
-        }
+    for (size_t c = 0; c < numChunks; c++)
+    {
+        #pragma omp task shared(chunkBins, centroidBounds)
+        binPrimitives(
+            prims + c * chunkSize, std::min(chunkSize, count - c * chunkSize),
+            centroidBounds, chunkBins[c].bins
+        );
     }
+    #pragma omp taskwait
 
-    // If no good split was found, create a leaf node and copy all remaining triangles into it
-    if (bestAxis == -1)
+    for (size_t c = 0; c < numChunks; c++)
     {
-        auto leaf = make_unique<BVHLeaf>();
-        for (auto aabb: work)
+        for (int axis = 0; axis < 3; axis++)
         {
-            leaf->triangles.reserve(aabb.triangles.size());
-            for (auto triangle: aabb.triangles)
+            for (int b = 0; b < NumBins; b++)
             {
-                leaf->triangles.push_back(triangle);
+                bins[axis][b].bounds.expand(chunkBins[c].bins[axis][b].bounds);
+                bins[axis][b].count += chunkBins[c].bins[axis][b].count;
             }
         }
-        return move(leaf);
     }
+}
 
-    vector<AABB> leftWork;
-    vector<AABB> rightWork;
-    BoundingBox<BaseVecT> lBb;
-    BoundingBox<BaseVecT> rBb;
+template<typename BaseVecT>
+typename BVHTree<BaseVecT>::BVHNodePtr BVHTree<BaseVecT>::createLeaf(const uint32_t* prims, size_t count)
+{
+    auto leaf = make_unique<BVHLeaf>();
+    leaf->triangles.assign(prims, prims + count);
+    return leaf;
+}
+
+template<typename BaseVecT>
+typename BVHTree<BaseVecT>::BVHNodePtr BVHTree<BaseVecT>::buildTreeRecursive(uint32_t* prims, size_t count)
+{
+    Bounds bounds;
+    Bounds centroidBounds;
+    computeBounds(prims, count, bounds, centroidBounds);
+
+    BVHNodePtr node = splitNode(prims, count, bounds, centroidBounds);
+    node->bb = BoundingBox<BaseVecT>(
+        BaseVecT(bounds.min[0], bounds.min[1], bounds.min[2]),
+        BaseVecT(bounds.max[0], bounds.max[1], bounds.max[2])
+    );
+    return node;
+}
 
-    // Use the found split to split the current node into two new inner nodes
-    for (size_t i = 0; i < work.size(); i++)
+template<typename BaseVecT>
+typename BVHTree<BaseVecT>::BVHNodePtr BVHTree<BaseVecT>::splitNode(
+    uint32_t* prims, size_t count,
+    const Bounds& bounds, const Bounds& centroidBounds)
+{
+    // terminate recursion, if work size is small enough
+    if (count <= 2)
     {
-        auto& v = work[i];
+        return createLeaf(prims, count);
+    }
+
+    Bin bins[3][NumBins];
+    binPrimitives(prims, count, centroidBounds, bins);
 
-        // Get the best axis centroid value
-        float value;
-        if (bestAxis == 0)
+    // SAH, surface area heuristic: evaluate the planes between all bins of all 3 axes
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestBin = -1;
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (!(centroidBounds.max[axis] > centroidBounds.min[axis]))
         {
-            value = v.bb.getCentroid().x;
+            // all centroids lie in one plane along this axis, we must move to a different axis
+            continue;
         }
-        else if (bestAxis == 1)
+
+        // sweep from the right to get the cost of all right sides
+        float rightArea[NumBins];
+        size_t rightCount[NumBins];
+        Bounds acc;
+        size_t accCount = 0;
+        for (int b = NumBins - 1; b > 0; b--)
         {
-            value = v.bb.getCentroid().y;
+            acc.expand(bins[axis][b].bounds);
+            accCount += bins[axis][b].count;
+            rightArea[b] = acc.halfArea();
+            rightCount[b] = accCount;
         }
-        else
+
+        // sweep from the left and combine
+        acc = Bounds();
+        accCount = 0;
+        for (int b = 0; b < NumBins - 1; b++)
         {
-            value = v.bb.getCentroid().z;
+            acc.expand(bins[axis][b].bounds);
+            accCount += bins[axis][b].count;
+            if (accCount == 0 || rightCount[b + 1] == 0)
+            {
+                continue;
+            }
+
+            float cost = accCount * acc.halfArea() + rightCount[b + 1] * rightArea[b + 1];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = b;
+            }
         }
+    }
 
-        // Create queues for left and right sub trees
-        if (value < bestSplit)
+    size_t mid;
+    if (bestAxis == -1)
+    {
+        // all centroids are identical, split in the middle if the leaf would get too large
+        if (count <= MaxLeafSize)
         {
-            leftWork.push_back(v);
-            lBb.expand(v.bb);
+            return createLeaf(prims, count);
         }
-        else
+        mid = count / 2;
+    }
+    else
+    {
+        // traversal step relative to one triangle test
+        float area = bounds.halfArea();
+        float splitCost = area > 0 ? 1.0f + bestCost / area : static_cast<float>(count);
+        if (count <= MaxLeafSize && splitCost >= count)
         {
-            rightWork.push_back(v);
-            rBb.expand(v.bb);
+            return createLeaf(prims, count);
         }
+
+        uint32_t* pivot = std::partition(prims, prims + count, [&](uint32_t p)
+        {
+            return binIndex(centroidBounds, bestAxis, m_primBounds[p].centroid(bestAxis)) <= bestBin;
+        });
+        mid = static_cast<size_t>(pivot - prims);
     }
 
     // Recursively split new sub trees into further inner or leaf nodes
-    
     auto inner = make_unique<BVHInner>();
-
-    // #pragma omp parallel
-    // #pragma omp single nowait
-    // {
-    #pragma omp task shared(inner)
+    if (count >= ParallelThreshold / 16)
     {
-        inner->left = buildTreeRecursive(leftWork, depth + 1);
-        inner->left->bb = lBb;
+        #pragma omp task shared(inner)
+        inner->left = buildTreeRecursive(prims, mid);
+
+        inner->right = buildTreeRecursive(prims + mid, count - mid);
+        #pragma omp taskwait
     }
-    #pragma omp task shared(inner)
+    else
     {
-        inner->right = buildTreeRecursive(rightWork, depth + 1);
-        inner->right->bb = rBb;
+        inner->left = buildTreeRecursive(prims, mid);
+        inner->right = buildTreeRecursive(prims + mid, count - mid);
     }
-    #pragma omp taskwait
-    // }
-    
-    return move(inner);
+
+    return inner;
 }
 
 template<typename BaseVecT>
@@ -508,6 +567,7 @@ void BVHTree<BaseVecT>::createCFTree()
     uint32_t idxBoxes = 0;
     createCFTreeRecursive(move(m_root), idxBoxes);
     convertTrianglesIntersectionData();
+    createWideTree();
 }
 
 template<typename BaseVecT>
@@ -573,6 +633,111 @@ void BVHTree<BaseVecT>::createCFTreeRecursive(BVHNodePtr currentNode, uint32_t&
     }
 }
 
+template<typename BaseVecT>
+void BVHTree<BaseVecT>::createWideTree()
+{
+    m_wideNodes.clear();
+    if (m_indexesOrTrilists.empty())
+    {
+        return;
+    }
+
+    // every wide node replaces at least one inner node of the binary tree
+    m_wideNodes.reserve(m_indexesOrTrilists.size() / 8 + 1);
+    createWideTreeRecursive(0);
+}
+
+template<typename BaseVecT>
+uint32_t BVHTree<BaseVecT>::createWideTreeRecursive(uint32_t binaryIdx)
+{
+    auto isLeaf = [this](uint32_t idx)
+    {
+        return (m_indexesOrTrilists[idx * 4] & 0x80000000) != 0;
+    };
+    auto halfArea = [this](uint32_t idx)
+    {
+        const float* l = &m_limits[idx * 6];
+        float dx = l[1] - l[0];
+        float dy = l[3] - l[2];
+        float dz = l[5] - l[4];
+        return dx * dy + dy * dz + dz * dx;
+    };
+
+    // Gather up to four descendants by repeatedly opening the inner child with the largest surface
+    uint32_t children[4];
+    int numChildren = 0;
+    if (isLeaf(binaryIdx))
+    {
+        // only happens, if the root itself is a leaf
+        children[numChildren++] = binaryIdx;
+    }
+    else
+    {
+        children[numChildren++] = m_indexesOrTrilists[binaryIdx * 4 + 1];
+        children[numChildren++] = m_indexesOrTrilists[binaryIdx * 4 + 2];
+    }
+
+    while (numChildren < 4)
+    {
+        int best = -1;
+        float bestArea = -1.0f;
+        for (int i = 0; i < numChildren; i++)
+        {
+            if (!isLeaf(children[i]) && halfArea(children[i]) > bestArea)
+            {
+                best = i;
+                bestArea = halfArea(children[i]);
+            }
+        }
+        if (best == -1)
+        {
+            break;
+        }
+
+        uint32_t opened = children[best];
+        children[best] = m_indexesOrTrilists[opened * 4 + 1];
+        children[numChildren++] = m_indexesOrTrilists[opened * 4 + 2];
+    }
+
+    uint32_t wideIdx = static_cast<uint32_t>(m_wideNodes.size());
+    m_wideNodes.emplace_back();
+
+    for (int i = 0; i < 4; i++)
+    {
+        // the recursion below reallocates m_wideNodes, so always access by index
+        if (i >= numChildren)
+        {
+            for (int j = 0; j < 6; j++)
+            {
+                m_wideNodes[wideIdx].bounds[j][i] = std::numeric_limits<float>::infinity();
+            }
+            m_wideNodes[wideIdx].children[i] = 0;
+            m_wideNodes[wideIdx].counts[i] = 0x80000000;
+            continue;
+        }
+
+        uint32_t child = children[i];
+        for (int j = 0; j < 6; j++)
+        {
+            m_wideNodes[wideIdx].bounds[j][i] = m_limits[child * 6 + j];
+        }
+
+        if (isLeaf(child))
+        {
+            m_wideNodes[wideIdx].children[i] = m_indexesOrTrilists[child * 4 + 3];
+            m_wideNodes[wideIdx].counts[i] = m_indexesOrTrilists[child * 4];
+        }
+        else
+        {
+            uint32_t childIdx = createWideTreeRecursive(child);
+            m_wideNodes[wideIdx].children[i] = childIdx;
+            m_wideNodes[wideIdx].counts[i] = 0;
+        }
+    }
+
+    return wideIdx;
+}
+
 template<typename BaseVecT>
 void BVHTree<BaseVecT>::convertTrianglesIntersectionData()
 {
@@ -626,4 +791,16 @@ const vector<float>& BVHTree<BaseVecT>::getTrianglesIntersectionData() const
     return m_trianglesIntersectionData;
 }
 
+template<typename BaseVecT>
+const vector<uint32_t>& BVHTree<BaseVecT>::getFaceIndices() const
+{
+    return m_faceIndices;
+}
+
+template<typename BaseVecT>
+const vector<typename BVHTree<BaseVecT>::WideNode>& BVHTree<BaseVecT>::getWideNodes() const
+{
+    return m_wideNodes;
+}
+
 } /* namespace lvr2 */
@@ -0,0 +1,181 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * CompactMesh.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#ifndef LVR2_GEOMETRY_COMPACTMESH_H_
+#define LVR2_GEOMETRY_COMPACTMESH_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "lvr2/geometry/BaseMesh.hpp"
+#include "lvr2/geometry/Handles.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief Immutable snapshot of a mesh in compressed sparse row (CSR) layout.
+ *
+ * The half-edge structure of a `HalfEdgeMesh` is great for modifications, but
+ * every adjacency query has to circulate around a vertex by following
+ * pointers. Passes that only read the mesh can convert it once into this
+ * layout instead: vertex positions, face and edge vertices are stored in
+ * contiguous arrays and the faces, neighbours and edges around a vertex are
+ * stored as one contiguous range each.
+ *
+ * All handles keep the index they have in the original mesh, so attribute
+ * maps computed on a `CompactMesh` can be used with the original mesh and
+ * vice versa. The adjacency ranges of a vertex follow the order of `faces()`
+ * and `edges()`, not the circular order around the vertex.
+ *
+ * The snapshot doesn't reference the original mesh. It has to be rebuilt
+ * after the original mesh was modified.
+ */
+template<typename BaseVecT>
+class CompactMesh
+{
+public:
+
+    /**
+     * @brief A contiguous, read-only range of handles.
+     */
+    template<typename HandleT>
+    class Range
+    {
+    public:
+        Range(const HandleT* begin, const HandleT* end) : m_begin(begin), m_end(end) {}
+
+        const HandleT* begin() const { return m_begin; }
+        const HandleT* end() const { return m_end; }
+        size_t size() const { return m_end - m_begin; }
+        bool empty() const { return m_begin == m_end; }
+        const HandleT& operator[](size_t i) const { return m_begin[i]; }
+
+    private:
+        const HandleT* m_begin;
+        const HandleT* m_end;
+    };
+
+    /**
+     * @brief Creates the compact representation of the given mesh.
+     *
+     * The vertex, face and edge data is copied in parallel. The adjacency
+     * ranges are built with a counting sort over all faces and edges.
+     */
+    explicit CompactMesh(const BaseMesh<BaseVecT>& mesh);
+
+    size_t numVertices() const { return m_vertices.size(); }
+    size_t numFaces() const { return m_faces.size(); }
+    size_t numEdges() const { return m_edges.size(); }
+
+    /// Upper bound for all vertex indices, equals the one of the original mesh
+    Index nextVertexIndex() const { return m_positions.size(); }
+
+    /// Upper bound for all face indices, equals the one of the original mesh
+    Index nextFaceIndex() const { return m_faceVertices.size(); }
+
+    /// Upper bound for all edge indices, equals the one of the original mesh
+    Index nextEdgeIndex() const { return m_edgeVertices.size(); }
+
+    bool containsVertex(VertexHandle vH) const;
+    bool containsFace(FaceHandle fH) const;
+    bool containsEdge(EdgeHandle eH) const;
+
+    /// All vertices, in the iteration order of the original mesh
+    const vector<VertexHandle>& vertices() const { return m_vertices; }
+
+    /// All faces, in the iteration order of the original mesh
+    const vector<FaceHandle>& faces() const { return m_faces; }
+
+    /// All edges, in the iteration order of the original mesh
+    const vector<EdgeHandle>& edges() const { return m_edges; }
+
+    const BaseVecT& getVertexPosition(VertexHandle vH) const;
+
+    const std::array<VertexHandle, 3>& getVerticesOfFace(FaceHandle fH) const;
+
+    std::array<BaseVecT, 3> getVertexPositionsOfFace(FaceHandle fH) const;
+
+    const std::array<VertexHandle, 2>& getVerticesOfEdge(EdgeHandle eH) const;
+
+    /// The faces adjacent to the given vertex
+    Range<FaceHandle> getFacesOfVertex(VertexHandle vH) const;
+
+    /// The vertices connected to the given vertex by an edge
+    Range<VertexHandle> getNeighboursOfVertex(VertexHandle vH) const;
+
+    /**
+     * @brief The edges of the given vertex.
+     *
+     * The i-th edge connects the vertex with the i-th vertex of
+     * `getNeighboursOfVertex()`.
+     */
+    Range<EdgeHandle> getEdgesOfVertex(VertexHandle vH) const;
+
+private:
+
+    /// Positions by vertex index
+    vector<BaseVecT> m_positions;
+
+    /// Vertices by face index
+    vector<std::array<VertexHandle, 3>> m_faceVertices;
+
+    /// Vertices by edge index
+    vector<std::array<VertexHandle, 2>> m_edgeVertices;
+
+    /// Flags for used vertex, face and edge indices
+    vector<uint8_t> m_vertexUsed;
+    vector<uint8_t> m_faceUsed;
+    vector<uint8_t> m_edgeUsed;
+
+    vector<VertexHandle> m_vertices;
+    vector<FaceHandle> m_faces;
+    vector<EdgeHandle> m_edges;
+
+    /// Start of the faces of vertex i in m_vertexFaces, m_vertexFaceOffsets[i + 1] is the end
+    vector<size_t> m_vertexFaceOffsets;
+    vector<FaceHandle> m_vertexFaces;
+
+    /// Start of the neighbours/edges of vertex i, m_vertexEdgeOffsets[i + 1] is the end
+    vector<size_t> m_vertexEdgeOffsets;
+    vector<VertexHandle> m_vertexNeighbours;
+    vector<EdgeHandle> m_vertexEdges;
+};
+
+} // namespace lvr2
+
+#include "lvr2/geometry/CompactMesh.tcc"
+
+#endif /* LVR2_GEOMETRY_COMPACTMESH_H_ */
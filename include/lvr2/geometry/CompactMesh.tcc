@@ -0,0 +1,240 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * CompactMesh.tcc
+ *
+ *  @date 19.10.2026
+ */
+
+namespace lvr2
+{
+
+template<typename BaseVecT>
+CompactMesh<BaseVecT>::CompactMesh(const BaseMesh<BaseVecT>& mesh)
+{
+    const size_t numVertexIndices = mesh.nextVertexIndex();
+    const size_t numFaceIndices = mesh.nextFaceIndex();
+    const size_t numEdgeIndices = mesh.nextEdgeIndex();
+
+    m_positions.resize(numVertexIndices);
+    m_faceVertices.resize(numFaceIndices, {VertexHandle(0), VertexHandle(0), VertexHandle(0)});
+    m_edgeVertices.resize(numEdgeIndices, {VertexHandle(0), VertexHandle(0)});
+    m_vertexUsed.assign(numVertexIndices, 0);
+    m_faceUsed.assign(numFaceIndices, 0);
+    m_edgeUsed.assign(numEdgeIndices, 0);
+
+    // Collect the handles first. The edges have to be taken from the
+    // iterator: not every index below nextEdgeIndex() is a valid edge handle
+    // (a HalfEdgeMesh uses every other half edge index).
+    m_vertices.reserve(mesh.numVertices());
+    for (auto vH: mesh.vertices())
+    {
+        m_vertices.push_back(vH);
+    }
+    m_faces.reserve(mesh.numFaces());
+    for (auto fH: mesh.faces())
+    {
+        m_faces.push_back(fH);
+    }
+    m_edges.reserve(mesh.numEdges());
+    for (auto eH: mesh.edges())
+    {
+        m_edges.push_back(eH);
+    }
+
+    // Copy positions and incidences. Every index is written by one thread only.
+    #pragma omp parallel
+    {
+        #pragma omp for schedule(static) nowait
+        for (size_t i = 0; i < m_vertices.size(); i++)
+        {
+            auto vH = m_vertices[i];
+            m_vertexUsed[vH.idx()] = 1;
+            m_positions[vH.idx()] = mesh.getVertexPosition(vH);
+        }
+
+        #pragma omp for schedule(static) nowait
+        for (size_t i = 0; i < m_faces.size(); i++)
+        {
+            auto fH = m_faces[i];
+            m_faceUsed[fH.idx()] = 1;
+            m_faceVertices[fH.idx()] = mesh.getVerticesOfFace(fH);
+        }
+
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < m_edges.size(); i++)
+        {
+            auto eH = m_edges[i];
+            m_edgeUsed[eH.idx()] = 1;
+            m_edgeVertices[eH.idx()] = mesh.getVerticesOfEdge(eH);
+        }
+    }
+
+    // Counting sort of the faces by their vertices: count the faces of every
+    // vertex, turn the counts into offsets and scatter the faces. The ranges
+    // keep the order of m_faces.
+    m_vertexFaceOffsets.assign(numVertexIndices + 1, 0);
+    for (auto fH: m_faces)
+    {
+        for (auto vH: m_faceVertices[fH.idx()])
+        {
+            m_vertexFaceOffsets[vH.idx() + 1]++;
+        }
+    }
+    for (size_t i = 0; i < numVertexIndices; i++)
+    {
+        m_vertexFaceOffsets[i + 1] += m_vertexFaceOffsets[i];
+    }
+    m_vertexFaces.resize(m_vertexFaceOffsets.back(), FaceHandle(0));
+    {
+        vector<size_t> cursor(m_vertexFaceOffsets.begin(), m_vertexFaceOffsets.end() - 1);
+        for (auto fH: m_faces)
+        {
+            for (auto vH: m_faceVertices[fH.idx()])
+            {
+                m_vertexFaces[cursor[vH.idx()]++] = fH;
+            }
+        }
+    }
+
+    // Same for the edges, every edge is added to both of its vertices
+    m_vertexEdgeOffsets.assign(numVertexIndices + 1, 0);
+    for (auto eH: m_edges)
+    {
+        for (auto vH: m_edgeVertices[eH.idx()])
+        {
+            m_vertexEdgeOffsets[vH.idx() + 1]++;
+        }
+    }
+    for (size_t i = 0; i < numVertexIndices; i++)
+    {
+        m_vertexEdgeOffsets[i + 1] += m_vertexEdgeOffsets[i];
+    }
+    m_vertexNeighbours.resize(m_vertexEdgeOffsets.back(), VertexHandle(0));
+    m_vertexEdges.resize(m_vertexEdgeOffsets.back(), EdgeHandle(0));
+    {
+        vector<size_t> cursor(m_vertexEdgeOffsets.begin(), m_vertexEdgeOffsets.end() - 1);
+        for (auto eH: m_edges)
+        {
+            auto& vertices = m_edgeVertices[eH.idx()];
+            size_t first = cursor[vertices[0].idx()]++;
+            m_vertexNeighbours[first] = vertices[1];
+            m_vertexEdges[first] = eH;
+
+            size_t second = cursor[vertices[1].idx()]++;
+            m_vertexNeighbours[second] = vertices[0];
+            m_vertexEdges[second] = eH;
+        }
+    }
+}
+
+template<typename BaseVecT>
+bool CompactMesh<BaseVecT>::containsVertex(VertexHandle vH) const
+{
+    return vH.idx() < m_vertexUsed.size() && m_vertexUsed[vH.idx()];
+}
+
+template<typename BaseVecT>
+bool CompactMesh<BaseVecT>::containsFace(FaceHandle fH) const
+{
+    return fH.idx() < m_faceUsed.size() && m_faceUsed[fH.idx()];
+}
+
+template<typename BaseVecT>
+bool CompactMesh<BaseVecT>::containsEdge(EdgeHandle eH) const
+{
+    return eH.idx() < m_edgeUsed.size() && m_edgeUsed[eH.idx()];
+}
+
+template<typename BaseVecT>
+const BaseVecT& CompactMesh<BaseVecT>::getVertexPosition(VertexHandle vH) const
+{
+    return m_positions[vH.idx()];
+}
+
+template<typename BaseVecT>
+const std::array<VertexHandle, 3>& CompactMesh<BaseVecT>::getVerticesOfFace(FaceHandle fH) const
+{
+    return m_faceVertices[fH.idx()];
+}
+
+template<typename BaseVecT>
+std::array<BaseVecT, 3> CompactMesh<BaseVecT>::getVertexPositionsOfFace(FaceHandle fH) const
+{
+    auto& vertices = m_faceVertices[fH.idx()];
+    return {
+        m_positions[vertices[0].idx()],
+        m_positions[vertices[1].idx()],
+        m_positions[vertices[2].idx()]
+    };
+}
+
+template<typename BaseVecT>
+const std::array<VertexHandle, 2>& CompactMesh<BaseVecT>::getVerticesOfEdge(EdgeHandle eH) const
+{
+    return m_edgeVertices[eH.idx()];
+}
+
+template<typename BaseVecT>
+typename CompactMesh<BaseVecT>::template Range<FaceHandle> CompactMesh<BaseVecT>::getFacesOfVertex(
+    VertexHandle vH
+) const
+{
+    const FaceHandle* data = m_vertexFaces.data();
+    return Range<FaceHandle>(
+        data + m_vertexFaceOffsets[vH.idx()],
+        data + m_vertexFaceOffsets[vH.idx() + 1]
+    );
+}
+
+template<typename BaseVecT>
+typename CompactMesh<BaseVecT>::template Range<VertexHandle> CompactMesh<BaseVecT>::getNeighboursOfVertex(
+    VertexHandle vH
+) const
+{
+    const VertexHandle* data = m_vertexNeighbours.data();
+    return Range<VertexHandle>(
+        data + m_vertexEdgeOffsets[vH.idx()],
+        data + m_vertexEdgeOffsets[vH.idx() + 1]
+    );
+}
+
+template<typename BaseVecT>
+typename CompactMesh<BaseVecT>::template Range<EdgeHandle> CompactMesh<BaseVecT>::getEdgesOfVertex(
+    VertexHandle vH
+) const
+{
+    const EdgeHandle* data = m_vertexEdges.data();
+    return Range<EdgeHandle>(
+        data + m_vertexEdgeOffsets[vH.idx()],
+        data + m_vertexEdgeOffsets[vH.idx() + 1]
+    );
+}
+
+} // namespace lvr2
@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * AsciiParser.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#pragma once
+#ifndef LVR2_IO_ASCIIPARSER_HPP
+#define LVR2_IO_ASCIIPARSER_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lvr2/io/PointBuffer.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief Read-only memory mapping of a file
+ */
+class MappedFile
+{
+public:
+    /**
+     * @brief Maps the given file. Use good() to check for success.
+     */
+    explicit MappedFile(const std::string& filename);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Returns true if the file could be mapped
+    bool good() const { return m_good; }
+
+    /// First byte of the file
+    const char* begin() const { return m_data; }
+
+    /// Behind the last byte of the file
+    const char* end() const { return m_data + m_size; }
+
+    /// Size of the file in bytes
+    size_t size() const { return m_size; }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    bool m_good;
+};
+
+/**
+ * @brief Columns of a whitespace separated point file, -1 marks a missing attribute
+ */
+struct AsciiColumns
+{
+    int x = 0;
+    int y = 1;
+    int z = 2;
+    int r = -1;
+    int g = -1;
+    int b = -1;
+    int intensity = -1;
+
+    /// Guesses the columns from the number of entries per line like the slam6d readers:
+    /// 4 entries are xyz + intensity, 6 are xyz + rgb and 7 are xyz + intensity + rgb.
+    static AsciiColumns guess(int numEntries);
+
+    /// Returns the largest column index that is read
+    int maxColumn() const;
+};
+
+/**
+ * @brief Parses a floating point number at the beginning of [begin, end).
+ *
+ * Decimal numbers with optional sign, fraction and exponent are converted directly, other
+ * representations like "nan" or "inf" are passed to strtof.
+ *
+ * @return Pointer behind the number, or begin if no number was found
+ */
+const char* parseFloat(const char* begin, const char* end, float& value);
+
+/**
+ * @brief Writes the shortest decimal representation of value that parses back to
+ *        the same float.
+ *
+ * @return Pointer behind the last written character. At most 16 characters are written.
+ */
+char* formatFloat(char* out, float value);
+
+/**
+ * @brief Splits [begin, end) into blocks of complete lines of roughly blockSize bytes
+ */
+std::vector<std::pair<const char*, const char*>> splitLines(const char* begin, const char* end, size_t blockSize);
+
+/**
+ * @brief Returns the number of lines, i.e. the number of line breaks + 1
+ */
+size_t countLines(const MappedFile& file);
+
+/**
+ * @brief Returns the number of whitespace separated entries in the given line (counted from 0)
+ */
+int countEntries(const MappedFile& file, size_t line);
+
+/**
+ * @brief Parses the points of a whitespace separated text file like .3d, .pts or .xyz files.
+ *
+ * The file is split into blocks of lines that are parsed in parallel. Lines that do not contain
+ * numbers in all requested columns are skipped. Colors are stored in the "colors" channel,
+ * intensities in the "intensities" channel.
+ *
+ * @param file      The mapped file
+ * @param columns   Columns of the attributes
+ * @param skipLines Number of header lines that are ignored
+ */
+PointBufferPtr parseAsciiPoints(const MappedFile& file, const AsciiColumns& columns, size_t skipLines = 1);
+
+} // namespace lvr2
+
+#endif // LVR2_IO_ASCIIPARSER_HPP
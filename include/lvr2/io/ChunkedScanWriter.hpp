@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * ChunkedScanWriter.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#pragma once
+#ifndef LVR2_IO_CHUNKEDSCANWRITER_HPP
+#define LVR2_IO_CHUNKEDSCANWRITER_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <highfive/H5File.hpp>
+
+#include "lvr2/io/PointBuffer.hpp"
+#include "lvr2/types/MatrixTypes.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief Streams point clouds into an HDF5 file in chunks.
+ *
+ * Every call of write() appends the points, normals and face ids of one chunk to the datasets of
+ * the scan in /raw/scans/position_<nr>. The datasets are extendible and chunked, so a scan never
+ * has to be held in memory completely. write() is thread safe.
+ */
+class ChunkedScanWriter
+{
+public:
+    /**
+     * @brief Creates (or truncates) the given HDF5 file
+     *
+     * @param filename  Name of the HDF5 file
+     * @param chunkSize Number of points per HDF5 chunk
+     */
+    ChunkedScanWriter(const std::string& filename, size_t chunkSize = 1 << 16);
+
+    /**
+     * @brief Appends the points to the scan with the given number. The pose is stored with the
+     *        first chunk of each scan.
+     *
+     * @param scanNr    Number of the scan
+     * @param pose      Pose of the scanner, the points are given in its local frame
+     * @param points    Points with optional normals and "face_ids" index channel
+     */
+    void write(size_t scanNr, const Transformf& pose, PointBufferPtr points);
+
+private:
+
+    std::shared_ptr<HighFive::File> m_file;
+    size_t m_chunkSize;
+    std::mutex m_mutex;
+};
+
+} // namespace lvr2
+
+#endif // LVR2_IO_CHUNKEDSCANWRITER_HPP
@@ -31,14 +31,86 @@
 #define DRCIO_HPP
 
 #include "BaseIO.hpp"
+#include "lvr2/geometry/BaseVector.hpp"
+#include "lvr2/geometry/BoundingBox.hpp"
+
+#include <cstdint>
+#include <vector>
 
 namespace lvr2
 {
 
+/**
+ * @brief Index entry of a single chunk in a chunked draco file.
+ */
+struct DrcChunk
+{
+    /// Bounding box of the vertices referenced by the chunk
+    BoundingBox<BaseVector<float>> bb;
+
+    /// Byte offset of the draco stream relative to the file start
+    uint64_t offset;
+
+    /// Size of the draco stream in bytes
+    uint64_t size;
+
+    /// Number of vertices and faces encoded in the chunk
+    uint64_t numVertices;
+    uint64_t numFaces;
+};
+
+/**
+ * @brief IO class for draco compressed meshes and point clouds.
+ *
+ *        If enabled via \ref setMaxChunkFaces(), meshes with more faces
+ *        than that are split into spatial chunks that are compressed
+ *        independently and in parallel. Faces are assigned to the chunk
+ *        grid cell that contains their centroid, using the cell logic of
+ *        the ChunkManager. The chunks are written into a small container
+ *        with a bounding box index, so they can be decoded in parallel or
+ *        selectively via \ref readArea().
+ *        Vertices shared by faces of different chunks are duplicated and
+ *        are not merged again when reading, so a chunked file does not
+ *        preserve the connectivity of the mesh. Smaller meshes, point
+ *        clouds and all meshes while chunking is disabled (the default)
+ *        are written as plain draco files.
+ */
 class DrcIO : public BaseIO
 {
   public:
-    DrcIO(){};
+    DrcIO() : m_chunkSize(0), m_maxChunkFaces(0) {};
+
+    /**
+     * @brief Sets the edge length of the chunk grid cells. A value of 0
+     *        (default) derives the size from the bounding box and
+     *        \ref setMaxChunkFaces().
+     */
+    void setChunkSize(float size) { m_chunkSize = size; }
+
+    /**
+     * @brief Sets the number of faces up to which a mesh is written as a
+     *        single draco stream. Larger meshes are chunked. A value of 0
+     *        (default) disables chunking.
+     */
+    void setMaxChunkFaces(size_t n) { m_maxChunkFaces = n; }
+
+    /**
+     * @brief Returns the chunk index of a chunked draco file. The index is
+     *        empty for plain draco files.
+     *
+     * @param filename  The file to read.
+     */
+    std::vector<DrcChunk> readChunkIndex(string filename);
+
+    /**
+     * @brief Decodes only the chunks of a chunked draco file whose bounding
+     *        box overlaps the given area. Plain draco files are read
+     *        completely.
+     *
+     * @param filename  The file to read.
+     * @param area      The area of interest
+     */
+    ModelPtr readArea(string filename, const BoundingBox<BaseVector<float>>& area);
 
     /**
      * @brief Parse the draco and load supported elements.
@@ -61,6 +133,22 @@ class DrcIO : public BaseIO
      * @param filename Filename of the file to write.
      */
     virtual void save(ModelPtr model, string filename);
+
+  private:
+
+    /// Encodes the mesh of m_model chunk-wise into the given file
+    void saveChunked(string filename);
+
+    /// Decodes the given chunks of a chunked file in parallel and merges them
+    ModelPtr readChunks(const std::vector<char>& data,
+                        const std::vector<DrcChunk>& chunks,
+                        std::vector<Texture>& textures);
+
+    /// Edge length of the chunk grid cells
+    float m_chunkSize;
+
+    /// Maximum number of faces per single draco stream, 0 to never chunk
+    size_t m_maxChunkFaces;
 };
 
 } /* namespace lvr */
@@ -61,6 +61,17 @@ public:
      */
     int writeBand(cv::Mat *mat, int band);
 
+    /**
+     * @brief Writing a block of consecutive rows of a band from a contiguous buffer.
+     *        The buffer is handed to GDAL directly without copying.
+     * @param data row major buffer with num_rows * width values
+     * @param band number of band to be written
+     * @param first_row first row of the block
+     * @param num_rows number of rows of the block
+     * @return standard C++ return value
+     */
+    int writeBlock(const uint16_t *data, int band, int first_row, int num_rows);
+
     /**
      * @return width of dataset in number of pixels
      */
@@ -36,6 +36,7 @@
 #define LASIO_H_
 
 #include "lvr2/io/BaseIO.hpp"
+#include "lvr2/io/LasStreamReader.hpp"
 
 namespace lvr2
 {
@@ -63,6 +64,13 @@ public:
      */
     virtual void save( string filename );
 
+    /**
+     * @brief Sets the filters that are applied while reading.
+     */
+    void setFilter(const LasFilter& filter) { m_filter = filter; }
+
+private:
+    LasFilter m_filter;
 };
 
 } /* namespace lvr2 */
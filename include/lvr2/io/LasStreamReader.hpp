@@ -0,0 +1,166 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * LasStreamReader.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#pragma once
+#ifndef LVR2_IO_LASSTREAMREADER_HPP
+#define LVR2_IO_LASSTREAMREADER_HPP
+
+#include "lvr2/geometry/BaseVector.hpp"
+#include "lvr2/geometry/BoundingBox.hpp"
+#include "lvr2/io/LineReader.hpp"
+
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+class LASreader;
+class LASreadOpener;
+
+namespace lvr2
+{
+
+/**
+ * @brief Point filters that are evaluated while a LAS file is read.
+ */
+struct LasFilter
+{
+    LasFilter() : useBoundingBox(false), returnNumber(0), lastReturnOnly(false) {}
+
+    /// Only keep points inside \ref boundingBox
+    bool useBoundingBox;
+
+    /// Area of interest if \ref useBoundingBox is set
+    BoundingBox<BaseVector<float>> boundingBox;
+
+    /// Accepted classification codes. An empty list accepts all classes.
+    std::vector<unsigned char> classifications;
+
+    /// Accepted return number (1 = first return). 0 accepts all returns.
+    unsigned char returnNumber;
+
+    /// Only keep the last return of each pulse
+    bool lastReturnOnly;
+};
+
+/**
+ * @brief Block-wise reader for LAS/LAZ files.
+ *
+ *        Opening a file only parses its header, so the point count and
+ *        bounding box are available without touching the point records.
+ *        Points are then streamed in blocks via \ref getNextPoints() in
+ *        the packed layouts of the \ref LineReader. The filters of a
+ *        \ref LasFilter are applied inside the read loop. The xy part of
+ *        the bounding box filter is handed to laslib, which skips whole
+ *        cells if a spatial index (.lax) exists next to the file.
+ */
+class LasStreamReader
+{
+public:
+    /**
+     * @brief Opens the file and reads its header.
+     *
+     * @param filename  A .las or .laz file
+     * @param filter    Filters applied to the streamed points
+     */
+    LasStreamReader(const std::string& filename, const LasFilter& filter = LasFilter());
+
+    ~LasStreamReader();
+
+    LasStreamReader(const LasStreamReader&) = delete;
+    LasStreamReader& operator=(const LasStreamReader&) = delete;
+
+    /// True if the file could be opened and not all points were read yet
+    bool ok() const;
+
+    /// Number of point records according to the header. This is an upper
+    /// bound of the number of streamed points if filters are set.
+    size_t getNumPoints() const;
+
+    /// Bounding box of all points according to the header
+    BoundingBox<BaseVector<float>> getBoundingBox() const;
+
+    /// True if the point format contains RGB values
+    bool hasColors() const;
+
+    /// XYZRGB if the file contains colors, XYZ otherwise
+    fileType getFileType() const;
+
+    /**
+     * @brief Reads the next point that passes the filters.
+     *
+     * @param xyz       Receives the coordinates
+     * @param rgb       Receives the 8 bit color if not null. Black if the
+     *                  file has no colors. 16 bit colors are scaled down
+     *                  unless the first points of the file only contain
+     *                  values up to 255.
+     * @param intensity Receives the intensity if not null
+     *
+     * @return false if the end of the file is reached
+     */
+    bool readPoint(float* xyz, unsigned char* rgb = nullptr, float* intensity = nullptr);
+
+    /**
+     * @brief Reads the next block of points that pass the filters.
+     *
+     * @param return_amount Number of returned points. Less than amount
+     *                      only at the end of the file.
+     * @param amount        Maximum number of points to read
+     *
+     * @return An array of \ref xyz or \ref xyzc structs, depending on
+     *         \ref getFileType()
+     */
+    boost::shared_ptr<void> getNextPoints(size_t& return_amount, size_t amount = 1000000);
+
+private:
+    /// Checks the attribute filters for the current point
+    bool accept() const;
+
+    /// Decides from the first points whether the colors are stored with 8
+    /// or 16 bits and rewinds the reader
+    void detectColorShift(LASreadOpener& opener);
+
+    LASreader* m_reader;
+    LasFilter m_filter;
+    bool m_classes[256];
+    bool m_eof;
+    size_t m_numPoints;
+    bool m_hasColors;
+    /// Right shift that converts the stored colors to 8 bit
+    int m_colorShift;
+    BoundingBox<BaseVector<float>> m_boundingBox;
+};
+
+} // namespace lvr2
+
+#endif // LVR2_IO_LASSTREAMREADER_HPP
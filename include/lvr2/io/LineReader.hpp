@@ -38,6 +38,7 @@
 #include "DataStruct.hpp"
 
 #include <boost/shared_array.hpp>
+#include <boost/shared_ptr.hpp>
 #include <exception>
 #include <string>
 
@@ -60,6 +61,7 @@ struct fileAttribut
     fileType m_fileType;
     size_t m_PointBlockSize;
     bool m_ply;
+    bool m_las;
     bool m_binary;
     size_t m_line_element_amount;
 };
@@ -84,6 +86,9 @@ struct __attribute__((packed)) xyzc : xyz
 };
 
 
+class LasStreamReader;
+struct LasFilter;
+
 class LineReader
 {
 public:
@@ -106,6 +111,12 @@ public:
   bool ok();
   bool isPly() { return m_ply; }
 
+  /**
+   * @brief Sets the filters that are applied when streaming .las/.laz files.
+   *        Call before reading, getNumPoints() ignores the filters.
+   */
+  void setLasFilter(const LasFilter& filter);
+
   class readException : public std::exception
   {
   public:
@@ -129,6 +140,8 @@ private:
   size_t m_currentReadFile;
   bool m_openNextFile;
   std::vector<fileAttribut> m_fileAttributes;
+  boost::shared_ptr<LasFilter> m_lasFilter;
+  boost::shared_ptr<LasStreamReader> m_lasReader;
 };
 
 } // namespace lvr2
@@ -41,6 +41,7 @@
 #include <fstream>
 #include <set>
 #include <map>
+#include <unordered_map>
 
 using namespace std;
 
@@ -82,7 +83,7 @@ public:
 
 private:
 
-    void parseMtlFile(map<string, int>& matNames,
+    void parseMtlFile(unordered_map<string, int>& matNames,
             vector<Material>& materials,
             vector<Texture>& textures,
             string mtlname);
@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * PLYWriter.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#pragma once
+#ifndef LVR2_IO_PLYWRITER_HPP
+#define LVR2_IO_PLYWRITER_HPP
+
+#include <cstdio>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "lvr2/io/Model.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief Scalar types supported by the \ref PLYWriter
+ */
+enum class PLYType
+{
+    UCHAR,
+    INT,
+    UINT,
+    FLOAT
+};
+
+/**
+ * @brief Binary PLY writer that serializes channels directly into interleaved
+ *        records.
+ *
+ * The layout of the file is declared first via addElement() and addProperties().
+ * Each call to addProperties() describes a group of properties that is filled from
+ * one interleaved source array, e.g. "x", "y", "z" from a point array or "red",
+ * "green", "blue" from a color array with width 3 or 4. Records are then appended
+ * per element with write(). This can happen in arbitrary chunks, so producers do
+ * not have to assemble the complete buffer in memory. Records are encoded in
+ * parallel into large blocks that are written to disk asynchronously while the
+ * next block is encoded.
+ *
+ * Elements have to be written in the order they were declared. If the number of
+ * records of an element is not known in advance, it is written into the header
+ * when the file is closed.
+ */
+class PLYWriter
+{
+public:
+    /**
+     * @brief Creates the given file. Use good() to check for success.
+     */
+    explicit PLYWriter(const std::string& filename);
+
+    /**
+     * @brief Closes the file if close() was not called explicitly
+     */
+    ~PLYWriter();
+
+    PLYWriter(const PLYWriter&) = delete;
+    PLYWriter& operator=(const PLYWriter&) = delete;
+
+    /// Returns false if the file could not be created or a write failed
+    bool good() const { return m_good; }
+
+    /**
+     * @brief Declares a new element
+     *
+     * @param name      Name of the element, e.g. "vertex" or "face"
+     * @param count     Number of records. Use UnknownCount if the number is
+     *                  determined while streaming.
+     */
+    void addElement(const std::string& name, size_t count = UnknownCount);
+
+    /**
+     * @brief Adds properties to the last element that are read from one
+     *        interleaved source array
+     *
+     * @param names     Names of the properties, one per component
+     * @param type      Type of the properties and the source array
+     * @param width     Number of entries per record in the source array. Only
+     *                  the first names.size() entries are written. 0 means
+     *                  names.size().
+     */
+    void addProperties(const std::vector<std::string>& names, PLYType type, size_t width = 0);
+
+    /**
+     * @brief Adds a list property with three indices per record to the last element,
+     *        i.e. "property list uchar int vertex_indices". The source array holds
+     *        three unsigned ints per record.
+     */
+    void addTriangleList(const std::string& name = "vertex_indices");
+
+    /**
+     * @brief Writes the header. Has to be called after declaring the layout and
+     *        before writing records.
+     */
+    bool writeHeader();
+
+    /**
+     * @brief Appends records to the given element
+     *
+     * @param element   Name of the element. Switching to the next element finishes
+     *                  the current one, elements can not be revisited.
+     * @param sources   One source array per property group in declaration order
+     * @param n         Number of records in the source arrays
+     */
+    bool write(const std::string& element, const std::vector<const void*>& sources, size_t n);
+
+    /**
+     * @brief Flushes all pending data, fills in the unknown element counts and
+     *        closes the file.
+     *
+     * @return false if writing failed or the number of written records does not
+     *         match a declared count
+     */
+    bool close();
+
+    /**
+     * @brief Writes the point cloud and mesh of the model. The layout matches
+     *        the one of \ref PLYIO.
+     */
+    static bool save(ModelPtr model, const std::string& filename);
+
+    /// Marks an element count that is not known when writing the header
+    static const size_t UnknownCount;
+
+private:
+    struct Group
+    {
+        std::vector<std::string> names;
+        PLYType type;
+        size_t width;
+        bool list;
+
+        /// Size of the group in a record in bytes
+        size_t size() const;
+    };
+
+    struct Element
+    {
+        std::string name;
+        size_t count;
+        size_t written;
+        long countPosition;
+        std::vector<Group> groups;
+        size_t recordSize;
+    };
+
+    /// Encodes n records into the given buffer
+    void encode(const Element& element, const std::vector<const void*>& sources,
+                size_t first, size_t n, char* out) const;
+
+    /// Waits for the pending write to finish
+    void finishWrite();
+
+    /// Starts writing the given number of bytes of the current buffer in the background
+    void startWrite(size_t size);
+
+    bool finishElement();
+
+    FILE* m_file;
+    bool m_good;
+    bool m_headerWritten;
+    std::vector<Element> m_elements;
+    size_t m_current;
+
+    std::vector<char> m_buffers[2];
+    int m_buffer;
+    std::future<bool> m_pendingWrite;
+};
+
+} // namespace lvr2
+
+#endif // LVR2_IO_PLYWRITER_HPP
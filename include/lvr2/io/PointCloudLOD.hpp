@@ -0,0 +1,175 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * PointCloudLOD.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#pragma once
+#ifndef LVR2_IO_POINTCLOUDLOD_HPP
+#define LVR2_IO_POINTCLOUDLOD_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <highfive/H5File.hpp>
+
+#include "lvr2/io/PointBuffer.hpp"
+#include "lvr2/types/MatrixTypes.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief A node of a level-of-detail octree.
+ *
+ * Every node stores a subsample of the points in its cube with a spacing of about
+ * size / gridSize, its descendants refine that subsample. The points of a node are stored
+ * contiguously in the points dataset of the file.
+ */
+struct LODNode
+{
+    /// Index of the first point of the node in the points dataset
+    uint64_t offset;
+
+    /// Number of points of the node
+    uint32_t count;
+
+    /// Index of the first child in the node table, the children are stored consecutively
+    uint32_t firstChild;
+
+    /// Bit i is set if the child in octant i exists (bit 0: x, bit 1: y, bit 2: z)
+    uint8_t childMask;
+
+    /// Depth of the node, the root has level 0
+    uint8_t level;
+
+    /// Minimum corner of the node cube
+    Vector3f min;
+
+    /// Side length of the node cube
+    float size;
+};
+
+/**
+ * @brief Reads point clouds in the nested octree level-of-detail format written by
+ *        PointCloudLODBuilder.
+ *
+ * The file is an HDF5 file with the following layout:
+ *
+ *  /lod                attributes "version", "grid_size" and "num_points"
+ *  /lod/bounds         float[4]: minimum corner and side length of the root cube
+ *  /lod/points         float[n][3], the points of all nodes in breadth first order
+ *  /lod/colors         uchar[n][3], optional
+ *  /lod/nodes/offset   uint64, first point of each node
+ *  /lod/nodes/count    uint32, number of points of each node
+ *  /lod/nodes/first_child  uint32, index of the first child of each node
+ *  /lod/nodes/child_mask   uint8, existing children of each node
+ *
+ * Only the node table is read when the file is opened. The points are streamed on demand for a
+ * set of nodes, which is usually chosen by selectNodes() from the current camera.
+ */
+class PointCloudLOD
+{
+public:
+    /**
+     * @brief Opens the file and reads the node table
+     */
+    PointCloudLOD(const std::string& filename);
+
+    /// Number of nodes in the hierarchy
+    size_t numNodes() const { return m_nodes.size(); }
+
+    /// Number of points in the file
+    size_t numPoints() const { return m_numPoints; }
+
+    /// Returns true if the points have colors
+    bool hasColors() const { return m_hasColors; }
+
+    /// Returns the node with the given index, the root has index 0
+    const LODNode& node(size_t i) const { return m_nodes[i]; }
+
+    /// Returns the point spacing of the given node
+    float spacing(size_t i) const { return m_nodes[i].size / m_gridSize; }
+
+    /**
+     * @brief Chooses the nodes needed to render the cloud from the given camera position.
+     *
+     * A node is refined as long as the projected point spacing of the node is larger than
+     * maxError pixels. Nodes with the largest error are loaded first until the point budget
+     * is reached.
+     *
+     * @param camera        Camera position
+     * @param fovY          Vertical field of view in radians
+     * @param screenHeight  Height of the viewport in pixels
+     * @param maxError      Maximum projected point spacing in pixels
+     * @param pointBudget   Maximum number of points in the selected nodes
+     *
+     * @return Indices of the selected nodes
+     */
+    std::vector<size_t> selectNodes(
+        const Vector3f& camera,
+        float fovY,
+        float screenHeight,
+        float maxError,
+        size_t pointBudget) const;
+
+    /**
+     * @brief Chooses the coarsest levels of the hierarchy that fit into the point budget. The
+     *        root is always selected.
+     */
+    std::vector<size_t> selectNodes(size_t pointBudget) const;
+
+    /**
+     * @brief Reads the points of the given nodes. Nodes that are stored next to each other in
+     *        the file are read with a single request.
+     */
+    PointBufferPtr load(const std::vector<size_t>& nodes) const;
+
+private:
+
+    /// Returns the projected spacing of a node in units of the screen height
+    float projectedSpacing(const LODNode& node, const Vector3f& camera) const;
+
+    std::shared_ptr<HighFive::File> m_file;
+    std::vector<LODNode> m_nodes;
+    uint32_t m_gridSize;
+    uint64_t m_numPoints;
+    bool m_hasColors;
+};
+
+using PointCloudLODPtr = std::shared_ptr<PointCloudLOD>;
+
+} // namespace lvr2
+
+#endif // LVR2_IO_POINTCLOUDLOD_HPP
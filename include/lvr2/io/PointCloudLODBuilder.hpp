@@ -0,0 +1,168 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * PointCloudLODBuilder.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#pragma once
+#ifndef LVR2_IO_POINTCLOUDLODBUILDER_HPP
+#define LVR2_IO_POINTCLOUDLODBUILDER_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <highfive/H5File.hpp>
+
+#include "lvr2/io/PointStream.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief Builds the level-of-detail octree files read by PointCloudLOD.
+ *
+ * The builder works out-of-core, the memory it needs depends on the chunk size and not on the
+ * size of the input cloud:
+ *
+ *  1. The bounding box of the input is computed.
+ *  2. The points are counted in a coarse grid that is used to split the root cube into
+ *     chunks of at most maxChunkPoints points.
+ *  3. The points are distributed into one temporary file per chunk.
+ *  4. The octree of each chunk is built in memory. Every node keeps the first point of each
+ *     cell of a gridSize^3 grid over its cube and passes the remaining points on to its
+ *     children. Nodes with at most maxNodePoints points become leaves.
+ *  5. The levels above the chunks are built bottom up by subsampling the points of the
+ *     chunk roots in the same way.
+ *
+ * The points of every node are written contiguously, the node table is stored breadth first.
+ */
+class PointCloudLODBuilder
+{
+public:
+    /**
+     * @param tmpDir            Directory for the temporary chunk files
+     * @param maxChunkPoints    Maximum number of points of a chunk that is built in memory
+     * @param maxNodePoints     Nodes with at most this many points are not subdivided
+     * @param gridSize          Resolution of the sampling grid of each node
+     */
+    PointCloudLODBuilder(
+        const std::string& tmpDir,
+        size_t maxChunkPoints = 1 << 23,
+        size_t maxNodePoints = 20000,
+        uint32_t gridSize = 128);
+
+    /**
+     * @brief Builds the hierarchy for all points of the stream and writes it to the file.
+     *        The stream is traversed three times.
+     */
+    void build(PointStream& input, const std::string& filename);
+
+private:
+
+    /// A point as stored in the chunk files
+    struct LODPoint
+    {
+        float pos[3];
+        unsigned char color[4];
+    };
+
+    /// Identifies a node by its level and integer cube coordinates on that level
+    struct NodeKey
+    {
+        uint32_t level;
+        uint32_t x;
+        uint32_t y;
+        uint32_t z;
+
+        bool operator<(const NodeKey& other) const;
+
+        NodeKey parent() const { return {level - 1, x >> 1, y >> 1, z >> 1}; }
+        NodeKey child(int octant) const;
+    };
+
+    /// Position of the points of a written node
+    struct NodeRange
+    {
+        uint64_t offset;
+        uint32_t count;
+    };
+
+    /**
+     * @brief Recursively builds the subtree of the given node from the points in [begin, end).
+     *        The points of the chunk root are kept in m_pending instead of being written.
+     */
+    void buildNode(LODPoint* begin, LODPoint* end, const NodeKey& key, bool chunkRoot);
+
+    /**
+     * @brief Moves one point per sampling grid cell of the node to the front of [begin, end)
+     *        and returns the end of the sample
+     */
+    LODPoint* sample(LODPoint* begin, LODPoint* end, const NodeKey& key);
+
+    /// Appends the points of a node to the output
+    void writeNode(const NodeKey& key, const LODPoint* points, size_t n);
+
+    /// Writes the buffered points to the datasets
+    void flush();
+
+    /// Writes the bounds, attributes and the breadth first node table
+    void writeHierarchy();
+
+    /// Minimum corner and side length of the cube of a node
+    void nodeCube(const NodeKey& key, float* min, float& size) const;
+
+    std::string m_tmpDir;
+    size_t m_maxChunkPoints;
+    size_t m_maxNodePoints;
+    uint32_t m_gridSize;
+
+    float m_min[3];
+    float m_size;
+    uint64_t m_numPoints;
+    bool m_hasColors;
+
+    std::shared_ptr<HighFive::File> m_file;
+    std::map<NodeKey, NodeRange> m_nodes;
+    std::map<NodeKey, std::vector<LODPoint>> m_pending;
+    std::vector<float> m_pointBuffer;
+    std::vector<unsigned char> m_colorBuffer;
+    uint64_t m_written;
+    std::mutex m_mutex;
+};
+
+} // namespace lvr2
+
+#endif // LVR2_IO_POINTCLOUDLODBUILDER_HPP
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * PointCloudLODIO.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#pragma once
+#ifndef LVR2_IO_POINTCLOUDLODIO_HPP
+#define LVR2_IO_POINTCLOUDLODIO_HPP
+
+#include <string>
+
+#include "lvr2/io/BaseIO.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief Reads an overview of .lod files written by PointCloudLODBuilder.
+ *
+ * Only the coarsest levels of the hierarchy that fit into the point budget are loaded. Use
+ * PointCloudLOD directly to stream the nodes for a camera position.
+ */
+class PointCloudLODIO : public BaseIO
+{
+public:
+    /**
+     * @param pointBudget   Maximum number of points that are loaded
+     */
+    PointCloudLODIO(size_t pointBudget = 10000000);
+
+    /**
+     * @brief Reads the coarsest levels of the file that fit into the point budget
+     */
+    ModelPtr read(std::string filename) override;
+
+    /**
+     * @brief This function is not supported and will do nothing. Use PointCloudLODBuilder
+     *        to create .lod files.
+     */
+    void save(std::string filename) override;
+
+    using BaseIO::save;
+
+private:
+    size_t m_pointBudget;
+};
+
+} // namespace lvr2
+
+#endif // LVR2_IO_POINTCLOUDLODIO_HPP
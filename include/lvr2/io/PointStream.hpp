@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * PointStream.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#pragma once
+#ifndef LVR2_IO_POINTSTREAM_HPP
+#define LVR2_IO_POINTSTREAM_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <highfive/H5File.hpp>
+
+#include "lvr2/io/PointBuffer.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief A point cloud that is read in chunks and can be traversed several times.
+ *
+ * Used by algorithms that work out-of-core and therefore never need the whole cloud in memory.
+ */
+class PointStream
+{
+public:
+    virtual ~PointStream() = default;
+
+    /**
+     * @brief Restarts the stream at its first point
+     */
+    virtual void rewind() = 0;
+
+    /**
+     * @brief Returns the next chunk of points, optionally with a "colors" channel of width 3.
+     *        Returns nullptr after the last chunk.
+     */
+    virtual PointBufferPtr next() = 0;
+};
+
+using PointStreamPtr = std::shared_ptr<PointStream>;
+
+/**
+ * @brief Streams a point buffer that is already in memory
+ */
+class PointBufferStream : public PointStream
+{
+public:
+    /**
+     * @param buffer    The streamed points
+     * @param chunkSize Maximum number of points per chunk
+     */
+    PointBufferStream(PointBufferPtr buffer, size_t chunkSize = 1 << 20);
+
+    void rewind() override;
+
+    PointBufferPtr next() override;
+
+private:
+    PointBufferPtr m_buffer;
+    size_t m_chunkSize;
+    size_t m_position;
+};
+
+/**
+ * @brief Streams the points of all scans in /raw/scans of an HDF5 file.
+ *
+ * The points are returned as stored in the "points" dataset of each scan, a "colors" dataset
+ * of width 3 is passed along if present.
+ */
+class HDF5ScanStream : public PointStream
+{
+public:
+    /**
+     * @param filename  Name of the HDF5 file
+     * @param chunkSize Maximum number of points per chunk
+     */
+    HDF5ScanStream(const std::string& filename, size_t chunkSize = 1 << 20);
+
+    void rewind() override;
+
+    PointBufferPtr next() override;
+
+private:
+    std::shared_ptr<HighFive::File> m_file;
+    std::vector<std::string> m_scans;
+    size_t m_chunkSize;
+    size_t m_scan;
+    size_t m_position;
+};
+
+} // namespace lvr2
+
+#endif // LVR2_IO_POINTSTREAM_HPP
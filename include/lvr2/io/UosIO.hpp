@@ -50,6 +50,7 @@
 
 #include "lvr2/geometry/BaseVector.hpp"
 #include "lvr2/geometry/Matrix4.hpp"
+#include "lvr2/types/MatrixTypes.hpp"
 
 using std::string;
 using std::fstream;
@@ -163,6 +164,14 @@ private:
      */
     void readNewFormat(ModelPtr &m, string dir, int first, int last, size_t &n);
 
+    /**
+     * @brief Writes every n-th transformed point of the given scans to the
+     *        reduction target, n is chosen to match the reduction target.
+     * @param scanFiles     The scan files in new UOS format
+     * @param transforms    The transformation of each scan
+     */
+    void reduceScans(const std::vector<string>& scanFiles, const std::vector<Transformf>& transforms);
+
 
     /**
      * @brief Reads scans from \ref{first} to \ref{last} in old UOS format.
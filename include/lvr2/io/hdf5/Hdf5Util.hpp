@@ -326,6 +326,35 @@ bool checkAttribute(HighFive::Group& g,
     return true;
 }
 
+/**
+ * @brief Appends n rows of the given width to a two dimensional dataset
+ *        whose first dimension is unlimited. The dataset is created if it
+ *        doesn't exist yet.
+ *
+ * @param chunkRows Number of rows per HDF5 chunk of a new dataset
+ */
+template<typename T>
+void appendRows(HighFive::Group& g,
+    const std::string& datasetName,
+    const T* data,
+    size_t n,
+    size_t width,
+    size_t chunkRows)
+{
+    if (!g.exist(datasetName))
+    {
+        HighFive::DataSpace space({0, width}, {HighFive::DataSpace::UNLIMITED, width});
+        HighFive::DataSetCreateProps properties;
+        properties.add(HighFive::Chunking(std::vector<hsize_t>{chunkRows, width}));
+        g.createDataSet<T>(datasetName, space, properties);
+    }
+
+    HighFive::DataSet dataset = g.getDataSet(datasetName);
+    size_t offset = dataset.getSpace().getDimensions()[0];
+    dataset.resize({offset + n, width});
+    dataset.select({offset, 0}, {n, width}).template write<T>(data);
+}
+
 } // namespace hdf5util
 
 } // namespace lvr2
@@ -35,6 +35,7 @@
 #include "lvr2/io/LineReader.hpp"
 #include "lvr2/io/Progress.hpp"
 #include "lvr2/io/Timestamp.hpp"
+#include "lvr2/types/BufferPool.hpp"
 
 #include <boost/filesystem/path.hpp>
 #include <boost/optional/optional_io.hpp>
@@ -1589,7 +1590,7 @@ lvr2::floatArr BigGrid<BaseVecT>::points(int i, int j, int k, size_t& numPoints)
     {
         size_t cellSize = m_gridNumPoints[h].size;
 
-        points = lvr2::floatArr(new float[3 * cellSize]);
+        points = allocateArray<float>(3 * cellSize);
         boost::iostreams::mapped_file_params mmfparam;
         mmfparam.path = "points.mmf";
         mmfparam.mode = std::ios_base::in | std::ios_base::out | std::ios_base::trunc;
@@ -1630,7 +1631,7 @@ lvr2::floatArr BigGrid<BaseVecT>::points(
     std::cout << "min[" << minx << ", " << miny << ", " << minz << "]" << std::endl;
     std::cout << "max[" << maxx << ", " << maxy << ", " << maxz << "]" << std::endl;
 
-    lvr2::floatArr points(new float[numPoints * 3]);
+    lvr2::floatArr points = allocateArray<float>(numPoints * 3);
     size_t p_index = 0;
 
     boost::iostreams::mapped_file_source mmfs("points.mmf");
@@ -1682,7 +1683,7 @@ lvr2::floatArr BigGrid<BaseVecT>::normals(
 
     numPoints = getSizeofBox(minx, miny, minz, maxx, maxy, maxz);
 
-    lvr2::floatArr points(new float[numPoints * 3]);
+    lvr2::floatArr points = allocateArray<float>(numPoints * 3);
     size_t p_index = 0;
 
     boost::iostreams::mapped_file_source mmfs("normals.mmf");
@@ -1734,7 +1735,7 @@ lvr2::ucharArr BigGrid<BaseVecT>::colors(
 
     numPoints = getSizeofBox(minx, miny, minz, maxx, maxy, maxz);
 
-    lvr2::ucharArr points(new unsigned char[numPoints * 3]);
+    lvr2::ucharArr points = allocateArray<unsigned char>(numPoints * 3);
     size_t p_index = 0;
 
     boost::iostreams::mapped_file_source mmfs("colors.mmf");
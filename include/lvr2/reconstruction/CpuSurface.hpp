@@ -0,0 +1,175 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * CpuSurface.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#ifndef LVR2_RECONSTRUCTION_CPUSURFACE_HPP
+#define LVR2_RECONSTRUCTION_CPUSURFACE_HPP
+
+#include "lvr2/io/DataStruct.hpp"
+#include "lvr2/reconstruction/QueryPoint.hpp"
+#include "lvr2/reconstruction/LBKdTree.hpp"
+#include "lvr2/geometry/BaseVector.hpp"
+#include "lvr2/geometry/LBPointArray.hpp"
+
+#include <boost/shared_array.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <string>
+#include <vector>
+
+namespace lvr2
+{
+
+/**
+ * @brief CPU implementation of the normal estimation and distance evaluation
+ *        of CudaSurface and ClSurface.
+ *
+ * Uses the same left-balanced LBKdTree layout as the GPU backends. Nearest
+ * neighbors are searched with an exact, stack based traversal of the tree
+ * arrays. Points are processed in blocks: the neighbor searches of a block
+ * run first, then the plane fits of the whole block run in a vectorized loop.
+ * The interface matches the GPU classes, so it can be used as their drop-in
+ * replacement on machines without a GPU.
+ */
+class CpuSurface
+{
+public:
+
+    /**
+     * @brief Constructor. Builds the kd-tree.
+     *
+     * @param points    Input point cloud. The data is not copied.
+     */
+    CpuSurface(LBPointArray<float>& points);
+
+    /**
+     * @brief Constructor. Builds the kd-tree.
+     *
+     * @param points        Input point cloud. The data is not copied.
+     * @param num_points    Number of points
+     * @param device        Unused, for compatibility with the GPU classes
+     */
+    CpuSurface(floatArr& points, size_t num_points, int device = 0);
+
+    ~CpuSurface();
+
+    /**
+     * @brief Estimates the normals with the kn nearest neighbors and
+     *        interpolates them with the ki nearest neighbors
+     */
+    void calculateNormals();
+
+    /**
+     * @brief Averages each normal with the normals of its ki nearest neighbors
+     */
+    void interpolateNormals();
+
+    /**
+     * @brief Copies the normals into an allocated point array
+     */
+    void getNormals(LBPointArray<float>& output_normals);
+
+    /**
+     * @brief Copies the normals into an allocated array of 3 * num_points floats
+     */
+    void getNormals(floatArr output_normals);
+
+    /// Sets the number of neighbors for normal estimation
+    void setKn(int kn);
+
+    /// Sets the number of neighbors for normal interpolation
+    void setKi(int ki);
+
+    /// Sets the number of neighbors for distance evaluation
+    void setKd(int kd);
+
+    /// Sets the viewpoint to orientate the normals
+    void setFlippoint(float v_x, float v_y, float v_z);
+
+    /**
+     * @brief Set Method for normal calculation. Only "PCA" is supported.
+     */
+    void setMethod(const std::string& method);
+
+    /// Unused, for compatibility with the GPU classes
+    void setReconstructionMode(bool mode = true);
+
+    /**
+     * @brief Computes the signed distance of each query point to the surface
+     *        defined by its kd nearest points and their normals. Query points
+     *        farther than the diagonal of a voxel from that surface are
+     *        marked as invalid.
+     */
+    void distances(std::vector<QueryPoint<BaseVector<float> > >& query_points, float voxel_size);
+
+    /// Unused, for compatibility with the GPU classes
+    void freeGPU();
+
+    /**
+     * @brief Finds the k nearest neighbors of a position
+     *
+     * @param x, y, z   The position
+     * @param k         Number of neighbors
+     * @param indices   Receives the point indices, sorted by distance
+     * @param distances Receives the squared distances
+     *
+     * @return Number of neighbors found (less than k if there are not enough points)
+     */
+    int kSearch(float x, float y, float z, int k, unsigned int* indices, float* distances) const;
+
+private:
+
+    void init();
+
+    void initKdTree();
+
+    /// Number of points processed at once
+    static constexpr int BlockSize = 256;
+
+    // Points and normals
+    floatArr                                            m_points;
+    LBPointArray<float>                                 V;
+    std::vector<float>                                  m_normals;
+
+    // Left-balanced kd-tree
+    boost::shared_ptr<LBKdTree>                         m_kdTree;
+    boost::shared_ptr<LBPointArray<float> >             m_treeValues;
+    boost::shared_ptr<LBPointArray<unsigned char> >     m_treeSplits;
+
+    float m_vx, m_vy, m_vz;
+    int m_k, m_ki, m_kd;
+};
+
+} /* namespace lvr2 */
+
+#endif // LVR2_RECONSTRUCTION_CPUSURFACE_HPP
@@ -35,8 +35,7 @@
 
 #include <stdlib.h>
 #include <math.h>
-#include <list>
-#include <unordered_set>
+#include <vector>
 
 #include <boost/shared_ptr.hpp>
 
@@ -47,6 +46,12 @@ namespace lvr2
  * @brief The LBKdTree class implements a left-balanced array-based index kd-tree.
  *          Left-Balanced: minimum memory
  *          Array-Based: Good for GPU - Usage
+ *
+ * The tree is built in place on a packed copy of the points: every inner
+ * node partitions its range with std::nth_element along the axis of largest
+ * extent, so no per-node index arrays are allocated. The upper levels are
+ * split concurrently on the tree's own thread pool, the remaining subtrees
+ * are then built as independent tasks.
  */
 class LBKdTree {
 public:
@@ -63,45 +68,44 @@ public:
 
 private:
 
-    void generateKdTreeArray(LBPointArray<float>& V,
-            LBPointArray<unsigned int>* sorted_indices,
-            int max_dim);
-
-    boost::shared_ptr<LBPointArray<float> > m_values;
-
-    // split dim 4 dims per split_dim
-    boost::shared_ptr<LBPointArray<unsigned char> > m_splits;
-
-    // Static member
+    /// Maximum point dimension supported by the packed build representation
+    static constexpr unsigned int MaxDim = 3;
 
-    static int st_num_threads;
-    static int st_depth_threads;
+    /// A point together with its index in the input array
+    struct BuildPoint
+    {
+        float coords[MaxDim];
+        unsigned int index;
+    };
 
-    static ctpl::thread_pool *pool;
+    /**
+     * @brief Turns the range [begin, end) into the node at the given position.
+     *        A single point becomes a leaf. Otherwise the range is partitioned
+     *        along its axis of largest extent.
+     *
+     * @return The first index of the right child's range, or end for a leaf
+     */
+    size_t splitNode(size_t begin, size_t end, size_t position);
 
-    static void fillCriticalIndices(const LBPointArray<float>& V,
-            LBPointArray<unsigned int>& sorted_indices,
-            unsigned int current_dim,
-            float split_value, unsigned int split_index,
-            std::list<unsigned int>& critical_indices_left,
-            std::list<unsigned int>& critical_indices_right);
+    /// Builds the complete subtree for the range [begin, end) sequentially
+    void generateSubtree(size_t begin, size_t end, size_t position);
 
-    static void fillCriticalIndicesSet(const LBPointArray<float>& V,
-            LBPointArray<unsigned int>& sorted_indices,
-            unsigned int current_dim,
-            float split_value, unsigned int split_index,
-            std::unordered_set<unsigned int>& critical_indices_left,
-            std::unordered_set<unsigned int>& critical_indices_right);
+    boost::shared_ptr<LBPointArray<float> > m_values;
 
+    // split dim 4 dims per split_dim
+    boost::shared_ptr<LBPointArray<unsigned char> > m_splits;
 
-    static void generateKdTreeRecursive(int id, LBPointArray<float>& V,
-            LBPointArray<unsigned int>* sorted_indices, int current_dim, int max_dim,
-            LBPointArray<float> *values, LBPointArray<unsigned char> *splits,
-            int size, int max_tree_depth, int position, int current_depth);
+    /// Points of the tree during construction, reordered in place
+    std::vector<BuildPoint> m_buildPoints;
 
-    static void test(int id, LBPointArray<float>* sorted_indices);
+    /// Dimension of the points
+    unsigned int m_dim;
 
+    /// Tree levels that are split in parallel before subtrees become tasks
+    int m_parallelDepth;
 
+    /// Worker threads owned by this tree
+    ctpl::thread_pool m_pool;
 };
 
 }  /* namespace lvr2 */
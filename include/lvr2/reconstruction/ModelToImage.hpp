@@ -188,6 +188,15 @@ public:
 
 private:
 
+    ///
+    /// \brief  Projects all points of the point buffer in parallel
+    ///
+    /// \param pixels       Linear pixel index (row * width + column) of each point
+    /// \param ranges       Range of each point
+    /// \param minRange     Updated with the minimal range
+    /// \param maxRange     Updated with the maximal range
+    ///
+    void projectPoints(vector<int>& pixels, vector<float>& ranges, float& minRange, float& maxRange);
 
     /// Pointer to projection
     Projection*         m_projection;
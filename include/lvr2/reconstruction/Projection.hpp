@@ -42,6 +42,19 @@ public:
 
     virtual void project(int&i , int&j, float& r, float x, float y, float z) = 0;
 
+    ///
+    /// \brief Projects n points with interleaved coordinates. The default
+    ///        implementation calls project() for each point. Projections with
+    ///        a vectorizable kernel override it.
+    ///
+    /// \param n       Number of points
+    /// \param points  Point coordinates (x, y, z for each point)
+    /// \param i       Image columns
+    /// \param j       Image rows
+    /// \param r       Ranges
+    ///
+    virtual void projectBatch(size_t n, const float* points, int* i, int* j, float* r);
+
     int w() { return m_width;}
     int h() { return m_height;}
 
@@ -49,6 +62,42 @@ protected:
 
     inline void toPolar(const float point[], float polar[]);
 
+    /// Maps a point to the native coordinate system
+    inline void toNative(float x, float y, float z, float& kx, float& ky, float& kz) const
+    {
+        switch(m_system)
+        {
+            case ModelToImage::SLAM6D:
+                kx = z; ky = -x; kz = y;
+                break;
+            case ModelToImage::UOS:
+                kx = x; ky = -z; kz = y;
+                break;
+            case ModelToImage::NATIVE:
+            default:
+                kx = x; ky = y; kz = z;
+        }
+    }
+
+    ///
+    /// \brief Branch free approximation of atan2 (max. error about 1e-5 rad).
+    ///        Used by the batch projections, where it is auto-vectorized.
+    ///
+    static inline float fastAtan2(float y, float x)
+    {
+        float ax = std::abs(x);
+        float ay = std::abs(y);
+        float mx = ax > ay ? ax : ay;
+        float mn = ax > ay ? ay : ax;
+        float a = mx > 0.0f ? mn / mx : 0.0f;
+        float s = a * a;
+        float r = ((((( -0.01172120f * s + 0.05265332f) * s - 0.11643287f) * s
+                    + 0.19354346f) * s - 0.33262347f) * s + 0.99997726f) * a;
+        r = ay > ax ? 1.570796327f - r : r;
+        r = x < 0.0f ? 3.141592654f - r : r;
+        return y < 0.0f ? -r : r;
+    }
+
     float       m_xSize;
     float       m_ySize;
     float       m_xFactor;
@@ -78,6 +127,8 @@ public:
 
     virtual void project(int&i , int&j, float& r, float x, float y, float z) override;
 
+    virtual void projectBatch(size_t n, const float* points, int* i, int* j, float* r) override;
+
 protected:
     float       m_xFactor;
     float       m_yFactor;
@@ -107,6 +158,10 @@ public:
                           int minV, int maxV,
                           bool optimize, ModelToImage::CoordinateSystem system = ModelToImage::NATIVE);
 
+    virtual void project(int&i , int&j, float& r, float x, float y, float z) override;
+
+    virtual void projectBatch(size_t n, const float* points, int* i, int* j, float* r) override;
+
 protected:
     float       m_heightLow;
     int         m_maxWidth;
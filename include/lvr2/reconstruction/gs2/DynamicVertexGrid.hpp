@@ -0,0 +1,118 @@
+//
+// Created on 19.10.26.
+//
+
+#ifndef LAS_VEGAS_DYNAMICVERTEXGRID_HPP
+#define LAS_VEGAS_DYNAMICVERTEXGRID_HPP
+
+#include <lvr2/geometry/Handles.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace lvr2{
+
+    /**
+     * Hashed uniform grid over the vertices of a growing mesh, used to find the closest vertex to a point.
+     *
+     * The grid keeps a copy of every vertex position, so it has to be told about every vertex that is added,
+     * removed or moved. Moving a vertex within its cell is just a copy of the position. The cell size is chosen
+     * from the extent of the vertices and their number, and the grid rebuilds itself whenever the number of
+     * vertices has grown by a factor of four since the last build, so the cells stay small while the mesh grows.
+     *
+     * @tparam BaseVecT the vector type used
+     */
+    template <typename BaseVecT>
+    class DynamicVertexGrid {
+
+    public:
+
+        DynamicVertexGrid();
+
+        /**
+         * Adds a vertex to the grid
+         * @param vH    handle of the vertex, must not be in the grid yet
+         * @param pos   position of the vertex
+         */
+        void insert(VertexHandle vH, const BaseVecT& pos);
+
+        /**
+         * Removes a vertex from the grid, does nothing if it isn't part of the grid
+         */
+        void remove(VertexHandle vH);
+
+        /**
+         * Sets the position of a vertex which is already part of the grid
+         */
+        void update(VertexHandle vH, const BaseVecT& pos);
+
+        /**
+         * Finds the vertex closest to the given point. Ties are resolved in favour of the smaller handle, which
+         * gives the same result as a linear scan over the vertices of the mesh.
+         *
+         * @param point     the query point
+         * @param nearest   the closest vertex
+         * @param distSq    the squared distance between point and nearest
+         * @return          false, if the grid is empty
+         */
+        bool findNearest(const BaseVecT& point, VertexHandle& nearest, float& distSq) const;
+
+        bool contains(VertexHandle vH) const;
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+    private:
+
+        using CellKey = uint64_t;
+
+        struct CellCoord
+        {
+            int64_t x, y, z;
+        };
+
+        CellCoord cellOf(const BaseVecT& pos) const;
+
+        CellKey keyOf(int64_t x, int64_t y, int64_t z) const;
+
+        void addToCell(Index idx);
+
+        void removeFromCell(Index idx);
+
+        void expandBounds(const BaseVecT& pos);
+
+        /// Recomputes the cell size and reinserts all vertices
+        void rebuild();
+
+        float m_cellSize;
+
+        /// Number of vertices at the last rebuild
+        size_t m_builtSize;
+
+        size_t m_size;
+
+        /// Vertex indices by cell
+        std::unordered_map<CellKey, std::vector<Index>> m_cells;
+
+        /// Per vertex index: is it part of the grid, its position, its cell and its position in the cell
+        std::vector<uint8_t> m_present;
+        std::vector<BaseVecT> m_positions;
+        std::vector<CellKey> m_cellKeys;
+        std::vector<size_t> m_slots;
+
+        /// Bounding box of all positions the grid has seen (only grows)
+        BaseVecT m_min;
+        BaseVecT m_max;
+
+        /// Range of cells which may contain vertices (only grows between rebuilds)
+        CellCoord m_minCell;
+        CellCoord m_maxCell;
+    };
+}
+
+#include "DynamicVertexGrid.tcc"
+
+#endif //LAS_VEGAS_DYNAMICVERTEXGRID_HPP
@@ -0,0 +1,269 @@
+//
+// Created on 19.10.26.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace lvr2{
+
+    template <typename BaseVecT>
+    DynamicVertexGrid<BaseVecT>::DynamicVertexGrid()
+        : m_cellSize(1), m_builtSize(0), m_size(0), m_minCell{0, 0, 0}, m_maxCell{0, 0, 0}
+    {
+    }
+
+    /**
+     * Returns the integer coordinates of the cell containing the given position
+     */
+    template <typename BaseVecT>
+    typename DynamicVertexGrid<BaseVecT>::CellCoord DynamicVertexGrid<BaseVecT>::cellOf(const BaseVecT& pos) const
+    {
+        return {
+            static_cast<int64_t>(std::floor(static_cast<double>(pos.x) / m_cellSize)),
+            static_cast<int64_t>(std::floor(static_cast<double>(pos.y) / m_cellSize)),
+            static_cast<int64_t>(std::floor(static_cast<double>(pos.z) / m_cellSize))
+        };
+    }
+
+    /**
+     * Packs the cell coordinates into a hash key, 21 bits per axis. Coordinates beyond that wrap around, which
+     * only means that far apart cells share a key. The distance tests take care of the additional vertices.
+     */
+    template <typename BaseVecT>
+    typename DynamicVertexGrid<BaseVecT>::CellKey DynamicVertexGrid<BaseVecT>::keyOf(int64_t x, int64_t y, int64_t z) const
+    {
+        const uint64_t mask = (uint64_t(1) << 21) - 1;
+        return (uint64_t(x) & mask) | ((uint64_t(y) & mask) << 21) | ((uint64_t(z) & mask) << 42);
+    }
+
+    template <typename BaseVecT>
+    void DynamicVertexGrid<BaseVecT>::addToCell(Index idx)
+    {
+        CellCoord c = cellOf(m_positions[idx]);
+        CellKey key = keyOf(c.x, c.y, c.z);
+
+        auto& cell = m_cells[key];
+        m_cellKeys[idx] = key;
+        m_slots[idx] = cell.size();
+        cell.push_back(idx);
+
+        m_minCell.x = std::min(m_minCell.x, c.x);
+        m_minCell.y = std::min(m_minCell.y, c.y);
+        m_minCell.z = std::min(m_minCell.z, c.z);
+        m_maxCell.x = std::max(m_maxCell.x, c.x);
+        m_maxCell.y = std::max(m_maxCell.y, c.y);
+        m_maxCell.z = std::max(m_maxCell.z, c.z);
+    }
+
+    template <typename BaseVecT>
+    void DynamicVertexGrid<BaseVecT>::removeFromCell(Index idx)
+    {
+        auto it = m_cells.find(m_cellKeys[idx]);
+        auto& cell = it->second;
+
+        // swap the last vertex of the cell into the freed slot
+        Index last = cell.back();
+        cell[m_slots[idx]] = last;
+        m_slots[last] = m_slots[idx];
+        cell.pop_back();
+
+        if(cell.empty())
+        {
+            m_cells.erase(it);
+        }
+    }
+
+    template <typename BaseVecT>
+    void DynamicVertexGrid<BaseVecT>::expandBounds(const BaseVecT& pos)
+    {
+        m_min.x = std::min(m_min.x, pos.x);
+        m_min.y = std::min(m_min.y, pos.y);
+        m_min.z = std::min(m_min.z, pos.z);
+        m_max.x = std::max(m_max.x, pos.x);
+        m_max.y = std::max(m_max.y, pos.y);
+        m_max.z = std::max(m_max.z, pos.z);
+    }
+
+    template <typename BaseVecT>
+    void DynamicVertexGrid<BaseVecT>::rebuild()
+    {
+        // choose the cell size such that a surface covering the bounding box would put a few vertices
+        // into every cell
+        float diagonal = (m_max - m_min).length();
+        m_cellSize = diagonal > 0 && m_size > 1 ? diagonal / std::sqrt(static_cast<float>(m_size)) : 1.0f;
+        m_builtSize = m_size;
+
+        m_cells.clear();
+        m_minCell = {std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::max()};
+        m_maxCell = {std::numeric_limits<int64_t>::lowest(), std::numeric_limits<int64_t>::lowest(), std::numeric_limits<int64_t>::lowest()};
+
+        for(size_t i = 0; i < m_present.size(); i++)
+        {
+            if(m_present[i])
+            {
+                addToCell(i);
+            }
+        }
+    }
+
+    template <typename BaseVecT>
+    void DynamicVertexGrid<BaseVecT>::insert(VertexHandle vH, const BaseVecT& pos)
+    {
+        Index idx = vH.idx();
+        if(idx >= m_present.size())
+        {
+            size_t newSize = std::max<size_t>(idx + 1, 2 * m_present.size());
+            m_present.resize(newSize, 0);
+            m_positions.resize(newSize);
+            m_cellKeys.resize(newSize, 0);
+            m_slots.resize(newSize, 0);
+        }
+
+        m_present[idx] = 1;
+        m_positions[idx] = pos;
+
+        if(m_builtSize == 0 && m_size == 0)
+        {
+            m_min = pos;
+            m_max = pos;
+        }
+        expandBounds(pos);
+        m_size++;
+
+        // the first vertices don't tell much about the extent of the mesh, so rebuild until there are a few
+        if(m_size <= 16 || m_size > 4 * m_builtSize)
+        {
+            rebuild();
+        }
+        else
+        {
+            addToCell(idx);
+        }
+    }
+
+    template <typename BaseVecT>
+    void DynamicVertexGrid<BaseVecT>::remove(VertexHandle vH)
+    {
+        if(!contains(vH))
+        {
+            return;
+        }
+
+        removeFromCell(vH.idx());
+        m_present[vH.idx()] = 0;
+        m_size--;
+    }
+
+    template <typename BaseVecT>
+    void DynamicVertexGrid<BaseVecT>::update(VertexHandle vH, const BaseVecT& pos)
+    {
+        Index idx = vH.idx();
+        expandBounds(pos);
+
+        CellCoord c = cellOf(pos);
+        if(keyOf(c.x, c.y, c.z) == m_cellKeys[idx])
+        {
+            // still in the same cell
+            m_positions[idx] = pos;
+            return;
+        }
+
+        removeFromCell(idx);
+        m_positions[idx] = pos;
+        addToCell(idx);
+    }
+
+    template <typename BaseVecT>
+    bool DynamicVertexGrid<BaseVecT>::contains(VertexHandle vH) const
+    {
+        return vH.idx() < m_present.size() && m_present[vH.idx()];
+    }
+
+    /**
+     * Searches the cells in growing shells around the cell of the query point. After shell r has been searched,
+     * every vertex in shell r + 1 or beyond is at least r cell sizes away, so the search can stop as soon as the
+     * best distance found is below that bound.
+     */
+    template <typename BaseVecT>
+    bool DynamicVertexGrid<BaseVecT>::findNearest(const BaseVecT& point, VertexHandle& nearest, float& distSq) const
+    {
+        if(m_size == 0)
+        {
+            return false;
+        }
+
+        const CellCoord c = cellOf(point);
+
+        // no occupied cell is further away than this
+        int64_t maxRing = 0;
+        maxRing = std::max(maxRing, std::max(c.x - m_minCell.x, m_maxCell.x - c.x));
+        maxRing = std::max(maxRing, std::max(c.y - m_minCell.y, m_maxCell.y - c.y));
+        maxRing = std::max(maxRing, std::max(c.z - m_minCell.z, m_maxCell.z - c.z));
+
+        Index bestIdx = std::numeric_limits<Index>::max();
+        float bestDist = std::numeric_limits<float>::infinity();
+
+        auto visitCell = [&](int64_t x, int64_t y, int64_t z)
+        {
+            auto it = m_cells.find(keyOf(x, y, z));
+            if(it == m_cells.end())
+            {
+                return;
+            }
+            for(Index idx : it->second)
+            {
+                BaseVecT distanceVector = point - m_positions[idx];
+                float length = distanceVector.length2();
+                if(length < bestDist || (length == bestDist && idx < bestIdx))
+                {
+                    bestDist = length;
+                    bestIdx = idx;
+                }
+            }
+        };
+
+        for(int64_t r = 0; r <= maxRing; r++)
+        {
+            // only visit the part of the shell which overlaps the occupied cells
+            int64_t x0 = std::max(c.x - r, m_minCell.x), x1 = std::min(c.x + r, m_maxCell.x);
+            int64_t y0 = std::max(c.y - r, m_minCell.y), y1 = std::min(c.y + r, m_maxCell.y);
+            for(int64_t x = x0; x <= x1; x++)
+            {
+                for(int64_t y = y0; y <= y1; y++)
+                {
+                    if(std::abs(x - c.x) == r || std::abs(y - c.y) == r)
+                    {
+                        int64_t z0 = std::max(c.z - r, m_minCell.z), z1 = std::min(c.z + r, m_maxCell.z);
+                        for(int64_t z = z0; z <= z1; z++)
+                        {
+                            visitCell(x, y, z);
+                        }
+                    }
+                    else
+                    {
+                        if(c.z - r >= m_minCell.z)
+                        {
+                            visitCell(x, y, c.z - r);
+                        }
+                        if(r > 0 && c.z + r <= m_maxCell.z)
+                        {
+                            visitCell(x, y, c.z + r);
+                        }
+                    }
+                }
+            }
+
+            float bound = r * m_cellSize;
+            if(bestIdx != std::numeric_limits<Index>::max() && bestDist < bound * bound)
+            {
+                break;
+            }
+        }
+
+        nearest = VertexHandle(bestIdx);
+        distSq = bestDist;
+        return true;
+    }
+}
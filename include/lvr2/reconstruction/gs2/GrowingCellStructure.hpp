@@ -11,6 +11,7 @@
 #include <lvr2/attrmaps/HashMap.hpp>
 #include <lvr2/reconstruction/gs2/TumbleTree.hpp>
 #include <lvr2/reconstruction/gs2/DynamicKDTree.hpp>
+#include <lvr2/reconstruction/gs2/DynamicVertexGrid.hpp>
 
 
 namespace lvr2{
@@ -84,6 +85,10 @@ namespace lvr2{
             return m_interior;
         }
 
+        int getBatchSize() const {
+            return m_batchSize;
+        }
+
         void setRuntime(int m_runtime) {
             GrowingCellStructure::m_runtime = m_runtime;
         }
@@ -140,6 +145,14 @@ namespace lvr2{
             GrowingCellStructure::m_balances = m_balances;
         }
 
+        /**
+         * Sets the number of basic steps whose closest vertex searches run concurrently. The result does not
+         * depend on the batch size.
+         */
+        void setBatchSize(int m_batchSize) {
+            GrowingCellStructure::m_batchSize = m_batchSize;
+        }
+
     private:
         PointsetSurfacePtr<BaseVecT> *m_surface; //helper-surface
         HalfEdgeMesh<BaseVecT> *m_mesh;
@@ -155,11 +168,13 @@ namespace lvr2{
         bool m_filterChain; //should a filter chain be applied?
         bool m_interior; //should the interior be reconstructed or the exterior?
         int m_balances;
+        int m_batchSize = 1; //how many basic steps search their winner concurrently
         float m_avgSignalCounter = 0;
 
         // "GCS" related members
         TumbleTree* tumble_tree;
         DynamicKDTree<BaseVecT>* kd_tree;
+        DynamicVertexGrid<BaseVecT> m_vertexIndex; //index for the closest vertex search, kept in sync with the mesh
         std::vector<Cell*> cellArr; //TODO: OUTSOURCE IT INTO THE TUMBLETREE CLASS, NEW PARAMETER FOR THE TUMBLE TREE CONSTRUCTOR
                                     // CONTAINING THE MAXMIMUM SIZE OF THE MESH
         float m_decreaseFactor; //for sc calc
@@ -185,6 +200,10 @@ namespace lvr2{
 
         void executeBasicStep(PacmanProgressBar& progress_bar);
 
+        void executeBasicSteps(int n, PacmanProgressBar& progress_bar);
+
+        void moveWinner(VertexHandle winnerH, BaseVecT random_point, std::vector<VertexHandle>& moved);
+
         void executeVertexSplit();
 
         void executeEdgeCollapse();
@@ -7,6 +7,7 @@
 #include <lvr2/reconstruction/PointsetSurface.hpp>
 #include <lvr2/io/Progress.hpp>
 #include <lvr2/reconstruction/LBKdTree.hpp>
+#include <algorithm>
 #include <cmath>
 
 
@@ -69,9 +70,9 @@ namespace lvr2 {
 
             for(int j = 0; j < getNumSplits(); j++)
             {
-                for(int k = 0; k < getBasicSteps(); k++)
+                for(int k = 0; k < getBasicSteps(); k += std::max(m_batchSize, 1))
                 {
-                    executeBasicStep(progress_bar);
+                    executeBasicSteps(std::min(std::max(m_batchSize, 1), getBasicSteps() - k), progress_bar);
                 }
                 executeVertexSplit(); //TODO: execute vertex split after a specific number of basic steps
 
@@ -141,71 +142,164 @@ namespace lvr2 {
         //cout << "basic step" << endl;
         if(!m_useGSS) //if only gcs is used (gcs basic step)
         {
-            VertexHandle winnerH = this->getClosestPointInMesh(random_point, progress_bar); //TODO: better runtime efficency(kd-tree)
-            /*Index winnerIndex = kd_tree->findNearest(random_point);
-            VertexHandle winnerH(winnerIndex);*/
+            VertexHandle winnerH = this->getClosestPointInMesh(random_point, progress_bar);
 
-            //smooth the winning vertex
-            BaseVecT &winner = m_mesh->getVertexPosition(winnerH);
-            //kd_tree->deleteNode(winner);
-            winner += (random_point - winner) * getLearningRate();
-            //kd_tree->insert(winner, winnerH);
+            vector<VertexHandle> moved;
+            moveWinner(winnerH, random_point, moved);
 
-            //smooth the winning vertices' neighbors (laplacian smoothing)
+        }
+        else //GSS TODO: INCLUDE GSS ADDITIONS
+        {
+            std::cout << "Using GSS" << endl;
+            //find closest structure
 
-            vector<VertexHandle> neighborsOfWinner;
-            m_mesh->getNeighboursOfVertex(winnerH, neighborsOfWinner);
+            //set approx error(s) and age of faces (using HashMap)
 
-            //perform laplacian smoothing on all the neighbors of the winning vertex
-            for(auto v : neighborsOfWinner)
-            {
-                BaseVecT& nb = m_mesh->getVertexPosition(v);
-                //kd_tree->deleteNode(nb);
+            //smoothing
 
-                nb += (random_point - winner) * getNeighborLearningRate();
-                if(m_mesh->numVertices() > 100) performLaplacianSmoothing(v, random_point, getNeighborLearningRate());
+            //coalescing
 
-                //kd_tree->insert(nb, v);
-            }
+            //filter chain
+        }
+    }
 
 
-            Cell* winnerNode = cellArr[winnerH.idx()];
+    /**
+     * Executes n basic steps. The closest vertices of the n random points are searched concurrently, then the
+     * steps are applied one after another. A step whose winner was moved by an earlier step of the batch, or
+     * which is now closer to a vertex moved by an earlier step, gets corrected before it is applied, so the
+     * result is the same as executing the basic steps one by one.
+     *
+     * @tparam BaseVecT
+     * @tparam NormalT
+     * @param n number of basic steps
+     * @param progress_bar progress of the algorithm
+     */
+    template <typename BaseVecT, typename NormalT>
+    void GrowingCellStructure<BaseVecT, NormalT>::executeBasicSteps(int n, PacmanProgressBar& progress_bar)
+    {
+        if(n <= 1 || m_useGSS)
+        {
+            for(int i = 0; i < n; i++)
+            {
+                executeBasicStep(progress_bar);
+            }
+            return;
+        }
 
-            //TODO: determine mistake in remove operation in basic step. why on earth is there a prob here
+        //draw the random points in the same order as the single steps would
+        vector<BaseVecT> random_points(n);
+        for(int i = 0; i < n; i++)
+        {
+            random_points[i] = this->getRandomPointFromPointcloud();
+        }
 
-            //we need to remove the winner before updating.
-            double winnerSC = tumble_tree->remove(winnerNode, winnerH); //remove the winning vertex from the tumble tree, get the real sc
+        vector<VertexHandle> winners(n, VertexHandle(0));
+        vector<float> distances(n);
 
-            //decrease signal counter of others by a fraction according to hennings implementation
-            if(m_decreaseFactor == 1.0)
-            {
-                size_t n = m_allowMiss * m_mesh->numVertices();
-                float dynamicDecrease = 1 - (float)pow(m_collapseThreshold, (1 / n));
-                tumble_tree->updateSC(dynamicDecrease);
+        #pragma omp parallel for schedule(dynamic, 4)
+        for(int i = 0; i < n; i++)
+        {
+            m_vertexIndex.findNearest(random_points[i], winners[i], distances[i]);
+        }
+        progress_bar += n * m_mesh->numVertices();
 
+        vector<VertexHandle> moved;
+        for(int i = 0; i < n; i++)
+        {
+            VertexHandle winnerH = winners[i];
+            if(std::find(moved.begin(), moved.end(), winnerH) != moved.end())
+            {
+                //the winner has moved, the index is up to date, so just search again
+                m_vertexIndex.findNearest(random_points[i], winnerH, distances[i]);
             }
             else
             {
-                tumble_tree->updateSC(m_decreaseFactor);
-
+                //only the moved vertices can have come closer than the winner
+                for(auto vH : moved)
+                {
+                    float length = (random_points[i] - m_mesh->getVertexPosition(vH)).length2();
+                    if(length < distances[i] || (length == distances[i] && vH.idx() < winnerH.idx()))
+                    {
+                        winnerH = vH;
+                        distances[i] = length;
+                    }
+                }
             }
-            //reinsert the winner's vH with updated sc
-            cellArr[winnerH.idx()] = tumble_tree->insert(winnerSC + 1, winnerH);
 
+            moveWinner(winnerH, random_points[i], moved);
         }
-        else //GSS TODO: INCLUDE GSS ADDITIONS
+    }
+
+
+    /**
+     * Moves the winner of a basic step and its neighbours towards the random point, updates the signal counters
+     * (GCS)
+     *
+     * @tparam BaseVecT
+     * @tparam NormalT
+     * @param winnerH the vertex closest to the random point
+     * @param random_point the random point of the basic step
+     * @param moved all vertices moved get appended to this vector
+     */
+    template <typename BaseVecT, typename NormalT>
+    void GrowingCellStructure<BaseVecT, NormalT>::moveWinner(VertexHandle winnerH, BaseVecT random_point, vector<VertexHandle>& moved)
+    {
+        //smooth the winning vertex
+        BaseVecT &winner = m_mesh->getVertexPosition(winnerH);
+        //kd_tree->deleteNode(winner);
+        winner += (random_point - winner) * getLearningRate();
+        //kd_tree->insert(winner, winnerH);
+
+        //smooth the winning vertices' neighbors (laplacian smoothing)
+
+        vector<VertexHandle> neighborsOfWinner;
+        m_mesh->getNeighboursOfVertex(winnerH, neighborsOfWinner);
+
+        //perform laplacian smoothing on all the neighbors of the winning vertex
+        for(auto v : neighborsOfWinner)
         {
-            std::cout << "Using GSS" << endl;
-            //find closest structure
+            BaseVecT& nb = m_mesh->getVertexPosition(v);
+            //kd_tree->deleteNode(nb);
 
-            //set approx error(s) and age of faces (using HashMap)
+            nb += (random_point - winner) * getNeighborLearningRate();
+            if(m_mesh->numVertices() > 100) performLaplacianSmoothing(v, random_point, getNeighborLearningRate());
 
-            //smoothing
+            //kd_tree->insert(nb, v);
+        }
 
-            //coalescing
+        //keep the index in sync with the moved vertices
+        m_vertexIndex.update(winnerH, winner);
+        moved.push_back(winnerH);
+        for(auto v : neighborsOfWinner)
+        {
+            m_vertexIndex.update(v, m_mesh->getVertexPosition(v));
+            moved.push_back(v);
+        }
+
+
+        Cell* winnerNode = cellArr[winnerH.idx()];
+
+        //TODO: determine mistake in remove operation in basic step. why on earth is there a prob here
+
+        //we need to remove the winner before updating.
+        double winnerSC = tumble_tree->remove(winnerNode, winnerH); //remove the winning vertex from the tumble tree, get the real sc
+
+        //decrease signal counter of others by a fraction according to hennings implementation
+        if(m_decreaseFactor == 1.0)
+        {
+            size_t n = m_allowMiss * m_mesh->numVertices();
+            float dynamicDecrease = 1 - (float)pow(m_collapseThreshold, (1 / n));
+            tumble_tree->updateSC(dynamicDecrease);
+
+        }
+        else
+        {
+            tumble_tree->updateSC(m_decreaseFactor);
 
-            //filter chain
         }
+        //reinsert the winner's vH with updated sc
+        cellArr[winnerH.idx()] = tumble_tree->insert(winnerSC + 1, winnerH);
     }
 
 
@@ -239,6 +333,8 @@ namespace lvr2 {
             cellArr[highestSC.idx()] = tumble_tree->insert(actual_sc / 2, highestSC);
             cellArr[newVH.idx()] = tumble_tree->insert(actual_sc / 2, newVH);
 
+            m_vertexIndex.insert(newVH, m_mesh->getVertexPosition(newVH));
+
 
             /*BaseVecT kdInsert = m_mesh->getVertexPosition(newVH);
             kd_tree->insert(kdInsert, newVH);*/
@@ -347,6 +443,8 @@ namespace lvr2 {
                         EdgeCollapseResult result = m_mesh->collapseEdge(eToSixVal.unwrap());
                         tumble_tree->remove(cellArr[result.removedPoint.idx()], result.removedPoint);
                         cellArr[result.removedPoint.idx()] = NULL;
+                        m_vertexIndex.remove(result.removedPoint);
+                        m_vertexIndex.update(result.midPoint, m_mesh->getVertexPosition(result.midPoint));
                         std::cout << "Collapsed an Edge!" << endl;
                     }
                 }
@@ -390,8 +488,9 @@ namespace lvr2 {
 
 
     /**
-     * Gets the closest point to the given point using the euclidean distance
-     * runtime: O(n) //TODO: make it better. kd-tree? KD-TREE IMPLEMENTATION IN GS2 NOT GOOD.
+     * Gets the closest point to the given point using the euclidean distance. Ties are resolved in favour of the
+     * smaller handle.
+     * runtime: O(1) on average, using the vertex index
      *
      * @tparam BaseVecT
      * @tparam NormalT
@@ -402,34 +501,12 @@ namespace lvr2 {
     template <typename BaseVecT, typename NormalT>
     VertexHandle GrowingCellStructure<BaseVecT, NormalT>::getClosestPointInMesh(BaseVecT point, PacmanProgressBar& progress_bar)
     {
-        //search the closest point of the mesh
-        auto vertices = m_mesh->vertices();
-
         VertexHandle closestVertexToRandomPoint(numeric_limits<int>::max());
         float smallestDistance = numeric_limits<float>::infinity();
-        float avg_counter = 0;
-
-        for(auto vertexH : vertices)
-        {
-            /*if(m_mesh->numVertices() != 4) TODO: PRINT NUMBER OF VERTICES WHILE ALSO PRINTING THE PROGRESS BAR...
-            {
-                cout << "\33[2K\r" << endl;
-            }*/
-            ++progress_bar;
-            //cout << "Vertices in Mesh: " << m_mesh->numVertices() << endl;
+        m_vertexIndex.findNearest(point, closestVertexToRandomPoint, smallestDistance);
 
-            BaseVecT vertex = m_mesh->getVertexPosition(vertexH); //get Vertex from Handle
-            BaseVecT distanceVector = point - vertex;
-            float length = distanceVector.length2();
-
-            if(length < smallestDistance)
-            {
-
-                closestVertexToRandomPoint = vertexH;
-                smallestDistance = length;
-
-            }
-        }
+        //the progress is still counted in vertices compared
+        progress_bar += m_mesh->numVertices();
 
         return closestVertexToRandomPoint;
     }
@@ -604,6 +681,11 @@ namespace lvr2 {
             kd_tree->insert(right, vH3);
             kd_tree->insert(back, vH4);
         }
+
+        m_vertexIndex.insert(vH1, top);
+        m_vertexIndex.insert(vH2, left);
+        m_vertexIndex.insert(vH3, right);
+        m_vertexIndex.insert(vH4, back);
     }
 
 
@@ -751,6 +833,12 @@ namespace lvr2 {
         {
             m_mesh->removeFace(face);
         }
+
+        //removing the faces also removes vertices left without faces
+        if(!m_mesh->containsVertex(vH))
+        {
+            m_vertexIndex.remove(vH);
+        }
     }
 
     /**
@@ -40,52 +40,156 @@
 #include "lvr2/io/PointBuffer.hpp"
 #include "lvr2/io/Timestamp.hpp"
 
+#include <cstdint>
 #include <vector>
 
 namespace lvr2
 {
 
+/**
+ * @brief Selects the point that represents a voxel after the reduction
+ */
+enum class VoxelReductionPolicy
+{
+    /// The first point of the voxel in Morton order. Cheapest policy.
+    FIRST,
+    /// The centroid of the voxel's points. Other channels are taken from
+    /// the point closest to the centroid.
+    CENTROID,
+    /// The point closest to the center of the voxel
+    CLOSEST_TO_CENTER
+};
+
+/**
+ * @brief Reduces a point cloud to (at most) one point per voxel of a regular grid.
+ *
+ * The points are sorted by the Morton code of their voxel: a first radix
+ * pass distributes them to buckets by the upper 16 code bits, then every
+ * bucket is sorted with an in-place MSD radix sort on its own. Equal codes
+ * are adjacent afterwards, and a single linear pass picks one representative
+ * per voxel. Voxels that contain at most minPointsPerVoxel points are kept
+ * completely. PointBuffers are not modified, only their point indices are
+ * sorted. Raw point arrays are sorted and compacted in place.
+ */
 class OctreeReduction
 {
 public:
-    OctreeReduction(PointBufferPtr& pointBuffer, const double& voxelSize, const size_t& minPointsPerVoxel);
-    OctreeReduction(Vector3f* points, const size_t& n, const double& voxelSize, const size_t& minPointsPerVoxel);
-
+    /**
+     * @brief Reduces the given point buffer. All channels of the buffer
+     *        are carried over to the reduced points, see getReducedPoints().
+     *
+     * @param pointBuffer       The point cloud. It is not modified.
+     * @param voxelSize         The edge length of the voxels
+     * @param minPointsPerVoxel Voxels with at most this many points are not reduced
+     * @param policy            Selects the representative of each voxel
+     */
+    OctreeReduction(
+        PointBufferPtr& pointBuffer,
+        const double& voxelSize,
+        const size_t& minPointsPerVoxel,
+        VoxelReductionPolicy policy = VoxelReductionPolicy::CLOSEST_TO_CENTER);
+
+    /**
+     * @brief Reduces the given points in place. The reduced points are
+     *        stored at the front of the array, see getReducedPoints(size_t&).
+     *
+     * @param points            The point cloud, reordered by the reduction
+     * @param n                 The number of points
+     * @param voxelSize         The edge length of the voxels
+     * @param minPointsPerVoxel Voxels with at most this many points are not reduced
+     * @param policy            Selects the representative of each voxel
+     */
+    OctreeReduction(
+        Vector3f* points,
+        const size_t& n,
+        const double& voxelSize,
+        const size_t& minPointsPerVoxel,
+        VoxelReductionPolicy policy = VoxelReductionPolicy::CLOSEST_TO_CENTER);
+
+    /// Returns a new buffer with the reduced points and all their channels
     PointBufferPtr getReducedPoints();
-    void getReducedPoints(Vector3f& points, size_t& n);
 
-    ~OctreeReduction() { delete[] m_flags;}
+    /// Returns the array passed to the constructor and the number of reduced points at its front
+    Vector3f* getReducedPoints(size_t& n);
 
 private:
-    template<typename T>
-    void createOctree(T* points, const int& n, bool* flagged, const T& min, const T& max, const int& level);
-
-    template<typename T>
-    size_t splitPoints(T* points, const size_t& n, const int axis, const double& splitValue);
-
-    template<typename T>
-    void createOctree(lvr2::PointBufferPtr& points, size_t s, size_t n, bool* flagged, const lvr2::Vector3<T>& min, const lvr2::Vector3<T>& max, const int& level);
-
-    template<typename T>
-    size_t splitPoints(lvr2::PointBufferPtr& points, size_t s, size_t n, const int axis, const double& splitValue);
-
-    template<typename T>
-    void swapAllChannelsOfType(lvr2::PointBufferPtr& points, const size_t& l, const size_t& r);
-
-    template<typename T>
-    void swapInChannel(lvr2::Channel<T>& ch, const size_t& l, const size_t& r);
-
-    double  m_voxelSize;
-    size_t  m_minPointsPerVoxel;
-    size_t  m_numPoints; 
-    bool*   m_flags;
-
-    PointBufferPtr  m_pointBuffer;
-    Vector3f        m_points;
+    /// A Morton code together with the index of its point in a bucket
+    struct BucketRecord
+    {
+        uint32_t code[2];
+        uint32_t index;
+    };
+
+    /// Sets up the voxel grid for the given bounding box
+    void initGrid(const Vector3f& min, const Vector3f& max);
+
+    /// Morton code of the voxel that contains the point
+    uint64_t mortonCode(const Vector3f& point) const;
+
+    /// Center of the voxel that contains the point
+    Vector3f voxelCenter(const Vector3f& point) const;
+
+    /**
+     * @brief Sorts records by their Morton code, most significant byte
+     *        first and in place.
+     *
+     * @param codeOf    Functor that returns the Morton code of a record
+     * @param shift     Bit offset of the current digit
+     */
+    template<typename R, typename CodeFunc>
+    void radixSort(R* records, size_t n, const CodeFunc& codeOf, int shift);
+
+    /**
+     * @brief Sorts the points of one bucket and picks the representatives of its voxels.
+     *
+     * @param n         The number of points in the bucket
+     * @param pointAt   Functor that returns the i-th point of the bucket
+     * @param records   Scratch space. Its first entries hold the local indices
+     *                  of the kept points afterwards.
+     * @param centroids Receives the centroid of each kept point if the policy is CENTROID
+     *
+     * @return The number of kept points
+     */
+    template<typename PointFunc>
+    size_t reduceBucket(
+        size_t n,
+        const PointFunc& pointAt,
+        std::vector<BucketRecord>& records,
+        std::vector<Vector3f>& centroids);
+
+    /// Reduces an interleaved xyz array through point indices of the given type
+    template<typename IndexT>
+    void reduceBuffer(const float* points, size_t n);
+
+    /// Reduces a point array in place
+    void reducePoints(Vector3f* points, size_t n);
+
+    double                  m_voxelSize;
+    size_t                  m_minPointsPerVoxel;
+    VoxelReductionPolicy    m_policy;
+
+    /// Lower corner and inverse voxel size of the grid
+    Vector3f                m_min;
+    double                  m_invVoxelSize;
+
+    /// Largest valid voxel index per axis
+    uint32_t                m_maxCell;
+
+    /// The points are first distributed to buckets by the upper
+    /// m_bucketBits bits of their code, which start at m_bucketShift
+    int                     m_bucketShift;
+    int                     m_bucketBits;
+
+    PointBufferPtr          m_pointBuffer;
+    std::vector<size_t>     m_reducedIndices;
+    std::vector<Vector3f>   m_centroids;
+
+    Vector3f*               m_points;
+    size_t                  m_numReducedPoints;
 };
 
 } // namespace lvr2
 
 #include "lvr2/registration/OctreeReduction.tcc"
 
-#endif
\ No newline at end of file
+#endif
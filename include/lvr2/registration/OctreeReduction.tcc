@@ -1,245 +1,341 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include <omp.h>
+
 namespace lvr2
 {
 
-template<typename T>
-void OctreeReduction::createOctree(
-    lvr2::PointBufferPtr& points, 
-    size_t startIndex, 
-    size_t pointsInVoxel, 
-    bool* flagged, 
-    const lvr2::Vector3<T>& min, 
-    const lvr2::Vector3<T>& max, const int& level)
+namespace
+{
+
+/// Spreads the lower 21 bits of a so that two zero bits follow each bit
+inline uint64_t spreadBits3(uint64_t a)
+{
+    a &= 0x1fffff;
+    a = (a | a << 32) & 0x1f00000000ffffULL;
+    a = (a | a << 16) & 0x1f0000ff0000ffULL;
+    a = (a | a << 8)  & 0x100f00f00f00f00fULL;
+    a = (a | a << 4)  & 0x10c30c30c30c30c3ULL;
+    a = (a | a << 2)  & 0x1249249249249249ULL;
+    return a;
+}
+
+} // anonymous namespace
+
+inline uint64_t OctreeReduction::mortonCode(const Vector3f& point) const
 {
-    // Stop recursion - not enough points in voxel
-    if (pointsInVoxel <= m_minPointsPerVoxel)
+    uint64_t code = 0;
+    for (int axis = 0; axis < 3; axis++)
     {
-        return;
+        double cell = (point[axis] - m_min[axis]) * m_invVoxelSize;
+        uint32_t c = cell > 0.0 ? std::min(static_cast<uint32_t>(cell), m_maxCell) : 0;
+        code |= spreadBits3(c) << axis;
     }
+    return code;
+}
 
-    // Determine split axis and compute new center
-    int axis = level % 3;
-    Vector3<T> center = (max + min) / 2.0;
+inline Vector3f OctreeReduction::voxelCenter(const Vector3f& point) const
+{
+    Vector3f center;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        double cell = (point[axis] - m_min[axis]) * m_invVoxelSize;
+        uint32_t c = cell > 0.0 ? std::min(static_cast<uint32_t>(cell), m_maxCell) : 0;
+        center[axis] = m_min[axis] + (c + 0.5) * m_voxelSize;
+    }
+    return center;
+}
 
-    typename lvr2::Channel<T>::Optional opt = points->getChannel<T>("points");
-    if(opt)
+template<typename R, typename CodeFunc>
+void OctreeReduction::radixSort(R* records, size_t n, const CodeFunc& codeOf, int shift)
+{
+    // Small ranges: insertion sort on the complete code
+    if (n <= 32)
     {
-        lvr2::Channel<T> point_c = *opt;
-        // Stop recursion if voxel size is below given limit
-        if (max[axis] - min[axis] <= m_voxelSize)
+        uint64_t codes[32];
+        for (size_t i = 0; i < n; i++)
         {
-            // Keep the Point closest to the center
-            int closest = startIndex;
-            double minDist = (Vector3f(point_c[closest][0], point_c[closest][1], point_c[closest][2]) - center).squaredNorm();
-            for (int i = 1; i < pointsInVoxel; i++)
-            {
-                double dist = (Vector3f(point_c[startIndex + i][0], point_c[startIndex + i][1], point_c[startIndex + i][2]) - center).squaredNorm();
-                if (dist < minDist)
-                {
-                    closest = startIndex + i;
-                    minDist = dist;
-                }
-            }
-            // Flag all other Points for deletion
-            for (int i = 0; i < pointsInVoxel; i++)
+            codes[i] = codeOf(records[i]);
+        }
+        for (size_t i = 1; i < n; i++)
+        {
+            R r = records[i];
+            uint64_t code = codes[i];
+            size_t j = i;
+            while (j > 0 && codes[j - 1] > code)
             {
-                size_t pos = startIndex + i;
-                flagged[pos] = pos != closest;
+                records[j] = records[j - 1];
+                codes[j] = codes[j - 1];
+                j--;
             }
-            return;
+            records[j] = r;
+            codes[j] = code;
         }
+        return;
+    }
 
-        // Sort and get new split index
-        int newRight = splitPoints<T>(points, startIndex, pointsInVoxel, axis, center[axis]);
-
-        Vector3<T> lMin = min, lMax = max;
-        Vector3<T> rMin = min, rMax = max;
-
-        lMax[axis] = center[axis];
-        rMin[axis] = center[axis];
+    auto digit = [&](const R& r)
+    {
+        return (codeOf(r) >> shift) & 0xff;
+    };
 
-        size_t numPointsLeft = newRight - startIndex;
-        size_t numPointsRight = (startIndex + pointsInVoxel) - newRight;
+    std::array<size_t, 256> counts;
+    counts.fill(0);
+    for (size_t i = 0; i < n; i++)
+    {
+        counts[digit(records[i])]++;
+    }
 
-        // If number of points in new intervall is higher then
-        // the number of points in the new interval, start recursion
-        if (numPointsLeft > m_minPointsPerVoxel)
-        {
-            #pragma omp task
-            createOctree<T>(points, startIndex, numPointsLeft, flagged, lMin, lMax, level + 1);
-        }
+    std::array<size_t, 256> begin;
+    std::array<size_t, 256> end;
+    size_t offset = 0;
+    for (int d = 0; d < 256; d++)
+    {
+        begin[d] = offset;
+        offset += counts[d];
+        end[d] = offset;
+    }
 
-        if (numPointsRight > m_minPointsPerVoxel)
+    // American flag sort: move every record directly into its bucket
+    std::array<size_t, 256> next = begin;
+    for (int d = 0; d < 256; d++)
+    {
+        while (next[d] < end[d])
         {
-            #pragma omp task
-            createOctree<T>(points, newRight, numPointsRight, flagged, rMin, rMax, level + 1);
+            R r = records[next[d]];
+            size_t rd = digit(r);
+            while (rd != static_cast<size_t>(d))
+            {
+                std::swap(r, records[next[rd]++]);
+                rd = digit(r);
+            }
+            records[next[d]++] = r;
         }
     }
-    else
+
+    if (shift == 0)
     {
-        std::cout << timestamp << "Error: OctreeReduction: Unable to get point channel." << std::endl;
+        return;
     }
-}
 
-template<typename T>
-void OctreeReduction::swapAllChannelsOfType(lvr2::PointBufferPtr& points, const size_t& l, const size_t& r)
-{
-    // Go over all supported channel types and sub-sample
-    std::vector<std::pair<std::string, Channel<T>>> channels;
-    points->getAllChannelsOfType(channels);      
-    for(auto i : channels)
+    for (int d = 0; d < 256; d++)
     {
-        swapInChannel(i.second, l, r);
+        if (counts[d] > 1)
+        {
+            radixSort(records + begin[d], counts[d], codeOf, std::max(0, shift - 8));
+        }
     }
 }
 
-template<typename T>
-void OctreeReduction::swapInChannel(lvr2::Channel<T>& ch, const size_t& l, const size_t& r)
+template<typename PointFunc>
+size_t OctreeReduction::reduceBucket(
+    size_t n,
+    const PointFunc& pointAt,
+    std::vector<BucketRecord>& records,
+    std::vector<Vector3f>& centroids)
 {
-    // std::swap(points[l], points[r]) is not (yet?) compatible with
-    // channels. Using manual swap...
-    size_t w = ch.width();
+    records.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t code = mortonCode(pointAt(i));
+        records[i].code[0] = static_cast<uint32_t>(code);
+        records[i].code[1] = static_cast<uint32_t>(code >> 32);
+        records[i].index = static_cast<uint32_t>(i);
+    }
 
-    T* tmp = new T[w];
-    for(size_t i = 0; i < w; i++)
+    auto codeOf = [](const BucketRecord& r)
     {
-        tmp[i] = ch[l][i];
+        return (static_cast<uint64_t>(r.code[1]) << 32) | r.code[0];
+    };
 
-        ch[l][i] = ch[r][i];
-        ch[r][i] = tmp[i];
+    // The upper bits are equal within a bucket
+    if (m_bucketShift > 0)
+    {
+        radixSort(records.data(), n, codeOf, std::max(0, m_bucketShift - 8));
     }
-    delete[] tmp;
- }
 
-template<typename T>
-size_t OctreeReduction::splitPoints(
-    PointBufferPtr& points, 
-    size_t startIndex, 
-    size_t numPoints, 
-    const int axis, 
-    const double& splitValue)
-{
-    size_t l = startIndex;
-    size_t r = startIndex + numPoints - 1;
-
-    // Should be safe since we checked the optional in create octree
-    lvr2::Channel<T> point_c = points->get<T>("points");
-   
-    while (l < r)
+    // Linear pass over the sorted codes, the kept records are moved to the front
+    bool keepCentroids = m_policy == VoxelReductionPolicy::CENTROID;
+    size_t out = 0;
+    size_t i = 0;
+    while (i < n)
     {
-        while (l < r && point_c[l][axis] < splitValue)
+        uint64_t code = codeOf(records[i]);
+        size_t voxelEnd = i + 1;
+        while (voxelEnd < n && codeOf(records[voxelEnd]) == code)
         {
-            ++l;
+            voxelEnd++;
         }
-        while (r > l && point_c[r][axis] >= splitValue)
+
+        if (voxelEnd - i <= m_minPointsPerVoxel)
         {
-            --r;
+            // Sparse voxel: keep all points
+            for (size_t j = i; j < voxelEnd; j++)
+            {
+                records[out] = records[j];
+                if (keepCentroids)
+                {
+                    centroids.push_back(pointAt(records[out].index));
+                }
+                out++;
+            }
         }
-        if (l < r)
+        else
         {
-            // // std::swap(points[l], points[r]) is not (yet?) compatible with 
-            // // channels. Using manual swap...
-            // Vector3f tmp(points[l][0], points[l][1], points[l][2]);
-            // points[l][0] = points[r][0];
-            // points[l][1] = points[r][1];
-            // points[l][2] = points[r][2];
-
-            // points[r][0] = tmp[0];
-            // points[r][1] = tmp[1];
-            // points[r][2] = tmp[2];
-
-            // Swap elements in all channels 
-
-            swapAllChannelsOfType<char>(points, l, r);
-            swapAllChannelsOfType<unsigned char>(points, l, r);
-            swapAllChannelsOfType<short>(points, l, r);
-            swapAllChannelsOfType<int>(points, l, r);
-            swapAllChannelsOfType<unsigned int>(points, l, r);
-            swapAllChannelsOfType<float>(points, l, r);
-            swapAllChannelsOfType<double>(points, l, r);
+            size_t rep = i;
+            if (m_policy != VoxelReductionPolicy::FIRST)
+            {
+                Vector3f target;
+                if (keepCentroids)
+                {
+                    Vector3d sum = Vector3d::Zero();
+                    for (size_t j = i; j < voxelEnd; j++)
+                    {
+                        sum += pointAt(records[j].index).template cast<double>();
+                    }
+                    target = (sum / (voxelEnd - i)).template cast<float>();
+                    centroids.push_back(target);
+                }
+                else
+                {
+                    target = voxelCenter(pointAt(records[i].index));
+                }
 
+                float minDist = std::numeric_limits<float>::max();
+                for (size_t j = i; j < voxelEnd; j++)
+                {
+                    float dist = (pointAt(records[j].index) - target).squaredNorm();
+                    if (dist < minDist)
+                    {
+                        minDist = dist;
+                        rep = j;
+                    }
+                }
+            }
+            records[out++] = records[rep];
         }
+        i = voxelEnd;
     }
-
-    return l;
+    return out;
 }
 
-template<typename T>
-size_t OctreeReduction::splitPoints(T* points, const size_t& n, const int axis, const double& splitValue)
+template<typename IndexT>
+void OctreeReduction::reduceBuffer(const float* points, size_t n)
 {
-    size_t l = 0, r = n - 1;
+    auto pointAt = [points](size_t i)
+    {
+        return Vector3f(points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+    };
+
+    // Counting sort of the point indices by the upper code bits. Stable and parallel.
+    size_t numBuckets = size_t(1) << m_bucketBits;
+    int numThreads = omp_get_max_threads();
+    std::vector<size_t> offsets(numBuckets * numThreads, 0);
 
-    while (l < r)
+    #pragma omp parallel num_threads(numThreads)
     {
-        while (l < r && points[l][axis] < splitValue)
-        {
-            ++l;
-        }
-        while (r > l && points[r][axis] >= splitValue)
+        size_t* local = offsets.data() + omp_get_thread_num() * numBuckets;
+
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < n; i++)
         {
-            --r;
+            local[mortonCode(pointAt(i)) >> m_bucketShift]++;
         }
-        if (l < r)
+    }
+
+    // Exclusive prefix sum in (bucket, thread) order
+    std::vector<size_t> bucketBegin(numBuckets + 1);
+    size_t sum = 0;
+    for (size_t b = 0; b < numBuckets; b++)
+    {
+        bucketBegin[b] = sum;
+        for (int t = 0; t < numThreads; t++)
         {
-            std::swap(points[l], points[r]);
+            size_t count = offsets[t * numBuckets + b];
+            offsets[t * numBuckets + b] = sum;
+            sum += count;
         }
     }
+    bucketBegin[numBuckets] = n;
 
-    return l;
-}
-
-template<typename T>
-void OctreeReduction::createOctree(T* points, const int& n, bool* flagged, const T& min, const T& max, const int& level)
-{
-    if (n <= m_minPointsPerVoxel)
+    std::vector<IndexT> indices(n);
+    #pragma omp parallel num_threads(numThreads)
     {
-        return;
+        size_t* local = offsets.data() + omp_get_thread_num() * numBuckets;
+
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < n; i++)
+        {
+            indices[local[mortonCode(pointAt(i)) >> m_bucketShift]++] = static_cast<IndexT>(i);
+        }
     }
+    std::vector<size_t>().swap(offsets);
 
-    int axis = level % 3;
-    T center = (max + min) / 2.0;
+    // Reduce every bucket, its kept indices are moved to its front
+    std::vector<size_t> numKept(numBuckets, 0);
+    std::vector<std::vector<Vector3f>> bucketCentroids(
+        m_policy == VoxelReductionPolicy::CENTROID ? numBuckets : 0);
 
-    if (max[axis] - min[axis] <= m_voxelSize)
+    #pragma omp parallel
     {
-        // keep the Point closest to the center
-        int closest = 0;
-        double minDist = (points[closest] - center).squaredNorm();
-        for (int i = 1; i < n; i++)
+        std::vector<BucketRecord> records;
+        std::vector<Vector3f> centroids;
+        std::vector<IndexT> kept;
+
+        #pragma omp for schedule(dynamic, 16)
+        for (size_t b = 0; b < numBuckets; b++)
         {
-            double dist = (points[i] - center).squaredNorm();
-            if (dist < minDist)
+            IndexT* bucket = indices.data() + bucketBegin[b];
+            size_t count = bucketBegin[b + 1] - bucketBegin[b];
+            if (count == 0)
             {
-                closest = i;
-                minDist = dist;
+                continue;
             }
-        }
-        // flag all other Points for deletion
-        for (int i = 0; i < n; i++)
-        {
-            flagged[i] = i != closest;
-        }
-        return;
-    }
 
-    int l = splitPoints(points, n, axis, center[axis]);
+            centroids.clear();
+            numKept[b] = reduceBucket(count, [&](size_t i) { return pointAt(bucket[i]); }, records, centroids);
 
-    T lMin = min, lMax = max;
-    T rMin = min, rMax = max;
+            kept.resize(numKept[b]);
+            for (size_t i = 0; i < numKept[b]; i++)
+            {
+                kept[i] = bucket[records[i].index];
+            }
+            std::copy(kept.begin(), kept.end(), bucket);
 
-    lMax[axis] = center[axis];
-    rMin[axis] = center[axis];
+            if (!bucketCentroids.empty())
+            {
+                bucketCentroids[b].swap(centroids);
+            }
+        }
+    }
 
-    if (l > m_minPointsPerVoxel)
+    // Gather the kept indices of all buckets
+    std::vector<size_t> keptBegin(numBuckets + 1, 0);
+    for (size_t b = 0; b < numBuckets; b++)
     {
-        #pragma omp task
-        createOctree<T>(points    , l    , flagged    , lMin, lMax, level + 1);
+        keptBegin[b + 1] = keptBegin[b] + numKept[b];
     }
 
-    if (n - l > m_minPointsPerVoxel)
+    m_reducedIndices.resize(keptBegin[numBuckets]);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (size_t b = 0; b < numBuckets; b++)
     {
-        #pragma omp task
-        createOctree<T>(points + l, n - l, flagged + l, rMin, rMax, level + 1);
+        std::copy(indices.begin() + bucketBegin[b],
+                  indices.begin() + bucketBegin[b] + numKept[b],
+                  m_reducedIndices.begin() + keptBegin[b]);
     }
-}
 
+    if (!bucketCentroids.empty())
+    {
+        m_centroids.reserve(m_reducedIndices.size());
+        for (auto& c : bucketCentroids)
+        {
+            m_centroids.insert(m_centroids.end(), c.begin(), c.end());
+            std::vector<Vector3f>().swap(c);
+        }
+    }
+}
 
-} // namespace lvr2
\ No newline at end of file
+} // namespace lvr2
@@ -41,6 +41,8 @@
 
 #include <Eigen/Dense>
 
+#include <algorithm>
+
 namespace lvr2
 {
 
@@ -117,6 +119,17 @@ void transformAndReducePointCloud(ModelPtr& model, int modulo, const CoordinateT
 template<typename T>
 void transformPointCloud(ModelPtr model, const Transform<T>& transformation);
 
+/**
+ * @brief   Transforms an interleaved xyz float array in place. The points are
+ *          processed in parallel blocks of 3 x n matrices, the computation is
+ *          done in the precision of the transformation.
+ * @param   points          Interleaved point coordinates
+ * @param   numPoints       Number of points in \ref points
+ * @param   transformation  The transformation that is applied
+ */
+template<typename T>
+void transformPoints(float* points, size_t numPoints, const Transform<T>& transformation);
+
 /**
  * @brief   Transforms the given source frame according to the given coordinate
  *          transform struct 
@@ -229,19 +229,26 @@ void transformPointCloud(ModelPtr model, const Transform<T>& transformation)
 
     size_t numPoints = model->m_pointCloud->numPoints();
     floatArr arr = model->m_pointCloud->getPointArray();
+    transformPoints(arr.get(), numPoints, transformation);
+}
 
-    for(int i = 0; i < numPoints; i++)
-    {
-        float x = arr[3 * i];
-        float y = arr[3 * i + 1];
-        float z = arr[3 * i + 2];
+template<typename T>
+void transformPoints(float* points, size_t numPoints, const Transform<T>& transformation)
+{
+    const size_t blockSize = 1024;
+    const size_t numBlocks = (numPoints + blockSize - 1) / blockSize;
+
+    const Eigen::Matrix<T, 3, 3> rotation = transformation.template block<3, 3>(0, 0);
+    const Eigen::Matrix<T, 3, 1> translation = transformation.template block<3, 1>(0, 3);
 
-        Vector4<T> v(x,y,z,1);
-        Vector4<T> tv = transformation * v;
+    #pragma omp parallel for schedule(static)
+    for(size_t i = 0; i < numBlocks; i++)
+    {
+        size_t first = i * blockSize;
+        size_t n = std::min(blockSize, numPoints - first);
 
-        arr[3 * i]     = tv[0];
-        arr[3 * i + 1] = tv[1];
-        arr[3 * i + 2] = tv[2];
+        Eigen::Map<Eigen::Matrix<float, 3, Eigen::Dynamic>> block(points + 3 * first, 3, n);
+        block = ((rotation * block.template cast<T>()).colwise() + translation).template cast<float>();
     }
 }
 
@@ -54,12 +54,12 @@ namespace lvr2
 int splitPoints(Vector3f* points, int n, int axis, double splitValue);
 
 /**
- * @brief Reduces a Point Cloud using an Octree with a minimum Voxel size
+ * @brief Reduces a Point Cloud in place to the Point closest to the center of each Voxel
  *
  * @param points      The Point Cloud
  * @param n           The number of Points in the Point Cloud
- * @param voxelSize   The minimum size of a Voxel
- * @param maxLeafSize When to stop subdividing Voxels
+ * @param voxelSize   The size of a Voxel
+ * @param maxLeafSize Voxels with at most this many Points are not reduced
  *
  * @return int the new number of Points in the Point Cloud
  */
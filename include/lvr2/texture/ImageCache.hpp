@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/**
+ * ImageCache.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#ifndef LVR2_TEXTURE_IMAGECACHE_HPP_
+#define LVR2_TEXTURE_IMAGECACHE_HPP_
+
+#include <boost/filesystem.hpp>
+#include <opencv2/core.hpp>
+
+#include <list>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace lvr2
+{
+
+/**
+ * @class ImageCache
+ * @brief Loads image files on demand and keeps the most recently used ones
+ *        in memory
+ *
+ * Image based texturing may use thousands of high resolution photos, which
+ * can't all be kept in memory at once. This cache loads images when they
+ * are requested and drops the least recently used ones as soon as the
+ * decoded images exceed the memory limit.
+ *
+ * Images are returned as reference counted cv::Mat headers, so an image
+ * which is dropped from the cache stays valid for everyone still using it.
+ * All methods are thread safe. Files are decoded outside of the lock, so
+ * several threads may load different images concurrently.
+ */
+class ImageCache
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param memoryLimit Maximum number of bytes of decoded images kept in
+     *                    memory, 0 for no limit
+     */
+    ImageCache(size_t memoryLimit = 0);
+
+    /**
+     * @brief Sets the maximum number of bytes of decoded images kept in
+     *        memory, 0 for no limit
+     */
+    void setMemoryLimit(size_t memoryLimit);
+
+    size_t getMemoryLimit() const;
+
+    /**
+     * @brief Registers an image file without loading it
+     *
+     * @return The id of the image
+     */
+    size_t addFile(const boost::filesystem::path& file);
+
+    /**
+     * @brief Returns the image with the given id, loads it if it is not in
+     *        memory
+     *
+     * @return The image as 8 bit BGR, or an empty matrix if the file could
+     *         not be read
+     */
+    cv::Mat get(size_t id);
+
+    /**
+     * @brief Determines the size of an image without decoding it
+     *
+     * The size is read from the file header of JPEG, PNG, BMP and PNM
+     * files. The EXIF orientation of JPEG files is taken into account the
+     * same way cv::imread applies it. Files in other formats are decoded
+     * once and kept in the cache. When an image is decoded later on, a
+     * warning is printed if its size differs from the one in the header.
+     *
+     * @return false if the file could not be read
+     */
+    bool imageSize(size_t id, int& rows, int& cols);
+
+    /// Number of registered images
+    size_t size() const;
+
+    /// Number of bytes of decoded images currently kept in memory
+    size_t memoryUsage() const;
+
+    /// Number of times an image file was decoded
+    size_t numLoads() const;
+
+private:
+
+    /// Inserts an image, the mutex has to be locked
+    void insert(size_t id, const cv::Mat& image);
+
+    /// Drops least recently used images until the limit is met, the mutex
+    /// has to be locked
+    void shrink();
+
+    /// Registered files
+    std::vector<boost::filesystem::path> m_files;
+
+    /// Decoded images, empty if not in memory
+    std::vector<cv::Mat> m_images;
+
+    /// Rows and columns read from the file headers, 0 if unknown. Used to
+    /// check the header parsers against the decoder.
+    std::vector<std::pair<int, int>> m_headerSizes;
+
+    /// Ids of the images in memory, the most recently used first
+    std::list<size_t> m_lru;
+
+    /// Position of each image in m_lru
+    std::vector<std::list<size_t>::iterator> m_lruPos;
+
+    size_t m_memoryLimit;
+    size_t m_memoryUsage;
+    size_t m_numLoads;
+
+    mutable std::mutex m_mutex;
+};
+
+} // namespace lvr2
+
+#endif /* LVR2_TEXTURE_IMAGECACHE_HPP_ */
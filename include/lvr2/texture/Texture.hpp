@@ -83,7 +83,7 @@ public:
     /**
      * @brief Constructor
      */
-    Texture(Texture&& other);
+    Texture(Texture&& other) noexcept;
 
     /**
      * @brief Constructor
@@ -92,6 +92,8 @@ public:
 
     Texture & operator=(const Texture &other);
 
+    Texture & operator=(Texture &&other) noexcept;
+
     /**
      * @brief Destructor
      */
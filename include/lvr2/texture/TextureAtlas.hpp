@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * TextureAtlas.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#ifndef LVR2_TEXTURE_TEXTUREATLAS_HPP_
+#define LVR2_TEXTURE_TEXTUREATLAS_HPP_
+
+#include "lvr2/io/MeshBuffer.hpp"
+#include "lvr2/texture/Texture.hpp"
+
+#include <vector>
+
+namespace lvr2
+{
+
+/**
+ * @class TextureAtlas
+ * @brief Packs the textures of a mesh buffer into a few large atlas pages
+ *
+ * The texturizer creates one small texture per planar cluster. For large
+ * meshes this results in tens of thousands of textures that are slow to
+ * write, load and render. This class bin-packs these textures into pages
+ * of a fixed maximum size (shelf packing, largest textures first), rewrites
+ * the texture coordinates of all affected vertices and replaces the
+ * texture materials with one material per page.
+ *
+ * Every vertex is expected to belong to faces of a single texture, which
+ * is the case for buffers created by the TextureFinalizer.
+ */
+class TextureAtlas
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param pageSize  Maximum edge length of an atlas page in texels.
+     *                  Textures that are larger get a page of their own.
+     *                  If a texture plus its padding exceeds 65535
+     *                  texels, no atlas is generated.
+     * @param padding   Number of texels that are replicated around each
+     *                  texture to prevent colors from bleeding between
+     *                  neighboring textures when filtering
+     */
+    TextureAtlas(unsigned short pageSize = 4096, unsigned short padding = 2);
+
+    /**
+     * @brief Limits the memory that is used for composing pages
+     *
+     * Pages are composed in parallel. With a memory limit, only as many
+     * pages are composed at once as fit into the given budget. The source
+     * textures of a page are released as soon as the page is complete.
+     *
+     * @param bytes Memory budget in bytes (0 = no limit)
+     */
+    void setMemoryLimit(size_t bytes);
+
+    /**
+     * @brief Packs the textures of the given buffer into atlas pages
+     *
+     * Textures, materials, face material indices, cluster material indices
+     * and texture coordinates of the buffer are replaced. Color materials
+     * are kept (in their original order) in front of the page materials.
+     *
+     * @param buffer The mesh buffer
+     *
+     * @return The number of created pages
+     */
+    size_t apply(MeshBuffer& buffer) const;
+
+private:
+
+    /// Position of a packed texture
+    struct Placement
+    {
+        /// Index of the page
+        size_t page;
+        /// Upper left corner of the padded texture in the page
+        size_t x, y;
+    };
+
+    /**
+     * @brief Computes positions for all textures
+     *
+     * @param textures   The textures
+     * @param pageWidth  Used width of each page
+     * @param pageHeight Used height of each page
+     *
+     * @return One placement per texture
+     */
+    std::vector<Placement> pack(
+        const std::vector<Texture>& textures,
+        std::vector<size_t>& pageWidth,
+        std::vector<size_t>& pageHeight
+    ) const;
+
+    /// Maximum edge length of a page
+    unsigned short m_pageSize;
+
+    /// Padding around each texture
+    unsigned short m_padding;
+
+    /// Memory budget for page composition (0 = no limit)
+    size_t m_memoryLimit;
+};
+
+} // namespace lvr2
+
+#endif /* LVR2_TEXTURE_TEXTUREATLAS_HPP_ */
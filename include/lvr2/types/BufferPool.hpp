@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#pragma once
+
+#ifndef LVR2_TYPES_BUFFERPOOL
+#define LVR2_TYPES_BUFFERPOOL
+
+#include <boost/shared_array.hpp>
+
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace lvr2 {
+
+/**
+ * @brief Allocation counters of a BufferPool
+ */
+struct BufferPoolStats
+{
+    /// Number of allocate() calls
+    size_t allocations = 0;
+
+    /// Number of allocations served from the pool
+    size_t poolHits = 0;
+
+    /// Number of blocks requested from the system
+    size_t systemAllocations = 0;
+
+    /// Number of blocks allocated with huge page advice
+    size_t hugePageAllocations = 0;
+
+    /// Bytes currently handed out
+    size_t liveBytes = 0;
+
+    /// Maximum of liveBytes
+    size_t peakBytes = 0;
+
+    /// Bytes of free blocks kept for reuse
+    size_t pooledBytes = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, const BufferPoolStats& stats);
+
+/**
+ * @brief Allocator for channel and buffer storage.
+ *
+ *        All blocks are aligned to 64 bytes. Blocks of at least
+ *        MinPooledSize bytes are rounded up to size classes (four per
+ *        power of two) and kept in a free list when released, so that
+ *        repeated processing of partitions or chunks of similar size
+ *        reuses memory instead of returning it to the system and faulting
+ *        it in again. The pool holds at most maxPooledBytes of free
+ *        blocks. Optionally, blocks of at least 2 MB are aligned to huge
+ *        pages and marked for transparent huge page backing.
+ *
+ *        The arrays returned by \ref allocateArray() release their block
+ *        to the pool they came from, so pools must outlive their arrays.
+ *        The global pool returned by \ref instance() is never destroyed.
+ */
+class BufferPool
+{
+public:
+    /// Alignment of all blocks
+    static constexpr size_t Alignment = 64;
+
+    /// Smaller blocks are not pooled
+    static constexpr size_t MinPooledSize = 64 * 1024;
+
+    /// Size and alignment of transparent huge pages
+    static constexpr size_t HugePageSize = 2 * 1024 * 1024;
+
+    BufferPool(size_t maxPooledBytes = 512 * 1024 * 1024, bool hugePages = false);
+
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /// The global pool used for Channel storage
+    static BufferPool& instance();
+
+    /// Returns an aligned block of at least the given size
+    void* allocate(size_t bytes);
+
+    /// Releases a block that was allocated with the same size
+    void deallocate(void* ptr, size_t bytes);
+
+    /**
+     * @brief Allocates an uninitialized array of n elements that returns
+     *        its memory to this pool when the last reference is released.
+     *        Types that are not trivial use new[] instead.
+     */
+    template<typename T>
+    boost::shared_array<T> allocateArray(size_t n);
+
+    /// Sets the maximum amount of free memory kept for reuse. 0 disables pooling.
+    void setMaxPooledBytes(size_t bytes);
+
+    /// Enables huge page alignment and advice for large blocks
+    void setHugePages(bool enable);
+
+    /// Returns all pooled blocks to the system
+    void trim();
+
+    BufferPoolStats stats() const;
+
+private:
+    /// Size of the class that a block of the given size is rounded to
+    static size_t sizeClass(size_t bytes);
+
+    void* allocateBlock(size_t bytes);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<size_t, std::vector<void*> > m_freeBlocks;
+    size_t m_maxPooledBytes;
+    bool m_hugePages;
+    BufferPoolStats m_stats;
+};
+
+/**
+ * @brief Allocates an array from the global BufferPool
+ */
+template<typename T>
+boost::shared_array<T> allocateArray(size_t n)
+{
+    return BufferPool::instance().allocateArray<T>(n);
+}
+
+} // namespace lvr2
+
+#include "BufferPool.tcc"
+
+#endif // LVR2_TYPES_BUFFERPOOL
@@ -30,6 +30,7 @@
 #ifndef LVR2_TYPES_CHANNEL
 #define LVR2_TYPES_CHANNEL
 
+#include "BufferPool.hpp"
 #include "ElementProxy.hpp"
 #include <memory>
 #include <boost/optional.hpp>
@@ -38,7 +38,7 @@ Channel<T>::Channel()
 template<typename T>
 Channel<T>::Channel(size_t n, size_t width)
 : m_elementWidth(width), m_numElements(n)
-, m_data(new T[n * width])
+, m_data(allocateArray<T>(n * width))
 {}
 
 template<typename T>
@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#pragma once
+
+#ifndef LVR2_TYPES_CHANNELVIEW
+#define LVR2_TYPES_CHANNELVIEW
+
+#include "Channel.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace lvr2 {
+
+/// Shared list of element indices used to select from channel views
+using ChannelIndicesPtr = std::shared_ptr<const std::vector<size_t> >;
+
+/**
+ * @brief Copies the elements src[ids[i]] to dst[i] for all i < n. Each
+ *        element consists of width values. The copy is parallelized and
+ *        the inner loop is unrolled for the common widths 1 to 4.
+ */
+template<typename T, typename IndexFunc>
+void gatherElements(const T* src, size_t width, size_t n, IndexFunc ids, T* dst);
+
+/**
+ * @brief A read-only view on a subset of the elements of a Channel.
+ *
+ *        The view shares ownership of the channel's array and selects
+ *        elements either by a stride (offset + i * stride) or by an index
+ *        list. Views can be sliced and filtered again without copying
+ *        channel data: slicing only changes offset and stride, selecting
+ *        from a view composes the index lists. Data is copied only when
+ *        the view is turned into a Channel with \ref materialize() or
+ *        \ref writable().
+ */
+template<typename T>
+class ChannelView
+{
+public:
+    using DataType = T;
+    using DataPtr = typename Channel<T>::DataPtr;
+    using Indices = std::vector<size_t>;
+    using IndicesPtr = ChannelIndicesPtr;
+
+    ChannelView();
+
+    /// View on all elements of the given channel
+    ChannelView(const Channel<T>& channel);
+
+    size_t numElements() const;
+    size_t width() const;
+
+    /// Index of the idx-th view element in the underlying channel
+    size_t baseIndex(size_t idx) const;
+
+    const ElementProxy<T> operator[](size_t idx) const;
+
+    /**
+     * @brief Returns a view on the elements begin, begin + step, ... < end
+     *        of this view.
+     */
+    ChannelView<T> slice(size_t begin, size_t end, size_t step = 1) const;
+
+    /**
+     * @brief Returns a view on the elements of this view with the given
+     *        indices. The index list is shared, not copied.
+     */
+    ChannelView<T> select(IndicesPtr indices) const;
+
+    /// Returns a view on the elements i of this view with filter[i] == true
+    ChannelView<T> select(const std::vector<bool>& filter) const;
+
+    /// True if the view covers the complete underlying channel in order
+    bool isIdentity() const;
+
+    /**
+     * @brief Returns the view as a Channel. A view on the complete channel
+     *        returns the channel itself without copying, otherwise the
+     *        selected elements are gathered into a new array.
+     */
+    Channel<T> materialize() const;
+
+    /**
+     * @brief Returns a Channel that can be modified without affecting
+     *        other owners of the underlying array (copy on write). The
+     *        array is only reused if this view covers all of it and holds
+     *        the last reference to it. In that case the view is left
+     *        empty.
+     */
+    Channel<T> writable();
+
+private:
+    DataPtr     m_data;
+    size_t      m_baseElements;
+    size_t      m_width;
+    size_t      m_numElements;
+
+    /// Position of element i is m_offset + i * m_stride, either directly
+    /// in the channel or in m_indices if an index list is set
+    size_t      m_offset;
+    size_t      m_stride;
+    IndicesPtr  m_indices;
+};
+
+using FloatChannelView = ChannelView<float>;
+using UCharChannelView = ChannelView<unsigned char>;
+using IndexChannelView = ChannelView<unsigned int>;
+
+} // namespace lvr2
+
+#include "ChannelView.tcc"
+
+#endif // LVR2_TYPES_CHANNELVIEW
@@ -0,0 +1,232 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <algorithm>
+#include <cstring>
+
+namespace lvr2 {
+
+namespace detail {
+
+template<typename T, size_t W, typename IndexFunc>
+void gatherFixedWidth(const T* src, size_t n, IndexFunc ids, T* dst)
+{
+    #pragma omp parallel for schedule(static) if(n > 65536)
+    for (size_t i = 0; i < n; i++)
+    {
+        const T* s = src + ids(i) * W;
+        T* d = dst + i * W;
+        for (size_t j = 0; j < W; j++)
+        {
+            d[j] = s[j];
+        }
+    }
+}
+
+} // namespace detail
+
+template<typename T, typename IndexFunc>
+void gatherElements(const T* src, size_t width, size_t n, IndexFunc ids, T* dst)
+{
+    switch (width)
+    {
+    case 1: detail::gatherFixedWidth<T, 1>(src, n, ids, dst); return;
+    case 2: detail::gatherFixedWidth<T, 2>(src, n, ids, dst); return;
+    case 3: detail::gatherFixedWidth<T, 3>(src, n, ids, dst); return;
+    case 4: detail::gatherFixedWidth<T, 4>(src, n, ids, dst); return;
+    default: break;
+    }
+
+    #pragma omp parallel for schedule(static) if(n > 65536)
+    for (size_t i = 0; i < n; i++)
+    {
+        std::copy_n(src + ids(i) * width, width, dst + i * width);
+    }
+}
+
+template<typename T>
+ChannelView<T>::ChannelView()
+: m_baseElements(0)
+, m_width(0)
+, m_numElements(0)
+, m_offset(0)
+, m_stride(1)
+{}
+
+template<typename T>
+ChannelView<T>::ChannelView(const Channel<T>& channel)
+: m_data(channel.dataPtr())
+, m_baseElements(channel.numElements())
+, m_width(channel.width())
+, m_numElements(channel.numElements())
+, m_offset(0)
+, m_stride(1)
+{}
+
+template<typename T>
+size_t ChannelView<T>::numElements() const
+{
+    return m_numElements;
+}
+
+template<typename T>
+size_t ChannelView<T>::width() const
+{
+    return m_width;
+}
+
+template<typename T>
+size_t ChannelView<T>::baseIndex(size_t idx) const
+{
+    size_t pos = m_offset + idx * m_stride;
+    return m_indices ? (*m_indices)[pos] : pos;
+}
+
+template<typename T>
+const ElementProxy<T> ChannelView<T>::operator[](size_t idx) const
+{
+    return ElementProxy<T>(m_data.get() + baseIndex(idx) * m_width, m_width);
+}
+
+template<typename T>
+ChannelView<T> ChannelView<T>::slice(size_t begin, size_t end, size_t step) const
+{
+    end = std::min(end, m_numElements);
+    step = std::max<size_t>(step, 1);
+
+    ChannelView<T> ret(*this);
+    ret.m_offset = m_offset + begin * m_stride;
+    ret.m_stride = m_stride * step;
+    ret.m_numElements = begin < end ? (end - begin + step - 1) / step : 0;
+    return ret;
+}
+
+template<typename T>
+ChannelView<T> ChannelView<T>::select(IndicesPtr indices) const
+{
+    ChannelView<T> ret(*this);
+    ret.m_offset = 0;
+    ret.m_stride = 1;
+    ret.m_numElements = indices->size();
+
+    if (!m_indices && m_offset == 0 && m_stride == 1)
+    {
+        // Indices refer to the channel directly
+        ret.m_indices = indices;
+    }
+    else
+    {
+        // Compose with the selection of this view
+        std::shared_ptr<Indices> composed(new Indices(indices->size()));
+        const Indices& in = *indices;
+        Indices& out = *composed;
+
+        #pragma omp parallel for schedule(static) if(out.size() > 65536)
+        for (size_t i = 0; i < out.size(); i++)
+        {
+            out[i] = baseIndex(in[i]);
+        }
+        ret.m_indices = composed;
+    }
+    return ret;
+}
+
+template<typename T>
+ChannelView<T> ChannelView<T>::select(const std::vector<bool>& filter) const
+{
+    size_t n = std::min(filter.size(), m_numElements);
+    std::shared_ptr<Indices> indices(new Indices);
+    indices->reserve(std::count(filter.begin(), filter.begin() + n, true));
+    for (size_t i = 0; i < n; i++)
+    {
+        if (filter[i])
+        {
+            indices->push_back(i);
+        }
+    }
+    return select(IndicesPtr(indices));
+}
+
+template<typename T>
+bool ChannelView<T>::isIdentity() const
+{
+    return !m_indices && m_offset == 0 && m_stride == 1 && m_numElements == m_baseElements;
+}
+
+template<typename T>
+Channel<T> ChannelView<T>::materialize() const
+{
+    if (isIdentity())
+    {
+        return Channel<T>(m_numElements, m_width, m_data);
+    }
+
+    Channel<T> ret(m_numElements, m_width);
+    const T* src = m_data.get();
+    T* dst = ret.dataPtr().get();
+
+    if (!m_indices && m_stride == 1)
+    {
+        std::memcpy(dst, src + m_offset * m_width, sizeof(T) * m_numElements * m_width);
+    }
+    else if (m_indices)
+    {
+        const size_t* ids = m_indices->data() + m_offset;
+        const size_t stride = m_stride;
+        gatherElements(src, m_width, m_numElements,
+                       [ids, stride](size_t i) { return ids[i * stride]; }, dst);
+    }
+    else
+    {
+        const size_t offset = m_offset;
+        const size_t stride = m_stride;
+        gatherElements(src, m_width, m_numElements,
+                       [offset, stride](size_t i) { return offset + i * stride; }, dst);
+    }
+    return ret;
+}
+
+template<typename T>
+Channel<T> ChannelView<T>::writable()
+{
+    if (!isIdentity())
+    {
+        // Gathering already creates a private copy
+        return materialize();
+    }
+
+    Channel<T> ret(m_numElements, m_width, m_data);
+    if (m_data.use_count() == 2)
+    {
+        *this = ChannelView<T>();
+        return ret;
+    }
+    return ret.clone();
+}
+
+} // namespace lvr2
@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#pragma once
+
+#ifndef LVR2_TYPES_VARIANTCHANNELVIEW
+#define LVR2_TYPES_VARIANTCHANNELVIEW
+
+#include <boost/variant.hpp>
+
+#include "ChannelView.hpp"
+#include "VariantChannel.hpp"
+
+namespace lvr2 {
+
+/**
+ * @brief A ChannelView over a VariantChannel. Slicing and selecting
+ *        share the underlying array of the active channel type, see
+ *        \ref ChannelView.
+ */
+template<typename... T>
+class VariantChannelView : public boost::variant<ChannelView<T>...>
+{
+    using base = boost::variant<ChannelView<T>...>;
+    using base::base;
+public:
+    using IndicesPtr = ChannelIndicesPtr;
+
+    /// View on all elements of the given channel
+    VariantChannelView(const VariantChannel<T...>& channel);
+
+    size_t numElements() const;
+
+    size_t width() const;
+
+    /**
+     * @brief Get type index of the active channel type
+     */
+    int type() const;
+
+    template<typename U>
+    bool is_type() const;
+
+    template<typename U>
+    const ChannelView<U>& extract() const;
+
+    /// \ref ChannelView::slice()
+    VariantChannelView<T...> slice(size_t begin, size_t end, size_t step = 1) const;
+
+    /// \ref ChannelView::select()
+    VariantChannelView<T...> select(IndicesPtr indices) const;
+
+    /// \ref ChannelView::select()
+    VariantChannelView<T...> select(const std::vector<bool>& filter) const;
+
+    /// \ref ChannelView::materialize()
+    VariantChannel<T...> materialize() const;
+
+// Visitor Implementations
+protected:
+    struct ViewVisitor : public boost::static_visitor<VariantChannelView<T...> >
+    {
+        template<typename U>
+        VariantChannelView<T...> operator()(const Channel<U>& channel) const
+        {
+            return ChannelView<U>(channel);
+        }
+    };
+
+    struct NumElementsVisitor : public boost::static_visitor<size_t>
+    {
+        template<typename U>
+        size_t operator()(const ChannelView<U>& view) const
+        {
+            return view.numElements();
+        }
+    };
+
+    struct WidthVisitor : public boost::static_visitor<size_t>
+    {
+        template<typename U>
+        size_t operator()(const ChannelView<U>& view) const
+        {
+            return view.width();
+        }
+    };
+
+    struct SliceVisitor : public boost::static_visitor<VariantChannelView<T...> >
+    {
+        SliceVisitor(size_t begin, size_t end, size_t step)
+        : m_begin(begin), m_end(end), m_step(step) {}
+
+        template<typename U>
+        VariantChannelView<T...> operator()(const ChannelView<U>& view) const
+        {
+            return view.slice(m_begin, m_end, m_step);
+        }
+
+        size_t m_begin, m_end, m_step;
+    };
+
+    template<typename Selection>
+    struct SelectVisitor : public boost::static_visitor<VariantChannelView<T...> >
+    {
+        SelectVisitor(const Selection& selection) : m_selection(selection) {}
+
+        template<typename U>
+        VariantChannelView<T...> operator()(const ChannelView<U>& view) const
+        {
+            return view.select(m_selection);
+        }
+
+        const Selection& m_selection;
+    };
+
+    struct MaterializeVisitor : public boost::static_visitor<VariantChannel<T...> >
+    {
+        template<typename U>
+        VariantChannel<T...> operator()(const ChannelView<U>& view) const
+        {
+            return view.materialize();
+        }
+    };
+};
+
+/**
+ * @brief Creates a view on all elements of the given channel
+ */
+template<typename... T>
+VariantChannelView<T...> makeChannelView(const VariantChannel<T...>& channel)
+{
+    return VariantChannelView<T...>(channel);
+}
+
+} // namespace lvr2
+
+#include "VariantChannelView.tcc"
+
+#endif // LVR2_TYPES_VARIANTCHANNELVIEW
@@ -155,10 +155,10 @@ public:
      * @return The transformation matrix in riegl coordinate system
      */
     template <typename T>
-    Transform<T> slam6d_to_riegl_transform(const Transform<T> &mat)
+    static Transform<T> slam6d_to_riegl_transform(const Transform<T> &mat)
     {
-        T* in = mat.data();
-        T* ret[16];
+        const T* in = mat.data();
+        T ret[16];
         ret[0] = in[10];
         ret[1] = -in[2];
         ret[2] = in[6];
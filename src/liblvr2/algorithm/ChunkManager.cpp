@@ -38,6 +38,7 @@
 
 #include "lvr2/io/ChunkIO.hpp"
 #include "lvr2/io/ModelFactory.hpp"
+#include "lvr2/types/VariantChannelView.hpp"
 
 #include <algorithm>
 #include <boost/filesystem.hpp>
@@ -367,15 +368,28 @@ MeshBufferPtr ChunkManager::extractArea(const BoundingBox<BaseVector<float>>& ar
         }
     }
 
-    // create a mapping from old vertices to new vertices
-    std::vector<std::size_t> vertexIndexMapping(areaMesh->numVertices(), 0);
-    std::size_t tmpIndex = 0;
-    for (std::size_t i = 0; i < areaMesh->numVertices(); i++)
+    // create a mapping from old vertices to new vertices and collect the
+    // remaining vertices and faces
+    const std::size_t numVerticesBefore = areaMesh->numVertices();
+    const std::size_t numFacesBefore = areaMesh->numFaces();
+    std::vector<std::size_t> vertexIndexMapping(numVerticesBefore, 0);
+    std::shared_ptr<std::vector<std::size_t>> vertexIndices(new std::vector<std::size_t>);
+    std::shared_ptr<std::vector<std::size_t>> faceIndices(new std::vector<std::size_t>);
+    vertexIndices->reserve(numVertices);
+    faceIndices->reserve(numFaces);
+    for (std::size_t i = 0; i < numVerticesBefore; i++)
     {
         if (vertexFilter[i] == true)
         {
-            vertexIndexMapping[i] = tmpIndex;
-            tmpIndex++;
+            vertexIndexMapping[i] = vertexIndices->size();
+            vertexIndices->push_back(i);
+        }
+    }
+    for (std::size_t i = 0; i < numFacesBefore; i++)
+    {
+        if (faceFilter[i] == true)
+        {
+            faceIndices->push_back(i);
         }
     }
 
@@ -386,21 +400,8 @@ MeshBufferPtr ChunkManager::extractArea(const BoundingBox<BaseVector<float>>& ar
         {
 #pragma omp single nowait
             {
-                if (channel.second.is_type<unsigned char>())
-                {
-                    channel.second = applyChannelFilter<unsigned char>(
-                        vertexFilter, faceFilter, numVertices, numFaces, areaMesh, channel.second);
-                }
-                else if (channel.second.is_type<unsigned int>())
-                {
-                    channel.second = applyChannelFilter<unsigned int>(
-                        vertexFilter, faceFilter, numVertices, numFaces, areaMesh, channel.second);
-                }
-                else if (channel.second.is_type<float>())
-                {
-                    channel.second = applyChannelFilter<float>(
-                        vertexFilter, faceFilter, numVertices, numFaces, areaMesh, channel.second);
-                }
+                channel.second = applyChannelFilter(
+                    vertexIndices, faceIndices, numVerticesBefore, numFacesBefore, channel.second);
             }
         }
     }
@@ -418,6 +419,33 @@ MeshBufferPtr ChunkManager::extractArea(const BoundingBox<BaseVector<float>>& ar
     return areaMesh;
 }
 
+MultiChannelMap::val_type
+ChunkManager::applyChannelFilter(ChannelIndicesPtr vertexIndices,
+                                 ChannelIndicesPtr faceIndices,
+                                 const size_t numVertices,
+                                 const size_t numFaces,
+                                 const MultiChannelMap::val_type& originalChannel) const
+{
+    // gather the remaining elements of vertex or face channels, other
+    // channels are kept as they are
+    if (originalChannel.numElements() == numVertices)
+    {
+        if (vertexIndices->size() != numVertices)
+        {
+            return makeChannelView(originalChannel).select(vertexIndices).materialize();
+        }
+    }
+    else if (originalChannel.numElements() == numFaces)
+    {
+        if (faceIndices->size() != numFaces)
+        {
+            return makeChannelView(originalChannel).select(faceIndices).materialize();
+        }
+    }
+
+    return originalChannel;
+}
+
 void ChunkManager::initBoundingBox(MeshBufferPtr mesh)
 {
     FloatChannel vertices = mesh->getFloatChannel("vertices").get();
@@ -638,16 +666,12 @@ BaseVector<float> ChunkManager::getFaceCenter(std::shared_ptr<HalfEdgeMesh<BaseV
 
 std::size_t ChunkManager::getCellIndex(const BaseVector<float>& vec) const
 {
-    BaseVector<float> tmpVec = (vec - m_boundingBox.getMin()) / m_chunkSize;
-    return static_cast<size_t>(tmpVec.x) * m_amount.y * m_amount.z
-           + static_cast<size_t>(tmpVec.y) * m_amount.z + static_cast<size_t>(tmpVec.z);
+    BaseVector<int> cell = getCellCoordinates(vec);
+    return hashValue(cell.x, cell.y, cell.z);
 }
 BaseVector<int> ChunkManager::getCellCoordinates(const BaseVector<float>& vec) const
 {
-    BaseVector<float> tmpVec = (vec - m_boundingBox.getMin()) / m_chunkSize;
-    BaseVector<int> ret      = BaseVector<int>(
-        static_cast<int>(tmpVec.x), static_cast<int>(tmpVec.y), static_cast<int>(tmpVec.z));
-    return ret;
+    return cellCoordinates(vec, m_boundingBox.getMin(), m_chunkSize);
 }
 
 // std::string ChunkManager::getCellName(const BaseVector<float>& vec) const
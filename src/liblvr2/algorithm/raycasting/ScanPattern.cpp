@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * ScanPattern.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/algorithm/raycasting/ScanPattern.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lvr2
+{
+
+namespace
+{
+
+const float DegToRad = static_cast<float>(M_PI / 180.0);
+
+// tolerance for ranges, that are a multiple of the resolution
+const float StepTolerance = 1e-4f;
+
+} // anonymous namespace
+
+ScanPattern ScanPattern::spherical(float hMin, float hMax, float hRes, float vMin, float vMax, float vRes)
+{
+    size_t numColumns = std::max<size_t>(1, static_cast<size_t>(std::floor((hMax - hMin) / hRes + StepTolerance)));
+    size_t numRows = static_cast<size_t>(std::floor(std::max(0.0f, vMax - vMin) / vRes + StepTolerance)) + 1;
+
+    return ScanPattern(hMin * DegToRad, hRes * DegToRad, numColumns, vMin * DegToRad, vRes * DegToRad, numRows);
+}
+
+ScanPattern ScanPattern::line(float fovMin, float fovMax, float res)
+{
+    size_t numRows = static_cast<size_t>(std::floor(std::max(0.0f, fovMax - fovMin) / res + StepTolerance)) + 1;
+
+    return ScanPattern(0.0f, 0.0f, 1, fovMin * DegToRad, res * DegToRad, numRows);
+}
+
+ScanPattern::ScanPattern(float hMin, float hStep, size_t numColumns, float vMin, float vStep, size_t numRows)
+    : m_hMin(hMin)
+    , m_hStep(hStep)
+    , m_numColumns(numColumns)
+    , m_vMin(vMin)
+    , m_vStep(vStep)
+    , m_numRows(numRows)
+{
+
+}
+
+void ScanPattern::direction(size_t i, float* dir) const
+{
+    float azimuth = m_hMin + m_hStep * static_cast<float>(i / m_numRows);
+    float elevation = m_vMin + m_vStep * static_cast<float>(i % m_numRows);
+
+    dir[0] = std::cos(elevation) * std::cos(azimuth);
+    dir[1] = std::cos(elevation) * std::sin(azimuth);
+    dir[2] = std::sin(elevation);
+}
+
+void ScanPattern::directions(size_t first, size_t count, float* dirs) const
+{
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < static_cast<long>(count); i++)
+    {
+        direction(first + i, dirs + 3 * i);
+    }
+}
+
+} // namespace lvr2
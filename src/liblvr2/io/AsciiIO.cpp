@@ -33,14 +33,12 @@
  */
 
 #include <fstream>
-#include <string.h>
 #include <algorithm>
 
-using std::ifstream;
-
 #include <boost/filesystem.hpp>
 
 #include "lvr2/io/AsciiIO.hpp"
+#include "lvr2/io/AsciiParser.hpp"
 #include "lvr2/io/Progress.hpp"
 #include "lvr2/io/Timestamp.hpp"
 
@@ -62,46 +60,21 @@ ModelPtr AsciiIO::read(
         cout << "»" << extension << "« is not a valid file extension." << endl;
         return ModelPtr();
     }
-    // Count lines in file to estimate the number of present points
-    size_t lines_in_file = countLines(filename);
+    MappedFile file(filename);
+    if ( !file.good() )
+    {
+        cout << timestamp << "AsciiIO: Unable to open file '" << filename << "'." << endl;
+        return ModelPtr();
+    }
 
-    if ( lines_in_file < 2 )
+    if ( lvr2::countLines(file) < 2 )
     {
         cout << timestamp << "AsciiIO: Too few lines in file (has to be > 2)." << endl;
         return ModelPtr();
     }
 
-    // Open file
-    ifstream in;
-    in.open(filename.c_str());
-
-    // Read first two lines, ignore the first one
-    char buffer[2048];
-    in.getline(buffer, 2048);
-    in.getline(buffer, 2048);
-
-    // Get number of entries in test line and analize
-    int num_columns  = AsciiIO::getEntriesInLine(filename);
-
-    // Reopen file and read data
-    in.close();
-    in.open(filename.c_str());
-
-    // Again skip first line
-    in.getline(buffer, 2048);
-
-    // Buffer related variables
-    size_t numPoints = 0;
-
-    floatArr points;
-    ucharArr pointColors;
-    floatArr pointIntensities;
-
-    // Alloc memory for points
-    numPoints = lines_in_file - 1;
-    points = floatArr( new float[ numPoints * 3 ] );
-    ModelPtr model(new Model);
-    model->m_pointCloud = PointBufferPtr( new PointBuffer);
+    // Get number of entries in the first data line
+    int num_columns = countEntries(file, 1);
 
     // (Some) sanity checks for given paramters
     if(rPos > num_columns || gPos > num_columns || bPos > num_columns || iPos > num_columns)
@@ -111,113 +84,28 @@ ModelPtr AsciiIO::read(
         return ModelPtr();
     }
 
-    // Check for color and intensity
-    bool has_color = (rPos > -1 && gPos > -1 && bPos > -1);
-    bool has_intensity = (iPos > -1);
-
-    // Alloc buffer memory for additional attributes
-    if ( has_color )
-    {
-        pointColors = ucharArr( new uint8_t[ numPoints * 3 ] );
-    }
-
-    if ( has_intensity )
-    {
-        pointIntensities = floatArr( new float[ numPoints ] );
-    }
-
-    // Read data form file
-    size_t c = 0;
-    while (in.good() && c < numPoints)
-    {
-        float x, y, z, intensity, dummy;
-        unsigned int r, g, b;
-
-        for(int i = 0; i < num_columns; i++)
-        {
-            if(i == xPos)
-            {
-                in >> x;
-            }
-            else if(i == yPos)
-            {
-                in >> y;
-            }
-            else if(i == zPos)
-            {
-                in >> z;
-            }
-            else if(i == rPos)
-            {
-                in >> r;
-            }
-            else if(i == gPos)
-            {
-                in >> g;
-            }
-            else if(i == bPos)
-            {
-                in >> b;
-            }
-            else if(i == iPos)
-            {
-                in >> intensity;
-            }
-            else
-            {
-                in >> dummy;
-            }
-
-        }
-
-        // Read according to determined format
-        if(has_color)
-        {
-            pointColors[ c * 3     ] = (unsigned char) r;
-            pointColors[ c * 3 + 1 ] = (unsigned char) g;
-            pointColors[ c * 3 + 2 ] = (unsigned char) b;
-
-        }
-
-        if (has_intensity)
-        {
-            pointIntensities[c] = intensity;
-
-        }
-
-        points[ c * 3     ] = x;
-        points[ c * 3 + 1 ] = y;
-        points[ c * 3 + 2 ] = z;
-        c++;
-    }
-
-    // Sanity check
-    if(c != numPoints)
-    {
-        cout << timestamp << "Warning: Point count / line count mismatch: "
-             << numPoints << " / " << c << endl;
-    }
-
-    // Assign buffers
-    size_t numColors = 0;
-    size_t numIntensities = 0;
-
-    if(has_color)
-    {
-        numColors = numPoints;
-        model->m_pointCloud->setColorArray(pointColors, numColors);
-
-    }
-
-    if(has_intensity)
+    AsciiColumns columns;
+    columns.x = xPos;
+    columns.y = yPos;
+    columns.z = zPos;
+    if (rPos > -1 && gPos > -1 && bPos > -1)
     {
-        numIntensities = numPoints;
-        model->m_pointCloud->addFloatChannel(pointIntensities, "intensities", numIntensities, 1);
-
+        columns.r = rPos;
+        columns.g = gPos;
+        columns.b = bPos;
     }
+    columns.intensity = iPos;
 
+    // Parse everything behind the first line in parallel
+    Timestamp ts;
+    ModelPtr model(new Model);
+    model->m_pointCloud = parseAsciiPoints(file, columns, 1);
 
-    model->m_pointCloud->setPointArray(points, numPoints);
+    double seconds = ts.getElapsedTimeInS();
+    size_t numPoints = model->m_pointCloud->numPoints();
+    cout << timestamp << "AsciiIO: Read " << numPoints << " points from " << filename
+         << " in " << seconds << " s (" << file.size() / (1024.0 * 1024.0) / std::max(seconds, 1e-6)
+         << " MB/s)" << endl;
 
     this->m_model = model;
     return model;
@@ -235,30 +123,14 @@ ModelPtr AsciiIO::read(string filename)
         cout << "»" << extension << "« is not a valid file extension." << endl;
         return ModelPtr();
     }
-    // Count lines in file to estimate the number of present points
-    int lines_in_file = countLines(filename);
-
-    if ( lines_in_file < 2 )
-    {
-        cout << timestamp << "AsciiIO: Too few lines in file (has to be > 2)." << endl;
-        return ModelPtr();
-    }
-    // Open the given file. Skip the first line (as it may
+    // Skip the first line (as it may
     // contain meta data in some formats). Then try to guess
     // the additional data using some heuristics that apply for
     // most data formats: If 4 values per point are, given
     // the 4th value usually is a reflectence information.
     // Six entries suggest RGB information, seven entries
-    // intensity and RGB.
-
-    // Open file
-    ifstream in;
-    in.open(filename.c_str());
-
-    // Read first to lines, ignore the first one
-    char buffer[2048];
-    in.getline(buffer, 2048);
-    in.getline(buffer, 2048);
+    // intensity and RGB. The number of lines is checked when
+    // the points are parsed.
 
     // Get number of entries in test line and analize
     int num_attributes  = AsciiIO::getEntriesInLine(filename) - 3;
@@ -385,45 +257,17 @@ void AsciiIO::save( std::string filename )
 
 size_t AsciiIO::countLines(string filename)
 {
-    // Open file for reading
-    ifstream in(filename.c_str());
-
-    // Count lines in file
-    size_t c = 0;
-    char line[2048];
-    while(in.good())
-    {
-        in.getline(line, 1024);
-        c++;
-    }
-    in.close();
-    return c;
+    MappedFile file(filename);
+    return lvr2::countLines(file);
 }
 
 
 int AsciiIO::getEntriesInLine(string filename)
 {
-
-    ifstream in(filename.c_str());
-
-    // Get first line from file and skip it (possibly metadata)
-    char line[1024];
-    in.getline(line, 1024);
-
-    // Get second line -> hopefully point data
-    in.getline(line, 1024);
-
-    in.close();
-
-    // Get number of blanks
-    int c = 0;
-    char* pch = strtok(line, " ");
-    while(pch){
-        c++;
-        pch = strtok(NULL, " ");
-    }
-
-    return c;
+    // Skip the first line (possibly metadata), the second one hopefully
+    // contains point data
+    MappedFile file(filename);
+    return countEntries(file, 1);
 }
 
 
@@ -0,0 +1,456 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * AsciiParser.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/io/AsciiParser.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace lvr2
+{
+
+namespace
+{
+
+/// Approximate size of the blocks of lines that are parsed in parallel
+const size_t BlockSize = 1 << 22;
+
+const double PowersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline const char* skipBlanks(const char* p, const char* end)
+{
+    while (p < end && isBlank(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* lineEnd(const char* p, const char* end)
+{
+    const char* e = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return e ? e : end;
+}
+
+inline unsigned char toColor(float value)
+{
+    return static_cast<unsigned char>(std::min(std::max(value, 0.0f), 255.0f));
+}
+
+/// A block of complete lines that is parsed by one thread
+struct Block
+{
+    const char* begin;
+    const char* end;
+    size_t offset;
+    size_t rows;
+};
+
+} // namespace
+
+MappedFile::MappedFile(const std::string& filename)
+    : m_data(nullptr), m_size(0), m_good(false)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0)
+    {
+        m_size = info.st_size;
+        if (m_size == 0)
+        {
+            m_good = true;
+        }
+        else
+        {
+            void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                madvise(data, m_size, MADV_SEQUENTIAL);
+                m_data = static_cast<const char*>(data);
+                m_good = true;
+            }
+            else
+            {
+                m_size = 0;
+            }
+        }
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data)
+    {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+}
+
+AsciiColumns AsciiColumns::guess(int numEntries)
+{
+    AsciiColumns columns;
+    switch (numEntries - 3)
+    {
+    case 1:
+        columns.intensity = 3;
+        break;
+    case 3:
+        columns.r = 3;
+        columns.g = 4;
+        columns.b = 5;
+        break;
+    case 4:
+        columns.intensity = 3;
+        columns.r = 4;
+        columns.g = 5;
+        columns.b = 6;
+        break;
+    default:
+        break;
+    }
+    return columns;
+}
+
+int AsciiColumns::maxColumn() const
+{
+    return std::max({x, y, z, r, g, b, intensity});
+}
+
+const char* parseFloat(const char* begin, const char* end, float& value)
+{
+    const char* p = begin;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+
+    // Collect up to 19 significant digits, the remaining ones only shift the exponent
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool found = false;
+    for (; p < end && isDigit(*p); ++p)
+    {
+        found = true;
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+        }
+        else
+        {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        ++p;
+        for (; p < end && isDigit(*p); ++p)
+        {
+            found = true;
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+
+    if (!found)
+    {
+        // Not a plain decimal number, let the C library handle nan, inf and hex floats
+        char buffer[64];
+        size_t n = std::min<size_t>(end - begin, sizeof(buffer) - 1);
+        std::memcpy(buffer, begin, n);
+        buffer[n] = 0;
+        char* parsed;
+        value = std::strtof(buffer, &parsed);
+        return begin + (parsed - buffer);
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char* e = p + 1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '-' || *e == '+'))
+        {
+            negativeExponent = *e == '-';
+            ++e;
+        }
+        if (e < end && isDigit(*e))
+        {
+            int exp = 0;
+            for (; e < end && isDigit(*e); ++e)
+            {
+                exp = std::min(exp * 10 + (*e - '0'), 10000);
+            }
+            exponent += negativeExponent ? -exp : exp;
+            p = e;
+        }
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (mantissa != 0)
+    {
+        if (exponent < 0 && exponent >= -22)
+        {
+            result /= PowersOf10[-exponent];
+        }
+        else if (exponent > 0 && exponent <= 22)
+        {
+            result *= PowersOf10[exponent];
+        }
+        else if (exponent != 0)
+        {
+            result *= std::pow(10.0, exponent);
+        }
+    }
+    value = static_cast<float>(negative ? -result : result);
+    return p;
+}
+
+char* formatFloat(char* out, float value)
+{
+#if defined(__cpp_lib_to_chars)
+    return std::to_chars(out, out + 16, value).ptr;
+#else
+    return out + snprintf(out, 17, "%.9g", value);
+#endif
+}
+
+std::vector<std::pair<const char*, const char*>> splitLines(const char* begin, const char* end, size_t blockSize)
+{
+    std::vector<std::pair<const char*, const char*>> blocks;
+    while (begin < end)
+    {
+        const char* blockEnd = begin + std::min<size_t>(blockSize, end - begin);
+        blockEnd = blockEnd < end ? std::min(lineEnd(blockEnd, end) + 1, end) : end;
+        blocks.emplace_back(begin, blockEnd);
+        begin = blockEnd;
+    }
+    return blocks;
+}
+
+size_t countLines(const MappedFile& file)
+{
+    return std::count(file.begin(), file.end(), '\n') + 1;
+}
+
+int countEntries(const MappedFile& file, size_t line)
+{
+    const char* p = file.begin();
+    for (size_t i = 0; i < line && p < file.end(); i++)
+    {
+        p = lineEnd(p, file.end()) + 1;
+    }
+    if (p >= file.end())
+    {
+        return 0;
+    }
+
+    const char* e = lineEnd(p, file.end());
+    int entries = 0;
+    while (true)
+    {
+        p = skipBlanks(p, e);
+        if (p == e)
+        {
+            break;
+        }
+        entries++;
+        while (p < e && !isBlank(*p))
+        {
+            ++p;
+        }
+    }
+    return entries;
+}
+
+PointBufferPtr parseAsciiPoints(const MappedFile& file, const AsciiColumns& columns, size_t skipLines)
+{
+    const char* begin = file.begin();
+    const char* end = file.end();
+    for (size_t i = 0; i < skipLines && begin < end; i++)
+    {
+        begin = std::min(lineEnd(begin, end) + 1, end);
+    }
+
+    // Split into blocks of complete lines
+    std::vector<Block> blocks;
+    for (const auto& lines : splitLines(begin, end, BlockSize))
+    {
+        blocks.push_back({lines.first, lines.second, 0, 0});
+    }
+
+    // Every line can hold a point, reserve space for all of them
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        blocks[i].rows = std::count(blocks[i].begin, blocks[i].end, '\n') + 1;
+    }
+    size_t maxPoints = 0;
+    for (Block& block : blocks)
+    {
+        block.offset = maxPoints;
+        maxPoints += block.rows;
+    }
+
+    bool hasColor = columns.r >= 0 && columns.g >= 0 && columns.b >= 0;
+    bool hasIntensity = columns.intensity >= 0;
+    int numColumns = columns.maxColumn() + 1;
+
+    floatArr points(new float[3 * std::max<size_t>(maxPoints, 1)]);
+    ucharArr colors;
+    floatArr intensities;
+    if (hasColor)
+    {
+        colors = ucharArr(new unsigned char[3 * std::max<size_t>(maxPoints, 1)]);
+    }
+    if (hasIntensity)
+    {
+        intensities = floatArr(new float[std::max<size_t>(maxPoints, 1)]);
+    }
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        Block& block = blocks[i];
+        std::vector<float> values(numColumns);
+        size_t row = block.offset;
+
+        const char* p = block.begin;
+        while (p < block.end)
+        {
+            const char* e = lineEnd(p, block.end);
+
+            int column = 0;
+            for (; column < numColumns; column++)
+            {
+                p = skipBlanks(p, e);
+                const char* q = parseFloat(p, e, values[column]);
+                if (q == p || (q < e && !isBlank(*q)))
+                {
+                    break;
+                }
+                p = q;
+            }
+
+            if (column == numColumns)
+            {
+                points[3 * row + 0] = values[columns.x];
+                points[3 * row + 1] = values[columns.y];
+                points[3 * row + 2] = values[columns.z];
+                if (hasColor)
+                {
+                    colors[3 * row + 0] = toColor(values[columns.r]);
+                    colors[3 * row + 1] = toColor(values[columns.g]);
+                    colors[3 * row + 2] = toColor(values[columns.b]);
+                }
+                if (hasIntensity)
+                {
+                    intensities[row] = values[columns.intensity];
+                }
+                row++;
+            }
+
+            p = e + 1;
+        }
+        block.rows = row - block.offset;
+    }
+
+    // Close the gaps left by empty or invalid lines
+    size_t numPoints = 0;
+    for (const Block& block : blocks)
+    {
+        if (block.offset != numPoints)
+        {
+            std::memmove(points.get() + 3 * numPoints, points.get() + 3 * block.offset, 3 * block.rows * sizeof(float));
+            if (hasColor)
+            {
+                std::memmove(colors.get() + 3 * numPoints, colors.get() + 3 * block.offset, 3 * block.rows);
+            }
+            if (hasIntensity)
+            {
+                std::memmove(intensities.get() + numPoints, intensities.get() + block.offset, block.rows * sizeof(float));
+            }
+        }
+        numPoints += block.rows;
+    }
+
+    PointBufferPtr buffer(new PointBuffer);
+    buffer->setPointArray(points, numPoints);
+    if (hasColor)
+    {
+        buffer->setColorArray(colors, numPoints);
+    }
+    if (hasIntensity)
+    {
+        buffer->addFloatChannel(intensities, "intensities", numPoints, 1);
+    }
+    return buffer;
+}
+
+} // namespace lvr2
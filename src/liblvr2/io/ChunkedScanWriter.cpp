@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * ChunkedScanWriter.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/io/ChunkedScanWriter.hpp"
+#include "lvr2/io/hdf5/Hdf5Util.hpp"
+
+#include <cstdio>
+#include <vector>
+
+namespace lvr2
+{
+
+ChunkedScanWriter::ChunkedScanWriter(const std::string& filename, size_t chunkSize)
+    : m_chunkSize(chunkSize)
+{
+    m_file = std::make_shared<HighFive::File>(
+        filename,
+        HighFive::File::ReadWrite | HighFive::File::Create | HighFive::File::Truncate
+    );
+    hdf5util::writeBaseStructure(m_file);
+}
+
+void ChunkedScanWriter::write(size_t scanNr, const Transformf& pose, PointBufferPtr points)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    char buffer[128];
+    sprintf(buffer, "position_%05zu", scanNr);
+    HighFive::Group g = hdf5util::getGroup(m_file, "/raw/scans/" + std::string(buffer));
+
+    if (!g.exist("finalPose"))
+    {
+        std::vector<float> poseData(pose.data(), pose.data() + 16);
+        HighFive::DataSpace poseSpace({4, 4});
+        g.createDataSet<float>("initialPose", poseSpace).write<float>(poseData.data());
+        g.createDataSet<float>("finalPose", poseSpace).write<float>(poseData.data());
+    }
+
+    size_t n = points->numPoints();
+    if (n == 0)
+    {
+        return;
+    }
+
+    hdf5util::appendRows(g, "points", points->getPointArray().get(), n, 3, m_chunkSize);
+
+    if (points->hasNormals())
+    {
+        hdf5util::appendRows(g, "normals", points->getNormalArray().get(), n, 3, m_chunkSize);
+    }
+
+    size_t numFaceIds;
+    size_t faceIdWidth;
+    indexArray faceIds = points->getIndexArray("face_ids", numFaceIds, faceIdWidth);
+    if (faceIds)
+    {
+        hdf5util::appendRows(g, "face_ids", faceIds.get(), numFaceIds, faceIdWidth, m_chunkSize);
+    }
+
+    m_file->flush();
+}
+
+} // namespace lvr2
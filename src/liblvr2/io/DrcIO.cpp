@@ -25,17 +25,37 @@
  *
  **/
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <unordered_map>
 #include <unistd.h>
 
+#include "lvr2/algorithm/ChunkManager.hpp"
 #include "lvr2/io/DracoDecoder.hpp"
 #include "lvr2/io/DracoEncoder.hpp"
 #include "lvr2/io/DrcIO.hpp"
+#include "lvr2/io/Timestamp.hpp"
 
 namespace lvr2
 {
 
-ModelPtr DrcIO::read(string filename)
+namespace
+{
+
+/// Magic bytes of the chunked container. Plain draco files start with "DRACO".
+const char ChunkMagic[8] = {'L', 'V', 'R', 'D', 'R', 'C', 'C', 'H'};
+const uint32_t ChunkVersion = 1;
+
+/// Size of a serialized chunk index entry: 6 floats and 4 uint64
+const size_t ChunkEntrySize = 6 * sizeof(float) + 4 * sizeof(uint64_t);
+
+/// Size of a serialized texture header
+const size_t TextureHeaderSize = sizeof(int32_t) + 2 * sizeof(uint16_t) + 2 + sizeof(float);
+
+bool readFile(const string& filename, std::vector<char>& data)
 {
     std::ifstream file(filename, std::ios::binary);
     if (!file)
@@ -43,14 +63,14 @@ ModelPtr DrcIO::read(string filename)
         std::cerr << "File:"
                   << " " << filename << " "
                   << "could not be read!" << std::endl;
-        return ModelPtr(new Model());
+        return false;
     }
 
     std::streampos file_size = 0;
     file.seekg(0, std::ios::end);
     file_size = file.tellg() - file_size;
     file.seekg(0, std::ios::beg);
-    std::vector<char> data(file_size);
+    data.resize(file_size);
     file.read(data.data(), file_size);
 
     if (data.empty())
@@ -58,9 +78,128 @@ ModelPtr DrcIO::read(string filename)
         std::cerr << "File:"
                   << " " << filename << " "
                   << "is empty!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+void put(char*& dst, T value)
+{
+    memcpy(dst, &value, sizeof(T));
+    dst += sizeof(T);
+}
+
+template<typename T>
+T get(const char*& src)
+{
+    T value;
+    memcpy(&value, src, sizeof(T));
+    src += sizeof(T);
+    return value;
+}
+
+size_t textureBytes(const Texture& t)
+{
+    return (size_t)t.m_width * t.m_height * t.m_numChannels * t.m_numBytesPerChan;
+}
+
+/**
+ * @brief Parses the header of a chunked draco container. Returns false
+ *        if data does not start with the container magic or is truncated.
+ */
+bool parseChunkIndex(const std::vector<char>& data,
+                     std::vector<DrcChunk>& chunks,
+                     std::vector<Texture>* textures)
+{
+    const size_t headerSize = sizeof(ChunkMagic) + 3 * sizeof(uint32_t);
+    if (data.size() < headerSize || memcmp(data.data(), ChunkMagic, sizeof(ChunkMagic)) != 0)
+    {
+        return false;
+    }
+
+    const char* src = data.data() + sizeof(ChunkMagic);
+    const char* end = data.data() + data.size();
+    uint32_t version     = get<uint32_t>(src);
+    uint32_t numChunks   = get<uint32_t>(src);
+    uint32_t numTextures = get<uint32_t>(src);
+
+    if (version != ChunkVersion || (size_t)(end - src) < numChunks * ChunkEntrySize)
+    {
+        std::cerr << "DrcIO: Unsupported or corrupt chunk index." << std::endl;
+        return false;
+    }
+
+    chunks.resize(numChunks);
+    for (DrcChunk& c : chunks)
+    {
+        float bb[6];
+        for (int i = 0; i < 6; i++)
+        {
+            bb[i] = get<float>(src);
+        }
+        c.bb = BoundingBox<BaseVector<float>>(BaseVector<float>(bb[0], bb[1], bb[2]),
+                                              BaseVector<float>(bb[3], bb[4], bb[5]));
+        c.offset      = get<uint64_t>(src);
+        c.size        = get<uint64_t>(src);
+        c.numVertices = get<uint64_t>(src);
+        c.numFaces    = get<uint64_t>(src);
+
+        if (c.offset > data.size() || c.size > data.size() - c.offset)
+        {
+            std::cerr << "DrcIO: Chunk exceeds file size." << std::endl;
+            return false;
+        }
+    }
+
+    if (textures)
+    {
+        textures->clear();
+        textures->reserve(numTextures);
+        for (uint32_t i = 0; i < numTextures; i++)
+        {
+            if ((size_t)(end - src) < TextureHeaderSize)
+            {
+                return false;
+            }
+            int32_t index          = get<int32_t>(src);
+            uint16_t width         = get<uint16_t>(src);
+            uint16_t height        = get<uint16_t>(src);
+            unsigned char channels = get<unsigned char>(src);
+            unsigned char bytes    = get<unsigned char>(src);
+            float texelSize        = get<float>(src);
+
+            size_t n = (size_t)width * height * channels * bytes;
+            if ((size_t)(end - src) < n)
+            {
+                return false;
+            }
+            textures->emplace_back(index, width, height, channels, bytes, texelSize,
+                                   (unsigned char*)src);
+            src += n;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+ModelPtr DrcIO::read(string filename)
+{
+    std::vector<char> data;
+    if (!readFile(filename, data))
+    {
         return ModelPtr(new Model());
     }
 
+    std::vector<DrcChunk> chunks;
+    std::vector<Texture> textures;
+    if (parseChunkIndex(data, chunks, &textures))
+    {
+        m_model = readChunks(data, chunks, textures);
+        return m_model;
+    }
+
     draco::DecoderBuffer buffer;
     buffer.Init(data.data(), data.size());
 
@@ -82,6 +221,454 @@ ModelPtr DrcIO::read(string filename)
     return modelPtr;
 }
 
+std::vector<DrcChunk> DrcIO::readChunkIndex(string filename)
+{
+    std::vector<DrcChunk> chunks;
+    std::vector<char> data;
+    if (readFile(filename, data))
+    {
+        parseChunkIndex(data, chunks, nullptr);
+    }
+    return chunks;
+}
+
+ModelPtr DrcIO::readArea(string filename, const BoundingBox<BaseVector<float>>& area)
+{
+    std::vector<char> data;
+    if (!readFile(filename, data))
+    {
+        return ModelPtr(new Model());
+    }
+
+    std::vector<DrcChunk> chunks;
+    std::vector<Texture> textures;
+    if (!parseChunkIndex(data, chunks, &textures))
+    {
+        return read(filename);
+    }
+
+    std::vector<DrcChunk> selected;
+    for (DrcChunk& c : chunks)
+    {
+        if (c.bb.overlap(area))
+        {
+            selected.push_back(c);
+        }
+    }
+
+    m_model = readChunks(data, selected, textures);
+    return m_model;
+}
+
+ModelPtr DrcIO::readChunks(const std::vector<char>& data,
+                           const std::vector<DrcChunk>& chunks,
+                           std::vector<Texture>& textures)
+{
+    // Decode all chunks independently
+    std::vector<MeshBufferPtr> parts(chunks.size());
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        draco::DecoderBuffer buffer;
+        buffer.Init(data.data() + chunks[i].offset, chunks[i].size);
+        ModelPtr part = decodeDraco(buffer, draco::EncodedGeometryType::TRIANGULAR_MESH);
+        if (part && part->m_mesh && part->m_mesh->hasFaces())
+        {
+            parts[i] = part->m_mesh;
+        }
+    }
+
+    parts.erase(std::remove(parts.begin(), parts.end(), MeshBufferPtr()), parts.end());
+    if (parts.size() < chunks.size())
+    {
+        std::cerr << timestamp << "DrcIO: " << chunks.size() - parts.size()
+                  << " chunks could not be decoded." << std::endl;
+    }
+
+    MeshBufferPtr mesh(new MeshBuffer);
+    ModelPtr model(new Model(mesh));
+    if (parts.empty())
+    {
+        return model;
+    }
+
+    // Offsets of each part in the merged buffers. Optional channels are
+    // only kept if all parts provide them.
+    std::vector<size_t> vertexOffsets(parts.size() + 1, 0);
+    std::vector<size_t> faceOffsets(parts.size() + 1, 0);
+    size_t colorWidth = 0;
+    parts[0]->getVertexColors(colorWidth);
+    bool hasNormals   = true;
+    bool hasColors    = colorWidth > 0;
+    bool hasTexCoords = true;
+    bool hasMaterials = true;
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        size_t w = 0;
+        parts[i]->getVertexColors(w);
+        hasNormals   &= parts[i]->hasVertexNormals();
+        hasColors    &= (w == colorWidth);
+        hasTexCoords &= (bool)parts[i]->getTextureCoordinates();
+        hasMaterials &= (bool)parts[i]->getFaceMaterialIndices();
+        vertexOffsets[i + 1] = vertexOffsets[i] + parts[i]->numVertices();
+        faceOffsets[i + 1]   = faceOffsets[i] + parts[i]->numFaces();
+    }
+
+    size_t numVertices = vertexOffsets.back();
+    size_t numFaces    = faceOffsets.back();
+    floatArr vertices(new float[3 * numVertices]);
+    indexArray faces(new unsigned int[3 * numFaces]);
+    floatArr normals(hasNormals ? new float[3 * numVertices] : nullptr);
+    ucharArr colors(hasColors ? new unsigned char[colorWidth * numVertices] : nullptr);
+    floatArr texCoords(hasTexCoords ? new float[2 * numVertices] : nullptr);
+    indexArray materialIndices(hasMaterials ? new unsigned int[numFaces] : nullptr);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        MeshBufferPtr part = parts[i];
+        size_t nv = part->numVertices();
+        size_t nf = part->numFaces();
+        size_t v0 = vertexOffsets[i];
+        size_t f0 = faceOffsets[i];
+
+        std::copy_n(part->getVertices().get(), 3 * nv, vertices.get() + 3 * v0);
+        if (hasNormals)
+        {
+            std::copy_n(part->getVertexNormals().get(), 3 * nv, normals.get() + 3 * v0);
+        }
+        if (hasColors)
+        {
+            size_t w;
+            std::copy_n(part->getVertexColors(w).get(), colorWidth * nv,
+                        colors.get() + colorWidth * v0);
+        }
+        if (hasTexCoords)
+        {
+            std::copy_n(part->getTextureCoordinates().get(), 2 * nv, texCoords.get() + 2 * v0);
+        }
+        if (hasMaterials)
+        {
+            std::copy_n(part->getFaceMaterialIndices().get(), nf, materialIndices.get() + f0);
+        }
+
+        indexArray partFaces = part->getFaceIndices();
+        for (size_t j = 0; j < 3 * nf; j++)
+        {
+            faces[3 * f0 + j] = partFaces[j] + v0;
+        }
+    }
+
+    mesh->setVertices(vertices, numVertices);
+    mesh->setFaceIndices(faces, numFaces);
+    if (hasNormals)
+    {
+        mesh->setVertexNormals(normals);
+    }
+    if (hasColors)
+    {
+        mesh->setVertexColors(colors, colorWidth);
+    }
+    if (hasTexCoords)
+    {
+        mesh->setTextureCoordinates(texCoords);
+    }
+    if (hasMaterials)
+    {
+        mesh->setFaceMaterialIndices(materialIndices);
+    }
+
+    // All chunks carry the full material list, textures are stored once
+    std::vector<Material> materials = parts[0]->getMaterials();
+    mesh->setMaterials(materials);
+    mesh->setTextures(textures);
+
+    return model;
+}
+
+void DrcIO::saveChunked(string filename)
+{
+    MeshBufferPtr mesh = m_model->m_mesh;
+    size_t numVertices = mesh->numVertices();
+    size_t numFaces    = mesh->numFaces();
+    floatArr vertices  = mesh->getVertices();
+    indexArray faces   = mesh->getFaceIndices();
+
+    size_t colorWidth = 0;
+    size_t faceColorWidth = 0;
+    floatArr normals         = mesh->getVertexNormals();
+    ucharArr colors          = mesh->getVertexColors(colorWidth);
+    floatArr texCoords       = mesh->getTextureCoordinates();
+    indexArray materialIndices = mesh->getFaceMaterialIndices();
+    floatArr faceNormals     = mesh->getFaceNormals();
+    ucharArr faceColors      = mesh->getFaceColors(faceColorWidth);
+
+    BoundingBox<BaseVector<float>> bb;
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        bb.expand(BaseVector<float>(vertices[3 * i], vertices[3 * i + 1], vertices[3 * i + 2]));
+    }
+
+    // Without an explicit chunk size, choose the grid such that a surface
+    // mesh, which covers roughly a quadratic number of cells, is split into
+    // at least numFaces / m_maxChunkFaces chunks.
+    float chunkSize = m_chunkSize;
+    if (chunkSize <= 0)
+    {
+        size_t target = (numFaces + m_maxChunkFaces - 1) / m_maxChunkFaces;
+        chunkSize = bb.getLongestSide() / std::ceil(std::sqrt((float)target));
+    }
+    chunkSize = std::max(chunkSize, std::numeric_limits<float>::min());
+
+    // Cell of each face centroid, computed and hashed by the ChunkManager.
+    // One extra cell per axis keeps vertices on the upper bound inside.
+    BaseVector<float> bbMin = bb.getMin();
+    BaseVector<std::size_t> cells((size_t)(bb.getXSize() / chunkSize) + 1,
+                                  (size_t)(bb.getYSize() / chunkSize) + 1,
+                                  (size_t)(bb.getZSize() / chunkSize) + 1);
+
+    std::vector<uint64_t> faceCells(numFaces);
+    #pragma omp parallel for
+    for (size_t f = 0; f < numFaces; f++)
+    {
+        BaseVector<float> centroid;
+        for (int d = 0; d < 3; d++)
+        {
+            centroid[d] = (vertices[3 * faces[3 * f] + d]
+                         + vertices[3 * faces[3 * f + 1] + d]
+                         + vertices[3 * faces[3 * f + 2] + d]) / 3.0f;
+        }
+        BaseVector<int> cell = ChunkManager::cellCoordinates(centroid, bbMin, chunkSize);
+
+        // Rounding may put a centroid just outside of the grid
+        size_t idx[3];
+        for (int d = 0; d < 3; d++)
+        {
+            idx[d] = std::min((size_t)std::max(cell[d], 0), cells[d] - 1);
+        }
+        faceCells[f] = ChunkManager::hashValue(idx[0], idx[1], idx[2], cells);
+    }
+
+    // Bucket the faces by chunk (numbered in order of first appearance)
+    std::unordered_map<uint64_t, uint32_t> chunkIds;
+    std::vector<uint32_t> faceChunks(numFaces);
+    std::vector<size_t> chunkOffsets;
+    uint64_t lastCell = std::numeric_limits<uint64_t>::max();
+    uint32_t lastId = 0;
+    for (size_t f = 0; f < numFaces; f++)
+    {
+        if (faceCells[f] != lastCell)
+        {
+            auto it  = chunkIds.emplace(faceCells[f], (uint32_t)chunkIds.size());
+            lastCell = faceCells[f];
+            lastId   = it.first->second;
+            if (it.second)
+            {
+                chunkOffsets.push_back(0);
+            }
+        }
+        faceChunks[f] = lastId;
+        chunkOffsets[lastId]++;
+    }
+    faceCells.clear();
+    faceCells.shrink_to_fit();
+
+    size_t numChunks = chunkOffsets.size();
+    size_t sum = 0;
+    for (size_t& o : chunkOffsets)
+    {
+        size_t n = o;
+        o = sum;
+        sum += n;
+    }
+    chunkOffsets.push_back(sum);
+
+    std::vector<size_t> chunkFaces(numFaces);
+    {
+        std::vector<size_t> fill(chunkOffsets.begin(), chunkOffsets.end() - 1);
+        for (size_t f = 0; f < numFaces; f++)
+        {
+            chunkFaces[fill[faceChunks[f]]++] = f;
+        }
+    }
+
+    std::cout << timestamp << "DrcIO: Encoding " << numFaces << " faces in "
+              << numChunks << " chunks" << std::endl;
+
+    // Build and encode the chunk meshes in parallel
+    std::vector<DrcChunk> chunks(numChunks);
+    std::vector<std::unique_ptr<draco::EncoderBuffer>> buffers(numChunks);
+    std::vector<Material> materials = mesh->getMaterials();
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t c = 0; c < numChunks; c++)
+    {
+        const size_t* cf = chunkFaces.data() + chunkOffsets[c];
+        size_t nf = chunkOffsets[c + 1] - chunkOffsets[c];
+
+        // Referenced vertices in ascending order; the local index of a
+        // vertex is its position in this list
+        std::vector<unsigned int> ids(3 * nf);
+        for (size_t j = 0; j < nf; j++)
+        {
+            std::copy_n(faces.get() + 3 * cf[j], 3, ids.data() + 3 * j);
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        size_t nv = ids.size();
+
+        MeshBufferPtr part(new MeshBuffer);
+        BoundingBox<BaseVector<float>> partBB;
+        floatArr partVertices(new float[3 * nv]);
+        for (size_t j = 0; j < nv; j++)
+        {
+            std::copy_n(vertices.get() + 3 * ids[j], 3, partVertices.get() + 3 * j);
+            partBB.expand(BaseVector<float>(partVertices[3 * j],
+                                            partVertices[3 * j + 1],
+                                            partVertices[3 * j + 2]));
+        }
+        part->setVertices(partVertices, nv);
+
+        indexArray partFaces(new unsigned int[3 * nf]);
+        for (size_t j = 0; j < 3 * nf; j++)
+        {
+            unsigned int v = faces[3 * cf[j / 3] + j % 3];
+            partFaces[j] = std::lower_bound(ids.begin(), ids.end(), v) - ids.begin();
+        }
+        part->setFaceIndices(partFaces, nf);
+
+        if (normals)
+        {
+            floatArr a(new float[3 * nv]);
+            for (size_t j = 0; j < nv; j++)
+            {
+                std::copy_n(normals.get() + 3 * ids[j], 3, a.get() + 3 * j);
+            }
+            part->setVertexNormals(a);
+        }
+        if (colors)
+        {
+            ucharArr a(new unsigned char[colorWidth * nv]);
+            for (size_t j = 0; j < nv; j++)
+            {
+                std::copy_n(colors.get() + colorWidth * ids[j], colorWidth, a.get() + colorWidth * j);
+            }
+            part->setVertexColors(a, colorWidth);
+        }
+        if (texCoords)
+        {
+            floatArr a(new float[2 * nv]);
+            for (size_t j = 0; j < nv; j++)
+            {
+                std::copy_n(texCoords.get() + 2 * ids[j], 2, a.get() + 2 * j);
+            }
+            part->setTextureCoordinates(a);
+        }
+        if (materialIndices)
+        {
+            indexArray a(new unsigned int[nf]);
+            for (size_t j = 0; j < nf; j++)
+            {
+                a[j] = materialIndices[cf[j]];
+            }
+            part->setFaceMaterialIndices(a);
+        }
+        if (faceNormals)
+        {
+            floatArr a(new float[3 * nf]);
+            for (size_t j = 0; j < nf; j++)
+            {
+                std::copy_n(faceNormals.get() + 3 * cf[j], 3, a.get() + 3 * j);
+            }
+            part->setFaceNormals(a);
+        }
+        if (faceColors)
+        {
+            ucharArr a(new unsigned char[faceColorWidth * nf]);
+            for (size_t j = 0; j < nf; j++)
+            {
+                std::copy_n(faceColors.get() + faceColorWidth * cf[j], faceColorWidth,
+                            a.get() + faceColorWidth * j);
+            }
+            part->setFaceColors(a, faceColorWidth);
+        }
+
+        // Textures are written once into the container, not per chunk
+        std::vector<Material> partMaterials = materials;
+        part->setMaterials(partMaterials);
+
+        buffers[c] = encodeDraco(ModelPtr(new Model(part)),
+                                 draco::EncodedGeometryType::TRIANGULAR_MESH);
+
+        chunks[c].bb          = partBB;
+        chunks[c].numVertices = nv;
+        chunks[c].numFaces    = nf;
+        chunks[c].size        = buffers[c] ? buffers[c]->size() : 0;
+    }
+
+    // Header: magic, version, counts, chunk index and textures
+    std::vector<Texture>& textures = mesh->getTextures();
+    size_t headerSize = sizeof(ChunkMagic) + 3 * sizeof(uint32_t) + numChunks * ChunkEntrySize;
+    for (const Texture& t : textures)
+    {
+        headerSize += TextureHeaderSize + textureBytes(t);
+    }
+
+    uint64_t offset = headerSize;
+    for (DrcChunk& c : chunks)
+    {
+        c.offset = offset;
+        offset += c.size;
+    }
+
+    std::vector<char> header(headerSize);
+    char* dst = header.data();
+    memcpy(dst, ChunkMagic, sizeof(ChunkMagic));
+    dst += sizeof(ChunkMagic);
+    put<uint32_t>(dst, ChunkVersion);
+    put<uint32_t>(dst, numChunks);
+    put<uint32_t>(dst, textures.size());
+    for (DrcChunk& c : chunks)
+    {
+        BaseVector<float> min = c.bb.getMin();
+        BaseVector<float> max = c.bb.getMax();
+        for (int i = 0; i < 3; i++)
+        {
+            put<float>(dst, min[i]);
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            put<float>(dst, max[i]);
+        }
+        put<uint64_t>(dst, c.offset);
+        put<uint64_t>(dst, c.size);
+        put<uint64_t>(dst, c.numVertices);
+        put<uint64_t>(dst, c.numFaces);
+    }
+    for (const Texture& t : textures)
+    {
+        put<int32_t>(dst, t.m_index);
+        put<uint16_t>(dst, t.m_width);
+        put<uint16_t>(dst, t.m_height);
+        put<unsigned char>(dst, t.m_numChannels);
+        put<unsigned char>(dst, t.m_numBytesPerChan);
+        put<float>(dst, t.m_texelSize);
+        memcpy(dst, t.m_data, textureBytes(t));
+        dst += textureBytes(t);
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    file.write(header.data(), header.size());
+    for (auto& buffer : buffers)
+    {
+        if (buffer)
+        {
+            file.write(buffer->data(), buffer->size());
+        }
+    }
+}
+
 void DrcIO::save(string filename)
 {
     // check for validity
@@ -97,6 +684,13 @@ void DrcIO::save(string filename)
         return;
     }
 
+    // if enabled, large meshes are split into independently encoded chunks
+    if (m_maxChunkFaces > 0 && !m_model->m_pointCloud && m_model->m_mesh->numFaces() > m_maxChunkFaces)
+    {
+        saveChunked(filename);
+        return;
+    }
+
     // encode
     std::unique_ptr<draco::EncoderBuffer> buffer =
         encodeDraco(m_model, (m_model->m_pointCloud ? draco::EncodedGeometryType::POINT_CLOUD
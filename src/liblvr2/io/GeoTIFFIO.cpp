@@ -15,7 +15,14 @@ GeoTIFFIO::GeoTIFFIO(std::string filename, int cols, int rows, int bands) : m_co
 {
     GDALAllRegister();
     m_gtif_driver = GetGDALDriverManager()->GetDriverByName("GTiff");
-    m_gtif_dataset = m_gtif_driver->Create(filename.c_str(), m_cols, m_rows, m_bands, GDT_UInt16, NULL);
+
+    // Bands are written one after another, so store them one after another. Pixel interleaved
+    // files would have to be rewritten for every band.
+    char **options = NULL;
+    options = CSLSetNameValue(options, "INTERLEAVE", "BAND");
+    options = CSLSetNameValue(options, "BIGTIFF", "IF_SAFER");
+    m_gtif_dataset = m_gtif_driver->Create(filename.c_str(), m_cols, m_rows, m_bands, GDT_UInt16, options);
+    CSLDestroy(options);
 }
 
 GeoTIFFIO::GeoTIFFIO(std::string filename)
@@ -26,30 +33,47 @@ GeoTIFFIO::GeoTIFFIO(std::string filename)
 
 int GeoTIFFIO::writeBand(cv::Mat *mat, int band)
 {
-    if (!m_gtif_dataset)
+    if (mat->type() != CV_16UC1 || mat->rows != m_rows || mat->cols != m_cols)
     {
-        std::cout << timestamp << "GeoTIFF dataset not initialized!" << std::endl;
+        std::cout << timestamp << "Band " << band << " does not match the GeoTIFF dataset." << std::endl;
         return -1;
     }
 
-    uint16_t *rowBuff = (uint16_t *) CPLMalloc(sizeof(uint16_t) * m_cols);
+    if (mat->isContinuous())
+    {
+        return writeBlock(mat->ptr<uint16_t>(), band, 0, m_rows);
+    }
+
     for (int row = 0; row < m_rows; row++)
     {
-        for (int col = 0; col < m_cols; col++)
+        if (writeBlock(mat->ptr<uint16_t>(row), band, row, 1) != 0)
         {
-            rowBuff[col] = mat->at<uint16_t>(row, col);
-        }
-        if (m_gtif_dataset->GetRasterBand(band)->RasterIO(
-                GF_Write, 0, row, m_cols, 1, rowBuff, m_cols, 1, GDT_UInt16, 0, 0) != CPLE_None)
-        {
-            std::cout << timestamp << "An error occurred in GDAL while writing band "
-                << band << " in row " << row << "." << std::endl;
             return -1;
         }
     }
     return 0;
 }
 
+int GeoTIFFIO::writeBlock(const uint16_t *data, int band, int first_row, int num_rows)
+{
+    if (!m_gtif_dataset)
+    {
+        std::cout << timestamp << "GeoTIFF dataset not initialized!" << std::endl;
+        return -1;
+    }
+
+    // GDAL does not modify the buffer in GF_Write mode
+    if (m_gtif_dataset->GetRasterBand(band)->RasterIO(
+            GF_Write, 0, first_row, m_cols, num_rows, const_cast<uint16_t *>(data),
+            m_cols, num_rows, GDT_UInt16, 0, 0) != CPLE_None)
+    {
+        std::cout << timestamp << "An error occurred in GDAL while writing band "
+            << band << " in rows " << first_row << " to " << first_row + num_rows - 1 << "." << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
 int GeoTIFFIO::getRasterWidth()
 {
     if(m_gtif_dataset)
@@ -28,6 +28,7 @@
 #include "lvr2/io/IOUtils.hpp"
 #include "lvr2/io/ModelFactory.hpp"
 #include "lvr2/registration/TransformUtils.hpp"
+#include "lvr2/types/ChannelView.hpp"
 
 #include <random>
 #include <unordered_set>
@@ -349,33 +350,19 @@ size_t getNumberOfPointsInPLY(const std::string& filename)
 }
 
 template<typename T>
-typename Channel<T>::Ptr subSampleChannel(Channel<T>& src, std::vector<size_t> ids)
+typename Channel<T>::Ptr subSampleChannel(Channel<T>& src, ChannelIndicesPtr ids)
 {
-    // Create smaller channel of same type
-    size_t width = src.width();
-    typename Channel<T>::Ptr red(new Channel<T>(ids.size(), width));
-
-    // Sample from original and insert into reduced 
-    // channel
-    boost::shared_array<T> a(red->dataPtr());
-    boost::shared_array<T> b(src.dataPtr());
-    for(size_t i = 0; i < ids.size(); i++)
-    {
-        for(size_t j = 0; j < red->width(); j++)
-        {
-            a[i * width + j] = b[ids[i] * width + j];
-        }
-    }
-    return red;
+    // Gather the selected elements into a smaller channel of same type
+    return typename Channel<T>::Ptr(new Channel<T>(ChannelView<T>(src).select(ids).materialize()));
 }
 
 template<typename T>
-void subsample(PointBufferPtr src, PointBufferPtr dst, const vector<size_t>& indices)
+void subsample(PointBufferPtr src, PointBufferPtr dst, ChannelIndicesPtr indices)
 {
     // Go over all supported channel types and sub-sample
     std::map<std::string, Channel<T>> channels;
     src->getAllChannelsOfType(channels);      
-    for(auto i : channels)
+    for(auto& i : channels)
     {
         std::cout << timestamp << "Subsampling channel " << i.first << std::endl;
         typename Channel<T>::Ptr c = subSampleChannel(i.second, indices);
@@ -388,14 +375,17 @@ PointBufferPtr subSamplePointBuffer(PointBufferPtr src, const std::vector<size_t
 {
     PointBufferPtr buffer(new PointBuffer);
 
+    // The index list is shared by all channel views
+    ChannelIndicesPtr ids(new std::vector<size_t>(indices));
+
     // Go over all supported channel types and sub-sample
-    subsample<char>(src, buffer, indices);
-    subsample<unsigned char>(src, buffer, indices);
-    subsample<short>(src, buffer, indices);
-    subsample<int>(src, buffer, indices);
-    subsample<unsigned int>(src, buffer, indices);
-    subsample<float>(src, buffer, indices);
-    subsample<double>(src, buffer, indices);
+    subsample<char>(src, buffer, ids);
+    subsample<unsigned char>(src, buffer, ids);
+    subsample<short>(src, buffer, ids);
+    subsample<int>(src, buffer, ids);
+    subsample<unsigned int>(src, buffer, ids);
+    subsample<float>(src, buffer, ids);
+    subsample<double>(src, buffer, ids);
 
     return buffer;
 }
@@ -409,7 +399,7 @@ PointBufferPtr subSamplePointBuffer(PointBufferPtr src, const size_t& n)
     // Setup random device and distribution
     std::random_device dev;
     std::mt19937 rng(dev());
-    std::uniform_int_distribution<std::mt19937::result_type> dist(0, numSrcPts);
+    std::uniform_int_distribution<std::mt19937::result_type> dist(0, numSrcPts - 1);
 
     // Check buffer size
     if(n <= numSrcPts)
@@ -428,14 +418,7 @@ PointBufferPtr subSamplePointBuffer(PointBufferPtr src, const size_t& n)
         indices.insert(indices.end(), index_set.begin(), index_set.end());
         index_set.clear();
 
-        // Go over all supported channel types and sub-sample
-        subsample<char>(src, buffer, indices);
-        subsample<unsigned char>(src, buffer, indices);
-        subsample<short>(src, buffer, indices);
-        subsample<int>(src, buffer, indices);
-        subsample<unsigned int>(src, buffer, indices);
-        subsample<float>(src, buffer, indices);
-        subsample<double>(src, buffer, indices);
+        return subSamplePointBuffer(src, indices);
     }
     else
     {
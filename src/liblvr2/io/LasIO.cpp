@@ -39,48 +39,37 @@ using std::endl;
 #include "lvr2/io/LasIO.hpp"
 #include "lvr2/io/Timestamp.hpp"
 
-#include <lasreader.hpp>
-#include <laswriter.hpp>
-
 namespace lvr2
 {
 
 ModelPtr LasIO::read(string filename )
 {
+    LasStreamReader reader(filename, m_filter);
 
-    // Create Lasreader object
-    LASreadOpener lasreadopener;
-    lasreadopener.set_file_name(filename.c_str());
-
-    if(lasreadopener.active())
+    if(reader.ok())
     {
-        LASreader* lasreader = lasreadopener.open();
-
-        // Get number of points in file
-        size_t num_points = lasreader->npoints;
+        // The header count is an upper bound if filters are set
+        size_t max_points = reader.getNumPoints();
 
         // Alloc coordinate array
-        floatArr points ( new float[3 * num_points]);
-        floatArr intensities ( new float[num_points]);
-        ucharArr colors (new unsigned char[3 * num_points]);
+        floatArr points ( new float[3 * max_points]);
+        floatArr intensities ( new float[max_points]);
+        ucharArr colors (new unsigned char[3 * max_points]);
 
         // Read point data
-        for(size_t i = 0; i < num_points; i++)
+        size_t num_points = 0;
+        while(num_points < max_points &&
+              reader.readPoint(&points[3 * num_points], &colors[3 * num_points], &intensities[num_points]))
         {
-            size_t buf_pos = 3 * i;
-            lasreader->read_point();
-            points[buf_pos]     = lasreader->point.x;
-            points[buf_pos + 1] = lasreader->point.y;
-            points[buf_pos + 2] = lasreader->point.z;
-
-            // Create fake colors from intensities
-            /// TODO: Check for color attributes if possible...
-            colors[buf_pos] = lasreader->point.intensity;
-            colors[buf_pos + 1] = lasreader->point.intensity;
-            colors[buf_pos + 2] = lasreader->point.intensity;
-
-            intensities[i] = lasreader->point.intensity;
-
+            // Create fake colors from intensities if the file has no colors
+            if(!reader.hasColors())
+            {
+                unsigned char intensity = (unsigned short)intensities[num_points];
+                colors[3 * num_points] = intensity;
+                colors[3 * num_points + 1] = intensity;
+                colors[3 * num_points + 2] = intensity;
+            }
+            num_points++;
         }
 
         // Create point buffer and model
@@ -92,8 +81,6 @@ ModelPtr LasIO::read(string filename )
         ModelPtr m_ptr( new Model(p_buffer));
         m_model = m_ptr;
 
-        delete lasreader;
-
         return m_ptr;
     }
     else
@@ -0,0 +1,247 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * LasStreamReader.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/io/LasStreamReader.hpp"
+#include "lvr2/io/Timestamp.hpp"
+
+#include <lasreader.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+namespace lvr2
+{
+
+LasStreamReader::LasStreamReader(const std::string& filename, const LasFilter& filter)
+    : m_reader(nullptr), m_filter(filter), m_eof(true), m_numPoints(0), m_hasColors(false), m_colorShift(8)
+{
+    std::fill_n(m_classes, 256, m_filter.classifications.empty());
+    for (unsigned char c : m_filter.classifications)
+    {
+        m_classes[c] = true;
+    }
+
+    LASreadOpener lasreadopener;
+    lasreadopener.set_file_name(filename.c_str());
+    if (lasreadopener.active())
+    {
+        m_reader = lasreadopener.open();
+    }
+
+    if (!m_reader)
+    {
+        std::cout << timestamp << "LasStreamReader: Unable to open file " << filename << std::endl;
+        return;
+    }
+
+    m_eof       = false;
+    m_numPoints = m_reader->npoints;
+    m_hasColors = m_reader->point.have_rgb;
+    m_boundingBox = BoundingBox<BaseVector<float>>(
+        BaseVector<float>(m_reader->get_min_x(), m_reader->get_min_y(), m_reader->get_min_z()),
+        BaseVector<float>(m_reader->get_max_x(), m_reader->get_max_y(), m_reader->get_max_z()));
+
+    if (m_hasColors)
+    {
+        detectColorShift(lasreadopener);
+    }
+
+    // Let laslib skip points outside of the xy range. This overwrites
+    // the header bounds, which is why they are copied above.
+    if (m_filter.useBoundingBox)
+    {
+        BaseVector<float> min = m_filter.boundingBox.getMin();
+        BaseVector<float> max = m_filter.boundingBox.getMax();
+        m_reader->inside_rectangle(min.x, min.y, max.x, max.y);
+    }
+}
+
+LasStreamReader::~LasStreamReader()
+{
+    if (m_reader)
+    {
+        m_reader->close();
+        delete m_reader;
+    }
+}
+
+bool LasStreamReader::ok() const
+{
+    return !m_eof;
+}
+
+size_t LasStreamReader::getNumPoints() const
+{
+    return m_numPoints;
+}
+
+BoundingBox<BaseVector<float>> LasStreamReader::getBoundingBox() const
+{
+    return m_boundingBox;
+}
+
+bool LasStreamReader::hasColors() const
+{
+    return m_hasColors;
+}
+
+fileType LasStreamReader::getFileType() const
+{
+    return m_hasColors ? XYZRGB : XYZ;
+}
+
+bool LasStreamReader::accept() const
+{
+    const LASpoint& p = m_reader->point;
+    if (!m_classes[p.classification])
+    {
+        return false;
+    }
+    if (m_filter.returnNumber && p.return_number != m_filter.returnNumber)
+    {
+        return false;
+    }
+    if (m_filter.lastReturnOnly && p.return_number != p.number_of_returns_of_given_pulse)
+    {
+        return false;
+    }
+    if (m_filter.useBoundingBox)
+    {
+        float z = m_reader->get_z();
+        if (z < m_filter.boundingBox.getMin().z || z > m_filter.boundingBox.getMax().z)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LasStreamReader::detectColorShift(LASreadOpener& opener)
+{
+    // The format demands 16 bit colors, but many files store 8 bit values.
+    // Like other LAS readers, only scale the colors down if the first points
+    // contain values above 255.
+    const size_t numSamples = 65536;
+    bool wide = false;
+    for (size_t i = 0; i < numSamples && !wide && m_reader->read_point(); i++)
+    {
+        const U16* rgb = m_reader->point.rgb;
+        wide = rgb[0] > 255 || rgb[1] > 255 || rgb[2] > 255;
+    }
+    m_colorShift = wide ? 8 : 0;
+
+    // Go back to the first point
+    if (!m_reader->seek(0))
+    {
+        m_reader->close();
+        delete m_reader;
+        m_reader = opener.open();
+        if (!m_reader)
+        {
+            m_eof = true;
+        }
+    }
+}
+
+bool LasStreamReader::readPoint(float* xyz, unsigned char* rgb, float* intensity)
+{
+    while (!m_eof)
+    {
+        if (!m_reader->read_point())
+        {
+            m_eof = true;
+            break;
+        }
+        if (!accept())
+        {
+            continue;
+        }
+
+        xyz[0] = m_reader->get_x();
+        xyz[1] = m_reader->get_y();
+        xyz[2] = m_reader->get_z();
+
+        // LAS colors are 16 bit per channel, unless the file stores 8 bit
+        // values (see detectColorShift())
+        if (rgb)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                rgb[i] = m_hasColors ? std::min(m_reader->point.rgb[i] >> m_colorShift, 255) : 0;
+            }
+        }
+        if (intensity)
+        {
+            *intensity = m_reader->point.intensity;
+        }
+        return true;
+    }
+    return false;
+}
+
+boost::shared_ptr<void> LasStreamReader::getNextPoints(size_t& return_amount, size_t amount)
+{
+    return_amount = 0;
+    float v[3];
+    unsigned char c[3];
+    if (m_hasColors)
+    {
+        boost::shared_ptr<xyzc> points(new xyzc[amount], std::default_delete<xyzc[]>());
+        while (return_amount < amount && readPoint(v, c))
+        {
+            xyzc& p = points.get()[return_amount++];
+            p.point.x = v[0];
+            p.point.y = v[1];
+            p.point.z = v[2];
+            p.color.r = c[0];
+            p.color.g = c[1];
+            p.color.b = c[2];
+        }
+        return points;
+    }
+    else
+    {
+        boost::shared_ptr<xyz> points(new xyz[amount], std::default_delete<xyz[]>());
+        while (return_amount < amount && readPoint(v))
+        {
+            xyz& p = points.get()[return_amount++];
+            p.point.x = v[0];
+            p.point.y = v[1];
+            p.point.z = v[2];
+        }
+        return points;
+    }
+}
+
+} // namespace lvr2
@@ -41,6 +41,7 @@
 #include <sstream>
 #include <stdio.h>
 
+#include "lvr2/io/LasStreamReader.hpp"
 #include "lvr2/io/LineReader.hpp"
 
 namespace lvr2
@@ -70,9 +71,16 @@ size_t LineReader::getNumPoints()
     return amount;
 }
 
+void LineReader::setLasFilter(const LasFilter& filter)
+{
+    m_lasFilter.reset(new LasFilter(filter));
+    m_lasReader.reset();
+}
+
 void LineReader::open(std::vector<std::string> filePaths)
 {
     m_fileAttributes.clear();
+    m_lasReader.reset();
     for (size_t currentFile = 0; currentFile < filePaths.size(); currentFile++)
     {
         fileAttribut currentAttr;
@@ -92,10 +100,25 @@ void LineReader::open(std::vector<std::string> filePaths)
         {
             currentAttr.m_ply = false;
         }
+        currentAttr.m_las = boost::algorithm::iends_with(filePath, ".las") ||
+                            boost::algorithm::iends_with(filePath, ".laz");
 
         std::ifstream ifs(filePath);
 
-        if (currentAttr.m_ply)
+        if (currentAttr.m_las)
+        {
+            // Only the header is parsed here, points are streamed later
+            LasStreamReader lasReader(filePath);
+            if (!lasReader.ok())
+            {
+                throw readException("Unable to open LAS file " + filePath);
+            }
+            currentAttr.m_elementAmount = lasReader.getNumPoints();
+            currentAttr.m_binary = true;
+            gotxyz = true;
+            gotcolor = lasReader.hasColors();
+        }
+        else if (currentAttr.m_ply)
         {
             std::string line;
             while (!readHeader)
@@ -273,6 +296,22 @@ boost::shared_ptr<void> LineReader::getNextPoints(size_t& return_amount, size_t
 
     std::string filePath = m_fileAttributes[m_currentReadFile].m_filePath;
 
+    if (m_fileAttributes[m_currentReadFile].m_las)
+    {
+        if (!m_lasReader)
+        {
+            m_lasReader.reset(
+                new LasStreamReader(filePath, m_lasFilter ? *m_lasFilter : LasFilter()));
+        }
+        boost::shared_ptr<void> pArray = m_lasReader->getNextPoints(return_amount, amount);
+        if (return_amount < amount)
+        {
+            m_openNextFile = true;
+            m_lasReader.reset();
+        }
+        return pArray;
+    }
+
     FILE* pFile;
     pFile = fopen(filePath.c_str(), "r");
     if (pFile != NULL)
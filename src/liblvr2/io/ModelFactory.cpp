@@ -41,6 +41,7 @@
 #include "lvr2/io/BoctreeIO.hpp"
 #include "lvr2/io/ModelFactory.hpp"
 #include "lvr2/io/DatIO.hpp"
+#include "lvr2/io/PointCloudLODIO.hpp"
 #include "lvr2/io/STLIO.hpp"
 #include "lvr2/io/ScanprojectIO.hpp"
 
@@ -105,6 +106,10 @@ ModelPtr ModelFactory::readModel( std::string filename )
     {
         io = new HDF5IO;
     }
+    else if (extension == ".lod")
+    {
+        io = new PointCloudLODIO;
+    }
 #ifdef LVR2_USE_PCL
     else if (extension == ".pcd")
     {
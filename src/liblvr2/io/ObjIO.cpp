@@ -42,12 +42,17 @@
 #include <string.h>
 #include <locale.h>
 #include <sstream>
+#include <algorithm>
+#include <charconv>
+
+#include <omp.h>
 
 #include <boost/filesystem.hpp>
 #include <boost/tuple/tuple.hpp>
 
 #include "lvr2/io/Timestamp.hpp"
 #include "lvr2/io/ObjIO.hpp"
+#include "lvr2/io/AsciiParser.hpp"
 #include "lvr2/texture/TextureFactory.hpp"
 #include "lvr2/texture/Texture.hpp"
 #include "lvr2/texture/Material.hpp"
@@ -60,28 +65,205 @@ namespace lvr2
 using namespace std; // Bitte vergebt mir....
 // Meinst du wirklich, dass ich dir so etwas durchgehen lassen kann?
 
-void tokenize(const string& str,
-                      vector<string>& tokens,
-                      const string& delimiters = " ")
+namespace
+{
+
+/// Approximate size of the blocks of lines that are parsed in parallel
+const size_t BlockSize = 1 << 22;
+
+inline bool isBlank(char c)
 {
-    // Skip delimiters at beginning.
-    string::size_type lastPos = str.find_first_not_of(delimiters, 0);
-    // Find first "non-delimiter".
-    string::size_type pos     = str.find_first_of(delimiters, lastPos);
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char* skipBlanks(const char* p, const char* end)
+{
+    while (p < end && isBlank(*p))
+    {
+        ++p;
+    }
+    return p;
+}
 
-    while (string::npos != pos || string::npos != lastPos)
+inline const char* skipToken(const char* p, const char* end)
+{
+    while (p < end && !isBlank(*p))
     {
-        // Found a token, add it to the vector.
-        tokens.push_back(str.substr(lastPos, pos - lastPos));
-        // Skip delimiters.  Note the "not_of"
-        lastPos = str.find_first_not_of(delimiters, pos);
-        // Find next "non-delimiter"
-        pos = str.find_first_of(delimiters, lastPos);
+        ++p;
     }
+    return p;
+}
+
+inline bool isKeyword(const char* begin, const char* end, const char* keyword)
+{
+    size_t n = strlen(keyword);
+    return (size_t)(end - begin) == n && memcmp(begin, keyword, n) == 0;
 }
 
+/// Parses up to n floats, returns the number of parsed values
+inline int parseFloats(const char*& p, const char* end, float* values, int n)
+{
+    int i = 0;
+    for (; i < n; i++)
+    {
+        p = skipBlanks(p, end);
+        const char* q = parseFloat(p, end, values[i]);
+        if (q == p)
+        {
+            break;
+        }
+        p = q;
+    }
+    return i;
+}
+
+/// Parses a signed integer, returns begin if there is none
+inline const char* parseInt(const char* begin, const char* end, long& value)
+{
+    const char* p = begin;
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        ++p;
+    }
+    const char* digits = p;
+    value = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p)
+    {
+        value = value * 10 + (*p - '0');
+    }
+    if (p == digits)
+    {
+        return begin;
+    }
+    value = negative ? -value : value;
+    return p;
+}
+
+/// Contents of a block of lines of an .obj file
+struct ObjBlock
+{
+    vector<float>         vertices;
+    vector<unsigned char> colors;
+    vector<float>         texcoords;
+    vector<float>         normals;
+
+    /// 0-based vertex indices. Negative (relative) indices are stored relative to the
+    /// first vertex of the block, see relativeIndices.
+    vector<uint>          faces;
+    vector<size_t>        relativeIndices;
+
+    /// Materials that were selected in this block with the number of faces before
+    vector<pair<size_t, string>> materialSwitches;
+    vector<string>        mtlFiles;
+
+    size_t vertexOffset = 0;
+    size_t faceOffset = 0;
+    size_t texcoordOffset = 0;
+    size_t normalOffset = 0;
+};
+
+void parseObjBlock(const char* p, const char* end, ObjBlock& block)
+{
+    vector<long> polygon;
+    while (p < end)
+    {
+        const char* e = static_cast<const char*>(memchr(p, '\n', end - p));
+        e = e ? e : end;
+
+        p = skipBlanks(p, e);
+        const char* keyEnd = skipToken(p, e);
+        float values[6];
+
+        if (isKeyword(p, keyEnd, "v"))
+        {
+            // Optional colors follow the coordinates
+            p = keyEnd;
+            int n = parseFloats(p, e, values, 6);
+            if (n >= 3)
+            {
+                block.vertices.insert(block.vertices.end(), values, values + 3);
+            }
+            if (n == 6)
+            {
+                for (int i = 3; i < 6; i++)
+                {
+                    block.colors.push_back(static_cast<unsigned char>(values[i] * 255.0 + 0.5));
+                }
+            }
+        }
+        else if (isKeyword(p, keyEnd, "vt"))
+        {
+            p = keyEnd;
+            if (parseFloats(p, e, values, 2) == 2)
+            {
+                block.texcoords.push_back(values[0]);
+                block.texcoords.push_back(1.0 - values[1]);
+            }
+        }
+        else if (isKeyword(p, keyEnd, "vn"))
+        {
+            p = keyEnd;
+            if (parseFloats(p, e, values, 3) == 3)
+            {
+                block.normals.insert(block.normals.end(), values, values + 3);
+            }
+        }
+        else if (isKeyword(p, keyEnd, "f"))
+        {
+            // Collect the vertex indices of the corners, texture and normal
+            // indices are ignored
+            polygon.clear();
+            p = skipBlanks(keyEnd, e);
+            while (p < e)
+            {
+                long index;
+                const char* q = parseInt(p, e, index);
+                if (q == p || index == 0)
+                {
+                    break;
+                }
+                polygon.push_back(index);
+                p = skipBlanks(skipToken(q, e), e);
+            }
+
+            // Triangulate polygons as fans
+            size_t localVertices = block.vertices.size() / 3;
+            for (size_t i = 2; i < polygon.size(); i++)
+            {
+                for (long index : {polygon[0], polygon[i - 1], polygon[i]})
+                {
+                    if (index < 0)
+                    {
+                        block.relativeIndices.push_back(block.faces.size());
+                        block.faces.push_back(static_cast<uint>(localVertices + index));
+                    }
+                    else
+                    {
+                        block.faces.push_back(static_cast<uint>(index - 1));
+                    }
+                }
+            }
+        }
+        else if (isKeyword(p, keyEnd, "usemtl"))
+        {
+            p = skipBlanks(keyEnd, e);
+            block.materialSwitches.emplace_back(block.faces.size() / 3, string(p, skipToken(p, e)));
+        }
+        else if (isKeyword(p, keyEnd, "mtllib"))
+        {
+            p = skipBlanks(keyEnd, e);
+            block.mtlFiles.emplace_back(p, skipToken(p, e));
+        }
+
+        p = e + 1;
+    }
+}
+
+} // namespace
+
 void ObjIO::parseMtlFile(
-        map<string, int>& matNames,
+        unordered_map<string, int>& matNames,
         vector<Material>& materials,
         vector<Texture>& textures,
         string mtlname)
@@ -96,7 +278,7 @@ void ObjIO::parseMtlFile(
     if(in.good())
     {
         char buffer[1024];
-        int matIndex = 0;
+        int matIndex = materials.size();
         while(in.good())
         {
             in.getline(buffer, 1024);
@@ -113,7 +295,7 @@ void ObjIO::parseMtlFile(
             {
                 string matName;
                 ss >> matName;
-                map<string, int>::iterator it = matNames.find(matName);
+                auto it = matNames.find(matName);
                 if(it == matNames.end())
                 {
                     Material m;
@@ -172,151 +354,174 @@ ModelPtr ObjIO::read(string filename)
     // Get path from filename
     boost::filesystem::path p(filename);
 
-    ifstream in(filename.c_str());
-
     MeshBufferPtr mesh = MeshBufferPtr(new MeshBuffer);
-
-    vector<float>         vertices;
-    vector<float>         normals;
-    vector<unsigned char> colors;
-    vector<float>         texcoords;
-    vector<uint>          faceMaterials;
-    vector<uint>          faces;
     vector<Material>&     materials = mesh->getMaterials();
     vector<Texture>&      textures = mesh->getTextures();
 
-    map<string, int> matNames;
+    MappedFile file(filename);
+    if(!file.good())
+    {
+        cout << timestamp << "ObjIO::read(): Unable to open file'" << filename << "'." << endl;
+        ModelPtr m(new Model(mesh));
+        m_model = m;
+        return m;
+    }
 
-    int currentMat = 0;
+    Timestamp ts;
 
-    if(in.good())
+    // Parse blocks of lines in parallel
+    vector<pair<const char*, const char*>> ranges = splitLines(file.begin(), file.end(), BlockSize);
+    vector<ObjBlock> blocks(ranges.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for(size_t i = 0; i < blocks.size(); i++)
     {
-        char buffer[1024];
-        while(in.good())
+        parseObjBlock(ranges[i].first, ranges[i].second, blocks[i]);
+    }
+
+    // Compute the position of each block in the merged buffers
+    size_t numVertices = 0, numColors = 0, numFaces = 0, numTexcoords = 0, numNormals = 0;
+    for(ObjBlock& block : blocks)
+    {
+        block.vertexOffset = numVertices;
+        block.faceOffset = numFaces;
+        block.texcoordOffset = numTexcoords;
+        block.normalOffset = numNormals;
+        numVertices += block.vertices.size() / 3;
+        numColors += block.colors.size() / 3;
+        numFaces += block.faces.size() / 3;
+        numTexcoords += block.texcoords.size() / 2;
+        numNormals += block.normals.size() / 3;
+    }
+
+    // Materials have to be known before faces can be assigned to them
+    unordered_map<string, int> matNames;
+    for(const ObjBlock& block : blocks)
+    {
+        for(const string& mtlfile : block.mtlFiles)
         {
-            in.getline(buffer, 1024);
+            boost::filesystem::path mtl_path = p.parent_path() / mtlfile;
+            parseMtlFile(matNames, materials, textures, mtl_path.string());
+        }
+    }
 
-            // Skip comments
-            if(buffer[0] == '#') continue;
+    floatArr vertices(new float[3 * numVertices]);
+    indexArray faces(new uint[3 * numFaces]);
+    indexArray faceMaterials(new uint[numFaces]);
+    floatArr texcoords;
+    floatArr normals;
+    ucharArr colors;
 
-            stringstream ss(buffer);
-            string keyword;
-            ss >> keyword;
-            float x, y, z;
-            float r, g, b;
-            if(keyword == "v")
-            {
-                ss >> x >> y >> z;
-                vertices.push_back(x);
-                vertices.push_back(y);
-                vertices.push_back(z);
-                // TODO: check if r is end of line
-                std::string s;
-                bool colors_exist = static_cast<bool>(ss >> r);
-                // r = s[0];
-                ss >> g >> b;
-                if(colors_exist)
-                {
-                    colors.push_back(static_cast<unsigned char>(r*255.0 + 0.5));
-                    colors.push_back(static_cast<unsigned char>(g*255.0 + 0.5));
-                    colors.push_back(static_cast<unsigned char>(b*255.0 + 0.5));
-                }
-            }
-            else if(keyword == "vt")
+    // Colors are only used if every vertex has one
+    bool hasColors = numColors > 0 && numColors == numVertices;
+    if(hasColors)
+    {
+        colors = ucharArr(new unsigned char[3 * numVertices]);
+    }
+    else if(numColors > 0)
+    {
+        cout << timestamp << "ObjIO::read(): Warning: Only " << numColors << " of " << numVertices
+             << " vertices have colors. Colors are ignored." << endl;
+    }
+    if(numTexcoords > 0)
+    {
+        texcoords = floatArr(new float[2 * numTexcoords]);
+    }
+    if(numNormals > 0)
+    {
+        normals = floatArr(new float[3 * numNormals]);
+    }
+
+    // Resolve material names. A block continues with the material of the previous one.
+    vector<int> initialMaterial(blocks.size(), 0);
+    int currentMat = 0;
+    for(size_t i = 0; i < blocks.size(); i++)
+    {
+        initialMaterial[i] = currentMat;
+        for(const auto& materialSwitch : blocks[i].materialSwitches)
+        {
+            auto it = matNames.find(materialSwitch.second);
+            if(it == matNames.end())
             {
-                ss >> x >> y >> z;
-                texcoords.push_back(x);
-                texcoords.push_back(1.0 - y);
-                // z is ignored because texcoords only have 2 coords...
-                //texcoords.push_back(z);
+                cout << "ObjIO:read(): Warning material '" << materialSwitch.second << "' is undefined." << endl;
             }
-            else if(keyword == "vn")
+            else
             {
-                ss >> x >> y >> z;
-                normals.push_back(x);
-                normals.push_back(y);
-                normals.push_back(z);
+                currentMat = it->second;
             }
-            else if(keyword == "f")
-            {
-                vector<string> tokens;
-                tokenize(buffer, tokens);
-
-                if(tokens.size() < 4)
-                    continue;
-
-                vector<string> tokens2;
-                tokenize(tokens.at(1),tokens2,"/");
-                int a = atoi(tokens2.at(0).c_str());
-                tokens2.clear();
-
-                tokenize(tokens.at(2),tokens2,"/");
-                int b = atoi(tokens2.at(0).c_str());
-                tokens2.clear();
+        }
+    }
 
-                tokenize(tokens.at(3),tokens2,"/");
-                int c = atoi(tokens2.at(0).c_str());
-                tokens2.clear();
+    // Merge blocks
+    #pragma omp parallel for schedule(dynamic)
+    for(size_t i = 0; i < blocks.size(); i++)
+    {
+        ObjBlock& block = blocks[i];
+        std::copy(block.vertices.begin(), block.vertices.end(), vertices.get() + 3 * block.vertexOffset);
+        if(hasColors)
+        {
+            std::copy(block.colors.begin(), block.colors.end(), colors.get() + 3 * block.vertexOffset);
+        }
+        if(texcoords)
+        {
+            std::copy(block.texcoords.begin(), block.texcoords.end(), texcoords.get() + 2 * block.texcoordOffset);
+        }
+        if(normals)
+        {
+            std::copy(block.normals.begin(), block.normals.end(), normals.get() + 3 * block.normalOffset);
+        }
 
-                faces.push_back(a - 1);
-                faces.push_back(b - 1);
-                faces.push_back(c - 1);
+        for(size_t index : block.relativeIndices)
+        {
+            block.faces[index] += block.vertexOffset;
+        }
+        std::copy(block.faces.begin(), block.faces.end(), faces.get() + 3 * block.faceOffset);
 
-                // Use current material
-                faceMaterials.push_back(currentMat);
-            }
-            else if(keyword == "usemtl")
+        size_t blockFaces = block.faces.size() / 3;
+        int material = initialMaterial[i];
+        size_t face = 0;
+        for(const auto& materialSwitch : block.materialSwitches)
+        {
+            for(; face < materialSwitch.first; face++)
             {
-                string mtlname;
-                ss >> mtlname;
-                // Find name and set current material
-                map<string, int>::iterator it = matNames.find(mtlname);
-                if(it == matNames.end())
-                {
-                    cout << "ObjIO:read(): Warning material '" << mtlname << "' is undefined." << endl;
-                }
-                else
-                {
-                    currentMat = it->second;
-                }
+                faceMaterials[block.faceOffset + face] = material;
             }
-            else if(keyword == "mtllib")
+            auto it = matNames.find(materialSwitch.second);
+            if(it != matNames.end())
             {
-                // Get current path
-                p = p.remove_filename();
-
-                // Append .mtl file name
-                string mtlfile;
-                ss >> mtlfile;
-                p = p / mtlfile;
-
-                // Get path as string and parse mtl
-                string mtl_path = p.string();
-                parseMtlFile(matNames, materials, textures, mtl_path);
+                material = it->second;
             }
         }
+        for(; face < blockFaces; face++)
+        {
+            faceMaterials[block.faceOffset + face] = material;
+        }
 
-    }
-    else
-    {
-        cout << timestamp << "ObjIO::read(): Unable to open file'" << filename << "'." << endl;
+        // Free memory of merged blocks early
+        block = ObjBlock();
     }
 
-    mesh->setVertices(Util::convert_vector_to_shared_array(vertices), vertices.size() / 3);
-    mesh->setFaceIndices(Util::convert_vector_to_shared_array(faces), faces.size() / 3);
+    mesh->setVertices(vertices, numVertices);
+    mesh->setFaceIndices(faces, numFaces);
+    mesh->setFaceMaterialIndices(faceMaterials);
 
-    if(faceMaterials.size() == faces.size() / 3)
+    if(texcoords)
     {
-        mesh->setFaceMaterialIndices(Util::convert_vector_to_shared_array(faceMaterials));
+        mesh->setTextureCoordinates(texcoords);
     }
-    else
+    if(normals)
     {
-        cout << "ObjIO::read(): Warning: Face material index buffer does not match face number." << endl;
+        mesh->setVertexNormals(normals);
+    }
+    if(hasColors)
+    {
+        mesh->setVertexColors(colors);
     }
 
-    mesh->setTextureCoordinates(Util::convert_vector_to_shared_array(texcoords));
-    mesh->setVertexNormals(Util::convert_vector_to_shared_array(normals));
-    mesh->setVertexColors(Util::convert_vector_to_shared_array(colors));
+    double seconds = ts.getElapsedTimeInS();
+    cout << timestamp << "ObjIO::read(): Read " << numVertices << " vertices and " << numFaces
+         << " faces in " << seconds << " s (" << file.size() / (1024.0 * 1024.0) / std::max(seconds, 1e-6)
+         << " MB/s)" << endl;
 
     ModelPtr m(new Model(mesh));
     m_model = m;
@@ -325,14 +530,91 @@ ModelPtr ObjIO::read(string filename)
 }
 
 
-class sort_indices
+namespace
 {
-   private:
-     uintArr faceMaterialIndices;
-   public:
-     sort_indices(uintArr faceMaterialIndices) : faceMaterialIndices(faceMaterialIndices) {}
-     bool operator()(int i, int j) { return faceMaterialIndices[i]<faceMaterialIndices[j]; }
-};
+
+/// Number of lines that are formatted by one thread at once
+const size_t LinesPerChunk = 1 << 14;
+
+/// Maximum length of a line written by ObjIO::save
+const size_t MaxLineLength = 256;
+
+/**
+ * @brief Formats n lines in parallel chunks and writes them in order. The format
+ *        function writes line i into the given buffer and returns its end.
+ */
+template<typename FormatFunc>
+void writeLines(ostream& out, size_t n, FormatFunc format)
+{
+    const size_t chunksPerBatch = 4 * omp_get_max_threads();
+    vector<string> chunks(chunksPerBatch);
+
+    for(size_t first = 0; first < n; first += chunksPerBatch * LinesPerChunk)
+    {
+        size_t numChunks = std::min(chunksPerBatch, (n - first + LinesPerChunk - 1) / LinesPerChunk);
+
+        #pragma omp parallel for schedule(dynamic)
+        for(size_t c = 0; c < numChunks; c++)
+        {
+            size_t begin = first + c * LinesPerChunk;
+            size_t end = std::min(n, begin + LinesPerChunk);
+
+            string& chunk = chunks[c];
+            chunk.resize((end - begin) * MaxLineLength);
+            char* pos = &chunk[0];
+            for(size_t i = begin; i < end; i++)
+            {
+                pos = format(i, pos);
+            }
+            chunk.resize(pos - &chunk[0]);
+        }
+
+        for(size_t c = 0; c < numChunks; c++)
+        {
+            out.write(chunks[c].data(), chunks[c].size());
+        }
+    }
+}
+
+inline char* writeString(char* out, const char* str)
+{
+    size_t n = strlen(str);
+    memcpy(out, str, n);
+    return out + n;
+}
+
+inline char* writeUInt(char* out, size_t value)
+{
+    return std::to_chars(out, out + 20, value).ptr;
+}
+
+/// Writes "f a/b/c ..." with the given per-corner format
+inline char* writeFace(char* out, const uint* face, bool texcoords, bool normals)
+{
+    out = writeString(out, "f");
+    for(int i = 0; i < 3; i++)
+    {
+        *out++ = ' ';
+        out = writeUInt(out, face[i] + 1);
+        if(texcoords || normals)
+        {
+            *out++ = '/';
+            if(texcoords)
+            {
+                out = writeUInt(out, face[i] + 1);
+            }
+            if(normals)
+            {
+                *out++ = '/';
+                out = writeUInt(out, face[i] + 1);
+            }
+        }
+    }
+    *out++ = '\n';
+    return out;
+}
+
+} // namespace
 
 void ObjIO::save( string filename )
 {
@@ -344,11 +626,7 @@ void ObjIO::save( string filename )
 
     size_t w_color;
     size_t lenVertices = m_model->m_mesh->numVertices();
-    size_t lenNormals = lenVertices;
     size_t lenFaces = m_model->m_mesh->numFaces();
-    size_t lenTextureCoordinates = lenVertices;
-    size_t lenFaceMaterialIndices = lenFaces;
-    size_t lenColors = lenVertices;
     floatArr vertices              = m_model->m_mesh->getVertices();
     floatArr normals               = m_model->m_mesh->getVertexNormals();
     floatArr textureCoordinates    = m_model->m_mesh->getTextureCoordinates();
@@ -378,191 +656,145 @@ void ObjIO::save( string filename )
         }
     }
 
+    if ( !vertices )
+    {
+        cerr << "Received no vertices to store. Aborting save operation." << endl;
+        return;
+    }
 
-    std::set<unsigned int> materialIndexSet;
-    std::set<unsigned int> colorIndexSet;
+    Timestamp ts;
 
-    ofstream out(filename.c_str());
+    ofstream out(filename.c_str(), std::ios::binary);
     ofstream mtlFile("textures.mtl");
 
     if(out.good())
     {
         out<<"mtllib textures.mtl"<<endl;
 
-        if ( !vertices )
-        {
-            cerr << "Received no vertices to store. Aborting save operation." << endl;
-            return;
-        }
         out << endl << endl << "##  Beginning of vertex definitions.\n";
 
-        for( size_t i=0; i < lenVertices; ++i )
+        writeLines(out, lenVertices, [&](size_t i, char* pos)
         {
-            out << "v " << vertices[i*3 + 0] << " "
-                    << vertices[i*3 + 1] << " "
-                    << vertices[i*3 + 2] << " ";
-                    if(lenColors>0){
-                        unsigned char r = colors[i*w_color + 0],
-                                      g = colors[i*w_color + 1],
-                                      b = colors[i*w_color + 2];
-
-                        out << static_cast<float>(r)/255.0 << " "
-                        << static_cast<float>(g)/255.0 << " "
-                        << static_cast<float>(b)/255.0 ;
-                    }
-
-                    out << endl;
-        }
+            pos = writeString(pos, "v");
+            for(int j = 0; j < 3; j++)
+            {
+                *pos++ = ' ';
+                pos = formatFloat(pos, vertices[i * 3 + j]);
+            }
+            if(colors)
+            {
+                for(int j = 0; j < 3; j++)
+                {
+                    *pos++ = ' ';
+                    pos = formatFloat(pos, colors[i * w_color + j] / 255.0f);
+                }
+            }
+            *pos++ = '\n';
+            return pos;
+        });
 
         out<<endl;
 
-        if (m_model->m_mesh->hasVertexNormals())
+        if (normals)
         {
             out << endl << endl << "##  Beginning of vertex normals.\n";
-            for( size_t i=0; i < lenNormals; ++i )
+            writeLines(out, lenVertices, [&](size_t i, char* pos)
             {
-                out << "vn " << normals[i*3 + 0] << " "
-                        << normals[i*3 + 1] << " "
-                        << normals[i*3 + 2] << endl;
-            }
+                pos = writeString(pos, "vn");
+                for(int j = 0; j < 3; j++)
+                {
+                    *pos++ = ' ';
+                    pos = formatFloat(pos, normals[i * 3 + j]);
+                }
+                *pos++ = '\n';
+                return pos;
+            });
         }
 
-        out << endl << endl << "##  Beginning of vertexTextureCoordinates.\n";
-
-        for( size_t i=0; i < lenTextureCoordinates; ++i )
+        if (textureCoordinates)
         {
-            out << "vt " << textureCoordinates[i*2 + 0] << " "
-                    << 1.0 - textureCoordinates[i*2 + 1] << " "
-                    << 0.0 << endl;
+            out << endl << endl << "##  Beginning of vertexTextureCoordinates.\n";
+            writeLines(out, lenVertices, [&](size_t i, char* pos)
+            {
+                pos = writeString(pos, "vt ");
+                pos = formatFloat(pos, textureCoordinates[i * 2 + 0]);
+                *pos++ = ' ';
+                pos = formatFloat(pos, 1.0f - textureCoordinates[i * 2 + 1]);
+                return writeString(pos, " 0\n");
+            });
         }
 
-
         out << endl << endl << "##  Beginning of faces.\n";
-        // format of a face: f v/vt/vn
-        //for( size_t i = 0; i < lenFaces; ++i )
-        //{
-            //cout << faceMaterialIndices[i] << " " << lenFaceMaterials << endl;
-            //RGBMaterial* m = materials[faceMaterialIndices[i]];
-            //if(m->texture_index >= 0)
-            //{
-                //out << "usemtl texture_" << m->texture_index << endl;
-            //}
-            //else
-            //{
-                //out << "usemtl color_" << faceMaterialIndices[i] << endl;
-            //}
-
-            ////unsigned int* faceTextureIndices
-            ////float**       textureCoordinates
-            ////usemtl....
-            //// +1 after every index since in obj the 0-th vertex has index 1.
-            //out << "f "
-                    //<< faceIndices[i * 3 + 0] + 1 << "/"
-                    //<< faceIndices[i * 3 + 0] + 1 << "/"
-                    //<< faceIndices[i * 3 + 0] + 1 << " "
-                    //<< faceIndices[i * 3 + 1] + 1 << "/"
-                    //<< faceIndices[i * 3 + 1] + 1 << "/"
-                    //<< faceIndices[i * 3 + 1] + 1 << " "
-                    //<< faceIndices[i * 3 + 2] + 1 << "/"
-                    //<< faceIndices[i * 3 + 2] + 1 << "/"
-                    //<< faceIndices[i * 3 + 2] + 1 << endl;
-        //}
 
         // format of a face: f v/vt/vn
+        bool texcoords = static_cast<bool>(textureCoordinates);
+        bool vertexNormals = static_cast<bool>(normals);
 
-        std::vector<int> color_indices, texture_indices;
-
-        //splitting materials in colors an textures
-        for(size_t i = 0; i< lenFaceMaterialIndices; ++i)
+        if (faceIndices && faceMaterialIndices && !materials.empty())
         {
-            Material &m = materials[faceMaterialIndices[i]];
-            if(m.m_texture)
+            // Split faces into colored and textured ones, sorted by material
+            std::vector<uint> color_indices, texture_indices;
+            for(size_t i = 0; i < lenFaces; ++i)
             {
-                texture_indices.push_back(i);
-            }else{
-                color_indices.push_back(i);
+                Material &m = materials[faceMaterialIndices[i]];
+                if(m.m_texture)
+                {
+                    texture_indices.push_back(i);
+                }
+                else
+                {
+                    color_indices.push_back(i);
+                }
             }
-        }
-        //sort faceMaterialsIndices: colors, textur_indices
-        //sort new index lists instead of the faceMaterialIndices
-        std::sort(color_indices.begin(),color_indices.end(),sort_indices(faceMaterialIndices));
-        std::sort(texture_indices.begin(),texture_indices.end(),sort_indices(faceMaterialIndices));
 
-        //colors
-        for(size_t i = 0; i<color_indices.size() ; i++)
-        {
-            unsigned int first = faceMaterialIndices[color_indices[i]];
-            unsigned int face_index=color_indices[i];
+            auto byMaterial = [&](uint i, uint j) { return faceMaterialIndices[i] < faceMaterialIndices[j]; };
+            std::stable_sort(color_indices.begin(), color_indices.end(), byMaterial);
+            std::stable_sort(texture_indices.begin(), texture_indices.end(), byMaterial);
 
-            if( i == 0 || first != faceMaterialIndices[color_indices[i-1]] )
+            //colors
+            writeLines(out, color_indices.size(), [&](size_t i, char* pos)
             {
-                out << "usemtl color_" << faceMaterialIndices[color_indices[i]] << endl;
-                out << "f "
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << " "
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << " "
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << endl;
-
-            }else if( first == faceMaterialIndices[color_indices[i-1]] )
-            {
-                out << "f "
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << " "
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << " "
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << endl;
-            }
-        }
-
-        out<<endl;
+                uint face = color_indices[i];
+                uint material = faceMaterialIndices[face];
+                if(i == 0 || material != faceMaterialIndices[color_indices[i - 1]])
+                {
+                    pos = writeString(pos, "usemtl color_");
+                    pos = writeUInt(pos, material);
+                    *pos++ = '\n';
+                }
+                return writeFace(pos, faceIndices.get() + 3 * face, texcoords, vertexNormals);
+            });
 
-        //textures
-        for(size_t i = 0; i<texture_indices.size() ; i++)
-        {
-            Material &first = materials[faceMaterialIndices[texture_indices[i]]];
-            size_t face_index=texture_indices[i];
+            out<<endl;
 
-            if(i==0 || first.m_texture != materials[faceMaterialIndices[texture_indices[i-1]]].m_texture )
+            //textures
+            writeLines(out, texture_indices.size(), [&](size_t i, char* pos)
             {
-                out << "usemtl texture_" << first.m_texture->idx() << endl;
-                //std::cout << "usemtl texture_" << first->texture_index << std::endl;
-                out << "f "
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << " "
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << " "
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << endl;
-            }else if(first.m_texture == materials[faceMaterialIndices[texture_indices[i-1]]].m_texture )
+                uint face = texture_indices[i];
+                const Material& first = materials[faceMaterialIndices[face]];
+                if(i == 0 || first.m_texture != materials[faceMaterialIndices[texture_indices[i - 1]]].m_texture)
+                {
+                    pos = writeString(pos, "usemtl texture_");
+                    pos = writeUInt(pos, first.m_texture->idx());
+                    *pos++ = '\n';
+                }
+                return writeFace(pos, faceIndices.get() + 3 * face, texcoords, vertexNormals);
+            });
+        }
+        else if (faceIndices)
+        {
+            writeLines(out, lenFaces, [&](size_t i, char* pos)
             {
-                out << "f "
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << " "
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << " "
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << endl;
-            }
+                return writeFace(pos, faceIndices.get() + 3 * i, texcoords, vertexNormals);
+            });
         }
 
-
         out<<endl;
         out.close();
+
+        double seconds = ts.getElapsedTimeInS();
+        cout << timestamp << "ObjIO::save(): Wrote " << lenVertices << " vertices and " << lenFaces
+             << " faces in " << seconds << " s" << endl;
     }
     else
     {
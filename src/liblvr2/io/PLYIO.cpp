@@ -40,6 +40,7 @@
 
 
 #include "lvr2/io/PLYIO.hpp"
+#include "lvr2/io/PLYWriter.hpp"
 #include "lvr2/io/Timestamp.hpp"
 
 #include <cstring>
@@ -56,349 +57,9 @@ namespace lvr2
 
 void PLYIO::save( string filename )
 {
-    if ( !m_model )
-    {
-        std::cerr << timestamp << "No data to save." << std::endl;
-        return;
-    }
-
-    /* Handle options. */
-    e_ply_storage_mode mode( PLY_LITTLE_ENDIAN );
-
-    // Local buffer shortcuts
-    floatArr m_vertices;
-    floatArr m_vertexConfidence;
-    floatArr m_vertexIntensity;
-    floatArr m_vertexNormals;
-    floatArr m_points;
-    floatArr m_pointConfidences;
-    floatArr m_pointIntensities;
-    floatArr m_pointNormals;
-
-    size_t dummy                    = 0;
-    size_t w_point_color            = 0;
-    size_t w_vertex_color            = 0;
-    size_t m_numVertices              = 0;
-    size_t m_numVertexColors          = 0;
-    size_t m_numVertexConfidences     = 0;
-    size_t m_numVertexIntensities     = 0;
-    size_t m_numVertexNormals         = 0;
-
-    size_t m_numPoints                = 0;
-    size_t m_numPointColors           = 0;
-    size_t m_numPointConfidence       = 0;
-    size_t m_numPointIntensities      = 0;
-    size_t m_numPointNormals          = 0;
-    size_t m_numFaces                 = 0;
-
-    ucharArr m_vertexColors;
-    ucharArr m_pointColors;
-    uintArr  m_faceIndices;
-
-    // Get buffers
-    if ( m_model->m_pointCloud )
-    {
-        PointBufferPtr pc( m_model->m_pointCloud );
-
-        m_numPoints = pc->numPoints();
-        m_numPointNormals = m_numPoints;
-        m_numPointColors = m_numPoints;
-
-        m_points                = pc->getPointArray();
-        m_pointConfidences      = pc->getFloatArray("confidences", m_numPointConfidence, dummy);
-        m_pointColors           = pc->getColorArray(w_point_color);
-        m_pointIntensities      = pc->getFloatArray("intensities", m_numPointIntensities, dummy);
-        m_pointNormals          = pc->getNormalArray();
-    }
-
-    if ( m_model->m_mesh )
-    {
-        MeshBufferPtr mesh( m_model->m_mesh );
-        m_numVertices = mesh->numVertices();
-        m_numFaces = mesh->numFaces();
-        m_numVertexColors = m_numVertices;
-        m_numVertexNormals = m_numVertices;
-
-        m_vertices         = mesh->getVertices();
-        m_vertexColors     = mesh->getVertexColors(w_vertex_color);
-        m_vertexConfidence = mesh->getFloatArray("vertex_confidences", m_numVertexConfidences, dummy);
-        m_vertexIntensity  = mesh->getFloatArray("vertex_intensities", m_numVertexIntensities, dummy);
-        m_vertexNormals    = mesh->getVertexNormals();
-        m_faceIndices      = mesh->getFaceIndices();
-    }
-
-
-    p_ply oply = ply_create( filename.c_str(), mode, NULL, 0, NULL );
-    if ( !oply )
-    {
-        std::cerr << timestamp << "Could not create »" << filename << "«" << std::endl;
-        return;
-    }
-
-    /* Check if we have vertex information. */
-    if ( !( m_vertices || m_points ) )
-    {
-        std::cout << timestamp << "Neither vertices nor points to write." << std::endl;
-        if ( !ply_close( oply ) )
-        {
-            std::cerr << timestamp << "Could not close file." << std::endl;
-        }
-        return;
-    }
-
-    /* First: Write Header information according to data. */
-
-    bool vertex_color      = false;
-    bool vertex_intensity  = false;
-    bool vertex_confidence = false;
-    bool vertex_normal     = false;
-    bool point_color       = false;
-    bool point_intensity   = false;
-    bool point_confidence  = false;
-    bool point_normal      = false;
-
-
-    /* Add vertex element. */
-    if ( m_vertices )
-    {
-        ply_add_element( oply, "vertex", m_numVertices );
-
-        /* Add vertex properties: x, y, z, (r, g, b) */
-        ply_add_scalar_property( oply, "x", PLY_FLOAT );
-        ply_add_scalar_property( oply, "y", PLY_FLOAT );
-        ply_add_scalar_property( oply, "z", PLY_FLOAT );
-
-        /* Add color information if there is any. */
-        if ( m_vertexColors )
-        {
-            if ( m_numVertexColors != m_numVertices )
-            {
-                std::cerr << timestamp << "Amount of vertices and color information is"
-                    << " not equal. Color information won't be written." << std::endl;
-            }
-            else
-            {
-                ply_add_scalar_property( oply, "red",   PLY_UCHAR );
-                ply_add_scalar_property( oply, "green", PLY_UCHAR );
-                ply_add_scalar_property( oply, "blue",  PLY_UCHAR );
-                vertex_color = true;
-            }
-        }
-
-        /* Add intensity. */
-        if ( m_vertexIntensity )
-        {
-            if ( m_numVertexIntensities != m_numVertices )
-            {
-                std::cout << timestamp << "Amount of vertices and intensity"
-                    << " information is not equal. Intensity information won't be"
-                    << " written." << std::endl;
-            }
-            else
-            {
-                ply_add_scalar_property( oply, "intensity",  PLY_FLOAT );
-                vertex_intensity = true;
-            }
-        }
-
-        /* Add confidence. */
-        if ( m_vertexConfidence )
-        {
-            if ( m_numVertexConfidences != m_numVertices )
-            {
-                std::cout << timestamp << "Amount of vertices and confidence"
-                    << " information is not equal. Confidence information won't be"
-                    << " written." << std::endl;
-            }
-            else
-            {
-                ply_add_scalar_property( oply, "confidence",  PLY_FLOAT );
-                vertex_confidence = true;
-            }
-        }
-
-        /* Add normals if there are any. */
-        if ( m_vertexNormals )
-        {
-            if ( m_numVertexNormals != m_numVertices )
-            {
-                std::cout << timestamp << "Amount of vertices and normals"
-                    << " does not match. Normals won't be written." << std::endl;
-            }
-            else
-            {
-                ply_add_scalar_property( oply, "nx", PLY_FLOAT );
-                ply_add_scalar_property( oply, "ny", PLY_FLOAT );
-                ply_add_scalar_property( oply, "nz", PLY_FLOAT );
-                vertex_normal = true;
-            }
-        }
-
-        /* Add faces. */
-        if ( m_faceIndices )
-        {
-            ply_add_element( oply, "face", m_numFaces );
-            ply_add_list_property( oply, "vertex_indices", PLY_UCHAR, PLY_INT );
-        }
-    }
-
-    /* Add point element */
-    if ( m_points )
-    {
-        ply_add_element( oply, "point", m_numPoints );
-
-        /* Add point properties: x, y, z, (r, g, b) */
-        ply_add_scalar_property( oply, "x", PLY_FLOAT );
-        ply_add_scalar_property( oply, "y", PLY_FLOAT );
-        ply_add_scalar_property( oply, "z", PLY_FLOAT );
-
-        /* Add color information if there is any. */
-        if ( m_pointColors )
-        {
-            if ( m_numPointColors != m_numPoints )
-            {
-                std::cout << timestamp << "Amount of points and color information is"
-                    << " not equal. Color information won't be written." << std::endl;
-            }
-            else
-            {
-                ply_add_scalar_property( oply, "red",   PLY_UCHAR );
-                ply_add_scalar_property( oply, "green", PLY_UCHAR );
-                ply_add_scalar_property( oply, "blue",  PLY_UCHAR );
-                point_color = true;
-            }
-        }
-
-        /* Add intensity. */
-        if ( m_pointIntensities )
-        {
-            if ( m_numPointIntensities != m_numPoints )
-            {
-                std::cout << timestamp << "Amount of points and intensity"
-                    << " information is not equal. Intensity information won't be"
-                    << " written." << std::endl;
-            }
-            else
-            {
-                ply_add_scalar_property( oply, "intensity",  PLY_FLOAT );
-                point_intensity = true;
-            }
-        }
-
-        /* Add confidence. */
-        if ( m_pointConfidences )
-        {
-            if ( m_numPointConfidence != m_numPoints )
-            {
-                std::cout << timestamp << "Amount of point and confidence"
-                    << " information is not equal. Confidence information won't be"
-                    << " written." << std::endl;
-            }
-            else
-            {
-                ply_add_scalar_property( oply, "confidence",  PLY_FLOAT );
-                point_confidence = true;
-            }
-        }
-
-        /* Add normals if there are any. */
-        if ( m_pointNormals )
-        {
-            if ( m_numPointNormals != m_numPoints )
-            {
-                std::cout << timestamp << "Amount of point and normals does"
-                    << " not match. Normals won't be written." << std::endl;
-            }
-            else
-            {
-                ply_add_scalar_property( oply, "nx", PLY_FLOAT );
-                ply_add_scalar_property( oply, "ny", PLY_FLOAT );
-                ply_add_scalar_property( oply, "nz", PLY_FLOAT );
-                point_normal = true;
-            }
-        }
-    }
-
-    /* Write header to file. */
-    if ( !ply_write_header( oply ) )
-    {
-        std::cerr << timestamp << "Could not write header." << std::endl;
-        return;
-    }
-
-    /* Second: Write data. */
-
-    for (size_t i = 0; i < m_numVertices; i++ )
-    {
-        ply_write( oply, (double) m_vertices[ i * 3     ] ); /* x */
-        ply_write( oply, (double) m_vertices[ i * 3 + 1 ] ); /* y */
-        ply_write( oply, (double) m_vertices[ i * 3 + 2 ] ); /* z */
-        if ( vertex_color )
-        {
-            ply_write( oply, m_vertexColors[ i * w_vertex_color     ] ); /* red */
-            ply_write( oply, m_vertexColors[ i * w_vertex_color + 1 ] ); /* green */
-            ply_write( oply, m_vertexColors[ i * w_vertex_color + 2 ] ); /* blue */
-        }
-        if ( vertex_intensity )
-        {
-            ply_write( oply, m_vertexIntensity[ i ] );
-        }
-        if ( vertex_confidence )
-        {
-            ply_write( oply, m_vertexConfidence[ i ] );
-        }
-        if ( vertex_normal )
-        {
-            ply_write( oply, (double) m_vertexNormals[ i * 3     ] ); /* nx */
-            ply_write( oply, (double) m_vertexNormals[ i * 3 + 1 ] ); /* ny */
-            ply_write( oply, (double) m_vertexNormals[ i * 3 + 2 ] ); /* nz */
-        }
-    }
-
-    /* Write faces (Only if we also have vertices). */
-    if ( m_vertices )
-    {
-        for ( size_t i = 0; i < m_numFaces; i++ )
-        {
-            ply_write( oply, 3.0 ); /* Indices per face. */
-            ply_write( oply, (double) m_faceIndices[ i * 3     ] );
-            ply_write( oply, (double) m_faceIndices[ i * 3 + 1 ] );
-            ply_write( oply, (double) m_faceIndices[ i * 3 + 2 ] );
-        }
-    }
-
-    for ( size_t i = 0; i < m_numPoints; i++ )
-    {
-        ply_write( oply, (double) m_points[ i * 3     ] ); /* x */
-        ply_write( oply, (double) m_points[ i * 3 + 1 ] ); /* y */
-        ply_write( oply, (double) m_points[ i * 3 + 2 ] ); /* z */
-        if ( point_color )
-        {
-            ply_write( oply, m_pointColors[ i * w_point_color     ] ); /* red */
-            ply_write( oply, m_pointColors[ i * w_point_color + 1 ] ); /* green */
-            ply_write( oply, m_pointColors[ i * w_point_color + 2 ] ); /* blue */
-        }
-        if ( point_intensity )
-        {
-            ply_write( oply, m_pointIntensities[ i ] );
-        }
-        if ( point_confidence )
-        {
-            ply_write( oply, m_pointConfidences[ i ] );
-        }
-        if ( point_normal )
-        {
-            ply_write( oply, (double) m_pointNormals[ i * 3     ] ); /* nx */
-            ply_write( oply, (double) m_pointNormals[ i * 3 + 1 ] ); /* ny */
-            ply_write( oply, (double) m_pointNormals[ i * 3 + 2 ] ); /* nz */
-        }
-    }
-
-    if ( !ply_close( oply ) )
-    {
-       std::cerr << timestamp << "Could not close file." << std::endl;
-    }
-
+    // Channels are encoded into binary records in parallel and written in
+    // large blocks, see PLYWriter
+    PLYWriter::save( m_model, filename );
 }
 
 
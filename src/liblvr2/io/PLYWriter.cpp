@@ -0,0 +1,557 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * PLYWriter.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/io/PLYWriter.hpp"
+#include "lvr2/io/Timestamp.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace lvr2
+{
+
+namespace
+{
+
+/// Size of the blocks that are encoded and written at once
+const size_t BlockSize = 1 << 24;
+
+/// Number of records that are encoded by one thread at once
+const size_t ChunkSize = 1 << 12;
+
+const char* typeName(PLYType type)
+{
+    switch (type)
+    {
+    case PLYType::UCHAR:
+        return "uchar";
+    case PLYType::INT:
+        return "int";
+    case PLYType::UINT:
+        return "uint";
+    default:
+        return "float";
+    }
+}
+
+size_t typeSize(PLYType type)
+{
+    return type == PLYType::UCHAR ? 1 : 4;
+}
+
+/// memcpy with compile time sizes for the common property groups
+inline void copyBytes(char* dst, const char* src, size_t n)
+{
+    switch (n)
+    {
+    case 1:
+        *dst = *src;
+        break;
+    case 3:
+        std::memcpy(dst, src, 3);
+        break;
+    case 4:
+        std::memcpy(dst, src, 4);
+        break;
+    case 12:
+        std::memcpy(dst, src, 12);
+        break;
+    default:
+        std::memcpy(dst, src, n);
+        break;
+    }
+}
+
+bool isLittleEndian()
+{
+    const uint16_t one = 1;
+    return *reinterpret_cast<const uint8_t*>(&one) == 1;
+}
+
+} // namespace
+
+const size_t PLYWriter::UnknownCount = static_cast<size_t>(-1);
+
+size_t PLYWriter::Group::size() const
+{
+    return list ? 1 + 3 * sizeof(int32_t) : names.size() * typeSize(type);
+}
+
+PLYWriter::PLYWriter(const std::string& filename)
+    : m_file(fopen(filename.c_str(), "wb")),
+      m_good(m_file != nullptr),
+      m_headerWritten(false),
+      m_current(0),
+      m_buffer(0)
+{
+    if (!m_good)
+    {
+        std::cerr << timestamp << "PLYWriter: Could not create »" << filename << "«" << std::endl;
+    }
+}
+
+PLYWriter::~PLYWriter()
+{
+    close();
+}
+
+void PLYWriter::addElement(const std::string& name, size_t count)
+{
+    m_elements.push_back({name, count, 0, -1, {}, 0});
+}
+
+void PLYWriter::addProperties(const std::vector<std::string>& names, PLYType type, size_t width)
+{
+    Element& element = m_elements.back();
+    element.groups.push_back({names, type, width ? width : names.size(), false});
+    element.recordSize += element.groups.back().size();
+}
+
+void PLYWriter::addTriangleList(const std::string& name)
+{
+    Element& element = m_elements.back();
+    element.groups.push_back({{name}, PLYType::UINT, 3, true});
+    element.recordSize += element.groups.back().size();
+}
+
+bool PLYWriter::writeHeader()
+{
+    if (!m_good)
+    {
+        return false;
+    }
+
+    fprintf(m_file, "ply\nformat %s 1.0\n", isLittleEndian() ? "binary_little_endian" : "binary_big_endian");
+    for (Element& element : m_elements)
+    {
+        fprintf(m_file, "element %s ", element.name.c_str());
+        if (element.count == UnknownCount)
+        {
+            // Reserve a fixed width field that is filled in on close()
+            element.countPosition = ftell(m_file);
+            fprintf(m_file, "%020zu\n", size_t(0));
+        }
+        else
+        {
+            fprintf(m_file, "%zu\n", element.count);
+        }
+
+        for (const Group& group : element.groups)
+        {
+            for (const std::string& name : group.names)
+            {
+                if (group.list)
+                {
+                    fprintf(m_file, "property list uchar int %s\n", name.c_str());
+                }
+                else
+                {
+                    fprintf(m_file, "property %s %s\n", typeName(group.type), name.c_str());
+                }
+            }
+        }
+    }
+    m_good = fprintf(m_file, "end_header\n") > 0;
+    m_headerWritten = true;
+    return m_good;
+}
+
+void PLYWriter::encode(const Element& element, const std::vector<const void*>& sources,
+                       size_t first, size_t n, char* out) const
+{
+    const size_t recordSize = element.recordSize;
+    const long numChunks = (n + ChunkSize - 1) / ChunkSize;
+
+    #pragma omp parallel for schedule(static)
+    for (long c = 0; c < numChunks; c++)
+    {
+        size_t begin = c * ChunkSize;
+        size_t end = std::min(n, begin + ChunkSize);
+
+        size_t offset = 0;
+        for (size_t g = 0; g < element.groups.size(); g++)
+        {
+            const Group& group = element.groups[g];
+            const char* src = static_cast<const char*>(sources[g]);
+            char* dst = out + offset;
+
+            if (group.list)
+            {
+                const size_t stride = 3 * sizeof(uint32_t);
+                for (size_t i = begin; i < end; i++)
+                {
+                    dst[i * recordSize] = 3;
+                    copyBytes(dst + i * recordSize + 1, src + (first + i) * stride, stride);
+                }
+            }
+            else
+            {
+                const size_t bytes = group.size();
+                const size_t stride = group.width * typeSize(group.type);
+                for (size_t i = begin; i < end; i++)
+                {
+                    copyBytes(dst + i * recordSize, src + (first + i) * stride, bytes);
+                }
+            }
+            offset += group.size();
+        }
+    }
+}
+
+void PLYWriter::finishWrite()
+{
+    if (m_pendingWrite.valid())
+    {
+        m_good = m_pendingWrite.get() && m_good;
+    }
+}
+
+void PLYWriter::startWrite(size_t size)
+{
+    int index = m_buffer;
+    m_pendingWrite = std::async(std::launch::async, [this, index, size]()
+    {
+        return fwrite(m_buffers[index].data(), 1, size, m_file) == size;
+    });
+    m_buffer = 1 - m_buffer;
+}
+
+bool PLYWriter::write(const std::string& element, const std::vector<const void*>& sources, size_t n)
+{
+    if (!m_good || !m_headerWritten)
+    {
+        return false;
+    }
+
+    // Advance to the requested element
+    while (m_current < m_elements.size() && m_elements[m_current].name != element)
+    {
+        if (!finishElement())
+        {
+            return false;
+        }
+        m_current++;
+    }
+
+    if (m_current == m_elements.size())
+    {
+        std::cerr << timestamp << "PLYWriter: Element '" << element
+                  << "' was not declared or was already written." << std::endl;
+        m_good = false;
+        return false;
+    }
+
+    Element& e = m_elements[m_current];
+    if (sources.size() != e.groups.size())
+    {
+        std::cerr << timestamp << "PLYWriter: Expected " << e.groups.size()
+                  << " sources for element '" << element << "'." << std::endl;
+        m_good = false;
+        return false;
+    }
+
+    if (e.count != UnknownCount && e.written + n > e.count)
+    {
+        std::cerr << timestamp << "PLYWriter: Too many records for element '" << element << "'." << std::endl;
+        m_good = false;
+        return false;
+    }
+
+    // Encode blocks while the previous one is written
+    const size_t recordsPerBlock = std::max<size_t>(1, BlockSize / e.recordSize);
+    for (size_t first = 0; first < n; first += recordsPerBlock)
+    {
+        size_t num = std::min(recordsPerBlock, n - first);
+        std::vector<char>& buffer = m_buffers[m_buffer];
+        if (buffer.size() < num * e.recordSize)
+        {
+            buffer.resize(num * e.recordSize);
+        }
+
+        encode(e, sources, first, num, buffer.data());
+        finishWrite();
+        startWrite(num * e.recordSize);
+    }
+    e.written += n;
+
+    return m_good;
+}
+
+bool PLYWriter::finishElement()
+{
+    Element& e = m_elements[m_current];
+    if (e.count != UnknownCount && e.written != e.count)
+    {
+        std::cerr << timestamp << "PLYWriter: Wrote " << e.written << " of " << e.count
+                  << " records of element '" << e.name << "'." << std::endl;
+        m_good = false;
+    }
+    return m_good;
+}
+
+bool PLYWriter::close()
+{
+    if (!m_file)
+    {
+        return m_good;
+    }
+
+    if (m_headerWritten)
+    {
+        for (; m_current < m_elements.size(); m_current++)
+        {
+            finishElement();
+        }
+    }
+    finishWrite();
+
+    // Fill in the counts of elements that were streamed
+    for (const Element& e : m_elements)
+    {
+        if (e.countPosition >= 0)
+        {
+            fseek(m_file, e.countPosition, SEEK_SET);
+            fprintf(m_file, "%020zu", e.written);
+        }
+    }
+
+    m_good = fclose(m_file) == 0 && m_good;
+    m_file = nullptr;
+    return m_good;
+}
+
+bool PLYWriter::save(ModelPtr model, const std::string& filename)
+{
+    if (!model)
+    {
+        std::cerr << timestamp << "No data to save." << std::endl;
+        return false;
+    }
+
+    size_t w_point_color = 0;
+    size_t w_vertex_color = 0;
+    size_t w_point_intensity = 0;
+    size_t w_point_confidence = 0;
+    size_t w_vertex_intensity = 0;
+    size_t w_vertex_confidence = 0;
+    size_t numPointIntensities = 0;
+    size_t numPointConfidences = 0;
+    size_t numVertexIntensities = 0;
+    size_t numVertexConfidences = 0;
+
+    size_t numPoints = 0;
+    size_t numVertices = 0;
+    size_t numFaces = 0;
+
+    floatArr points, pointIntensities, pointConfidences, pointNormals;
+    floatArr vertices, vertexIntensities, vertexConfidences, vertexNormals;
+    ucharArr pointColors, vertexColors;
+    indexArray faceIndices;
+
+    if (model->m_pointCloud)
+    {
+        PointBufferPtr pc = model->m_pointCloud;
+        numPoints        = pc->numPoints();
+        points           = pc->getPointArray();
+        pointColors      = pc->getColorArray(w_point_color);
+        pointIntensities = pc->getFloatArray("intensities", numPointIntensities, w_point_intensity);
+        pointConfidences = pc->getFloatArray("confidences", numPointConfidences, w_point_confidence);
+        pointNormals     = pc->getNormalArray();
+    }
+
+    if (model->m_mesh)
+    {
+        MeshBufferPtr mesh = model->m_mesh;
+        numVertices       = mesh->numVertices();
+        numFaces          = mesh->numFaces();
+        vertices          = mesh->getVertices();
+        vertexColors      = mesh->getVertexColors(w_vertex_color);
+        vertexIntensities = mesh->getFloatArray("vertex_intensities", numVertexIntensities, w_vertex_intensity);
+        vertexConfidences = mesh->getFloatArray("vertex_confidences", numVertexConfidences, w_vertex_confidence);
+        vertexNormals     = mesh->getVertexNormals();
+        faceIndices       = mesh->getFaceIndices();
+    }
+
+    if (!(vertices || points))
+    {
+        std::cout << timestamp << "Neither vertices nor points to write." << std::endl;
+        return false;
+    }
+
+    PLYWriter writer(filename);
+    if (!writer.good())
+    {
+        return false;
+    }
+
+    std::vector<const void*> vertexSources;
+    std::vector<const void*> faceSources;
+    std::vector<const void*> pointSources;
+
+    if (vertices)
+    {
+        writer.addElement("vertex", numVertices);
+        writer.addProperties({"x", "y", "z"}, PLYType::FLOAT);
+        vertexSources.push_back(vertices.get());
+
+        if (vertexColors)
+        {
+            writer.addProperties({"red", "green", "blue"}, PLYType::UCHAR, w_vertex_color);
+            vertexSources.push_back(vertexColors.get());
+        }
+
+        if (vertexIntensities)
+        {
+            if (numVertexIntensities != numVertices)
+            {
+                std::cout << timestamp << "Amount of vertices and intensity"
+                    << " information is not equal. Intensity information won't be"
+                    << " written." << std::endl;
+            }
+            else
+            {
+                writer.addProperties({"intensity"}, PLYType::FLOAT, w_vertex_intensity);
+                vertexSources.push_back(vertexIntensities.get());
+            }
+        }
+
+        if (vertexConfidences)
+        {
+            if (numVertexConfidences != numVertices)
+            {
+                std::cout << timestamp << "Amount of vertices and confidence"
+                    << " information is not equal. Confidence information won't be"
+                    << " written." << std::endl;
+            }
+            else
+            {
+                writer.addProperties({"confidence"}, PLYType::FLOAT, w_vertex_confidence);
+                vertexSources.push_back(vertexConfidences.get());
+            }
+        }
+
+        if (vertexNormals)
+        {
+            writer.addProperties({"nx", "ny", "nz"}, PLYType::FLOAT);
+            vertexSources.push_back(vertexNormals.get());
+        }
+
+        if (faceIndices)
+        {
+            writer.addElement("face", numFaces);
+            writer.addTriangleList();
+            faceSources.push_back(faceIndices.get());
+        }
+    }
+
+    if (points)
+    {
+        writer.addElement("point", numPoints);
+        writer.addProperties({"x", "y", "z"}, PLYType::FLOAT);
+        pointSources.push_back(points.get());
+
+        if (pointColors)
+        {
+            writer.addProperties({"red", "green", "blue"}, PLYType::UCHAR, w_point_color);
+            pointSources.push_back(pointColors.get());
+        }
+
+        if (pointIntensities)
+        {
+            if (numPointIntensities != numPoints)
+            {
+                std::cout << timestamp << "Amount of points and intensity"
+                    << " information is not equal. Intensity information won't be"
+                    << " written." << std::endl;
+            }
+            else
+            {
+                writer.addProperties({"intensity"}, PLYType::FLOAT, w_point_intensity);
+                pointSources.push_back(pointIntensities.get());
+            }
+        }
+
+        if (pointConfidences)
+        {
+            if (numPointConfidences != numPoints)
+            {
+                std::cout << timestamp << "Amount of point and confidence"
+                    << " information is not equal. Confidence information won't be"
+                    << " written." << std::endl;
+            }
+            else
+            {
+                writer.addProperties({"confidence"}, PLYType::FLOAT, w_point_confidence);
+                pointSources.push_back(pointConfidences.get());
+            }
+        }
+
+        if (pointNormals)
+        {
+            writer.addProperties({"nx", "ny", "nz"}, PLYType::FLOAT);
+            pointSources.push_back(pointNormals.get());
+        }
+    }
+
+    if (!writer.writeHeader())
+    {
+        std::cerr << timestamp << "Could not write header." << std::endl;
+        return false;
+    }
+
+    if (vertices)
+    {
+        writer.write("vertex", vertexSources, numVertices);
+        if (faceIndices)
+        {
+            writer.write("face", faceSources, numFaces);
+        }
+    }
+
+    if (points)
+    {
+        writer.write("point", pointSources, numPoints);
+    }
+
+    if (!writer.close())
+    {
+        std::cerr << timestamp << "Could not write »" << filename << "«" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace lvr2
@@ -51,7 +51,7 @@ PointBuffer::PointBuffer(floatArr points, size_t n)
 PointBuffer::PointBuffer(floatArr points, floatArr normals, size_t n) : PointBuffer(points, n)
 {
     // Add normal data
-    FloatChannelPtr normal_data(new FloatChannel(n, 3, points));
+    FloatChannelPtr normal_data(new FloatChannel(n, 3, normals));
     this->addFloatChannel(normal_data, "normals");
 }
 
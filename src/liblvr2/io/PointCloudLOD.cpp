@@ -0,0 +1,275 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * PointCloudLOD.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/io/PointCloudLOD.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace lvr2
+{
+
+PointCloudLOD::PointCloudLOD(const std::string& filename)
+    : m_gridSize(1), m_numPoints(0), m_hasColors(false)
+{
+    m_file = std::make_shared<HighFive::File>(filename, HighFive::File::ReadOnly);
+    if (!m_file->exist("/lod"))
+    {
+        throw std::runtime_error("PointCloudLOD: " + filename + " contains no level of detail data");
+    }
+
+    HighFive::Group g = m_file->getGroup("/lod");
+    g.getAttribute("grid_size").read(m_gridSize);
+    g.getAttribute("num_points").read(m_numPoints);
+    m_hasColors = g.exist("colors");
+
+    float bounds[4];
+    g.getDataSet("bounds").template read<float>(bounds);
+
+    HighFive::Group nodes = g.getGroup("nodes");
+    size_t n = nodes.getDataSet("offset").getSpace().getDimensions()[0];
+
+    std::vector<uint64_t> offsets(n);
+    std::vector<uint32_t> counts(n);
+    std::vector<uint32_t> firstChildren(n);
+    std::vector<uint8_t> childMasks(n);
+    if (n > 0)
+    {
+        nodes.getDataSet("offset").template read<uint64_t>(offsets.data());
+        nodes.getDataSet("count").template read<uint32_t>(counts.data());
+        nodes.getDataSet("first_child").template read<uint32_t>(firstChildren.data());
+        nodes.getDataSet("child_mask").template read<uint8_t>(childMasks.data());
+    }
+
+    m_nodes.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        m_nodes[i].offset = offsets[i];
+        m_nodes[i].count = counts[i];
+        m_nodes[i].firstChild = firstChildren[i];
+        m_nodes[i].childMask = childMasks[i];
+    }
+
+    // The cubes are implicit: derive them top down, parents precede their children
+    if (n > 0)
+    {
+        m_nodes[0].level = 0;
+        m_nodes[0].min = Vector3f(bounds[0], bounds[1], bounds[2]);
+        m_nodes[0].size = bounds[3];
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        const LODNode& parent = m_nodes[i];
+        float half = parent.size / 2;
+        size_t child = parent.firstChild;
+        for (int octant = 0; octant < 8; octant++)
+        {
+            if (!(parent.childMask & (1 << octant)))
+            {
+                continue;
+            }
+            if (child >= n)
+            {
+                throw std::runtime_error("PointCloudLOD: corrupt node table in " + filename);
+            }
+            LODNode& c = m_nodes[child++];
+            c.level = parent.level + 1;
+            c.size = half;
+            c.min = parent.min + Vector3f(
+                (octant & 1) ? half : 0.0f,
+                (octant & 2) ? half : 0.0f,
+                (octant & 4) ? half : 0.0f);
+        }
+    }
+}
+
+float PointCloudLOD::projectedSpacing(const LODNode& node, const Vector3f& camera) const
+{
+    Vector3f max = node.min + Vector3f::Constant(node.size);
+    Vector3f d = (node.min - camera).cwiseMax(camera - max).cwiseMax(Vector3f::Zero());
+    float distance = d.norm();
+
+    if (distance <= 1e-6f * node.size)
+    {
+        return std::numeric_limits<float>::max();
+    }
+    return node.size / m_gridSize / distance;
+}
+
+std::vector<size_t> PointCloudLOD::selectNodes(
+    const Vector3f& camera,
+    float fovY,
+    float screenHeight,
+    float maxError,
+    size_t pointBudget) const
+{
+    std::vector<size_t> selected;
+    if (m_nodes.empty())
+    {
+        return selected;
+    }
+
+    // Projected spacing in pixels per unit spacing / distance
+    float pixels = screenHeight / (2.0f * std::tan(fovY / 2.0f));
+
+    std::priority_queue<std::pair<float, size_t>> queue;
+    queue.push({projectedSpacing(m_nodes[0], camera), 0});
+
+    size_t numSelected = 0;
+    while (!queue.empty())
+    {
+        std::pair<float, size_t> top = queue.top();
+        queue.pop();
+
+        const LODNode& node = m_nodes[top.second];
+        if (numSelected + node.count > pointBudget)
+        {
+            break;
+        }
+        selected.push_back(top.second);
+        numSelected += node.count;
+
+        if (top.first * pixels <= maxError)
+        {
+            continue;
+        }
+
+        size_t child = node.firstChild;
+        for (int octant = 0; octant < 8; octant++)
+        {
+            if (node.childMask & (1 << octant))
+            {
+                queue.push({projectedSpacing(m_nodes[child], camera), child});
+                child++;
+            }
+        }
+    }
+
+    return selected;
+}
+
+std::vector<size_t> PointCloudLOD::selectNodes(size_t pointBudget) const
+{
+    // The nodes are stored breadth first, so complete levels are prefixes of the node table.
+    // The root is always selected.
+    std::vector<size_t> selected;
+    size_t numSelected = 0;
+    size_t i = 0;
+    while (i < m_nodes.size())
+    {
+        size_t end = i;
+        size_t levelPoints = 0;
+        while (end < m_nodes.size() && m_nodes[end].level == m_nodes[i].level)
+        {
+            levelPoints += m_nodes[end].count;
+            end++;
+        }
+        if (i > 0 && numSelected + levelPoints > pointBudget)
+        {
+            break;
+        }
+        for (; i < end; i++)
+        {
+            selected.push_back(i);
+        }
+        numSelected += levelPoints;
+    }
+    return selected;
+}
+
+PointBufferPtr PointCloudLOD::load(const std::vector<size_t>& nodes) const
+{
+    std::vector<size_t> sorted(nodes);
+    std::sort(sorted.begin(), sorted.end(), [this](size_t a, size_t b)
+    {
+        return m_nodes[a].offset < m_nodes[b].offset;
+    });
+
+    size_t n = 0;
+    for (size_t i : sorted)
+    {
+        n += m_nodes[i].count;
+    }
+
+    floatArr points(new float[3 * n]);
+    ucharArr colors;
+    if (m_hasColors)
+    {
+        colors = ucharArr(new unsigned char[3 * n]);
+    }
+
+    HighFive::Group g = m_file->getGroup("/lod");
+    HighFive::DataSet pointSet = g.getDataSet("points");
+
+    size_t position = 0;
+    size_t i = 0;
+    while (i < sorted.size())
+    {
+        // Merge nodes that are adjacent in the file into one read
+        uint64_t begin = m_nodes[sorted[i]].offset;
+        uint64_t end = begin + m_nodes[sorted[i]].count;
+        i++;
+        while (i < sorted.size() && m_nodes[sorted[i]].offset == end)
+        {
+            end += m_nodes[sorted[i]].count;
+            i++;
+        }
+
+        size_t count = end - begin;
+        if (count == 0)
+        {
+            continue;
+        }
+        pointSet.select({begin, 0}, {count, 3}).template read<float>(points.get() + 3 * position);
+        if (m_hasColors)
+        {
+            g.getDataSet("colors").select({begin, 0}, {count, 3})
+                .template read<unsigned char>(colors.get() + 3 * position);
+        }
+        position += count;
+    }
+
+    PointBufferPtr buffer(new PointBuffer(points, n));
+    if (m_hasColors)
+    {
+        buffer->setColorArray(colors, n);
+    }
+    return buffer;
+}
+
+} // namespace lvr2
@@ -0,0 +1,618 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * PointCloudLODBuilder.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/io/PointCloudLODBuilder.hpp"
+#include "lvr2/io/Timestamp.hpp"
+#include "lvr2/io/hdf5/Hdf5Util.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace lvr2
+{
+
+namespace
+{
+
+/// Level of the grid that is used to split the root cube into chunks
+const uint32_t CountLevel = 7;
+
+/// Nodes below this level are not subdivided
+const uint32_t MaxLevel = 20;
+
+/// Number of points that are buffered before they are written to the output
+const size_t FlushPoints = 1 << 20;
+
+/// Memory used for buffering the points of all chunk files
+const size_t DistributionBufferSize = 256 << 20;
+
+/// Number of rows per HDF5 chunk of the output datasets
+const size_t DatasetChunkRows = 1 << 16;
+
+template<typename T>
+void writeVector(HighFive::Group& g, const std::string& name, const std::vector<T>& data)
+{
+    HighFive::DataSpace space(std::vector<size_t>{data.size()});
+    g.createDataSet<T>(name, space).template write<T>(data.data());
+}
+
+template<typename T>
+void appendToFile(const std::string& path, std::vector<T>& data)
+{
+    FILE* f = fopen(path.c_str(), "ab");
+    if (!f || fwrite(data.data(), sizeof(T), data.size(), f) != data.size())
+    {
+        if (f)
+        {
+            fclose(f);
+        }
+        throw std::runtime_error("PointCloudLODBuilder: unable to write " + path);
+    }
+    fclose(f);
+    data.clear();
+}
+
+template<typename T>
+std::vector<T> readFile(const std::string& path)
+{
+    std::vector<T> data(boost::filesystem::file_size(path) / sizeof(T));
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f || fread(data.data(), sizeof(T), data.size(), f) != data.size())
+    {
+        if (f)
+        {
+            fclose(f);
+        }
+        throw std::runtime_error("PointCloudLODBuilder: unable to read " + path);
+    }
+    fclose(f);
+    return data;
+}
+
+inline uint32_t gridCell(float value, float min, float scale, uint32_t resolution)
+{
+    float cell = (value - min) * scale;
+    if (cell <= 0.0f)
+    {
+        return 0;
+    }
+    return std::min(static_cast<uint32_t>(cell), resolution - 1);
+}
+
+} // namespace
+
+bool PointCloudLODBuilder::NodeKey::operator<(const NodeKey& other) const
+{
+    if (level != other.level)
+    {
+        return level < other.level;
+    }
+    if (z != other.z)
+    {
+        return z < other.z;
+    }
+    if (y != other.y)
+    {
+        return y < other.y;
+    }
+    return x < other.x;
+}
+
+PointCloudLODBuilder::NodeKey PointCloudLODBuilder::NodeKey::child(int octant) const
+{
+    return {
+        level + 1,
+        2 * x + (octant & 1),
+        2 * y + ((octant >> 1) & 1),
+        2 * z + ((octant >> 2) & 1)
+    };
+}
+
+PointCloudLODBuilder::PointCloudLODBuilder(
+    const std::string& tmpDir,
+    size_t maxChunkPoints,
+    size_t maxNodePoints,
+    uint32_t gridSize)
+    : m_tmpDir(tmpDir),
+      m_maxChunkPoints(std::max<size_t>(maxChunkPoints, 1)),
+      m_maxNodePoints(std::max<size_t>(maxNodePoints, 1)),
+      m_gridSize(std::max<uint32_t>(gridSize, 1)),
+      m_size(1.0f),
+      m_numPoints(0),
+      m_hasColors(false),
+      m_written(0)
+{
+    m_min[0] = m_min[1] = m_min[2] = 0.0f;
+}
+
+void PointCloudLODBuilder::nodeCube(const NodeKey& key, float* min, float& size) const
+{
+    size = m_size / static_cast<float>(1u << key.level);
+    min[0] = m_min[0] + key.x * size;
+    min[1] = m_min[1] + key.y * size;
+    min[2] = m_min[2] + key.z * size;
+}
+
+void PointCloudLODBuilder::build(PointStream& input, const std::string& filename)
+{
+    m_nodes.clear();
+    m_pending.clear();
+    m_pointBuffer.clear();
+    m_colorBuffer.clear();
+    m_written = 0;
+
+    // Pass 1: bounding box
+    std::cout << timestamp << "LOD: Computing bounding box" << std::endl;
+    float max[3];
+    for (int i = 0; i < 3; i++)
+    {
+        m_min[i] = std::numeric_limits<float>::max();
+        max[i] = std::numeric_limits<float>::lowest();
+    }
+    m_numPoints = 0;
+    m_hasColors = true;
+
+    input.rewind();
+    while (PointBufferPtr chunk = input.next())
+    {
+        size_t width;
+        ucharArr colors = chunk->getColorArray(width);
+        m_hasColors = m_hasColors && colors && width == 3;
+
+        const float* points = chunk->getPointArray().get();
+        for (size_t i = 0; i < chunk->numPoints(); i++)
+        {
+            for (int j = 0; j < 3; j++)
+            {
+                m_min[j] = std::min(m_min[j], points[3 * i + j]);
+                max[j] = std::max(max[j], points[3 * i + j]);
+            }
+        }
+        m_numPoints += chunk->numPoints();
+    }
+
+    if (m_numPoints == 0)
+    {
+        throw std::runtime_error("PointCloudLODBuilder: the input contains no points");
+    }
+
+    m_size = std::max({max[0] - m_min[0], max[1] - m_min[1], max[2] - m_min[2]});
+    if (m_size <= 0.0f)
+    {
+        m_size = 1.0f;
+    }
+
+    // Pass 2: count the points in a coarse grid and split the root cube into chunks
+    std::cout << timestamp << "LOD: Splitting " << m_numPoints << " points into chunks" << std::endl;
+    const uint32_t resolution = 1u << CountLevel;
+    const float countScale = resolution / m_size;
+
+    std::vector<std::vector<uint64_t>> counts(CountLevel + 1);
+    for (uint32_t level = 0; level <= CountLevel; level++)
+    {
+        size_t r = 1u << level;
+        counts[level].resize(r * r * r, 0);
+    }
+
+    auto countIndex = [](uint32_t level, uint32_t x, uint32_t y, uint32_t z)
+    {
+        size_t r = 1u << level;
+        return (z * r + y) * r + x;
+    };
+
+    input.rewind();
+    while (PointBufferPtr chunk = input.next())
+    {
+        const float* points = chunk->getPointArray().get();
+        for (size_t i = 0; i < chunk->numPoints(); i++)
+        {
+            const float* p = points + 3 * i;
+            counts[CountLevel][countIndex(
+                CountLevel,
+                gridCell(p[0], m_min[0], countScale, resolution),
+                gridCell(p[1], m_min[1], countScale, resolution),
+                gridCell(p[2], m_min[2], countScale, resolution))]++;
+        }
+    }
+
+    for (uint32_t level = CountLevel; level > 0; level--)
+    {
+        uint32_t r = 1u << level;
+        for (uint32_t z = 0; z < r; z++)
+        {
+            for (uint32_t y = 0; y < r; y++)
+            {
+                for (uint32_t x = 0; x < r; x++)
+                {
+                    counts[level - 1][countIndex(level - 1, x >> 1, y >> 1, z >> 1)] +=
+                        counts[level][countIndex(level, x, y, z)];
+                }
+            }
+        }
+    }
+
+    std::vector<NodeKey> chunks;
+    std::vector<NodeKey> stack = {{0, 0, 0, 0}};
+    while (!stack.empty())
+    {
+        NodeKey key = stack.back();
+        stack.pop_back();
+
+        uint64_t count = counts[key.level][countIndex(key.level, key.x, key.y, key.z)];
+        if (count == 0)
+        {
+            continue;
+        }
+        if (count <= m_maxChunkPoints || key.level == CountLevel)
+        {
+            chunks.push_back(key);
+        }
+        else
+        {
+            for (int octant = 0; octant < 8; octant++)
+            {
+                stack.push_back(key.child(octant));
+            }
+        }
+    }
+
+    std::vector<int32_t> cellChunk(resolution * resolution * resolution, -1);
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        uint32_t shift = CountLevel - chunks[i].level;
+        uint32_t r = 1u << shift;
+        for (uint32_t z = chunks[i].z << shift; z < (chunks[i].z << shift) + r; z++)
+        {
+            for (uint32_t y = chunks[i].y << shift; y < (chunks[i].y << shift) + r; y++)
+            {
+                for (uint32_t x = chunks[i].x << shift; x < (chunks[i].x << shift) + r; x++)
+                {
+                    cellChunk[countIndex(CountLevel, x, y, z)] = i;
+                }
+            }
+        }
+    }
+
+    // Pass 3: distribute the points into one temporary file per chunk
+    std::cout << timestamp << "LOD: Distributing points into " << chunks.size() << " chunks" << std::endl;
+    boost::filesystem::path tmpDir =
+        boost::filesystem::path(m_tmpDir) / boost::filesystem::unique_path("lod_%%%%-%%%%-%%%%");
+    boost::filesystem::create_directories(tmpDir);
+
+    std::vector<std::string> chunkFiles(chunks.size());
+    std::vector<std::vector<LODPoint>> chunkBuffers(chunks.size());
+    size_t flushSize = std::max<size_t>(1 << 12, DistributionBufferSize / sizeof(LODPoint) / chunks.size());
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        chunkFiles[i] = (tmpDir / ("chunk_" + std::to_string(i) + ".bin")).string();
+    }
+
+    input.rewind();
+    while (PointBufferPtr chunk = input.next())
+    {
+        const float* points = chunk->getPointArray().get();
+        size_t width;
+        ucharArr colors = chunk->getColorArray(width);
+
+        for (size_t i = 0; i < chunk->numPoints(); i++)
+        {
+            LODPoint point;
+            std::memcpy(point.pos, points + 3 * i, 3 * sizeof(float));
+            std::memset(point.color, 0, sizeof(point.color));
+            if (m_hasColors)
+            {
+                std::memcpy(point.color, colors.get() + 3 * i, 3);
+            }
+
+            int32_t c = cellChunk[countIndex(
+                CountLevel,
+                gridCell(point.pos[0], m_min[0], countScale, resolution),
+                gridCell(point.pos[1], m_min[1], countScale, resolution),
+                gridCell(point.pos[2], m_min[2], countScale, resolution))];
+
+            chunkBuffers[c].push_back(point);
+            if (chunkBuffers[c].size() >= flushSize)
+            {
+                appendToFile(chunkFiles[c], chunkBuffers[c]);
+            }
+        }
+    }
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        if (!chunkBuffers[i].empty())
+        {
+            appendToFile(chunkFiles[i], chunkBuffers[i]);
+        }
+        std::vector<LODPoint>().swap(chunkBuffers[i]);
+    }
+
+    // Build the octree of every chunk in memory
+    std::cout << timestamp << "LOD: Building chunk hierarchies" << std::endl;
+    m_file = std::make_shared<HighFive::File>(
+        filename,
+        HighFive::File::ReadWrite | HighFive::File::Create | HighFive::File::Truncate
+    );
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        std::vector<LODPoint> points = readFile<LODPoint>(chunkFiles[i]);
+        boost::filesystem::remove(chunkFiles[i]);
+        buildNode(points.data(), points.data() + points.size(), chunks[i], true);
+    }
+    boost::filesystem::remove_all(tmpDir);
+
+    // Build the levels above the chunks by subsampling the points of their roots
+    std::cout << timestamp << "LOD: Building upper levels" << std::endl;
+    uint32_t level = 0;
+    for (const auto& pending : m_pending)
+    {
+        level = std::max(level, pending.first.level);
+    }
+
+    std::vector<uint64_t> occupied;
+    for (; level > 0; level--)
+    {
+        std::map<NodeKey, std::vector<NodeKey>> parents;
+        for (const auto& pending : m_pending)
+        {
+            if (pending.first.level == level)
+            {
+                parents[pending.first.parent()].push_back(pending.first);
+            }
+        }
+
+        for (const auto& parent : parents)
+        {
+            float min[3];
+            float size;
+            nodeCube(parent.first, min, size);
+            float scale = m_gridSize / size;
+
+            size_t numCells = static_cast<size_t>(m_gridSize) * m_gridSize * m_gridSize;
+            occupied.assign((numCells + 63) / 64, 0);
+
+            std::vector<LODPoint> sampled;
+            for (const NodeKey& child : parent.second)
+            {
+                std::vector<LODPoint>& points = m_pending[child];
+                size_t keep = 0;
+                for (const LODPoint& p : points)
+                {
+                    size_t cell = (static_cast<size_t>(gridCell(p.pos[2], min[2], scale, m_gridSize)) * m_gridSize
+                        + gridCell(p.pos[1], min[1], scale, m_gridSize)) * m_gridSize
+                        + gridCell(p.pos[0], min[0], scale, m_gridSize);
+                    if (occupied[cell / 64] & (1ull << (cell % 64)))
+                    {
+                        points[keep++] = p;
+                    }
+                    else
+                    {
+                        occupied[cell / 64] |= 1ull << (cell % 64);
+                        sampled.push_back(p);
+                    }
+                }
+                writeNode(child, points.data(), keep);
+                m_pending.erase(child);
+            }
+
+            std::vector<LODPoint>& parentPoints = m_pending[parent.first];
+            parentPoints.insert(parentPoints.end(), sampled.begin(), sampled.end());
+        }
+    }
+
+    NodeKey root = {0, 0, 0, 0};
+    writeNode(root, m_pending[root].data(), m_pending[root].size());
+    m_pending.clear();
+    flush();
+
+    std::cout << timestamp << "LOD: Writing " << m_nodes.size() << " nodes" << std::endl;
+    writeHierarchy();
+    m_nodes.clear();
+    m_file.reset();
+}
+
+PointCloudLODBuilder::LODPoint* PointCloudLODBuilder::sample(LODPoint* begin, LODPoint* end, const NodeKey& key)
+{
+    thread_local std::vector<uint64_t> occupied;
+
+    float min[3];
+    float size;
+    nodeCube(key, min, size);
+    float scale = m_gridSize / size;
+
+    size_t numCells = static_cast<size_t>(m_gridSize) * m_gridSize * m_gridSize;
+    occupied.assign((numCells + 63) / 64, 0);
+
+    LODPoint* out = begin;
+    for (LODPoint* p = begin; p != end; ++p)
+    {
+        size_t cell = (static_cast<size_t>(gridCell(p->pos[2], min[2], scale, m_gridSize)) * m_gridSize
+            + gridCell(p->pos[1], min[1], scale, m_gridSize)) * m_gridSize
+            + gridCell(p->pos[0], min[0], scale, m_gridSize);
+
+        if (!(occupied[cell / 64] & (1ull << (cell % 64))))
+        {
+            occupied[cell / 64] |= 1ull << (cell % 64);
+            std::swap(*out, *p);
+            ++out;
+        }
+    }
+    return out;
+}
+
+void PointCloudLODBuilder::buildNode(LODPoint* begin, LODPoint* end, const NodeKey& key, bool chunkRoot)
+{
+    LODPoint* sampleEnd = end;
+    if (static_cast<size_t>(end - begin) > m_maxNodePoints && key.level < MaxLevel)
+    {
+        sampleEnd = sample(begin, end, key);
+    }
+
+    if (sampleEnd != end)
+    {
+        float min[3];
+        float size;
+        nodeCube(key, min, size);
+        float mid[3] = {min[0] + size / 2, min[1] + size / 2, min[2] + size / 2};
+
+        // Sort the remaining points into the octants, ordered by z, y and x
+        LODPoint* bounds[9];
+        bounds[0] = sampleEnd;
+        bounds[8] = end;
+        bounds[4] = std::partition(bounds[0], bounds[8], [&](const LODPoint& p) { return p.pos[2] < mid[2]; });
+        for (int i = 0; i < 8; i += 4)
+        {
+            bounds[i + 2] = std::partition(bounds[i], bounds[i + 4], [&](const LODPoint& p) { return p.pos[1] < mid[1]; });
+        }
+        for (int i = 0; i < 8; i += 2)
+        {
+            bounds[i + 1] = std::partition(bounds[i], bounds[i + 2], [&](const LODPoint& p) { return p.pos[0] < mid[0]; });
+        }
+
+        for (int octant = 0; octant < 8; octant++)
+        {
+            if (bounds[octant] != bounds[octant + 1])
+            {
+                buildNode(bounds[octant], bounds[octant + 1], key.child(octant), false);
+            }
+        }
+    }
+
+    if (chunkRoot)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending[key].assign(begin, sampleEnd);
+    }
+    else
+    {
+        writeNode(key, begin, sampleEnd - begin);
+    }
+}
+
+void PointCloudLODBuilder::writeNode(const NodeKey& key, const LODPoint* points, size_t n)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_nodes[key] = {m_written + m_pointBuffer.size() / 3, static_cast<uint32_t>(n)};
+    for (size_t i = 0; i < n; i++)
+    {
+        m_pointBuffer.insert(m_pointBuffer.end(), points[i].pos, points[i].pos + 3);
+        if (m_hasColors)
+        {
+            m_colorBuffer.insert(m_colorBuffer.end(), points[i].color, points[i].color + 3);
+        }
+    }
+
+    if (m_pointBuffer.size() / 3 >= FlushPoints)
+    {
+        flush();
+    }
+}
+
+void PointCloudLODBuilder::flush()
+{
+    size_t n = m_pointBuffer.size() / 3;
+    if (n == 0)
+    {
+        return;
+    }
+
+    HighFive::Group g = hdf5util::getGroup(m_file, "/lod");
+    hdf5util::appendRows(g, "points", m_pointBuffer.data(), n, 3, DatasetChunkRows);
+    if (m_hasColors)
+    {
+        hdf5util::appendRows(g, "colors", m_colorBuffer.data(), n, 3, DatasetChunkRows);
+    }
+
+    m_written += n;
+    m_pointBuffer.clear();
+    m_colorBuffer.clear();
+}
+
+void PointCloudLODBuilder::writeHierarchy()
+{
+    std::vector<NodeKey> order = {{0, 0, 0, 0}};
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> firstChildren;
+    std::vector<uint8_t> childMasks;
+
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        NodeKey key = order[i];
+        const NodeRange& range = m_nodes[key];
+
+        offsets.push_back(range.offset);
+        counts.push_back(range.count);
+        firstChildren.push_back(order.size());
+
+        uint8_t mask = 0;
+        for (int octant = 0; octant < 8; octant++)
+        {
+            NodeKey child = key.child(octant);
+            if (m_nodes.count(child))
+            {
+                mask |= 1 << octant;
+                order.push_back(child);
+            }
+        }
+        childMasks.push_back(mask);
+    }
+
+    HighFive::Group g = hdf5util::getGroup(m_file, "/lod");
+
+    uint32_t version = 1;
+    hdf5util::setAttribute(g, "version", version);
+    hdf5util::setAttribute(g, "grid_size", m_gridSize);
+    hdf5util::setAttribute(g, "num_points", m_numPoints);
+
+    std::vector<float> bounds = {m_min[0], m_min[1], m_min[2], m_size};
+    writeVector(g, "bounds", bounds);
+
+    HighFive::Group nodes = hdf5util::getGroup(g, "nodes");
+    writeVector(nodes, "offset", offsets);
+    writeVector(nodes, "count", counts);
+    writeVector(nodes, "first_child", firstChildren);
+    writeVector(nodes, "child_mask", childMasks);
+}
+
+} // namespace lvr2
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * PointCloudLODIO.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/io/PointCloudLODIO.hpp"
+#include "lvr2/io/PointCloudLOD.hpp"
+#include "lvr2/io/Timestamp.hpp"
+
+#include <iostream>
+
+namespace lvr2
+{
+
+PointCloudLODIO::PointCloudLODIO(size_t pointBudget)
+    : m_pointBudget(pointBudget)
+{
+}
+
+ModelPtr PointCloudLODIO::read(std::string filename)
+{
+    PointCloudLOD lod(filename);
+    std::vector<size_t> nodes = lod.selectNodes(m_pointBudget);
+
+    PointBufferPtr points = lod.load(nodes);
+    std::cout << timestamp << "Loaded " << points->numPoints() << " of "
+              << lod.numPoints() << " points from " << filename << std::endl;
+
+    m_model = ModelPtr(new Model(points));
+    return m_model;
+}
+
+void PointCloudLODIO::save(std::string filename)
+{
+    std::cout << "[PointCloudLODIO] Error: Saving files to .lod format is not supported" << std::endl;
+}
+
+} // namespace lvr2
@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * PointStream.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/io/PointStream.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace lvr2
+{
+
+PointBufferStream::PointBufferStream(PointBufferPtr buffer, size_t chunkSize)
+    : m_buffer(buffer), m_chunkSize(std::max<size_t>(chunkSize, 1)), m_position(0)
+{
+}
+
+void PointBufferStream::rewind()
+{
+    m_position = 0;
+}
+
+PointBufferPtr PointBufferStream::next()
+{
+    size_t numPoints = m_buffer->numPoints();
+    if (m_position >= numPoints)
+    {
+        return nullptr;
+    }
+
+    size_t n = std::min(m_chunkSize, numPoints - m_position);
+
+    floatArr points(new float[3 * n]);
+    std::memcpy(points.get(), m_buffer->getPointArray().get() + 3 * m_position, 3 * n * sizeof(float));
+    PointBufferPtr chunk(new PointBuffer(points, n));
+
+    size_t colorWidth;
+    ucharArr colors = m_buffer->getColorArray(colorWidth);
+    if (colors && colorWidth == 3)
+    {
+        ucharArr chunkColors(new unsigned char[3 * n]);
+        std::memcpy(chunkColors.get(), colors.get() + 3 * m_position, 3 * n);
+        chunk->setColorArray(chunkColors, n);
+    }
+
+    m_position += n;
+    return chunk;
+}
+
+HDF5ScanStream::HDF5ScanStream(const std::string& filename, size_t chunkSize)
+    : m_chunkSize(std::max<size_t>(chunkSize, 1)), m_scan(0), m_position(0)
+{
+    m_file = std::make_shared<HighFive::File>(filename, HighFive::File::ReadOnly);
+
+    if (m_file->exist("/raw/scans"))
+    {
+        HighFive::Group scans = m_file->getGroup("/raw/scans");
+        for (const std::string& name : scans.listObjectNames())
+        {
+            if (scans.getGroup(name).exist("points"))
+            {
+                m_scans.push_back("/raw/scans/" + name);
+            }
+        }
+    }
+}
+
+void HDF5ScanStream::rewind()
+{
+    m_scan = 0;
+    m_position = 0;
+}
+
+PointBufferPtr HDF5ScanStream::next()
+{
+    while (m_scan < m_scans.size())
+    {
+        HighFive::Group g = m_file->getGroup(m_scans[m_scan]);
+        HighFive::DataSet pointSet = g.getDataSet("points");
+        std::vector<size_t> dims = pointSet.getSpace().getDimensions();
+
+        // Points may be stored flat or as n x 3
+        size_t numPoints = dims.size() == 1 ? dims[0] / 3 : dims[0];
+        if (m_position >= numPoints)
+        {
+            m_scan++;
+            m_position = 0;
+            continue;
+        }
+
+        size_t n = std::min(m_chunkSize, numPoints - m_position);
+
+        floatArr points(new float[3 * n]);
+        if (dims.size() == 1)
+        {
+            pointSet.select({3 * m_position}, {3 * n}).template read<float>(points.get());
+        }
+        else
+        {
+            pointSet.select({m_position, 0}, {n, 3}).template read<float>(points.get());
+        }
+        PointBufferPtr chunk(new PointBuffer(points, n));
+
+        if (g.exist("colors"))
+        {
+            HighFive::DataSet colorSet = g.getDataSet("colors");
+            std::vector<size_t> colorDims = colorSet.getSpace().getDimensions();
+            if (colorDims.size() == 2 && colorDims[0] == numPoints && colorDims[1] == 3)
+            {
+                ucharArr colors(new unsigned char[3 * n]);
+                colorSet.select({m_position, 0}, {n, 3}).template read<unsigned char>(colors.get());
+                chunk->setColorArray(colors, n);
+            }
+        }
+
+        m_position += n;
+        return chunk;
+    }
+
+    return nullptr;
+}
+
+} // namespace lvr2
@@ -198,6 +198,32 @@ void PacmanProgressBar::operator++()
     boost::mutex::scoped_lock lock(m_mutex);
 
     m_currentVal++;
+    short difference = (short)((float)m_currentVal/m_maxVal * 100 - m_percent);
+
+    if (difference < 1)
+    {
+        return;
+    }
+
+    while (difference >= 1)
+    {
+        m_percent++;
+        difference--;
+        print_bar();
+
+        if(m_progressCallback)
+        {
+            m_progressCallback(m_percent);
+        }
+    }
+
+}
+
+void PacmanProgressBar::operator+=(size_t n)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    m_currentVal += n;
     short difference = (short)((float)m_currentVal/m_maxVal * 100 - m_percent);
 
 	if (difference < 1)
@@ -32,6 +32,9 @@
  *  @author Thomas Wiemann
  */
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <list>
 #include <vector>
 #include <string>
@@ -49,6 +52,9 @@ using std::stringstream;
 #include <boost/filesystem.hpp>
 
 #include "lvr2/io/UosIO.hpp"
+#include "lvr2/io/AsciiParser.hpp"
+#include "lvr2/config/lvropenmp.hpp"
+#include "lvr2/registration/TransformUtils.hpp"
 #include "lvr2/io/Progress.hpp"
 #include "lvr2/io/Timestamp.hpp"
 
@@ -200,47 +206,16 @@ void UosIO::reduce(string dir, string target, int reduction)
 
 void UosIO::readNewFormat(ModelPtr &model, string dir, int first, int last, size_t &n)
 {
-    list<Vec > allPoints;
-    list<BaseVector<int> > allColors;
-
-    size_t point_counter = 0;
-
-    vector<indexPair> sub_clouds;
-
-    // Count points in all given files
-    size_t numPointsTotal = 0;
-    for(int fileCounter = first; fileCounter <= last; fileCounter++)
-    {
-        // Create scan file name
-        boost::filesystem::path scan_path(
-                boost::filesystem::path(dir) /
-                boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".3d" ) );
-        string scanFileName = "/" + scan_path.relative_path().string();
-
-        // Count lines in scan
-        numPointsTotal += AsciiIO::countLines(scanFileName);
-    }
-
-    // Calculate the number of points to skip when writing to disk
-    size_t skipPoints = 1;
-
-    if(m_reductionTarget > 1)
-    {
-        skipPoints = (int)numPointsTotal / m_reductionTarget;
-    }
-
-    if(m_saveToDisk)
-    {
-        cout << timestamp << "Reduction mode. Writing every " << skipPoints << "th point." << endl;
-    }
-
+    // Collect existing scans and their transformations
+    vector<string> scanFiles;
+    vector<Transformf> transforms;
     for(int fileCounter = first; fileCounter <= last; fileCounter++)
     {
         // New (unit) transformation matrix
         Matrix4<Vec> tf;
 
-        // Input file streams for scan data, poses and frames
-        ifstream scan_in, pose_in, frame_in;
+        // Input file streams for poses and frames
+        ifstream pose_in, frame_in;
 
         // Create scan file name
         boost::filesystem::path scan_path(
@@ -248,244 +223,151 @@ void UosIO::readNewFormat(ModelPtr &model, string dir, int first, int last, size
                 boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".3d" ) );
         string scanFileName = scan_path.string();
 
-        // Count lines in scan
-        size_t points_in_file = AsciiIO::countLines(scanFileName);
-
-        int num_attributes = AsciiIO::getEntriesInLine(scanFileName) - 3;
-        bool has_color = (num_attributes == 3) || (num_attributes == 4);
-        bool has_intensity = (num_attributes == 1) || (num_attributes == 4);
-
-        if(has_color)
-        {
-            cout << timestamp << "Reading color information." << endl;
-        }
-
-        if(has_intensity)
-        {
-            cout << timestamp << "Reading intensity information." << endl;
-        }
-
-        // Read scan data
-        scan_in.open(scanFileName.c_str());
-        if(!scan_in.good())
+        if(!boost::filesystem::exists(scan_path))
         {
             // Continue with next file if the expected file couldn't be read
             cout << timestamp << "UOS Reader: Unable to read scan " << scanFileName << endl;
-            scan_in.close();
-            scan_in.clear();
             continue;
         }
-        else
-        {
-            // Tmp list of read points
-            list<Vec > tmp_points;
 
+        // Try to get fransformation from .frames file
+        boost::filesystem::path frame_path(
+                boost::filesystem::path(dir) /
+                boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".frames" ) );
+        string frameFileName = frame_path.string();
 
-            // Try to get fransformation from .frames file
-            boost::filesystem::path frame_path(
+        frame_in.open(frameFileName.c_str());
+        if(!frame_in.good())
+        {
+            // Try to parse .pose file
+            boost::filesystem::path pose_path(
                     boost::filesystem::path(dir) /
-                    boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".frames" ) );
-            string frameFileName = frame_path.string();
+                    boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".pose" ) );
+            string poseFileName = pose_path.string();
 
-            frame_in.open(frameFileName.c_str());
-            if(!frame_in.good())
+            pose_in.open(poseFileName.c_str());
+            if(pose_in.good())
             {
-                // Try to parse .pose file
-                boost::filesystem::path pose_path(
-                        boost::filesystem::path(dir) /
-                        boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".pose" ) );
-                string poseFileName = pose_path.string();
-
-                pose_in.open(poseFileName.c_str());
-                if(pose_in.good())
-                {
-                    float euler[6];
-                    for(int i = 0; i < 6; i++) pose_in >> euler[i];
+                float euler[6];
+                for(int i = 0; i < 6; i++) pose_in >> euler[i];
 
-                    euler[3] *= 0.017453293;
-                    euler[4] *= 0.017453293;
-                    euler[5] *= 0.017453293;
+                euler[3] *= 0.017453293;
+                euler[4] *= 0.017453293;
+                euler[5] *= 0.017453293;
 
-                    Vec position(euler[0], euler[1], euler[2]);
-                    Vec angle(euler[3], euler[4], euler[5]);
-
-                    tf = Matrix4<Vec>(position, angle);
-                }
-                else
-                {
-                    cout << timestamp << "UOS Reader: Warning: No position information found." << endl;
-                    tf = Matrix4<Vec>();
-                }
+                Vec position(euler[0], euler[1], euler[2]);
+                Vec angle(euler[3], euler[4], euler[5]);
 
+                tf = Matrix4<Vec>(position, angle);
             }
             else
             {
-                // Use transformation from .frame files
-                tf = parseFrameFile(frame_in);
-
+                cout << timestamp << "UOS Reader: Warning: No position information found." << endl;
+                tf = Matrix4<Vec>();
             }
 
-            // Print pose information
-            float euler[6];
-            tf.toPostionAngle(euler);
+        }
+        else
+        {
+            // Use transformation from .frame files
+            tf = parseFrameFile(frame_in);
 
-            cout << timestamp << "Processing " << scanFileName << " @ "
-                << euler[0] << " " << euler[1] << " " << euler[2] << " "
-                << euler[3] << " " << euler[4] << " " << euler[5] << endl;
+        }
 
-            // Skip first line in scan file (maybe metadata)
-            char dummy[1024];
-            scan_in.getline(dummy, 1024);
+        // Print pose information
+        float euler[6];
+        tf.toPostionAngle(euler);
 
-            // Setup info output
-            string comment = timestamp.getElapsedTime() + "Reading file " + scanFileName;
-            ProgressBar progress(points_in_file, comment);
+        cout << timestamp << "Processing " << scanFileName << " @ "
+            << euler[0] << " " << euler[1] << " " << euler[2] << " "
+            << euler[3] << " " << euler[4] << " " << euler[5] << endl;
 
-            // Read all points
-            while(scan_in.good())
-            {
-                float x, y, z, rem, dummy;
-                int r, g, b;
+        scanFiles.push_back(scanFileName);
+        transforms.push_back(Eigen::Map<Eigen::Matrix4f>(tf.getData()));
+    }
 
-                point_counter ++;
+    if(m_saveToDisk)
+    {
+        reduceScans(scanFiles, transforms);
+        return;
+    }
 
-                if(has_intensity && !has_color)
-                {
-                    scan_in >> x >> y >> z >> rem;
-                }
-                else if(has_intensity && has_color)
-                {
-                    scan_in >> x >> y >> z >> rem >> r >> g >> b;
-                    allColors.push_back(BaseVector<int> (r, g, b));
-                }
-                else if(has_color && !has_intensity)
-                {
-                    scan_in >> x >> y >> z >> r >> g >> b;
-                    allColors.push_back(BaseVector<int> (r, g, b));
-                }
-                else
-                {
-                    scan_in >> x >> y >> z;
-                    for(int n_dummys = 0; n_dummys < num_attributes; n_dummys++) scan_in >> dummy;
-                }
+    // Parse scans. Parallelize over files if there are enough of them, otherwise
+    // each file is parsed in parallel blocks.
+    vector<PointBufferPtr> clouds(scanFiles.size());
+    bool parallelFiles = scanFiles.size() >= (size_t)OpenMPConfig::getNumThreads();
 
-                BaseVector<float> point(x, y, z);
-                BaseVector<unsigned char> color;
+    #pragma omp parallel for schedule(dynamic) if(parallelFiles)
+    for(size_t i = 0; i < scanFiles.size(); i++)
+    {
+        Timestamp ts;
+        MappedFile file(scanFiles[i]);
+        if(!file.good())
+        {
+            continue;
+        }
 
-                // Code branching for point converter!
-                if(!m_saveToDisk)
-                {
-                    tmp_points.push_back(point);
-                }
-                else
-                {
-                    if(m_outputFile.good())
-                    {
-                        if(point_counter % skipPoints == 0)
-                        {
-                            point = tf * point;
-                            m_outputFile << point[0] << " " << point[1] << " " << point[2] << " ";
-
-                            // Save remission values if present
-                            if(has_intensity && m_saveRemission)
-                            {
-                                m_outputFile << rem << " ";
-                            }
-
-                            // Save color values if present
-                            if(has_color)
-                            {
-                                m_outputFile << r << " " << g << " " << b;
-                            }
-                            else if(m_saveRemissionColor)
-                            {
-                                r = g = b = rem;
-                                m_outputFile << r << " " << g << " " << b;
-                            }
-                            m_outputFile << endl;
-                        }
-                    }
-                }
-                ++progress;
-            }
+        // The first line may contain meta data, guess attributes from the second one
+        AsciiColumns columns = AsciiColumns::guess(countEntries(file, 1));
+        clouds[i] = parseAsciiPoints(file, columns, 1);
 
-            // Save index of first point of new scan
-            size_t firstIndex;
-            if(allPoints.size() > 0)
-            {
-                firstIndex = allPoints.size();
-            }
-            else
-            {
-                firstIndex = 0;
-            }
+        transformPoints(clouds[i]->getPointArray().get(), clouds[i]->numPoints(), transforms[i]);
 
-            // Transform scan point with current matrix
-            list<Vec >::iterator it, it1;
-            for(it = tmp_points.begin(); it != tmp_points.end(); it++)
-            {
-                Vec v = *it;
-                v = tf * v;
-                allPoints.push_back(v);
-            }
+        double seconds = ts.getElapsedTimeInS();
 
-            // Save last index
-            size_t lastIndex;
-            if(allPoints.size() > 0)
-            {
-                lastIndex = allPoints.size() - 1;
-            }
-            else
-            {
-                lastIndex = 0;
-            }
+        #pragma omp critical
+        {
+            cout << timestamp << "UOS Reader: Read " << clouds[i]->numPoints() << " points from "
+                 << scanFiles[i] << " in " << seconds << " s ("
+                 << file.size() / (1024.0 * 1024.0) / std::max(seconds, 1e-6) << " MB/s)" << endl;
+        }
+    }
 
-            // Save index pair for current scan
-            sub_clouds.push_back(make_pair(firstIndex, lastIndex));
-            m_numScans++;
+    // Count points and check whether all scans provide colors
+    size_t numPoints = 0;
+    bool hasColors = true;
+    for(const PointBufferPtr& cloud : clouds)
+    {
+        if(cloud)
+        {
+            numPoints += cloud->numPoints();
+            hasColors = hasColors && cloud->hasColors();
         }
-        cout << endl;
     }
 
     // Convert into array
-    if ( allPoints.size() )
+    if ( numPoints )
     {
-        cout << timestamp << "UOS Reader: Read " << allPoints.size() << " points." << endl;
+        cout << timestamp << "UOS Reader: Read " << numPoints << " points." << endl;
 
-        // Save position information
-
-        size_t numPoints(0);
-        floatArr points;
+        floatArr points( new float[3 * numPoints] );
         ucharArr pointColors;
-
-
-        numPoints = allPoints.size();
-        points = floatArr( new float[3 * allPoints.size()] );
-        list<Vec >::iterator p_it;
-        size_t i(0);
-        for( p_it = allPoints.begin(); p_it != allPoints.end(); p_it++ )
+        if ( hasColors )
         {
-            Vec v = *p_it;
-            points[i    ] = v[0];
-            points[i + 1] = v[1];
-            points[i + 2] = v[2];
-            i += 3;
+            pointColors = ucharArr( new unsigned char[3 * numPoints] );
         }
 
-        // Save color information
-        if ( allColors.size() )
+        vector<indexPair> sub_clouds;
+        size_t offset = 0;
+        for(const PointBufferPtr& cloud : clouds)
         {
-            pointColors = ucharArr( new unsigned char[ 3 * numPoints ] );
-            i = 0;
-            list<BaseVector<int>>::iterator c_it;
-            for(c_it = allColors.begin(); c_it != allColors.end(); c_it++)
+            if(!cloud)
+            {
+                continue;
+            }
+
+            size_t count = cloud->numPoints();
+            std::copy_n(cloud->getPointArray().get(), 3 * count, points.get() + 3 * offset);
+            if ( hasColors )
             {
-                BaseVector<int> v = *c_it;
-                pointColors[i    ] = (unsigned char) v[0];
-                pointColors[i + 1] = (unsigned char) v[1];
-                pointColors[i + 2] = (unsigned char) v[2];
-                i += 3;
+                size_t width;
+                std::copy_n(cloud->getColorArray(width).get(), 3 * count, pointColors.get() + 3 * offset);
             }
+
+            // Save index pair for current scan
+            sub_clouds.push_back(make_pair(offset, offset + count > 0 ? offset + count - 1 : 0));
+            offset += count;
+            m_numScans++;
         }
 
         // Create point cloud in model
@@ -493,7 +375,7 @@ void UosIO::readNewFormat(ModelPtr &model, string dir, int first, int last, size
         model->m_pointCloud = PointBufferPtr( new PointBuffer );
         model->m_pointCloud->setPointArray( points, numPoints );
 
-        if (allColors.size())
+        if ( hasColors )
         {
             model->m_pointCloud->setColorArray(pointColors, numPoints);
         }
@@ -514,6 +396,82 @@ void UosIO::readNewFormat(ModelPtr &model, string dir, int first, int last, size
 
 }
 
+void UosIO::reduceScans(const vector<string>& scanFiles, const vector<Transformf>& transforms)
+{
+    // Count points in all given files
+    size_t numPointsTotal = 0;
+    for(const string& scanFileName : scanFiles)
+    {
+        numPointsTotal += AsciiIO::countLines(scanFileName);
+    }
+
+    // Calculate the number of points to skip when writing to disk
+    size_t skipPoints = 1;
+
+    if(m_reductionTarget > 1)
+    {
+        skipPoints = std::max<size_t>(numPointsTotal / m_reductionTarget, 1);
+    }
+
+    cout << timestamp << "Reduction mode. Writing every " << skipPoints << "th point." << endl;
+
+    size_t point_counter = 0;
+    for(size_t i = 0; i < scanFiles.size(); i++)
+    {
+        Timestamp ts;
+        MappedFile file(scanFiles[i]);
+        if(!file.good())
+        {
+            continue;
+        }
+
+        AsciiColumns columns = AsciiColumns::guess(countEntries(file, 1));
+        PointBufferPtr cloud = parseAsciiPoints(file, columns, 1);
+
+        transformPoints(cloud->getPointArray().get(), cloud->numPoints(), transforms[i]);
+
+        floatArr points = cloud->getPointArray();
+        size_t width;
+        ucharArr colors = cloud->getColorArray(width);
+        FloatChannelOptional intensities = cloud->getFloatChannel("intensities");
+
+        for(size_t j = 0; j < cloud->numPoints() && m_outputFile.good(); j++)
+        {
+            point_counter++;
+            if(point_counter % skipPoints != 0)
+            {
+                continue;
+            }
+
+            m_outputFile << points[3 * j] << " " << points[3 * j + 1] << " " << points[3 * j + 2] << " ";
+
+            // Save remission values if present
+            float rem = intensities ? (*intensities)[j][0] : 0.0f;
+            if(intensities && m_saveRemission)
+            {
+                m_outputFile << rem << " ";
+            }
+
+            // Save color values if present
+            if(colors)
+            {
+                m_outputFile << (int)colors[3 * j] << " " << (int)colors[3 * j + 1] << " " << (int)colors[3 * j + 2];
+            }
+            else if(m_saveRemissionColor)
+            {
+                int r = rem;
+                m_outputFile << r << " " << r << " " << r;
+            }
+            m_outputFile << endl;
+        }
+
+        double seconds = ts.getElapsedTimeInS();
+        cout << timestamp << "UOS Reader: Reduced " << cloud->numPoints() << " points from "
+             << scanFiles[i] << " in " << seconds << " s ("
+             << file.size() / (1024.0 * 1024.0) / std::max(seconds, 1e-6) << " MB/s)" << endl;
+    }
+}
+
 void UosIO::readOldFormat(ModelPtr &model, string dir, int first, int last, size_t &n)
 {
     Matrix4<Vec> m_tf;
@@ -523,7 +481,7 @@ void UosIO::readOldFormat(ModelPtr &model, string dir, int first, int last, size
     for(int fileCounter = first; fileCounter <= last; fileCounter++)
     {
         float euler[6];
-        ifstream scan_in, pose_in, frame_in;
+        ifstream pose_in, frame_in;
 
         // Code imported from slam6d! Don't blame me..
         string scanFileName;
@@ -569,21 +527,20 @@ void UosIO::readOldFormat(ModelPtr &model, string dir, int first, int last, size
                     boost::filesystem::path( "scan" + to_string(i) + ".dat" ) );
             scanFileName = "/" + sfile.relative_path().string();
 
-            scan_in.open(scanFileName.c_str());
-            if (!scan_in.good()) {
-                scan_in.close();
-                scan_in.clear();
+            MappedFile scan(scanFileName);
+            if (!scan.good()) {
                 break;
             }
 
-
             int    Nr = 0, intensity_flag = 0;
-            int    D;
             double current_angle;
-            double X, Z, I;                     // x,z coordinate and intensity
 
-            char firstLine[81];
-            scan_in.getline(firstLine, 80);
+            // The header line has a fixed layout, only its first 79 characters are used
+            char firstLine[81] = {0};
+            const char* pos = scan.begin();
+            const char* lineEnd = std::find(pos, scan.end(), '\n');
+            std::copy(pos, std::min(lineEnd, pos + 79), firstLine);
+            pos = lineEnd;
 
             char cNr[4];
             cNr[0] = firstLine[2];
@@ -623,24 +580,39 @@ void UosIO::readOldFormat(ModelPtr &model, string dir, int first, int last, size
             double cos_currentAngle = cos(rad(current_angle));
             double sin_currentAngle = sin(rad(current_angle));
 
+            // x, z, and without intensity flag also distance and intensity
+            const int columns = intensity_flag ? 2 : 4;
             for (int j = 0; j < Nr; j++) {
-                if (!intensity_flag) {
-                    scan_in >> X >> Z >> D >> I;
-                } else {
-                    scan_in >> X >> Z;
-                    I = 1.0;
+                // Parsed as double like operator>> did, the points are computed in double
+                double values[4];
+                int c = 0;
+                for (; c < columns; c++) {
+                    while (pos < scan.end() && std::isspace(static_cast<unsigned char>(*pos))) {
+                        pos++;
+                    }
+                    if (pos < scan.end() && *pos == '+') {
+                        pos++;
+                    }
+                    std::from_chars_result result = std::from_chars(pos, scan.end(), values[c]);
+                    if (result.ec != std::errc()) {
+                        break;
+                    }
+                    pos = result.ptr;
+                }
+
+                // Stop at the end of the file or at malformed lines
+                if (c < columns) {
+                    break;
                 }
 
                 // calculate 3D coordinates (local coordinates)
                 Vec p;
-                p[0] = X;
-                p[1] = Z * sin_currentAngle;
-                p[2] = Z * cos_currentAngle;
+                p[0] = values[0];
+                p[1] = values[1] * sin_currentAngle;
+                p[2] = values[1] * cos_currentAngle;
 
                 ptss.push_back(p);
             }
-            scan_in.close();
-            scan_in.clear();
         }
 
         pose_in.close();
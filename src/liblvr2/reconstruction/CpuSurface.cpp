@@ -0,0 +1,489 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * CpuSurface.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/reconstruction/CpuSurface.hpp"
+#include "lvr2/io/Progress.hpp"
+#include "lvr2/io/Timestamp.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+
+namespace lvr2
+{
+
+namespace
+{
+
+/// Maximal depth of the kd-tree, enough for 2^62 points
+constexpr int MaxTreeDepth = 64;
+
+/// A subtree that still has to be visited, with the per axis offsets of its
+/// cell from the query point and the resulting lower bound of its distance
+struct StackEntry
+{
+    unsigned int node;
+    float dist;
+    float off[3];
+};
+
+} // namespace
+
+CpuSurface::CpuSurface(LBPointArray<float>& points)
+{
+    this->init();
+
+    this->V = points;
+
+    this->initKdTree();
+}
+
+CpuSurface::CpuSurface(floatArr& points, size_t num_points, int device)
+{
+    this->init();
+
+    this->m_points = points;
+
+    this->V.dim = 3;
+    this->V.width = static_cast<unsigned int>(num_points);
+    this->V.elements = points.get();
+
+    this->initKdTree();
+}
+
+CpuSurface::~CpuSurface()
+{
+}
+
+void CpuSurface::init()
+{
+    // Same defaults as the GPU implementations
+    this->m_k = 10;
+    this->m_ki = 10;
+    this->m_kd = 5;
+
+    this->m_vx = 1000000.0;
+    this->m_vy = 1000000.0;
+    this->m_vz = 1000000.0;
+}
+
+void CpuSurface::initKdTree()
+{
+    m_kdTree = boost::shared_ptr<LBKdTree>(new LBKdTree(this->V));
+    m_treeValues = m_kdTree->getKdTreeValues();
+    m_treeSplits = m_kdTree->getKdTreeSplits();
+}
+
+int CpuSurface::kSearch(float x, float y, float z, int k, unsigned int* indices, float* distances) const
+{
+    const float* values = m_treeValues->elements;
+    const unsigned char* splits = m_treeSplits->elements;
+    const unsigned int num_inner = m_treeSplits->width;
+    const float* points = V.elements;
+    const float q[3] = {x, y, z};
+
+    // The k best neighbors found so far, sorted by distance
+    int found = 0;
+    if(k <= 0)
+    {
+        return found;
+    }
+
+    // Every level of the tree contributes at most one entry
+    StackEntry stack[MaxTreeDepth];
+    int top = 0;
+    stack[top++] = {0, 0.0f, {0.0f, 0.0f, 0.0f}};
+
+    while(top > 0)
+    {
+        StackEntry entry = stack[--top];
+        if(found == k && entry.dist >= distances[k - 1])
+        {
+            continue;
+        }
+
+        // Descend to the leaf on the side of the query point and remember
+        // the other children together with a lower bound of their distance
+        unsigned int pos = entry.node;
+        while(pos < num_inner)
+        {
+            unsigned int dim = splits[pos];
+            float diff = q[dim] - values[pos];
+            unsigned int near = diff <= 0.0f ? pos * 2 + 1 : pos * 2 + 2;
+            unsigned int far = diff <= 0.0f ? pos * 2 + 2 : pos * 2 + 1;
+
+            // Incremental distance: only the offset along the split axis changes
+            float far_dist = entry.dist - entry.off[dim] * entry.off[dim] + diff * diff;
+
+            if(found < k || far_dist < distances[k - 1])
+            {
+                StackEntry& far_entry = stack[top++];
+                far_entry = entry;
+                far_entry.node = far;
+                far_entry.dist = far_dist;
+                far_entry.off[dim] = diff;
+            }
+            pos = near;
+        }
+
+        unsigned int index = static_cast<unsigned int>(values[pos] + 0.5f);
+        if(index >= V.width)
+        {
+            continue;
+        }
+
+        float dx = points[index * 3    ] - x;
+        float dy = points[index * 3 + 1] - y;
+        float dz = points[index * 3 + 2] - z;
+        float dist = dx * dx + dy * dy + dz * dz;
+
+        if(found < k || dist < distances[k - 1])
+        {
+            // Insertion into the sorted neighbor list
+            int i = found < k ? found++ : k - 1;
+            while(i > 0 && distances[i - 1] > dist)
+            {
+                distances[i] = distances[i - 1];
+                indices[i] = indices[i - 1];
+                i--;
+            }
+            distances[i] = dist;
+            indices[i] = index;
+        }
+    }
+
+    return found;
+}
+
+void CpuSurface::calculateNormals()
+{
+    const size_t n = V.width;
+    const float* points = V.elements;
+    m_normals.resize(n * 3);
+
+    // The neighborhood includes the point itself
+    const int k = static_cast<int>(std::min<size_t>(m_k + 1, n));
+    const size_t num_blocks = (n + BlockSize - 1) / BlockSize;
+
+    std::string comment = timestamp.getElapsedTime() + "Estimating normals ";
+    ProgressBar progress(num_blocks, comment);
+
+    #pragma omp parallel
+    {
+        std::vector<unsigned int> neighbors(BlockSize * k);
+        std::vector<float> distances(k);
+
+        // Per point moments of the neighborhood relative to the point, SoA
+        alignas(32) float count[BlockSize];
+        alignas(32) float sx[BlockSize], sy[BlockSize], sz[BlockSize];
+        alignas(32) float xx[BlockSize], xy[BlockSize], xz[BlockSize];
+        alignas(32) float yy[BlockSize], yz[BlockSize], zz[BlockSize];
+        int found[BlockSize];
+
+        #pragma omp for schedule(dynamic)
+        for(long b = 0; b < (long)num_blocks; b++)
+        {
+            size_t first = b * BlockSize;
+            int size = static_cast<int>(std::min<size_t>(BlockSize, n - first));
+
+            // Neighbor search
+            for(int i = 0; i < size; i++)
+            {
+                const float* p = points + (first + i) * 3;
+                found[i] = kSearch(p[0], p[1], p[2], k, neighbors.data() + i * k, distances.data());
+                std::fill(neighbors.begin() + i * k + found[i], neighbors.begin() + (i + 1) * k, first + i);
+            }
+
+            // Accumulate the moments neighbor by neighbor for all points of
+            // the block, so that the inner loop vectorizes
+            #pragma omp simd
+            for(int i = 0; i < size; i++)
+            {
+                count[i] = 0;
+                sx[i] = sy[i] = sz[i] = 0;
+                xx[i] = xy[i] = xz[i] = yy[i] = yz[i] = zz[i] = 0;
+            }
+
+            for(int j = 0; j < k; j++)
+            {
+                #pragma omp simd
+                for(int i = 0; i < size; i++)
+                {
+                    const float* p = points + (first + i) * 3;
+                    const float* q = points + neighbors[i * k + j] * 3;
+                    float w = j < found[i] ? 1.0f : 0.0f;
+                    float rx = w * (q[0] - p[0]);
+                    float ry = w * (q[1] - p[1]);
+                    float rz = w * (q[2] - p[2]);
+                    count[i] += w;
+                    sx[i] += rx; sy[i] += ry; sz[i] += rz;
+                    xx[i] += rx * rx; xy[i] += rx * ry; xz[i] += rx * rz;
+                    yy[i] += ry * ry; yz[i] += ry * rz; zz[i] += rz * rz;
+                }
+            }
+
+            // Plane fit: the normal is the direction of least variance.
+            // Solve the 2x2 system of the axis with the largest determinant
+            // (see ilikebigbits.com/blog/2015/3/2/plane-from-points)
+            #pragma omp simd
+            for(int i = 0; i < size; i++)
+            {
+                float inv = 1.0f / count[i];
+                float mx = sx[i] * inv;
+                float my = sy[i] * inv;
+                float mz = sz[i] * inv;
+
+                float cxx = xx[i] * inv - mx * mx;
+                float cxy = xy[i] * inv - mx * my;
+                float cxz = xz[i] * inv - mx * mz;
+                float cyy = yy[i] * inv - my * my;
+                float cyz = yz[i] * inv - my * mz;
+                float czz = zz[i] * inv - mz * mz;
+
+                float det_x = cyy * czz - cyz * cyz;
+                float det_y = cxx * czz - cxz * cxz;
+                float det_z = cxx * cyy - cxy * cxy;
+
+                bool use_x = det_x >= det_y && det_x >= det_z;
+                bool use_y = !use_x && det_y >= det_z;
+                float det = use_x ? det_x : (use_y ? det_y : det_z);
+
+                float nx = use_x ? det_x : (use_y ? cyz * cxz - cxy * czz : cyz * cxy - cxz * cyy);
+                float ny = use_x ? cxz * cyz - cxy * czz : (use_y ? det_y : cxz * cxy - cyz * cxx);
+                float nz = use_x ? cxy * cyz - cxz * cyy : (use_y ? cxy * cxz - cyz * cxx : det_z);
+
+                // Degenerated neighborhoods get an arbitrary normal
+                bool valid = det > 0.0f;
+                nx = valid ? nx : 0.0f;
+                ny = valid ? ny : 0.0f;
+                nz = valid ? nz : 1.0f;
+
+                float norm = 1.0f / std::sqrt(nx * nx + ny * ny + nz * nz);
+                nx *= norm;
+                ny *= norm;
+                nz *= norm;
+
+                // Flip towards the flip point
+                const float* p = points + (first + i) * 3;
+                float scalar = (m_vx - p[0]) * nx + (m_vy - p[1]) * ny + (m_vz - p[2]) * nz;
+                float sign = scalar < 0.0f ? -1.0f : 1.0f;
+
+                m_normals[(first + i) * 3    ] = sign * nx;
+                m_normals[(first + i) * 3 + 1] = sign * ny;
+                m_normals[(first + i) * 3 + 2] = sign * nz;
+            }
+            ++progress;
+        }
+    }
+    std::cout << std::endl;
+
+    if(m_ki > 0)
+    {
+        interpolateNormals();
+    }
+}
+
+void CpuSurface::interpolateNormals()
+{
+    const size_t n = V.width;
+    const float* points = V.elements;
+    const int k = static_cast<int>(std::min<size_t>(m_ki + 1, n));
+
+    std::vector<float> interpolated(n * 3);
+
+    std::string comment = timestamp.getElapsedTime() + "Interpolating normals ";
+    ProgressBar progress((n + BlockSize - 1) / BlockSize, comment);
+
+    #pragma omp parallel
+    {
+        std::vector<unsigned int> neighbors(k);
+        std::vector<float> distances(k);
+
+        #pragma omp for schedule(dynamic, BlockSize)
+        for(long i = 0; i < (long)n; i++)
+        {
+            const float* p = points + i * 3;
+            int found = kSearch(p[0], p[1], p[2], k, neighbors.data(), distances.data());
+
+            // The neighborhood contains the point itself
+            float x = 0.0f;
+            float y = 0.0f;
+            float z = 0.0f;
+            for(int j = 0; j < found; j++)
+            {
+                const float* nb = m_normals.data() + neighbors[j] * 3;
+                x += nb[0];
+                y += nb[1];
+                z += nb[2];
+            }
+
+            float norm = std::sqrt(x * x + y * y + z * z);
+            if(norm > 0.0f)
+            {
+                x /= norm;
+                y /= norm;
+                z /= norm;
+            }
+            else
+            {
+                x = m_normals[i * 3];
+                y = m_normals[i * 3 + 1];
+                z = m_normals[i * 3 + 2];
+            }
+
+            interpolated[i * 3    ] = x;
+            interpolated[i * 3 + 1] = y;
+            interpolated[i * 3 + 2] = z;
+
+            if(i % BlockSize == 0)
+            {
+                ++progress;
+            }
+        }
+    }
+    std::cout << std::endl;
+
+    m_normals.swap(interpolated);
+}
+
+void CpuSurface::getNormals(LBPointArray<float>& output_normals)
+{
+    output_normals.dim = 3;
+    output_normals.width = V.width;
+    std::copy(m_normals.begin(), m_normals.end(), output_normals.elements);
+}
+
+void CpuSurface::getNormals(floatArr output_normals)
+{
+    std::copy(m_normals.begin(), m_normals.end(), output_normals.get());
+}
+
+void CpuSurface::setKn(int kn)
+{
+    this->m_k = kn;
+}
+
+void CpuSurface::setKi(int ki)
+{
+    this->m_ki = ki;
+}
+
+void CpuSurface::setKd(int kd)
+{
+    this->m_kd = kd;
+}
+
+void CpuSurface::setFlippoint(float v_x, float v_y, float v_z)
+{
+    this->m_vx = v_x;
+    this->m_vy = v_y;
+    this->m_vz = v_z;
+}
+
+void CpuSurface::setMethod(const std::string& method)
+{
+    if(method != "PCA")
+    {
+        std::cout << timestamp << "WARNING: Normal calculation method '" << method
+                  << "' is not implemented on the CPU. Using PCA." << std::endl;
+    }
+}
+
+void CpuSurface::setReconstructionMode(bool mode)
+{
+}
+
+void CpuSurface::distances(std::vector<QueryPoint<BaseVector<float> > >& query_points, float voxel_size)
+{
+    const float* points = V.elements;
+    const int k = static_cast<int>(std::min<size_t>(m_kd, V.width));
+
+    std::string comment = timestamp.getElapsedTime() + "Calculating distance values ";
+    ProgressBar progress((query_points.size() + BlockSize - 1) / BlockSize, comment);
+
+    #pragma omp parallel
+    {
+        std::vector<unsigned int> neighbors(k);
+        std::vector<float> distances(k);
+
+        #pragma omp for schedule(dynamic, BlockSize)
+        for(long i = 0; i < (long)query_points.size(); i++)
+        {
+            QueryPoint<BaseVector<float> >& qp = query_points[i];
+            int found = kSearch(qp.m_position.x, qp.m_position.y, qp.m_position.z,
+                                k, neighbors.data(), distances.data());
+
+            if(found == 0)
+            {
+                // No neighbors (kd == 0 or empty tree), the distance is unknown
+                qp.m_invalid = true;
+            }
+            else
+            {
+                // Average position and normal of the nearest tangent planes
+                BaseVector<float> nearest(0, 0, 0);
+                BaseVector<float> normal(0, 0, 0);
+                for(int j = 0; j < found; j++)
+                {
+                    const float* p = points + neighbors[j] * 3;
+                    const float* nb = m_normals.data() + neighbors[j] * 3;
+                    nearest += BaseVector<float>(p[0], p[1], p[2]);
+                    normal += BaseVector<float>(nb[0], nb[1], nb[2]);
+                }
+                nearest /= found;
+                normal.normalize();
+
+                BaseVector<float> diff = qp.m_position - nearest;
+                qp.m_distance = diff.dot(normal);
+                if(diff.length() > 1.7320 * voxel_size)
+                {
+                    qp.m_invalid = true;
+                }
+            }
+
+            if(i % BlockSize == 0)
+            {
+                ++progress;
+            }
+        }
+    }
+    std::cout << std::endl;
+}
+
+void CpuSurface::freeGPU()
+{
+}
+
+} /* namespace lvr2 */
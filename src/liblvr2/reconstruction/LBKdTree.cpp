@@ -27,64 +27,127 @@
 
 #include <stdio.h>
 
+#include <algorithm>
+#include <future>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 #include "lvr2/reconstruction/LBKdTree.hpp"
 
 namespace lvr2
 {
 
-// Static variables
-
-ctpl::thread_pool* LBKdTree::pool;// = new ctpl::thread_pool(8);
-int LBKdTree::st_num_threads = 8;
-int LBKdTree::st_depth_threads = 3;
-
 /// Public
 
-LBKdTree::LBKdTree( LBPointArray<float>& vertices, int num_threads) {
+LBKdTree::LBKdTree( LBPointArray<float>& vertices, int num_threads)
+    : m_dim(0), m_pool(std::max(num_threads, 1))
+{
     this->m_values = boost::shared_ptr<LBPointArray<float> >(new LBPointArray<float>);
     this->m_splits = boost::shared_ptr<LBPointArray<unsigned char> >(new LBPointArray<unsigned char>);
-    st_num_threads = num_threads;
-    st_depth_threads = static_cast<int>(log2(st_num_threads));
-    pool = new ctpl::thread_pool(st_num_threads);
+
+    // Split levels in parallel until there are about two subtrees per thread
+    m_parallelDepth = 1;
+    while((1 << m_parallelDepth) < 2 * num_threads)
+    {
+        m_parallelDepth++;
+    }
+
     this->generateKdTree(vertices);
 }
 
 LBKdTree::~LBKdTree() {
-    if(pool)
-    {
-        delete pool;
-    }
+    m_pool.stop(true);
 }
 
 void LBKdTree::generateKdTree(LBPointArray<float> &vertices) {
 
-    LBPointArray<unsigned int>* indices_sorted =
-        (LBPointArray<unsigned int>*)malloc(vertices.dim * sizeof(LBPointArray<unsigned int>) );
-    LBPointArray<float>* values_sorted =
-        (LBPointArray<float>*)malloc(vertices.dim * sizeof(LBPointArray<float>) );
+    if(vertices.dim > MaxDim)
+    {
+        throw std::invalid_argument("LBKdTree: only points with up to 3 dimensions are supported");
+    }
+
+    size_t num_points = vertices.width;
+    m_dim = vertices.dim;
 
+    // Left-balanced layout: num_points - 1 inner nodes followed by num_points leaves
+    size_t size = num_points > 0 ? num_points * 2 - 1 : 0;
 
+    this->m_values->elements = (float*)malloc(sizeof(float) * size );
+    this->m_values->width = size;
+    this->m_values->dim = 1;
 
-    for(unsigned int i=0; i< vertices.dim; i++)
+    size_t size_splits = size - num_points;
+    this->m_splits->elements = (unsigned char*)malloc(sizeof(unsigned char) * size_splits );
+    this->m_splits->width = size_splits;
+    this->m_splits->dim = 1;
+
+    if(num_points == 0)
+    {
+        return;
+    }
+
+    m_buildPoints.resize(num_points);
+    #pragma omp parallel for schedule(static)
+    for(size_t i = 0; i < num_points; i++)
     {
-        pool->push(generateAndSort<float, unsigned int>, vertices, indices_sorted, values_sorted, i);
-        //generateAndSort<float, unsigned int>(0, vertices, indices_sorted, values_sorted, i);
+        BuildPoint& p = m_buildPoints[i];
+        for(unsigned int d = 0; d < MaxDim; d++)
+        {
+            p.coords[d] = d < m_dim ? vertices.elements[i * m_dim + d] : 0.0f;
+        }
+        p.index = static_cast<unsigned int>(i);
     }
 
-    pool->stop(true);
-    delete pool;
-    pool = new ctpl::thread_pool(st_num_threads);
+    struct Range
+    {
+        size_t begin;
+        size_t end;
+        size_t position;
+    };
+
+    // Upper levels: every node of a level is split concurrently
+    std::vector<Range> level{ {0, num_points, 0} };
+    for(int depth = 0; depth < m_parallelDepth && !level.empty(); depth++)
+    {
+        std::vector<std::future<size_t> > splits;
+        splits.reserve(level.size());
+        for(const Range& r : level)
+        {
+            splits.push_back(m_pool.push([this, r](int) {
+                return splitNode(r.begin, r.end, r.position);
+            }));
+        }
 
-    this->generateKdTreeArray(vertices, indices_sorted, vertices.dim);
+        std::vector<Range> next;
+        next.reserve(level.size() * 2);
+        for(size_t i = 0; i < level.size(); i++)
+        {
+            size_t mid = splits[i].get();
+            const Range& r = level[i];
+            if(mid != r.end)
+            {
+                next.push_back({r.begin, mid, r.position * 2 + 1});
+                next.push_back({mid, r.end, r.position * 2 + 2});
+            }
+        }
+        level.swap(next);
+    }
 
-    for(unsigned int i=0; i<vertices.dim;i++)
+    // Lower levels: one sequential task per remaining subtree
+    std::vector<std::future<void> > subtrees;
+    subtrees.reserve(level.size());
+    for(const Range& r : level)
     {
-        //free(indices_sorted[i].elements);
-        free(values_sorted[i].elements);
+        subtrees.push_back(m_pool.push([this, r](int) {
+            generateSubtree(r.begin, r.end, r.position);
+        }));
     }
-    //free(indices_sorted);
-    //free(values_sorted);
+    for(auto& f : subtrees)
+    {
+        f.get();
+    }
+
+    std::vector<BuildPoint>().swap(m_buildPoints);
 }
 
 boost::shared_ptr<LBPointArray<float> > LBKdTree::getKdTreeValues() {
@@ -97,259 +160,75 @@ boost::shared_ptr<LBPointArray<unsigned char> > LBKdTree::getKdTreeSplits() {
 
 /// Private
 
-void LBKdTree::generateKdTreeArray(LBPointArray<float>& V,
-        LBPointArray<unsigned int>* sorted_indices, int max_dim) {
-
-    // DEBUG CHECK
+size_t LBKdTree::splitNode(size_t begin, size_t end, size_t position)
+{
+    size_t num_points = end - begin;
+    BuildPoint* points = m_buildPoints.data();
 
-    int first_split_dim = -1;
-    float best_deviation = -1.0;
-    // std::cout << "BOX:" << std::endl;
-    for(int i=0; i<V.dim; i++)
+    if(num_points == 1)
     {
-        float deviation = V.elements[static_cast<unsigned int>(
-                            sorted_indices[i].elements[sorted_indices[i].width-1]+0.5)* V.dim + i]
-                        -  V.elements[static_cast<unsigned int>(
-                            sorted_indices[i].elements[i]+0.5)* V.dim + i] ;
-        // std::cout << "Dim: " << i << " size: "<< deviation << std::endl;
-        if(deviation > best_deviation)
-        {
-            best_deviation = deviation;
-            first_split_dim = i;
-        }
+        this->m_values->elements[position] = static_cast<float>(points[begin].index);
+        return end;
     }
 
-
-    unsigned int size;
-    int max_tree_depth;
-
-    max_tree_depth = static_cast<int>( log2f(V.width - 1 ) + 2.0 ) ;
-
-    if (V.width == 1)
+    // Split along the axis of largest extent
+    float min[MaxDim];
+    float max[MaxDim];
+    for(unsigned int d = 0; d < MaxDim; d++)
     {
-        max_tree_depth = 1;
+        min[d] = std::numeric_limits<float>::max();
+        max[d] = std::numeric_limits<float>::lowest();
     }
-
-    size = V.width * 2 - 1;
-
-    // std::cout << "size values: " << size << std::endl;
-    this->m_values->elements = (float*)malloc(sizeof(float) * size );
-    this->m_values->width = size;
-    this->m_values->dim = 1;
-
-    unsigned int size_splits = size - V.width;
-    // std::cout << "size splits: " << size_splits << std::endl;
-    this->m_splits->elements = (unsigned char*)malloc(sizeof(unsigned char) * size_splits );
-    this->m_splits->width = size_splits;
-    this->m_splits->dim = 1;
-
-    LBPointArray<float>* value_ptr = this->m_values.get();
-    LBPointArray<unsigned char>* splits_ptr = this->m_splits.get();
-    //start real generate
-    generateKdTreeRecursive(0, V, sorted_indices, first_split_dim,
-            max_dim, value_ptr, splits_ptr ,size, max_tree_depth, 0, 0);
-
-    pool->stop(true);
-    delete pool;
-    pool = new ctpl::thread_pool(st_num_threads);
-}
-
-void LBKdTree::fillCriticalIndices(const LBPointArray<float>& V,
-        LBPointArray<unsigned int>& sorted_indices, unsigned int current_dim,
-        float split_value, unsigned int split_index,
-        std::list<unsigned int>& critical_indices_left,
-        std::list<unsigned int>& critical_indices_right)
-{
-    critical_indices_left.push_back( sorted_indices.elements[split_index] );
-
-    unsigned int iterator;
-    // nach links
-    for(iterator = split_index-1;
-        iterator < sorted_indices.width
-        && V.elements[ sorted_indices.elements[iterator] * V.dim + current_dim] == split_value;
-        iterator--)
+    for(size_t i = begin; i < end; i++)
     {
-        critical_indices_left.push_back( sorted_indices.elements[iterator] );
+        for(unsigned int d = 0; d < MaxDim; d++)
+        {
+            min[d] = std::min(min[d], points[i].coords[d]);
+            max[d] = std::max(max[d], points[i].coords[d]);
+        }
     }
 
-    // nach rechts
-    for(iterator = split_index+1;
-        iterator < sorted_indices.width
-        && V.elements[ sorted_indices.elements[iterator] * V.dim + current_dim] == split_value;
-        iterator++)
+    unsigned int split_dim = 0;
+    float best_deviation = -1.0;
+    for(unsigned int d = 0; d < m_dim; d++)
     {
-        critical_indices_right.push_back( sorted_indices.elements[iterator] );
+        if(max[d] - min[d] > best_deviation)
+        {
+            best_deviation = max[d] - min[d];
+            split_dim = d;
+        }
     }
 
-}
-
-void LBKdTree::fillCriticalIndicesSet(const LBPointArray<float>& V,
-        LBPointArray<unsigned int>& sorted_indices, unsigned int current_dim,
-        float split_value, unsigned int split_index,
-        std::unordered_set<unsigned int>& critical_indices_left,
-        std::unordered_set<unsigned int>& critical_indices_right)
-{
-    //critical_indices_left.push_back( sorted_indices.elements[split_index] );
-    critical_indices_left.insert(sorted_indices.elements[split_index]);
-    unsigned int iterator;
-    // nach links
-    for(iterator = split_index-1;
-        iterator < sorted_indices.width
-        && V.elements[ sorted_indices.elements[iterator] * V.dim + current_dim] == split_value;
-        iterator--)
+    // Left-balanced split: the left subtree is a complete tree of
+    // v leaves or the right one is a complete tree of v / 2 leaves,
+    // v being the largest power of two below num_points
+    size_t v = 1;
+    while(v * 2 <= num_points - 1)
     {
-        critical_indices_left.insert( sorted_indices.elements[iterator] );
+        v *= 2;
     }
+    size_t left_size = std::min(num_points - v / 2, v);
 
-    // nach rechts
-    for(iterator = split_index+1;
-        iterator < sorted_indices.width
-        && V.elements[ sorted_indices.elements[iterator] * V.dim + current_dim] == split_value;
-        iterator++)
-    {
-        critical_indices_right.insert( sorted_indices.elements[iterator] );
-    }
+    BuildPoint* split = points + begin + left_size - 1;
+    std::nth_element(points + begin, split, points + end,
+        [split_dim](const BuildPoint& a, const BuildPoint& b) {
+            return a.coords[split_dim] < b.coords[split_dim];
+        });
 
+    this->m_values->elements[position] = split->coords[split_dim];
+    this->m_splits->elements[position] = static_cast<unsigned char>(split_dim);
+
+    return begin + left_size;
 }
 
-void LBKdTree::generateKdTreeRecursive(int id, LBPointArray<float>& V,
-        LBPointArray<unsigned int>* sorted_indices, int current_dim, int max_dim,
-        LBPointArray<float> *values, LBPointArray<unsigned char> *splits ,
-        int size, int max_tree_depth, int position, int current_depth)
+void LBKdTree::generateSubtree(size_t begin, size_t end, size_t position)
 {
-    int left = position*2+1;
-    int right = position*2+2;
-
-
-    if( sorted_indices[current_dim].width <= 1 )
+    size_t mid = splitNode(begin, end, position);
+    if(mid != end)
     {
-        values->elements[position] = static_cast<float>(sorted_indices[current_dim].elements[0] );
-    } else {
-        /// split sorted_indices
-        unsigned int indices_size = sorted_indices[current_dim].width;
-
-        unsigned int v = pow( 2, static_cast<int>( log2(indices_size-1) ) );
-        unsigned int left_size = indices_size - v/2;
-
-        if( left_size > v )
-        {
-            left_size = v;
-        }
-
-        unsigned int right_size = indices_size - left_size;
-
-
-
-        unsigned int split_index = static_cast<unsigned int>(
-                sorted_indices[current_dim].elements[left_size-1] + 0.5
-            );
-
-        float split_value = V.elements[split_index * V.dim + current_dim ];
-
-        // critical indices
-        // std::list<unsigned int> critical_indices_left;
-        // std::list<unsigned int> critical_indices_right;
-
-        // fillCriticalIndices(V, sorted_indices[current_dim], current_dim, split_value, left_size-1
-        //      critical_indices_left, critical_indices_right);
-
-
-        std::unordered_set<unsigned int> critical_indices_left;
-        std::unordered_set<unsigned int> critical_indices_right;
-
-        fillCriticalIndicesSet(V, sorted_indices[current_dim],
-                current_dim, split_value, left_size-1, critical_indices_left,
-                critical_indices_right);
-
-        //std::cout << "Split in dimension: " << current_dim << std::endl;
-        values->elements[ position ] = split_value;
-        splits->elements[ position ] = static_cast<unsigned char>(current_dim);
-
-
-        LBPointArray<unsigned int> *sorted_indices_left =
-            (LBPointArray<unsigned int>*)malloc( 3*sizeof(LBPointArray<unsigned int>) );
-        LBPointArray<unsigned int> *sorted_indices_right =
-            (LBPointArray<unsigned int>*)malloc( 3*sizeof(LBPointArray<unsigned int>) );
-
-        int next_dim_left = -1;
-        int next_dim_right = -1;
-        float biggest_deviation_left = -1.0;
-        float biggest_deviation_right = -1.0;
-
-        for( int i=0; i<max_dim; i++ )
-        {
-
-            sorted_indices_left[i].width = left_size;
-            sorted_indices_left[i].dim = 1;
-            sorted_indices_left[i].elements = (unsigned int*)malloc( left_size * sizeof(unsigned int) );
-
-            sorted_indices_right[i].width = right_size;
-            sorted_indices_right[i].dim = 1;
-            sorted_indices_right[i].elements = (unsigned int*)malloc( right_size * sizeof(unsigned int) );
-
-            float deviation_left;
-            float deviation_right;
-
-
-            if( i == current_dim ){
-                 splitPointArray<unsigned int>( sorted_indices[i],
-                         sorted_indices_left[i],
-                         sorted_indices_right[i]);
-
-
-                 deviation_left = fabs(V.elements[sorted_indices_left[i].elements[left_size - 1] * V.dim + i ]
-                                    - V.elements[sorted_indices_left[i].elements[0] * V.dim + i ]   );
-                 deviation_right = fabs( V.elements[ sorted_indices_right[i].elements[right_size - 1]  * V.dim + i ]
-                                    - V.elements[sorted_indices_right[i].elements[0]  * V.dim + i] );
-
-            } else {
-                splitPointArrayWithValueSet<float, unsigned int>(V, sorted_indices[i],
-                        sorted_indices_left[i], sorted_indices_right[i],
-                        current_dim, split_value,
-                        deviation_left, deviation_right, i,
-                        critical_indices_left, critical_indices_right);
-            }
-
-            if(deviation_left > biggest_deviation_left )
-            {
-                biggest_deviation_left = deviation_left;
-                next_dim_left = i;
-            }
-
-            if(deviation_right > biggest_deviation_right )
-            {
-                biggest_deviation_right = deviation_right;
-                next_dim_right = i;
-            }
-        }
-
-        //int next_dim = (current_dim+1)%max_dim;
-
-        if(current_depth == st_depth_threads )
-        {
-            pool->push(generateKdTreeRecursive, V, sorted_indices_left,
-                    next_dim_left, max_dim, values, splits, size, max_tree_depth,
-                    left, current_depth + 1);
-
-            pool->push(generateKdTreeRecursive, V, sorted_indices_right,
-                    next_dim_right, max_dim, values, splits, size, max_tree_depth,
-                    right, current_depth +1);
-        } else {
-            //std::cout<< "left " << current_dim << std::endl;
-            generateKdTreeRecursive(0, V, sorted_indices_left, next_dim_left, max_dim,
-                    values, splits, size, max_tree_depth, left, current_depth + 1);
-            //std::cout << "right " << current_dim << std::endl;
-            generateKdTreeRecursive(0, V, sorted_indices_right, next_dim_right, max_dim,
-                    values, splits, size, max_tree_depth, right, current_depth +1);
-        }
-
+        generateSubtree(begin, mid, position * 2 + 1);
+        generateSubtree(mid, end, position * 2 + 2);
     }
-
-    for(int i=0; i<max_dim; i++) {
-        free(sorted_indices[i].elements );
-    }
-    free(sorted_indices);
-
 }
 
 } /* namespace lvr2 */
@@ -37,6 +37,7 @@
 #include "lvr2/io/Progress.hpp"
 #include "lvr2/io/Timestamp.hpp"
 #include "lvr2/geometry/BaseVector.hpp"
+#include "lvr2/config/lvropenmp.hpp"
 
 #include <iostream>
 #include <fstream>
@@ -79,6 +80,9 @@ ModelToImage::ModelToImage(
                 minVerticalAngle, maxVerticalAngle,
                 imageOptimization, system);
 
+    // The projection may have adapted the image size to the field of view
+    m_width = m_projection->w();
+    m_height = m_projection->h();
 }
 
 
@@ -88,104 +92,211 @@ ModelToImage::~ModelToImage()
     // TODO Auto-generated destructor stub
 }
 
-void ModelToImage::computeDepthListMatrix(DepthListMatrix& mat)
+void ModelToImage::projectPoints(vector<int>& pixels, vector<float>& ranges, float& minRange, float& maxRange)
 {
-    cout << timestamp << "Initializting DepthListMatrix with dimensions " << m_width << " x " << m_height << endl;
-    // Set correct image width and height
-    for(int i = 0; i < m_height; i++)
-    {
-        mat.pixels.emplace_back(vector<vector<PanoramaPoint> >());
-        for(int j = 0; j < m_width; j++)
-        {
-            mat.pixels[i].push_back(vector<PanoramaPoint>());
-        }
-    }
-
     // Get point array and size from buffer
     size_t n_points = m_points->numPoints();
     floatArr points = m_points->getPointArray();
 
+    pixels.resize(n_points);
+    ranges.resize(n_points);
+
+    // Points are projected in blocks, so that the projection can vectorize
+    // its kernel
+    const size_t blockSize = 4096;
+    size_t n_blocks = (n_points + blockSize - 1) / blockSize;
+
     // Create progress output
     string comment = timestamp.getElapsedTime() + "Projecting points ";
-    ProgressBar progress(n_points, comment);
+    ProgressBar progress(n_blocks, comment);
 
-    float range;
-    int img_x, img_y;
-    for(int i = 0; i < n_points; i++)
-    {        
-        Vec ppt(points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+    float min_r = minRange;
+    float max_r = maxRange;
 
-        m_projection->project(
-                    img_x, img_y, range,
-                    ppt.x, ppt.y, ppt.z);
+    #pragma omp parallel for schedule(dynamic) reduction(min : min_r) reduction(max : max_r)
+    for(long b = 0; b < (long)n_blocks; b++)
+    {
+        size_t first = b * blockSize;
+        size_t n = std::min(blockSize, n_points - first);
 
-        // Update min and max ranges
-        if(range > mat.maxRange)
-        {
-            mat.maxRange = range;
-        }
+        int img_x[blockSize];
+        int img_y[blockSize];
+        float* range = ranges.data() + first;
 
-        if(range < mat.minRange)
-        {
-            mat.minRange = range;
-        }
+        m_projection->projectBatch(n, points.get() + 3 * first, img_x, img_y, range);
 
-        if(range < m_maxZ)
+        for(size_t k = 0; k < n; k++)
         {
-            // Add point index to image pixel
-            mat.pixels[img_y][img_x].emplace_back(PanoramaPoint(i));
+            pixels[first + k] = img_y[k] * m_width + img_x[k];
+            min_r = std::min(min_r, range[k]);
+            max_r = std::max(max_r, range[k]);
         }
         ++progress;
     }
     cout << endl;
+
+    minRange = min_r;
+    maxRange = max_r;
 }
 
-void ModelToImage::computeDepthImage(ModelToImage::DepthImage& img, ModelToImage::ProjectionPolicy policy)
+void ModelToImage::computeDepthListMatrix(DepthListMatrix& mat)
 {
-    cout << timestamp << "Computing depth image. Image dimensions: " << m_width << " x " << m_height << endl;
-
+    cout << timestamp << "Initializting DepthListMatrix with dimensions " << m_width << " x " << m_height << endl;
     // Set correct image width and height
-    for(int i = 0; i < m_height; i++)
+    mat.pixels.assign(m_height, vector<vector<PanoramaPoint> >(m_width));
+
+    vector<int> pixels;
+    vector<float> ranges;
+    projectPoints(pixels, ranges, mat.minRange, mat.maxRange);
+
+    // Bin the points into pixels. The image is split into one band of rows
+    // per thread. The points are first sorted into per-band buckets, then
+    // each thread fills the pixels of its band from its own bucket, so no
+    // synchronization is needed and the points of each pixel keep the order
+    // of the point buffer.
+    size_t n_points = pixels.size();
+    int n_threads = OpenMPConfig::getNumThreads();
+    int n_bands = std::max(1, std::min(n_threads, m_height));
+    size_t n_chunks = std::max(1, n_threads);
+
+    // Points outside of the image or the range are skipped
+    long n_pixels = (long)m_width * m_height;
+    auto valid = [&](size_t k)
+    {
+        return pixels[k] >= 0 && pixels[k] < n_pixels && ranges[k] < m_maxZ;
+    };
+
+    // Fills the pixels [first, last) with the points passed to the visitor
+    // of forEachPoint. Every pixel list is allocated only once.
+    auto fillBand = [&](int first, int last, auto forEachPoint)
     {
-        img.pixels.emplace_back(vector<float>());
-        for(int j = 0; j < m_width; j++)
+        vector<unsigned int> counts(last - first, 0);
+        forEachPoint([&](size_t k)
         {
-            img.pixels[i].push_back(0.0f);
+            counts[pixels[k] - first]++;
+        });
+
+        for(int p = first; p < last; p++)
+        {
+            mat.pixels[p / m_width][p % m_width].reserve(counts[p - first]);
         }
-    }
 
+        forEachPoint([&](size_t k)
+        {
+            // Add point index to image pixel
+            mat.pixels[pixels[k] / m_width][pixels[k] % m_width].emplace_back(PanoramaPoint(k));
+        });
+    };
 
-    // Get point array and size from buffer
-    size_t n_points = m_points->numPoints();
-    floatArr points = m_points->getPointArray();
+    // A single band needs no buckets
+    if(n_bands == 1)
+    {
+        fillBand(0, n_pixels, [&](auto visit)
+        {
+            for(size_t k = 0; k < n_points; k++)
+            {
+                if(valid(k))
+                {
+                    visit(k);
+                }
+            }
+        });
+        return;
+    }
 
-    // Create progress output
-    string comment = timestamp.getElapsedTime() + "Projecting points ";
-    ProgressBar progress(n_points, comment);
+    vector<int> bandOfRow(m_height);
+    for(int band = 0; band < n_bands; band++)
+    {
+        int firstRow = (long)m_height * band / n_bands;
+        int lastRow = (long)m_height * (band + 1) / n_bands;
+        std::fill(bandOfRow.begin() + firstRow, bandOfRow.begin() + lastRow, band);
+    }
+
+    // Count the points of each band in contiguous chunks of the point buffer
+    vector<size_t> chunkCounts(n_chunks * n_bands, 0);
 
-    float range;
-    int img_x, img_y;
-    for(int i = 0; i < n_points; i++)
+    #pragma omp parallel for schedule(static)
+    for(size_t chunk = 0; chunk < n_chunks; chunk++)
     {
-        m_projection->project(
-                    img_x, img_y, range,
-                    points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+        size_t first = n_points * chunk / n_chunks;
+        size_t last = n_points * (chunk + 1) / n_chunks;
+        size_t* counts = chunkCounts.data() + chunk * n_bands;
+        for(size_t k = first; k < last; k++)
+        {
+            if(valid(k))
+            {
+                counts[bandOfRow[pixels[k] / m_width]]++;
+            }
+        }
+    }
 
-        // Update min and max ranges
-        if(range > img.maxRange)
+    // Offsets of each chunk within the bucket of each band. Buckets are
+    // stored one after the other, chunks keep their order within a bucket.
+    vector<size_t> bandStart(n_bands + 1, 0);
+    size_t offset = 0;
+    for(int band = 0; band < n_bands; band++)
+    {
+        bandStart[band] = offset;
+        for(size_t chunk = 0; chunk < n_chunks; chunk++)
         {
-            img.maxRange = range;
+            size_t count = chunkCounts[chunk * n_bands + band];
+            chunkCounts[chunk * n_bands + band] = offset;
+            offset += count;
         }
+    }
+    bandStart[n_bands] = offset;
 
-        if(range < img.minRange)
+    vector<size_t> buckets(offset);
+
+    #pragma omp parallel for schedule(static)
+    for(size_t chunk = 0; chunk < n_chunks; chunk++)
+    {
+        size_t first = n_points * chunk / n_chunks;
+        size_t last = n_points * (chunk + 1) / n_chunks;
+        size_t* cursor = chunkCounts.data() + chunk * n_bands;
+        for(size_t k = first; k < last; k++)
         {
-            img.minRange = range;
+            if(valid(k))
+            {
+                buckets[cursor[bandOfRow[pixels[k] / m_width]]++] = k;
+            }
         }
+    }
 
-        img.pixels[img_y][img_x] = range;
-        ++progress;
+    #pragma omp parallel for schedule(static)
+    for(int band = 0; band < n_bands; band++)
+    {
+        int first = (long)m_height * band / n_bands * m_width;
+        int last = (long)m_height * (band + 1) / n_bands * m_width;
+
+        fillBand(first, last, [&](auto visit)
+        {
+            for(size_t i = bandStart[band]; i < bandStart[band + 1]; i++)
+            {
+                visit(buckets[i]);
+            }
+        });
     }
-    cout << endl;
+}
+
+void ModelToImage::computeDepthImage(ModelToImage::DepthImage& img, ModelToImage::ProjectionPolicy policy)
+{
+    cout << timestamp << "Computing depth image. Image dimensions: " << m_width << " x " << m_height << endl;
+
+    // Set correct image width and height
+    img.pixels.assign(m_height, vector<float>(m_width, 0.0f));
+
+    vector<int> pixels;
+    vector<float> ranges;
+    projectPoints(pixels, ranges, img.minRange, img.maxRange);
+
+    // The last projected point of each pixel wins. This is a single
+    // streaming pass over the projected points.
+    for(size_t k = 0; k < pixels.size(); k++)
+    {
+        img.pixels[pixels[k] / m_width][pixels[k] % m_width] = ranges[k];
+    }
+
     cout << timestamp << "Min / Max range: " << img.minRange << " / " << img.maxRange << endl;
 }
 
@@ -35,12 +35,8 @@
 #include <Eigen/Dense>
 
 #include <iostream>
-#include <iterator>
 #include <algorithm>
 
-#include <gsl/gsl_math.h>
-#include <gsl/gsl_eigen.h>
-
 using std::cout;
 using std::endl;
 
@@ -57,10 +53,8 @@ PanoramaNormals::PanoramaNormals(ModelToImage* mti)
 
 PointBufferPtr PanoramaNormals::computeNormals(int width, int height, bool interpolate)
 {
-    // Create new point buffer and tmp storages
+    // Create new point buffer
     PointBufferPtr out_buffer(new PointBuffer);
-    vector<float> pts;
-    vector<float> normals;
 
     // Get input buffer's points
     PointBufferPtr in_buffer = m_mti->pointBuffer();
@@ -69,13 +63,23 @@ PointBufferPtr PanoramaNormals::computeNormals(int width, int height, bool inter
     floatArr in_points = in_buffer->getPointArray();
     ucharArr in_colors = in_buffer->getColorArray(w_color);
 
-    // Reserve memory for output buffers (we need a deep copy)
+    // Reserve memory for output buffers (we need a deep copy). Points
+    // without a valid neighborhood keep a zero normal.
     floatArr p_arr(new float[n_inPoints * 3]);
     floatArr n_arr(new float[n_inPoints * 3]);
+    std::copy(in_points.get(), in_points.get() + n_inPoints * 3, p_arr.get());
+    std::fill(n_arr.get(), n_arr.get() + n_inPoints * 3, 0.0f);
+
     ucharArr c_arr;
     if(in_buffer->hasColors())
     {
         c_arr = ucharArr(new unsigned char[n_inPoints * 3]);
+        for(size_t k = 0; k < n_inPoints; k++)
+        {
+            c_arr[3 * k    ] = in_colors[k * w_color];
+            c_arr[3 * k + 1] = in_colors[k * w_color + 1];
+            c_arr[3 * k + 2] = in_colors[k * w_color + 2];
+        }
     }
 
     // Get panorama
@@ -102,24 +106,43 @@ PointBufferPtr PanoramaNormals::computeNormals(int width, int height, bool inter
     string comment = timestamp.getElapsedTime() + "Computing normals ";
     ProgressBar progress(mat.pixels.size(), comment);
 
+    int rows = mat.pixels.size();
 
-
-    for(size_t i = 0; i < mat.pixels.size(); i++)
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < rows; i++)
     {
-        #pragma omp parallel for
-        for(size_t j = 0; j < mat.pixels[i].size(); j++)
+        int cols = mat.pixels[i].size();
+        for(int j = 0; j < cols; j++)
         {
+            const vector<ModelToImage::PanoramaPoint>& pixel = mat.pixels[i][j];
+
             // Check if image entry is empty
-            if(mat.pixels[i][j].size() == 0)
+            if(pixel.size() == 0)
             {
                 continue;
             }
 
-            // Collect 'neighboring' points
-            vector<ModelToImage::PanoramaPoint> nb;
+            // Accumulate sums and squared sums of the neighborhood. The
+            // coordinates are shifted to the first point of the pixel to
+            // keep the covariance numerically stable.
+            Eigen::Map<const Eigen::Vector3f> ref(in_points.get() + pixel[0].index * 3);
+            Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+            Eigen::Matrix3d sq = Eigen::Matrix3d::Zero();
+            size_t n_nb = 0;
+
+            auto addNeighbor = [&](size_t index)
+            {
+                Eigen::Vector3d pt = (Eigen::Map<const Eigen::Vector3f>(in_points.get() + index * 3) - ref).cast<double>();
+                sum += pt;
+                sq.noalias() += pt * pt.transpose();
+                n_nb++;
+            };
 
             // The points at the current position are part of the neighborhood
-            std::copy(mat.pixels[i][j].begin(), mat.pixels[i][j].end(), std::back_inserter(nb));
+            for(const auto& p : pixel)
+            {
+                addNeighbor(p.index);
+            }
 
             for(int off_i = -di; off_i <= di; off_i++)
             {
@@ -128,9 +151,8 @@ PointBufferPtr PanoramaNormals::computeNormals(int width, int height, bool inter
                     int p_i = i + off_i;
                     int p_j = j + off_j;
 
-
-                    if(p_i >= 0 && p_i < mat.pixels.size() &&
-                       p_j >= 0 && p_j < mat.pixels[i].size())
+                    if(p_i >= 0 && p_i < rows &&
+                       p_j >= 0 && p_j < cols)
                     {
                         // We only save the first point as representative
                         // because using all points from list will likely
@@ -138,129 +160,36 @@ PointBufferPtr PanoramaNormals::computeNormals(int width, int height, bool inter
                         // normal estimation
                         if(mat.pixels[p_i][p_j].size() > 0)
                         {
-                            nb.push_back(mat.pixels[p_i][p_j][0]);
+                            addNeighbor(mat.pixels[p_i][p_j][0].index);
                         }
                     }
                 }
             }
 
             // Compute normal if more than three neighbors where found
-            if(nb.size() > 3)
+            if(n_nb > 3 && !interpolate)
             {
-
-
-                // Compute mean
-                Vec mean;
-                for(int i = 0; i < nb.size(); i++)
+                Eigen::Vector3d mean = sum / n_nb;
+                Eigen::Matrix3d covariance = sq / n_nb - mean * mean.transpose();
+
+                // Closed form solver for symmetric 3x3 matrices. The eigenvalues
+                // are sorted in increasing order, so the first eigenvector
+                // is the normal.
+                Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver;
+                solver.computeDirect(covariance);
+                Eigen::Vector3f normal = solver.eigenvectors().col(0).cast<float>();
+
+                // Flip normals towards reference point (the scanner position)
+                if(-ref.dot(normal) < 0)
                 {
-                    // Determine position of geometry in point array
-                    size_t index = nb[i].index * 3;
-
-                    // Get point coordinates
-                    Vec neighbor(in_points[index],
-                                           in_points[index + 1],
-                                           in_points[index + 2]);
-
-                    // Add to mean
-                    mean.x += neighbor.x;
-                    mean.y += neighbor.y;
-                    mean.z += neighbor.z;
+                    normal = -normal;
                 }
-                mean.x /= nb.size();
-                mean.y /= nb.size();
-                mean.z /= nb.size();
-
-                // Calculate covariance
-                double covariance[9] = {0};
 
-                for(int i = 0; i < nb.size(); i++)
+                // Assign the same normal to all points behind this
+                // pixel to preserve the complete point cloud
+                for(const auto& p : pixel)
                 {
-                    size_t index = nb[i].index * 3;
-
-                    Vec pt(in_points[index    ] - mean.x,
-                                     in_points[index + 1] - mean.y,
-                                     in_points[index + 3] - mean.z);
-
-                    covariance[4] += pt.y * pt.y;
-                    covariance[7] += pt.y * pt.z;
-                    covariance[8] += pt.z * pt.z;
-
-                    pt.x *= pt.x;
-                    pt.y *= pt.x;
-                    pt.z *= pt.x;
-
-                    covariance[0] += pt.x;
-                    covariance[1] += pt.y;
-                    covariance[6] += pt.z;
-
-                }
-
-                covariance[3] = covariance[1];
-                covariance[2] = covariance[6];
-                covariance[5] = covariance[7];
-
-                for(int i = 0; i < 9; i++)
-                {
-                    covariance[i] /= nb.size();
-                }
-
-                // Compute eigenvalues and eigenvectors using GSL
-                gsl_matrix_view m = gsl_matrix_view_array(covariance, 3, 3);
-                gsl_matrix* evec = gsl_matrix_alloc(3, 3);
-                gsl_vector* eval = gsl_vector_alloc(3);
-
-
-                gsl_eigen_symmv_workspace * w = gsl_eigen_symmv_alloc (3);
-                gsl_eigen_symmv (&m.matrix, eval, evec, w);
-
-                gsl_eigen_symmv_free (w);
-                gsl_eigen_symmv_sort (eval, evec, GSL_EIGEN_SORT_ABS_ASC);
-
-                gsl_vector_view evec_0 = gsl_matrix_column(evec, 0);
-                float nx = gsl_vector_get(&evec_0.vector, 0);
-                float ny = gsl_vector_get(&evec_0.vector, 1);
-                float nz = gsl_vector_get(&evec_0.vector, 2);
-
-                // Flip normals towards reference point
-                Normal<float> nn(nx, ny, nz);
-                Vec center(0, 0, 0);
-
-                size_t index = mat.pixels[i][j][0].index * 3;
-                Vec p1 = center - Vec(in_points[index], in_points[index + 1], in_points[index + 2]);
-
-                if(Normal<float>(p1) * nn < 0)
-                {
-                    nx *= -1;
-                    ny *= -1;
-                    nz *= -1;
-                }
-
-                for(size_t k = 0; k < mat.pixels[i][j].size(); k++)
-                {
-                    // Assign the same normal to all points
-                    // behind this pixel to preserve the complete
-                    // point cloud
-                    size_t index = mat.pixels[i][j][k].index * 3;
-                    size_t color_index = mat.pixels[i][j][k].index * w_color;
-
-                    // Copy point and normal to target buffer
-                    p_arr[index    ] = in_points[index];
-                    p_arr[index + 1] = in_points[index + 1];
-                    p_arr[index + 2] = in_points[index + 2];
-
-                    if(in_buffer->hasColors())
-                    {
-                        c_arr[index    ] = in_colors[color_index];
-                        c_arr[index + 1] = in_colors[color_index + 1];
-                        c_arr[index + 2] = in_colors[color_index + 2];
-                    }
-
-                    if(!interpolate)
-                    {
-                        n_arr[index    ] = nx;
-                        n_arr[index + 1] = ny;
-                        n_arr[index + 2] = nz;
-                    }
+                    Eigen::Map<Eigen::Vector3f>(n_arr.get() + p.index * 3) = normal;
                 }
             }
         }
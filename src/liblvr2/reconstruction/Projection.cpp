@@ -96,6 +96,15 @@ void Projection::setImageRatio()
 
 
 
+void Projection::projectBatch(size_t n, const float* points, int* i, int* j, float* r)
+{
+    for(size_t k = 0; k < n; k++)
+    {
+        r[k] = 0.0f;
+        project(i[k], j[k], r[k], points[3 * k], points[3 * k + 1], points[3 * k + 2]);
+    }
+}
+
 EquirectangularProjection::EquirectangularProjection(int width, int height, int minH, int maxH, int minV, int maxV, bool optimize, ModelToImage::CoordinateSystem system)
     : Projection(width, height, minH, maxH, minV, maxV, optimize, system)
 {
@@ -214,6 +223,43 @@ void EquirectangularProjection::project(int& i, int& j, float& range, float x, f
     //cout << i << " " << j <<  " " << range << " / " << m_maxWidth << " " << m_maxHeight << endl;
 }
 
+void EquirectangularProjection::projectBatch(size_t n, const float* points, int* i, int* j, float* r)
+{
+    const float twoPi = 2 * M_PI;
+
+    // Same mapping as project(), but longitude and latitude are computed
+    // with atan2 approximations instead of acos / asin
+    #pragma omp simd
+    for(size_t k = 0; k < n; k++)
+    {
+        float x, y, z;
+        toNative(points[3 * k], points[3 * k + 1], points[3 * k + 2], x, y, z);
+
+        float rxy = std::sqrt(x * x + y * y);
+        r[k] = std::sqrt(x * x + y * y + z * z);
+
+        // Longitude, clockwise in (0:2pi]
+        float phi = fastAtan2(y, x);
+        phi = phi < 0 ? -phi : twoPi - phi;
+
+        // Latitude
+        float theta = fastAtan2(z, rxy);
+
+        int ii = (int) (m_xFactor * phi);
+        ii = ii < 0 ? 0 : ii;
+        ii = ii > m_maxWidth ? m_maxWidth : ii;
+
+        int jj = m_maxHeight - (int) (m_yFactor * (theta - m_lowShift));
+        jj = jj < 0 ? 0 : jj;
+        jj = jj > m_maxHeight ? m_maxHeight : jj;
+
+        // Points on the coordinate planes are mapped to the first pixel
+        bool valid = x != 0 && y != 0 && z != 0;
+        i[k] = valid ? ii : 0;
+        j[k] = valid ? jj : 0;
+    }
+}
+
 ConicProjection::ConicProjection(int width, int height, int minH, int maxH, int minV, int maxV, bool optimize, ModelToImage::CoordinateSystem system)
     : Projection(width, height, minH, maxH, minV, maxV, optimize, system)
 {
@@ -264,6 +310,47 @@ CylindricalProjection::CylindricalProjection(int width, int height, int minH, in
     m_maxHeight = m_height - 1;
 }
 
+void CylindricalProjection::project(int& i, int& j, float& range, float x, float y, float z)
+{
+    float point[3] = {x, y, z};
+    projectBatch(1, point, &i, &j, &range);
+}
+
+void CylindricalProjection::projectBatch(size_t n, const float* points, int* i, int* j, float* r)
+{
+    const float twoPi = 2 * M_PI;
+    const float tanLow = std::tan(m_heightLow);
+
+    #pragma omp simd
+    for(size_t k = 0; k < n; k++)
+    {
+        float x, y, z;
+        toNative(points[3 * k], points[3 * k + 1], points[3 * k + 2], x, y, z);
+
+        float rxy = std::sqrt(x * x + y * y);
+        r[k] = std::sqrt(x * x + y * y + z * z);
+
+        // Longitude, clockwise in (0:2pi]
+        float phi = fastAtan2(y, x);
+        phi = phi < 0 ? -phi : twoPi - phi;
+
+        // tan(latitude) needs no trigonometry at all
+        float tanTheta = rxy > 0 ? z / rxy : 0.0f;
+
+        int ii = (int) (m_xFactor * phi);
+        ii = ii < 0 ? 0 : ii;
+        ii = ii > m_maxWidth ? m_maxWidth : ii;
+
+        int jj = m_maxHeight - (int) (m_yFactor * (tanTheta - tanLow));
+        jj = jj < 0 ? 0 : jj;
+        jj = jj > m_maxHeight ? m_maxHeight : jj;
+
+        bool valid = x != 0 && y != 0 && z != 0;
+        i[k] = valid ? ii : 0;
+        j[k] = valid ? jj : 0;
+    }
+}
+
 MercatorProjection::MercatorProjection(int width, int height, int minH, int maxH, int minV, int maxV, bool optimize, ModelToImage::CoordinateSystem system)
     : Projection(width, height, minH, maxH, minV, maxV, optimize, system)
 {
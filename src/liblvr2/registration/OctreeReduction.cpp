@@ -1,7 +1,9 @@
-#include "lvr2/registration/AABB.hpp"
 #include "lvr2/registration/OctreeReduction.hpp"
 #include "lvr2/io/IOUtils.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vector>
 
 namespace lvr2
@@ -10,67 +12,215 @@ namespace lvr2
 OctreeReduction::OctreeReduction(
     PointBufferPtr &pointBuffer,
     const double &voxelSize,
-    const size_t &minPointsPerVoxel)
+    const size_t &minPointsPerVoxel,
+    VoxelReductionPolicy policy)
     : m_voxelSize(voxelSize),
       m_minPointsPerVoxel(minPointsPerVoxel),
-      m_numPoints(pointBuffer->numPoints()),
-      m_pointBuffer(pointBuffer)
+      m_policy(policy),
+      m_pointBuffer(pointBuffer),
+      m_points(nullptr),
+      m_numReducedPoints(0)
 {
     size_t n = pointBuffer->numPoints();
-    m_flags = new bool[n];
-    for (int i = 0; i < n; i++)
+    floatArr points = pointBuffer->getPointArray();
+    if(!points)
     {
-        m_flags[i] = false;
+        std::cout << timestamp << "Error: OctreeReduction: Unable to get point channel." << std::endl;
+        return;
     }
 
-    typename lvr2::Channel<float>::Optional pts_opt = pointBuffer->getChannel<float>("points");
-    if(pts_opt)
+    float minX = std::numeric_limits<float>::max(), maxX = std::numeric_limits<float>::lowest();
+    float minY = minX, maxY = maxX;
+    float minZ = minX, maxZ = maxX;
+    const float* pts = points.get();
+
+    #pragma omp parallel for reduction(min:minX,minY,minZ) reduction(max:maxX,maxY,maxZ)
+    for (size_t i = 0; i < n; i++)
     {
-        lvr2::Channel<float> points = *pts_opt;
-        AABB<float> boundingBox(points, n);
+        minX = std::min(minX, pts[3 * i]);
+        minY = std::min(minY, pts[3 * i + 1]);
+        minZ = std::min(minZ, pts[3 * i + 2]);
+        maxX = std::max(maxX, pts[3 * i]);
+        maxY = std::max(maxY, pts[3 * i + 1]);
+        maxZ = std::max(maxZ, pts[3 * i + 2]);
+    }
+    initGrid(Vector3f(minX, minY, minZ), Vector3f(maxX, maxY, maxZ));
 
-        #pragma omp parallel // allows "pragma omp task"
-        #pragma omp single   // only execute every task once
-        createOctree(pointBuffer, 0, n, m_flags, boundingBox.min(), boundingBox.max(), 0);
+    if (n <= std::numeric_limits<uint32_t>::max())
+    {
+        reduceBuffer<uint32_t>(pts, n);
     }
+    else
+    {
+        reduceBuffer<uint64_t>(pts, n);
+    }
+    m_numReducedPoints = m_reducedIndices.size();
 }
 
 OctreeReduction::OctreeReduction(
     Vector3f *points,
-    const size_t &n0,
+    const size_t &n,
     const double &voxelSize,
-    const size_t &minPointsPerVoxel) : m_voxelSize(voxelSize), m_minPointsPerVoxel(minPointsPerVoxel)
+    const size_t &minPointsPerVoxel,
+    VoxelReductionPolicy policy)
+    : m_voxelSize(voxelSize),
+      m_minPointsPerVoxel(minPointsPerVoxel),
+      m_policy(policy),
+      m_points(points),
+      m_numReducedPoints(0)
 {
+    Vector3f min = Vector3f::Constant(std::numeric_limits<float>::max());
+    Vector3f max = Vector3f::Constant(std::numeric_limits<float>::lowest());
+    for (size_t i = 0; i < n; i++)
+    {
+        min = min.cwiseMin(points[i]);
+        max = max.cwiseMax(points[i]);
+    }
+    initGrid(min, max);
+
+    reducePoints(points, n);
+}
 
-    m_flags = new bool[n0];
-    for (int i = 0; i < n0; i++)
+PointBufferPtr OctreeReduction::getReducedPoints()
+{
+    if (!m_pointBuffer)
     {
-        m_flags[i] = false;
+        return PointBufferPtr(new PointBuffer);
     }
 
-    AABB<float> boundingBox(points, n0);
+    PointBufferPtr reduced = subSamplePointBuffer(m_pointBuffer, m_reducedIndices);
+    if (m_centroids.size() == m_reducedIndices.size() && !m_centroids.empty())
+    {
+        floatArr points = reduced->getPointArray();
+        for (size_t i = 0; i < m_centroids.size(); i++)
+        {
+            points[3 * i]     = m_centroids[i][0];
+            points[3 * i + 1] = m_centroids[i][1];
+            points[3 * i + 2] = m_centroids[i][2];
+        }
+    }
+    return reduced;
+}
 
-#pragma omp parallel // allows "pragma omp task"
-#pragma omp single   // only execute every task once
-    createOctree<Vector3f>(points, n0, m_flags, boundingBox.min(), boundingBox.max(), 0);
+Vector3f* OctreeReduction::getReducedPoints(size_t& n)
+{
+    n = m_numReducedPoints;
+    return m_points;
 }
 
-PointBufferPtr OctreeReduction::getReducedPoints()
+void OctreeReduction::reducePoints(Vector3f* points, size_t n)
 {
-    std::vector<size_t> reducedIndices;
-    for (size_t i = 0; i < m_numPoints; i++)
+    size_t numBuckets = size_t(1) << m_bucketBits;
+    auto bucketOf = [this](const Vector3f& p)
     {
-        if (!m_flags[i])
+        return mortonCode(p) >> m_bucketShift;
+    };
+
+    // Distribute the points to their buckets in place (American flag sort)
+    std::vector<size_t> counts(numBuckets, 0);
+    #pragma omp parallel
+    {
+        std::vector<size_t> local(numBuckets, 0);
+
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < n; i++)
+        {
+            local[bucketOf(points[i])]++;
+        }
+
+        #pragma omp critical
+        for (size_t b = 0; b < numBuckets; b++)
         {
-            reducedIndices.push_back(i);
+            counts[b] += local[b];
         }
     }
 
-    return subSamplePointBuffer(m_pointBuffer, reducedIndices);
+    std::vector<size_t> bucketBegin(numBuckets + 1, 0);
+    for (size_t b = 0; b < numBuckets; b++)
+    {
+        bucketBegin[b + 1] = bucketBegin[b] + counts[b];
+    }
+
+    std::vector<size_t> next(bucketBegin.begin(), bucketBegin.end() - 1);
+    for (size_t b = 0; b < numBuckets; b++)
+    {
+        while (next[b] < bucketBegin[b + 1])
+        {
+            Vector3f p = points[next[b]];
+            size_t pb = bucketOf(p);
+            while (pb != b)
+            {
+                std::swap(p, points[next[pb]++]);
+                pb = bucketOf(p);
+            }
+            points[next[b]++] = p;
+        }
+    }
+
+    // Reduce every bucket, its kept points are moved to its front
+    std::vector<size_t> numKept(numBuckets, 0);
+
+    #pragma omp parallel
+    {
+        std::vector<BucketRecord> records;
+        std::vector<Vector3f> centroids;
+        std::vector<Vector3f> kept;
+
+        #pragma omp for schedule(dynamic, 16)
+        for (size_t b = 0; b < numBuckets; b++)
+        {
+            Vector3f* bucket = points + bucketBegin[b];
+            size_t count = bucketBegin[b + 1] - bucketBegin[b];
+            if (count == 0)
+            {
+                continue;
+            }
+
+            centroids.clear();
+            numKept[b] = reduceBucket(count, [bucket](size_t i) { return bucket[i]; }, records, centroids);
+
+            kept.resize(numKept[b]);
+            for (size_t i = 0; i < numKept[b]; i++)
+            {
+                kept[i] = m_policy == VoxelReductionPolicy::CENTROID ? centroids[i] : bucket[records[i].index];
+            }
+            std::copy(kept.begin(), kept.end(), bucket);
+        }
+    }
+
+    // Move the kept points of all buckets to the front
+    m_numReducedPoints = 0;
+    for (size_t b = 0; b < numBuckets; b++)
+    {
+        std::move(points + bucketBegin[b], points + bucketBegin[b] + numKept[b], points + m_numReducedPoints);
+        m_numReducedPoints += numKept[b];
+    }
 }
 
-void OctreeReduction::getReducedPoints(Vector3f &points, size_t &n)
+void OctreeReduction::initGrid(const Vector3f& min, const Vector3f& max)
 {
+    // Morton codes interleave 21 bits per axis
+    const uint32_t maxCells = (1u << 21) - 1;
+
+    m_min = min;
+    double extent = std::max(0.0f, (max - min).maxCoeff());
+    if (extent / m_voxelSize >= maxCells)
+    {
+        m_voxelSize = extent / (maxCells - 1);
+        std::cout << timestamp << "Warning: OctreeReduction: Too many voxels, increasing voxel size to "
+                  << m_voxelSize << std::endl;
+    }
+    m_invVoxelSize = 1.0 / m_voxelSize;
+    m_maxCell = static_cast<uint32_t>(extent * m_invVoxelSize);
+
+    // Bucket by the 16 most significant bits that can be non-zero
+    int bitsPerAxis = 1;
+    while ((m_maxCell >> bitsPerAxis) > 0)
+    {
+        bitsPerAxis++;
+    }
+    m_bucketBits = std::min(16, 3 * bitsPerAxis);
+    m_bucketShift = 3 * bitsPerAxis - m_bucketBits;
 }
 
-} // namespace lvr2
\ No newline at end of file
+} // namespace lvr2
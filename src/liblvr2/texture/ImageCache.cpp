@@ -0,0 +1,393 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/**
+ * ImageCache.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/texture/ImageCache.hpp"
+#include "lvr2/io/Timestamp.hpp"
+
+#include <opencv2/imgcodecs.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace lvr2
+{
+
+namespace
+{
+
+uint16_t read16(const unsigned char* p, bool bigEndian)
+{
+    return bigEndian ? (p[0] << 8) | p[1] : (p[1] << 8) | p[0];
+}
+
+uint32_t read32(const unsigned char* p, bool bigEndian)
+{
+    return bigEndian
+        ? (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3]
+        : (uint32_t(p[3]) << 24) | (uint32_t(p[2]) << 16) | (uint32_t(p[1]) << 8) | p[0];
+}
+
+/// Returns the orientation tag of an EXIF APP1 segment, 1 if there is none
+int exifOrientation(const std::vector<unsigned char>& segment)
+{
+    if (segment.size() < 14 || std::memcmp(segment.data(), "Exif\0\0", 6) != 0)
+    {
+        return 1;
+    }
+
+    // The EXIF data is a TIFF file
+    const unsigned char* tiff = segment.data() + 6;
+    size_t length = segment.size() - 6;
+    bool bigEndian = tiff[0] == 'M';
+
+    size_t ifd = read32(tiff + 4, bigEndian);
+    if (ifd + 2 > length)
+    {
+        return 1;
+    }
+
+    size_t numEntries = read16(tiff + ifd, bigEndian);
+    for (size_t i = 0; i < numEntries && ifd + 2 + 12 * (i + 1) <= length; i++)
+    {
+        const unsigned char* entry = tiff + ifd + 2 + 12 * i;
+        if (read16(entry, bigEndian) == 0x0112)
+        {
+            return read16(entry + 8, bigEndian);
+        }
+    }
+    return 1;
+}
+
+bool readJpegSize(std::istream& in, int& rows, int& cols)
+{
+    int orientation = 1;
+    unsigned char buf[2];
+
+    while (in.read(reinterpret_cast<char*>(buf), 2))
+    {
+        if (buf[0] != 0xFF)
+        {
+            return false;
+        }
+
+        // Markers may be preceded by any number of fill bytes
+        unsigned char marker = buf[1];
+        while (marker == 0xFF && in.read(reinterpret_cast<char*>(&marker), 1));
+
+        // Markers without a segment
+        if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7))
+        {
+            continue;
+        }
+
+        // End of image or start of scan before any frame header
+        if (marker == 0xD9 || marker == 0xDA || !in.read(reinterpret_cast<char*>(buf), 2))
+        {
+            return false;
+        }
+
+        size_t length = read16(buf, true);
+        if (length < 2)
+        {
+            return false;
+        }
+        length -= 2;
+
+        bool frameHeader = marker >= 0xC0 && marker <= 0xCF
+                           && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+
+        if (frameHeader || (marker == 0xE1 && orientation == 1))
+        {
+            std::vector<unsigned char> segment(length);
+            if (!in.read(reinterpret_cast<char*>(segment.data()), length))
+            {
+                return false;
+            }
+
+            if (!frameHeader)
+            {
+                orientation = exifOrientation(segment);
+                continue;
+            }
+
+            if (length < 5)
+            {
+                return false;
+            }
+            rows = read16(&segment[1], true);
+            cols = read16(&segment[3], true);
+
+            // cv::imread rotates images with these orientations by 90 degrees
+            if (orientation >= 5 && orientation <= 8)
+            {
+                std::swap(rows, cols);
+            }
+            return rows > 0 && cols > 0;
+        }
+
+        in.seekg(length, std::ios::cur);
+    }
+    return false;
+}
+
+bool readPnmSize(std::istream& in, int& rows, int& cols)
+{
+    // Width and height follow the magic number, separated by whitespace
+    // and comments
+    int values[2];
+    for (int i = 0; i < 2; i++)
+    {
+        int c = in.get();
+        while (std::isspace(c) || c == '#')
+        {
+            if (c == '#')
+            {
+                while (c != '\n' && c != EOF)
+                {
+                    c = in.get();
+                }
+            }
+            c = in.get();
+        }
+        in.unget();
+
+        if (!(in >> values[i]))
+        {
+            return false;
+        }
+    }
+    cols = values[0];
+    rows = values[1];
+    return rows > 0 && cols > 0;
+}
+
+/**
+ * @brief Reads the size of an image from its file header
+ *
+ * @return false if the format is not supported or the header is broken
+ */
+bool readImageSize(const boost::filesystem::path& file, int& rows, int& cols)
+{
+    boost::filesystem::ifstream in(file, std::ios::binary);
+    unsigned char header[26];
+    if (!in.read(reinterpret_cast<char*>(header), 2))
+    {
+        return false;
+    }
+
+    if (header[0] == 0xFF && header[1] == 0xD8)
+    {
+        return readJpegSize(in, rows, cols);
+    }
+
+    if (header[0] == 'P' && header[1] >= '1' && header[1] <= '6')
+    {
+        return readPnmSize(in, rows, cols);
+    }
+
+    if (!in.read(reinterpret_cast<char*>(header + 2), sizeof(header) - 2))
+    {
+        return false;
+    }
+
+    // PNG: signature followed by the IHDR chunk
+    if (std::memcmp(header, "\x89PNG\r\n\x1a\n", 8) == 0 && std::memcmp(header + 12, "IHDR", 4) == 0)
+    {
+        cols = read32(header + 16, true);
+        rows = read32(header + 20, true);
+        return rows > 0 && cols > 0;
+    }
+
+    // BMP: the file header is followed by the size of the info header.
+    // Negative heights mark images stored top down.
+    if (header[0] == 'B' && header[1] == 'M')
+    {
+        if (read32(header + 14, false) == 12)
+        {
+            cols = read16(header + 18, false);
+            rows = read16(header + 20, false);
+        }
+        else
+        {
+            cols = static_cast<int32_t>(read32(header + 18, false));
+            rows = std::abs(static_cast<int32_t>(read32(header + 22, false)));
+        }
+        return rows > 0 && cols > 0;
+    }
+
+    return false;
+}
+
+} // anonymous namespace
+
+ImageCache::ImageCache(size_t memoryLimit)
+    : m_memoryLimit(memoryLimit), m_memoryUsage(0), m_numLoads(0)
+{
+}
+
+void ImageCache::setMemoryLimit(size_t memoryLimit)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_memoryLimit = memoryLimit;
+    shrink();
+}
+
+size_t ImageCache::getMemoryLimit() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryLimit;
+}
+
+size_t ImageCache::addFile(const boost::filesystem::path& file)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files.push_back(file);
+    m_images.emplace_back();
+    m_headerSizes.emplace_back(0, 0);
+    m_lruPos.push_back(m_lru.end());
+    return m_files.size() - 1;
+}
+
+cv::Mat ImageCache::get(size_t id)
+{
+    boost::filesystem::path file;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_images[id].empty())
+        {
+            // Mark as most recently used
+            m_lru.splice(m_lru.begin(), m_lru, m_lruPos[id]);
+            return m_images[id];
+        }
+        file = m_files[id];
+    }
+
+    // Decode without holding the lock
+    cv::Mat image = cv::imread(file.string(), CV_LOAD_IMAGE_COLOR);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_numLoads++;
+    if (image.empty())
+    {
+        return image;
+    }
+
+    // A size read from the header which doesn't match the decoded image
+    // points to a bug in the header parsers
+    const auto& headerSize = m_headerSizes[id];
+    if (headerSize.first > 0 && (headerSize.first != image.rows || headerSize.second != image.cols))
+    {
+        std::cout << timestamp << "ImageCache: Size " << headerSize.second << "x" << headerSize.first
+                  << " in the header of " << file << " doesn't match the decoded size "
+                  << image.cols << "x" << image.rows << std::endl;
+    }
+
+    if (!m_images[id].empty())
+    {
+        // Another thread was faster
+        m_lru.splice(m_lru.begin(), m_lru, m_lruPos[id]);
+        return m_images[id];
+    }
+
+    insert(id, image);
+    return image;
+}
+
+bool ImageCache::imageSize(size_t id, int& rows, int& cols)
+{
+    boost::filesystem::path file;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        file = m_files[id];
+    }
+
+    if (readImageSize(file, rows, cols))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_headerSizes[id] = std::make_pair(rows, cols);
+        return true;
+    }
+
+    // Unknown format: decode it, the image stays in the cache
+    cv::Mat image = get(id);
+    rows = image.rows;
+    cols = image.cols;
+    return !image.empty();
+}
+
+size_t ImageCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_files.size();
+}
+
+size_t ImageCache::memoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryUsage;
+}
+
+size_t ImageCache::numLoads() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_numLoads;
+}
+
+void ImageCache::insert(size_t id, const cv::Mat& image)
+{
+    m_images[id] = image;
+    m_lru.push_front(id);
+    m_lruPos[id] = m_lru.begin();
+    m_memoryUsage += image.total() * image.elemSize();
+    shrink();
+}
+
+void ImageCache::shrink()
+{
+    // Always keep the most recently used image, even if it exceeds the limit
+    while (m_memoryLimit > 0 && m_memoryUsage > m_memoryLimit && m_lru.size() > 1)
+    {
+        size_t id = m_lru.back();
+        m_lru.pop_back();
+        m_lruPos[id] = m_lru.end();
+        m_memoryUsage -= m_images[id].total() * m_images[id].elemSize();
+        m_images[id] = cv::Mat();
+    }
+}
+
+} // namespace lvr2
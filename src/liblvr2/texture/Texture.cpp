@@ -95,7 +95,7 @@ Texture::Texture(
     }
 }
 
-Texture::Texture(Texture &&other) {
+Texture::Texture(Texture &&other) noexcept {
     this->m_index = other.m_index;
     this->m_width = other.m_width;
     this->m_height = other.m_height;
@@ -152,6 +152,32 @@ Texture & Texture::operator=(const Texture &other)
     return *this;
 }
 
+Texture & Texture::operator=(Texture &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (m_data)
+        {
+            delete[] m_data;
+        }
+        this->m_index = other.m_index;
+        this->m_width = other.m_width;
+        this->m_height = other.m_height;
+        this->m_data = other.m_data;
+        this->m_numChannels = other.m_numChannels;
+        this->m_numBytesPerChan = other.m_numBytesPerChan;
+        this->m_texelSize = other.m_texelSize;
+
+        other.m_data = nullptr;
+        other.m_width = 0;
+        other.m_height = 0;
+        other.m_numChannels = 0;
+        other.m_numBytesPerChan = 0;
+    }
+
+    return *this;
+}
+
 
 Texture::Texture(
     int index,
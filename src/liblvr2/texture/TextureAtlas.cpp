@@ -0,0 +1,385 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * TextureAtlas.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/texture/TextureAtlas.hpp"
+
+#include "lvr2/io/Timestamp.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+using std::cout;
+using std::endl;
+
+namespace lvr2
+{
+
+TextureAtlas::TextureAtlas(unsigned short pageSize, unsigned short padding)
+    : m_pageSize(pageSize),
+      m_padding(padding),
+      m_memoryLimit(0)
+{
+}
+
+void TextureAtlas::setMemoryLimit(size_t bytes)
+{
+    m_memoryLimit = bytes;
+}
+
+std::vector<TextureAtlas::Placement> TextureAtlas::pack(
+    const std::vector<Texture>& textures,
+    std::vector<size_t>& pageWidth,
+    std::vector<size_t>& pageHeight) const
+{
+    std::vector<Placement> placements(textures.size());
+
+    // Place the highest textures first, so that each shelf is filled
+    // with textures of similar height
+    std::vector<size_t> order(textures.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+    {
+        if (textures[a].m_height != textures[b].m_height)
+        {
+            return textures[a].m_height > textures[b].m_height;
+        }
+        return textures[a].m_width > textures[b].m_width;
+    });
+
+    // Open shelves of the current page: y position, height and used width
+    struct Shelf
+    {
+        size_t y, height, width;
+    };
+    std::vector<Shelf> shelves;
+    size_t currentPage = 0;
+    bool pageOpen = false;
+
+    for (size_t i : order)
+    {
+        size_t w = textures[i].m_width + 2 * m_padding;
+        size_t h = textures[i].m_height + 2 * m_padding;
+
+        // Oversized textures get a page of their own
+        if (w > m_pageSize || h > m_pageSize)
+        {
+            placements[i] = {pageWidth.size(), 0, 0};
+            pageWidth.push_back(w);
+            pageHeight.push_back(h);
+            continue;
+        }
+
+        if (!pageOpen)
+        {
+            currentPage = pageWidth.size();
+            pageWidth.push_back(0);
+            pageHeight.push_back(0);
+            shelves.clear();
+            pageOpen = true;
+        }
+
+        // First fit into an existing shelf of the current page
+        auto shelf = std::find_if(shelves.begin(), shelves.end(), [&](const Shelf& s)
+        {
+            return s.height >= h && s.width + w <= m_pageSize;
+        });
+
+        if (shelf == shelves.end())
+        {
+            size_t y = shelves.empty() ? 0 : shelves.back().y + shelves.back().height;
+            if (y + h > m_pageSize)
+            {
+                // Page is full, start a new one
+                currentPage = pageWidth.size();
+                pageWidth.push_back(0);
+                pageHeight.push_back(0);
+                shelves.clear();
+                y = 0;
+            }
+            shelves.push_back({y, h, 0});
+            shelf = shelves.end() - 1;
+        }
+
+        placements[i] = {currentPage, shelf->width, shelf->y};
+        shelf->width += w;
+
+        pageWidth[currentPage] = std::max(pageWidth[currentPage], shelf->width);
+        pageHeight[currentPage] = std::max(pageHeight[currentPage], shelf->y + shelf->height);
+    }
+
+    return placements;
+}
+
+size_t TextureAtlas::apply(MeshBuffer& buffer) const
+{
+    std::vector<Texture>& textures = buffer.getTextures();
+    std::vector<Material>& materials = buffer.getMaterials();
+    floatArr texCoords = buffer.getTextureCoordinates();
+    indexArray faceMaterials = buffer.getFaceMaterialIndices();
+
+    if (textures.empty() || !texCoords || !faceMaterials)
+    {
+        return 0;
+    }
+
+    const unsigned char numChannels = textures.front().m_numChannels;
+    const unsigned char numBytesPerChan = textures.front().m_numBytesPerChan;
+    for (const Texture& tex : textures)
+    {
+        if (tex.m_numChannels != numChannels || tex.m_numBytesPerChan != numBytesPerChan)
+        {
+            cout << timestamp << "TextureAtlas: Textures have different pixel formats. "
+                 << "Skipping atlas generation." << endl;
+            return 0;
+        }
+
+        // Pages store their size as unsigned short. An oversized texture
+        // gets a page of its own, which has to hold the padding as well.
+        const long maxSize = long(std::numeric_limits<unsigned short>::max()) - 2 * long(m_padding);
+        if (tex.m_width > maxSize || tex.m_height > maxSize)
+        {
+            cout << timestamp << "TextureAtlas: Texture " << tex.m_index << " is too large for a "
+                 << "padding of " << m_padding << " texels. Skipping atlas generation." << endl;
+            return 0;
+        }
+    }
+    const size_t texelBytes = numChannels * numBytesPerChan;
+
+    // Materials reference textures by handle, which is the index of the
+    // texture that was assigned by the texturizer
+    std::unordered_map<int, size_t> textureByIndex;
+    for (size_t i = 0; i < textures.size(); i++)
+    {
+        textureByIndex[textures[i].m_index] = i;
+    }
+
+    auto textureOfMaterial = [&](unsigned int materialIndex) -> long
+    {
+        if (materialIndex >= materials.size() || !materials[materialIndex].m_texture)
+        {
+            return -1;
+        }
+        size_t idx = materials[materialIndex].m_texture->idx();
+        auto it = textureByIndex.find(idx);
+        if (it != textureByIndex.end())
+        {
+            return it->second;
+        }
+        return idx < textures.size() ? idx : -1;
+    };
+
+    std::vector<size_t> pageWidth;
+    std::vector<size_t> pageHeight;
+    std::vector<Placement> placements = pack(textures, pageWidth, pageHeight);
+    const size_t numPages = pageWidth.size();
+
+    cout << timestamp << "Packing " << textures.size() << " textures into "
+         << numPages << " atlas pages" << endl;
+
+    // Rewrite texture coordinates. Each vertex is moved once according to
+    // the texture of the first face that references it.
+    const size_t numVertices = buffer.numVertices();
+    const size_t numFaces = buffer.numFaces();
+    indexArray faces = buffer.getFaceIndices();
+
+    std::vector<long> vertexTexture(numVertices, -1);
+    for (size_t f = 0; f < numFaces; f++)
+    {
+        long tex = textureOfMaterial(faceMaterials[f]);
+        if (tex < 0)
+        {
+            continue;
+        }
+        for (size_t j = 0; j < 3; j++)
+        {
+            unsigned int v = faces[3 * f + j];
+            if (vertexTexture[v] < 0)
+            {
+                vertexTexture[v] = tex;
+            }
+        }
+    }
+
+    #pragma omp parallel for
+    for (size_t v = 0; v < numVertices; v++)
+    {
+        if (vertexTexture[v] < 0)
+        {
+            continue;
+        }
+
+        const Texture& tex = textures[vertexTexture[v]];
+        const Placement& p = placements[vertexTexture[v]];
+
+        // Texture coordinates measure v from the last row of the image
+        float col = p.x + m_padding + texCoords[2 * v] * tex.m_width;
+        float row = p.y + m_padding + (1.0f - texCoords[2 * v + 1]) * tex.m_height;
+
+        texCoords[2 * v] = col / pageWidth[p.page];
+        texCoords[2 * v + 1] = 1.0f - row / pageHeight[p.page];
+    }
+
+    // Textures of each page
+    std::vector<std::vector<size_t>> pageTextures(numPages);
+    for (size_t i = 0; i < textures.size(); i++)
+    {
+        pageTextures[placements[i].page].push_back(i);
+    }
+
+    // Compose pages in batches that fit into the memory limit
+    size_t batchSize = numPages;
+    if (m_memoryLimit > 0)
+    {
+        size_t pageBytes = static_cast<size_t>(m_pageSize) * m_pageSize * texelBytes;
+        batchSize = std::max<size_t>(1, m_memoryLimit / pageBytes);
+    }
+
+    std::vector<Texture> pages(numPages);
+    for (size_t first = 0; first < numPages; first += batchSize)
+    {
+        size_t last = std::min(first + batchSize, numPages);
+
+        #pragma omp parallel for schedule(dynamic)
+        for (size_t page = first; page < last; page++)
+        {
+            assert(pageWidth[page] <= std::numeric_limits<unsigned short>::max()
+                   && pageHeight[page] <= std::numeric_limits<unsigned short>::max());
+            Texture atlas(page, pageWidth[page], pageHeight[page], numChannels, numBytesPerChan, 1.0);
+            std::memset(atlas.m_data, 0, pageWidth[page] * pageHeight[page] * texelBytes);
+
+            const size_t atlasStride = pageWidth[page] * texelBytes;
+
+            for (size_t i : pageTextures[page])
+            {
+                const Texture& tex = textures[i];
+                const Placement& p = placements[i];
+                const size_t texStride = tex.m_width * texelBytes;
+
+                if (tex.m_width == 0 || tex.m_height == 0)
+                {
+                    continue;
+                }
+
+                // Copy the texture including its padding, which replicates
+                // the border texels
+                for (size_t y = 0; y < tex.m_height + 2u * m_padding; y++)
+                {
+                    long srcRow = std::min<long>(std::max<long>(long(y) - m_padding, 0), tex.m_height - 1);
+                    const unsigned char* src = tex.m_data + srcRow * texStride;
+                    unsigned char* dst = atlas.m_data + (p.y + y) * atlasStride + p.x * texelBytes;
+
+                    for (size_t x = 0; x < m_padding; x++)
+                    {
+                        std::memcpy(dst + x * texelBytes, src, texelBytes);
+                        std::memcpy(dst + (m_padding + tex.m_width + x) * texelBytes,
+                                    src + (tex.m_width - 1) * texelBytes, texelBytes);
+                    }
+                    std::memcpy(dst + m_padding * texelBytes, src, texStride);
+                }
+            }
+
+            // Release the source textures of this page
+            for (size_t i : pageTextures[page])
+            {
+                textures[i] = Texture();
+            }
+
+            pages[page] = std::move(atlas);
+        }
+    }
+
+    // One material per page. Color materials are kept in front.
+    std::vector<Material> newMaterials;
+    std::vector<unsigned int> materialMap(materials.size());
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        if (!materials[i].m_texture)
+        {
+            materialMap[i] = newMaterials.size();
+            newMaterials.push_back(materials[i]);
+        }
+    }
+
+    const unsigned int firstPageMaterial = newMaterials.size();
+    for (size_t page = 0; page < numPages; page++)
+    {
+        Material m;
+        m.m_texture = TextureHandle(page);
+        std::array<unsigned char, 3> white = {255, 255, 255};
+        m.m_color = std::move(white);
+        newMaterials.push_back(m);
+    }
+
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        long tex = textureOfMaterial(i);
+        if (tex >= 0)
+        {
+            materialMap[i] = firstPageMaterial + placements[tex].page;
+        }
+    }
+
+    for (size_t f = 0; f < numFaces; f++)
+    {
+        if (faceMaterials[f] < materialMap.size())
+        {
+            faceMaterials[f] = materialMap[faceMaterials[f]];
+        }
+    }
+
+    IndexChannelOptional clusterMaterials = buffer.getIndexChannel("cluster_material_indices");
+    if (clusterMaterials)
+    {
+        unsigned int* indices = clusterMaterials->dataPtr().get();
+        for (size_t i = 0; i < clusterMaterials->numElements(); i++)
+        {
+            if (indices[i] < materialMap.size())
+            {
+                indices[i] = materialMap[indices[i]];
+            }
+        }
+    }
+
+    materials = std::move(newMaterials);
+    textures = std::move(pages);
+
+    return numPages;
+}
+
+} // namespace lvr2
@@ -0,0 +1,211 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * BufferPool.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "lvr2/types/BufferPool.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include <sys/mman.h>
+
+namespace lvr2 {
+
+std::ostream& operator<<(std::ostream& os, const BufferPoolStats& stats)
+{
+    const double mb = 1024.0 * 1024.0;
+    os << "allocations: " << stats.allocations
+       << ", pool hits: " << stats.poolHits
+       << ", system allocations: " << stats.systemAllocations
+       << ", huge page blocks: " << stats.hugePageAllocations
+       << ", live: " << stats.liveBytes / mb << " MB"
+       << ", peak: " << stats.peakBytes / mb << " MB"
+       << ", pooled: " << stats.pooledBytes / mb << " MB";
+    return os;
+}
+
+BufferPool::BufferPool(size_t maxPooledBytes, bool hugePages)
+    : m_maxPooledBytes(maxPooledBytes), m_hugePages(hugePages)
+{
+}
+
+BufferPool::~BufferPool()
+{
+    trim();
+}
+
+BufferPool& BufferPool::instance()
+{
+    // Never destroyed, channels may be released during static destruction
+    static BufferPool* pool = new BufferPool();
+    return *pool;
+}
+
+size_t BufferPool::sizeClass(size_t bytes)
+{
+    bytes = std::max<size_t>(bytes, 1);
+    if (bytes < MinPooledSize)
+    {
+        return (bytes + Alignment - 1) / Alignment * Alignment;
+    }
+
+    // Four classes per power of two, i.e., at most 25% overhead
+    size_t p = MinPooledSize;
+    while (p * 2 <= bytes)
+    {
+        p *= 2;
+    }
+    size_t step = p / 4;
+    return (bytes + step - 1) / step * step;
+}
+
+void* BufferPool::allocateBlock(size_t bytes)
+{
+    // The system allocation itself runs without the lock
+    bool huge;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        huge = m_hugePages && bytes >= HugePageSize;
+    }
+
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, huge ? HugePageSize : Alignment, bytes) != 0)
+    {
+        throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge)
+    {
+        madvise(ptr, bytes, MADV_HUGEPAGE);
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.systemAllocations++;
+    if (huge)
+    {
+        m_stats.hugePageAllocations++;
+    }
+    return ptr;
+}
+
+void* BufferPool::allocate(size_t bytes)
+{
+    size_t size = sizeClass(bytes);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.allocations++;
+        m_stats.liveBytes += size;
+        m_stats.peakBytes = std::max(m_stats.peakBytes, m_stats.liveBytes);
+
+        if (size >= MinPooledSize)
+        {
+            auto it = m_freeBlocks.find(size);
+            if (it != m_freeBlocks.end() && !it->second.empty())
+            {
+                void* ptr = it->second.back();
+                it->second.pop_back();
+                m_stats.poolHits++;
+                m_stats.pooledBytes -= size;
+                return ptr;
+            }
+        }
+    }
+    return allocateBlock(size);
+}
+
+void BufferPool::deallocate(void* ptr, size_t bytes)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    size_t size = sizeClass(bytes);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.liveBytes -= size;
+        if (size >= MinPooledSize && m_stats.pooledBytes + size <= m_maxPooledBytes)
+        {
+            m_freeBlocks[size].push_back(ptr);
+            m_stats.pooledBytes += size;
+            return;
+        }
+    }
+    free(ptr);
+}
+
+void BufferPool::setMaxPooledBytes(size_t bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maxPooledBytes = bytes;
+        if (m_stats.pooledBytes <= bytes)
+        {
+            return;
+        }
+    }
+    trim();
+}
+
+void BufferPool::setHugePages(bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hugePages = enable;
+}
+
+void BufferPool::trim()
+{
+    std::unordered_map<size_t, std::vector<void*> > blocks;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        blocks.swap(m_freeBlocks);
+        m_stats.pooledBytes = 0;
+    }
+    for (auto& sizeBlocks : blocks)
+    {
+        for (void* ptr : sizeBlocks.second)
+        {
+            free(ptr);
+        }
+    }
+}
+
+BufferPoolStats BufferPool::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace lvr2
@@ -84,6 +84,8 @@ namespace gs_reconstruction{
 
         int getNumBalances() const;
 
+        int getBatchSize() const;
+
         string getInputFileName() const;
 
         /*
@@ -115,6 +117,7 @@ namespace gs_reconstruction{
         int m_deleteLongEdgesFactor;
         bool m_interior;
         int m_balances;
+        int m_batchSize;
         /// The number of neighbors for distance function evaluation
         int                             m_kd;
 
@@ -149,6 +152,7 @@ namespace gs_reconstruction{
         cout << "##### DeleteLongEdgesFactor: " <<  o.getDeleteLongEdgesFactor() << endl;
         cout << "##### Interior: " <<  o.isInterior() << endl;
         cout << "##### Balances: " <<  o.getNumBalances() << endl;
+        cout << "##### BatchSize: " <<  o.getBatchSize() << endl;
         cout << "##### PCM: " <<  o.getPcm() << endl;
         cout << "##### KD: " <<  o.getKd() << endl;
         cout << "##### KI: " <<  o.getKi() << endl;
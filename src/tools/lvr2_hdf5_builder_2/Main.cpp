@@ -18,6 +18,9 @@
 #include <boost/spirit/include/phoenix_operator.hpp>
 #include <boost/spirit/include/qi.hpp>
 #include <boost/spirit/include/qi_lit.hpp>
+#include <ctpl.h>
+#include <deque>
+#include <future>
 #include <iterator>
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
@@ -37,6 +40,15 @@ using HDF5IO = lvr2::Hdf5IO<lvr2::hdf5features::ArrayIO,
 bool m_usePreviews;
 int m_previewReductionFactor;
 
+/// Number of images that are decoded ahead of the HDF5 writer per decoding thread
+const size_t IMAGES_AHEAD_PER_THREAD = 2;
+
+/// Number of scan positions whose point clouds are loaded ahead of the HDF5 writer
+const size_t SCANS_AHEAD = 2;
+
+/// Maximum size of an HDF5 chunk of an image stack
+const size_t IMAGE_CHUNK_BYTES = 1 << 20;
+
 bool parse_scan_filename(std::string path, int& i)
 {
     // check whether the foldername ends with at least one number
@@ -162,7 +174,7 @@ boost::shared_array<T> reduceData(boost::shared_array<T> data,
     return reducedData;
 }
 
-bool saveScan(int nr, ScanPtr scan, HDF5IO hdf5)
+bool saveScan(int nr, ScanPtr scan, HDF5IO& hdf5)
 {
     // Check scan data
     if (scan->m_points->numPoints())
@@ -260,17 +272,102 @@ bool saveScan(int nr, ScanPtr scan, HDF5IO hdf5)
                 hdf5.save(previewGroupName, "spectral", previewDim, previewData);
             }
         }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Decodes the given grayscale images in parallel and writes them into the dataset
+ *        groupName/datasetName with the dimensions {images, rows, cols}.
+ *
+ * Every image is written with its own hyperslab as soon as it is decoded, so the stack never
+ * has to fit into memory. The chunks span whole rows of a single image to make reading single
+ * bands cheap. The HDF5 file is only accessed by the calling thread.
+ */
+bool writeImageStack(const std::vector<boost::filesystem::path>& images,
+                     const std::string& groupName,
+                     const std::string& datasetName,
+                     HDF5IO& hdf,
+                     ctpl::thread_pool& pool)
+{
+    if (images.empty())
+    {
+        return false;
+    }
+
+    auto decode = [](int id, boost::filesystem::path file)
+    {
+        return cv::imread(file.string(), CV_LOAD_IMAGE_GRAYSCALE);
+    };
+
+    size_t ahead = IMAGES_AHEAD_PER_THREAD * std::max(pool.size(), 1);
+    std::deque<std::future<cv::Mat>> pending;
+    size_t next = 0;
+    for (; next < std::min(ahead, images.size()); next++)
+    {
+        pending.push_back(pool.push(decode, images[next]));
+    }
+
+    // we assume that every frame has the same resolution as the first one
+    std::unique_ptr<HighFive::DataSet> dataset;
+    size_t rows = 0;
+    size_t cols = 0;
+
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        cv::Mat img = pending.front().get();
+        pending.pop_front();
+        if (next < images.size())
+        {
+            pending.push_back(pool.push(decode, images[next++]));
+        }
+
+        if (img.empty())
+        {
+            std::cout << timestamp << "Unable to read " << images[i] << std::endl;
+            return false;
+        }
+
+        if (!dataset)
+        {
+            rows = img.rows;
+            cols = img.cols;
+
+            std::vector<hsize_t> chunks = {
+                1, std::max<hsize_t>(1, std::min<hsize_t>(rows, IMAGE_CHUNK_BYTES / cols)), cols};
+            HighFive::DataSetCreateProps properties;
+            properties.add(HighFive::Chunking(chunks));
+
+            HighFive::Group g = hdf5util::getGroup(hdf.m_hdf5_file, groupName);
+            dataset = hdf5util::createDataset<unsigned char>(
+                g, datasetName, HighFive::DataSpace({images.size(), rows, cols}), properties);
+        }
+        else if (img.rows != rows || img.cols != cols)
+        {
+            std::cout << timestamp << "Image " << images[i] << " has a different resolution ("
+                      << img.cols << "x" << img.rows << " instead of " << cols << "x" << rows
+                      << ")" << std::endl;
+            return false;
+        }
+
+        if (!img.isContinuous())
+        {
+            img = img.clone();
+        }
+        dataset->select({i, 0, 0}, {1, rows, cols}).write<unsigned char>(img.data);
     }
+
+    hdf.m_hdf5_file->flush();
+    return true;
 }
 
-bool channelIO(const boost::filesystem::path& p, int number, HDF5IO& hdf)
+bool channelIO(const boost::filesystem::path& p, int number, HDF5IO& hdf, ctpl::thread_pool& pool)
 {
     std::cout << timestamp << "Start processing channels" << std::endl;
     std::vector<boost::filesystem::path> spectral;
     char group[256];
     sprintf(group, "/raw/spectral/position_%05d", number);
-    // floatArr angles;
-    // std::cout << p << std::endl;
 
     // count files and get all png pathes.
     for (boost::filesystem::directory_iterator it(p); it != boost::filesystem::directory_iterator();
@@ -286,31 +383,12 @@ bool channelIO(const boost::filesystem::path& p, int number, HDF5IO& hdf)
     }
 
     std::sort(spectral.begin(), spectral.end(), sortPanoramas);
-    // std::cout << "sorted " << std::endl;
-
-    // we assume that every frame has the same resolution
-    // TODO change dimensions when writing
-    cv::Mat img = cv::imread(spectral[0].string(), CV_LOAD_IMAGE_GRAYSCALE);
-    ucharArr data(new unsigned char[spectral.size() * img.cols * img.rows]);
-    std::memcpy(
-        data.get() + (img.rows * img.cols), img.data, img.rows * img.cols * sizeof(unsigned char));
-
-    std::vector<size_t> dim = {
-        spectral.size(), static_cast<size_t>(img.rows), static_cast<size_t>(img.cols)};
 
-    for (size_t i = 1; i < spectral.size(); ++i)
+    if (!writeImageStack(spectral, group, "channels", hdf, pool))
     {
-
-        cv::Mat img = cv::imread(spectral[i].string(), CV_LOAD_IMAGE_GRAYSCALE);
-        std::memcpy(data.get() + i * (img.rows * img.cols),
-                    img.data,
-                    img.rows * img.cols * sizeof(unsigned char));
+        return false;
     }
 
-    std::vector<hsize_t> chunks = {50, 50, 50};
-    hdf.save(group, "channels", dim, chunks, data);
-    // std::cout << "wrote channels" << std::endl;
-
     // TODO write aperture. 47.5 deg oder so
     // TODO panorama?
 
@@ -442,7 +520,7 @@ void readScanMetaData(const boost::filesystem::path& fn, ScanPtr& scan_ptr)
     return;
 }
 
-bool spectralIO(const boost::filesystem::path& p, int number, HDF5IO& hdf)
+bool spectralIO(const boost::filesystem::path& p, int number, HDF5IO& hdf, ctpl::thread_pool& pool)
 {
     std::cout << timestamp << "Start processing frames" << std::endl;
     std::vector<boost::filesystem::path> spectral;
@@ -487,29 +565,11 @@ bool spectralIO(const boost::filesystem::path& p, int number, HDF5IO& hdf)
 
     std::sort(spectral.begin(), spectral.end(), sortPanoramas);
 
-    // we assume that every frame has the same resolution
-    // TODO change dimensions when writing
-    cv::Mat img = cv::imread(spectral[0].string(), CV_LOAD_IMAGE_GRAYSCALE);
-    ucharArr data(new unsigned char[spectral.size() * img.cols * img.rows]);
-    std::memcpy(
-        data.get() + (img.rows * img.cols), img.data, img.rows * img.cols * sizeof(unsigned char));
-
-    std::vector<size_t> dim = {
-        spectral.size(), static_cast<size_t>(img.rows), static_cast<size_t>(img.cols)};
-
-    for (size_t i = 1; i < spectral.size(); ++i)
+    if (!writeImageStack(spectral, group, "frames", hdf, pool))
     {
-
-        cv::Mat img = cv::imread(spectral[i].string(), CV_LOAD_IMAGE_GRAYSCALE);
-        std::memcpy(data.get() + i * (img.rows * img.cols),
-                    img.data,
-                    img.rows * img.cols * sizeof(unsigned char));
+        return false;
     }
 
-    std::vector<hsize_t> chunks = {50, 50, 50};
-
-    hdf.save(group, "frames", dim, chunks, data);
-
     if (size)
     {
         hdf.save(group, "timestamps", timestamps);
@@ -524,13 +584,15 @@ bool spectralIO(const boost::filesystem::path& p, int number, HDF5IO& hdf)
     return true;
 }
 
-bool scanIO(const boost::filesystem::path& p,
-            int number,
-            const boost::filesystem::path& yaml,
-            HDF5IO& hdf5)
+ScanPtr loadScan(const boost::filesystem::path& p, const boost::filesystem::path& yaml)
 {
     std::cout << timestamp << "Load scan " << p.string() << std::endl;
     ModelPtr model = ModelFactory::readModel(p.string());
+    if (!model || !model->m_pointCloud)
+    {
+        std::cout << timestamp << "Unable to load " << p.string() << std::endl;
+        return nullptr;
+    }
     std::cout << timestamp << "Loaded " << model->m_pointCloud->numPoints() << " points"
               << std::endl;
     ScanPtr scan_ptr(new Scan());
@@ -554,12 +616,21 @@ bool scanIO(const boost::filesystem::path& p,
         std::cout << timestamp << "No scan config found" << std::endl;
     }
 
-    saveScan(number, scan_ptr, hdf5);
-
-    // needed?
-    return true;
+    return scan_ptr;
 }
 
+/**
+ * @brief The raw data of one scan position
+ */
+struct ScanPosition
+{
+    boost::filesystem::path dir;
+    int number;
+    boost::filesystem::path ply;
+    std::vector<boost::filesystem::path> spectral;
+    std::vector<boost::filesystem::path> channels;
+};
+
 int main(int argc, char** argv)
 {
     hdf5tool2::Options options(argc, argv);
@@ -617,12 +688,12 @@ int main(int argc, char** argv)
     }
 
     std::sort(scans.begin(), scans.end(), sortScans);
+
+    std::vector<ScanPosition> positions;
     int count = 0;
     for (auto p : scans)
     {
         std::cout << timestamp << "Reading path " << p << std::endl;
-        char buffer[64];
-        boost::filesystem::path ply;
         std::string fn = p.stem().string();
 
         // check if foldername matches [a-zA-z]*\d+
@@ -632,42 +703,83 @@ int main(int argc, char** argv)
             continue;
         }
 
-        std::cout << timestamp << "Processing scan " << count << std::endl;
-
-        bool ply_exists = false;
-        bool spectral_exists = false;
+        ScanPosition position;
+        position.dir = p;
+        position.number = count + fileCounterIncr;
         for (boost::filesystem::directory_iterator it(p);
              it != boost::filesystem::directory_iterator();
              ++it)
         {
             if (boost::filesystem::is_directory((*it).path()) && (*it).path().stem() == "spectral")
             {
-                spectral_exists = spectralIO(it->path(), count + fileCounterIncr, hdf);
+                position.spectral.push_back(it->path());
             }
 
             if (boost::filesystem::is_directory((*it).path()) && (*it).path().stem() == "channels")
             {
-                channelIO(it->path(), count + fileCounterIncr, hdf);
+                position.channels.push_back(it->path());
             }
 
             if ((*it).path().extension() == ".ply")
             {
-                ply = *it;
-                ply_exists = true;
+                position.ply = *it;
             }
         }
+        positions.push_back(position);
+    }
+
+    // Point clouds and images are loaded by the pool, only this thread writes to the HDF5 file.
+    // The point clouds of the next positions are loaded while the current one is written.
+    ctpl::thread_pool pool(options.getNumThreads());
+    std::deque<std::future<ScanPtr>> scanLoads;
+    auto loadPosition = [&positions](int id, size_t i)
+    {
+        if (positions[i].ply.empty())
+        {
+            return ScanPtr();
+        }
+        return loadScan(positions[i].ply, positions[i].dir / std::string("scan.yaml"));
+    };
+
+    size_t nextLoad = 0;
+    for (; nextLoad < std::min(SCANS_AHEAD, positions.size()); nextLoad++)
+    {
+        scanLoads.push_back(pool.push(loadPosition, nextLoad));
+    }
+
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        const ScanPosition& position = positions[i];
+        std::cout << timestamp << "Processing scan " << position.number << std::endl;
+
+        bool spectral_exists = false;
+        for (auto& dir : position.spectral)
+        {
+            spectral_exists = spectralIO(dir, position.number, hdf, pool);
+        }
+        for (auto& dir : position.channels)
+        {
+            channelIO(dir, position.number, hdf, pool);
+        }
+
+        ScanPtr scan = scanLoads.front().get();
+        scanLoads.pop_front();
+        if (nextLoad < positions.size())
+        {
+            scanLoads.push_back(pool.push(loadPosition, nextLoad++));
+        }
 
         if (!spectral_exists)
         {
-            std::cout << timestamp << "No spectral information in: " << p << std::endl;
+            std::cout << timestamp << "No spectral information in: " << position.dir << std::endl;
         }
-        if (!ply_exists)
+        if (position.ply.empty())
         {
             std::cout << timestamp << "No scan found" << std::endl;
         }
-        else
+        else if (scan)
         {
-            scanIO(ply, count + fileCounterIncr, p / std::string("scan.yaml"), hdf);
+            saveScan(position.number, scan, hdf);
             std::cout << timestamp << "Finished" << std::endl;
             std::cout << std::endl;
         }
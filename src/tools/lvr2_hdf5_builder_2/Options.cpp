@@ -34,6 +34,9 @@
 
 #include "Options.hpp"
 
+#include <algorithm>
+#include <thread>
+
 namespace hdf5tool2
 {
 
@@ -48,7 +51,8 @@ Options::Options(int argc, char** argv) : m_descr("Supported options")
             ("outputDir", value<string>()->default_value("./"), "HDF5 file is written here.")
             ("outputFile", value<string>()->default_value("data.h5"), "HDF5 file name.")
             ("createPreview,p", value<bool>()->default_value(true), "Creates preview of the pointcloud.")
-            ("previewReduction,r", value<int>()->default_value(20), "Reduction ratio for the preview");
+            ("previewReduction,r", value<int>()->default_value(20), "Reduction ratio for the preview")
+            ("threads,t", value<int>()->default_value(std::max(1u, std::thread::hardware_concurrency())), "Number of threads for loading scans and decoding images");
 //            ("nch, n", value<int>()->default_value(150), "Number of spectral PNGs in image folder.")
 //            ("hsp_chunk_0", value<size_t>()->default_value(50), "Dim 0 of HSP image chunks.")
 //            ("hsp_chunk_1", value<size_t>()->default_value(50), "Dim 1 of HSP image chunks.")
@@ -73,6 +77,13 @@ Options::Options(int argc, char** argv) : m_descr("Supported options")
     std::cout << m_descr << std::endl;
     exit(-1);
   }
+  else if (m_variables["threads"].as<int>() < 1)
+  {
+    std::cout << "Error: The number of threads has to be at least 1." << std::endl;
+    std::cout << std::endl;
+    std::cout << m_descr << std::endl;
+    exit(-1);
+  }
 
 }
 
@@ -70,6 +70,7 @@ class Options
     string getOutputFile() const { return m_variables["outputFile"].as<string>(); }
     bool getPreview() const { return m_variables["createPreview"].as<bool>(); }
     int getPreviewReductionRatio() const { return m_variables["previewReduction"].as<int>(); }
+    int getNumThreads() const { return m_variables["threads"].as<int>(); }
     //    int     numPanoramaImages() const { return m_variables["nch"].as<int>();}
     //
     //    size_t  getHSPChunk0() const { return m_variables["hsp_chunk_0"].as<size_t>(); }
@@ -3,14 +3,19 @@
  * @author ndettmer <ndettmer@uos.de>
  */
 
-#include "lvr2/io/HDF5IO.hpp"
-
 #include <boost/range/iterator_range.hpp>
 #include <boost/foreach.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <deque>
+#include <future>
 #include <string>
 #include <fstream>
+#include <vector>
+
+#include <ctpl.h>
+#include <highfive/H5File.hpp>
 
 #include <sys/stat.h>
 
@@ -20,8 +25,29 @@
 
 using namespace lvr2;
 
+/// Maximum size of a block of rows that is read from the HDF5 file at once
+const size_t BLOCK_BYTES = 64 << 20;
+
+/// Number of blocks that are read ahead while the current one is written
+const size_t READ_AHEAD = 3;
+
+/**
+ * @brief Consecutive rows of one channel of the spectral cube
+ */
+struct SpectralBlock
+{
+    size_t channel;
+    size_t first_row;
+    size_t num_rows;
+    std::vector<uint16_t> data;
+};
+
 /**
- * @brief Extraction of radiometric data from a given HDF5 file into a new GeoTIFF file in (optionally) given output path
+ * @brief Extraction of radiometric data from a given HDF5 file into a new GeoTIFF file in (optionally) given output path.
+ *
+ * The cube is streamed in blocks of rows of one channel, so it does not have to fit into memory.
+ * The blocks are read by a worker thread while the previous blocks are written to the GeoTIFF file.
+ *
  * @param input_filename Path to the input HDF5 file formatted due to lvr_2 convention
  * @param position_code 5 character code of the scan position (e.g. 00000)
  * @param output_filename Path to the output GeoTIFF file
@@ -33,15 +59,19 @@ int processConversion(std::string input_filename,
         std::string position_code, std::string output_filename, size_t min_channel, size_t max_channel)
 {
     /*------------------- HDF5 INPUT ------------------------*/
-    HDF5IO hdf5(input_filename, false);
-    std::vector<size_t> dim;
+    HighFive::File hdf5(input_filename, HighFive::File::ReadOnly);
 
     // extract radiometric data
-    std::string groupname = "raw/spectral/position_" + position_code;
-    std::string datasetname = "spectral";
-    boost::shared_array<uint16_t> spectrals = hdf5.getArray<uint16_t>(groupname, datasetname, dim);
+    std::string datasetname = "raw/spectral/position_" + position_code + "/spectral";
+    if (!hdf5.exist(datasetname))
+    {
+        std::cout << "The dataset " << datasetname << " does not exist." << std::endl;
+        return -1;
+    }
+    HighFive::DataSet spectrals = hdf5.getDataSet(datasetname);
 
     // extract array dimension information
+    std::vector<size_t> dim = spectrals.getSpace().getDimensions();
     size_t num_channels = dim[0];
     size_t num_rows = dim[1];
     size_t num_cols = dim[2];
@@ -52,31 +82,64 @@ int processConversion(std::string input_filename,
         std::cout << "The dataset has only " << num_channels << " channels. Using this as upper boundary." << std::endl;
         max_channel = num_channels;
     }
+    if (max_channel <= min_channel)
+    {
+        std::cout << "No channels in the range [" << min_channel << ", " << max_channel << ")." << std::endl;
+        return -1;
+    }
     num_channels = max_channel - min_channel;
 
     GeoTIFFIO gtifio(output_filename, num_cols, num_rows, num_channels);
 
     /*--------------- FILE CONVERSION --------------------*/
-    // for each channel create a cv::Mat containing the spectral intensity data for the channel ...
-    for(size_t channel = 0; channel < num_channels; channel++)
+    size_t rows_per_block = std::max<size_t>(1, std::min(num_rows, BLOCK_BYTES / (num_cols * sizeof(uint16_t))));
+    size_t blocks_per_channel = (num_rows + rows_per_block - 1) / rows_per_block;
+    size_t num_blocks = num_channels * blocks_per_channel;
+
+    // HDF5 is only accessed by the single worker, GDAL only by this thread
+    ctpl::thread_pool reader(1);
+    auto read_block = [&](int id, size_t block)
+    {
+        SpectralBlock b;
+        b.channel = block / blocks_per_channel;
+        b.first_row = (block % blocks_per_channel) * rows_per_block;
+        b.num_rows = std::min(rows_per_block, num_rows - b.first_row);
+        b.data.resize(b.num_rows * num_cols);
+        spectrals.select({b.channel + min_channel, b.first_row, 0}, {1, b.num_rows, num_cols})
+            .read<uint16_t>(b.data.data());
+        return b;
+    };
+
+    std::deque<std::future<SpectralBlock>> pending;
+    size_t next_block = 0;
+    for (; next_block < std::min(READ_AHEAD, num_blocks); next_block++)
+    {
+        pending.push_back(reader.push(read_block, next_block));
+    }
+
+    while (!pending.empty())
     {
-        cv::Mat *mat = new cv::Mat(num_rows, num_cols, CV_16UC1);
-        for(size_t row = 0; row < num_rows; row++)
+        SpectralBlock b = pending.front().get();
+        pending.pop_front();
+        if (next_block < num_blocks)
         {
-            for(size_t col = 0; col < num_cols; col++)
-            {
-                mat->at<uint16_t>(row, col) = spectrals.get()[(channel + min_channel) * num_cols * num_rows + row * num_cols + col];
-            }
+            pending.push_back(reader.push(read_block, next_block++));
         }
+
         // ... and write it to the output GeoTIFF file
-        int ret = gtifio.writeBand(mat, channel + 1);
-        delete mat;
+        int ret = gtifio.writeBlock(b.data.data(), b.channel + 1, b.first_row, b.num_rows);
         if (ret != 0)
         {
+            // Let the worker finish before the dataset goes out of scope
+            for (auto& f : pending)
+            {
+                f.wait();
+            }
             return ret;
         }
     }
 
+    return 0;
 }
 
 int main(int argc, char**argv)
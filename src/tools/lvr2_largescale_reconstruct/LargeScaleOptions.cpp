@@ -52,7 +52,7 @@ Options::Options(int argc, char** argv) : BaseOption(argc, argv)
     m_descr.add_options()("help", "Produce help message")(
         "inputFile",
         value<vector<string>>(),
-        "Input file name. Supported formats are ASCII (.pts, .xyz) and .ply")(
+        "Input file name. Supported formats are ASCII (.pts, .xyz), .ply and .las/.laz")(
         "partialReconstruct",
         value<string>(&m_partialReconstruct)->default_value("NONE"),
         "Option to add partial-Mesh to a global-Mesh (make sure that the inputFile is the global "
@@ -197,6 +197,10 @@ Options::Options(int argc, char** argv) : BaseOption(argc, argv)
         "lineReaderBuffer",
         value<size_t>(&m_lineReaderBuffer)->default_value(1024),
         "Size of input stream buffer when parsing point cloud files")(
+        "poolSize",
+        value<size_t>(&m_poolSize)->default_value(512),
+        "Maximum size in MB of freed buffers that are kept for reuse by later partitions")(
+        "hugePages", "Back large buffers with transparent huge pages")(
         "interpolateBoxes", "Interpolate Boxes in intersection BoundingBox of two Grids")(
         "useNormals",
         "the ply file contains normals")("scale",
@@ -212,6 +216,10 @@ Options::Options(int argc, char** argv) : BaseOption(argc, argv)
 
 size_t Options::getLineReaderBuffer() const { return m_variables["lineReaderBuffer"].as<size_t>(); }
 
+size_t Options::getPoolSize() const { return m_variables["poolSize"].as<size_t>(); }
+
+bool Options::useHugePages() const { return m_variables.count("hugePages"); }
+
 float Options::getScaling() const { return m_variables["scale"].as<float>(); }
 unsigned int Options::getNodeSize() const { return m_variables["nodeSize"].as<unsigned int>(); }
 unsigned int Options::getBufferSize() const { return m_variables["buff"].as<unsigned int>(); }
@@ -335,6 +335,10 @@ class Options : public lvr2::BaseOption
 
     size_t getLineReaderBuffer() const;
 
+    size_t getPoolSize() const;
+
+    bool useHugePages() const;
+
     int getVGrid() const;
 
     int getGridSize() const;
@@ -476,6 +480,8 @@ class Options : public lvr2::BaseOption
 
     size_t m_lineReaderBuffer;
 
+    size_t m_poolSize;
+
     bool m_onlyNormals;
 
     string m_partialReconstruct;
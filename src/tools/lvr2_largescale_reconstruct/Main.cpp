@@ -42,6 +42,7 @@
 #include "lvr2/reconstruction/BigVolumen.hpp"
 #include "lvr2/reconstruction/QueryPoint.hpp"
 #include "lvr2/reconstruction/VirtualGrid.hpp"
+#include "lvr2/types/BufferPool.hpp"
 
 #include <algorithm>
 #include <boost/algorithm/string/replace.hpp>
@@ -90,6 +91,13 @@ typedef CudaSurface GpuSurface;
 #include <lvr2/reconstruction/opencl/ClSurface.hpp>
 
 typedef ClSurface GpuSurface;
+#else
+// Same LBKdTree based normal estimation on the CPU
+#define GPU_FOUND
+
+#include <lvr2/reconstruction/CpuSurface.hpp>
+
+typedef CpuSurface GpuSurface;
 #endif
 
 struct duplicateVertex
@@ -117,6 +125,9 @@ int mpiReconstruct(const LargeScaleOptions::Options& options)
     float voxelsize = options.getVoxelsize();
     float bgVoxelsize = options.getBGVoxelsize();
     float scale = options.getScaling();
+    BufferPool::instance().setMaxPooledBytes(options.getPoolSize() * 1024 * 1024);
+    BufferPool::instance().setHugePages(options.useHugePages());
+
     cout << lvr2::timestamp << "Starting grid" << endl;
     BigGrid<BaseVecT> bg(filePath, bgVoxelsize, scale);
     cout << lvr2::timestamp << "grid finished " << endl;
@@ -260,7 +271,29 @@ int mpiReconstruct(const LargeScaleOptions::Options& options)
                                                                  options.useRansac());
 
         if (!bg.hasNormals())
-            surface->calculateSurfaceNormals();
+        {
+            if (options.useGPU())
+            {
+                std::vector<float> flipPoint = options.getFlippoint();
+                floatArr normals = floatArr(new float[numPoints * 3]);
+                cout << timestamp << "Generate GPU kd-tree..." << endl;
+                GpuSurface gpu_surface(points, numPoints);
+
+                gpu_surface.setKn(options.getKn());
+                gpu_surface.setKi(options.getKi());
+                gpu_surface.setFlippoint(flipPoint[0], flipPoint[1], flipPoint[2]);
+
+                gpu_surface.calculateNormals();
+                gpu_surface.getNormals(normals);
+
+                p_loader->setNormalArray(normals, numPoints);
+                gpu_surface.freeGPU();
+            }
+            else
+            {
+                surface->calculateSurfaceNormals();
+            }
+        }
 
         auto ps_grid = std::make_shared<lvr2::PointsetGrid<Vec, lvr2::FastBox<Vec>>>(
             voxelsize, surface, gridbb, true, options.extrude());
@@ -294,6 +327,7 @@ int mpiReconstruct(const LargeScaleOptions::Options& options)
     }
     std::cout << "Skipped PartitionBoxes: " << partitionBoxesSkipped << std::endl;
     std::cout << "Generated Meshes: " << meshes.size() << std::endl;
+    std::cout << lvr2::timestamp << "Buffer pool: " << BufferPool::instance().stats() << std::endl;
     ofstream vGrid_ser;
     vGrid_ser.open("VGrid.ser", ofstream::out | ofstream::trunc);
     unordered_set<string>::iterator itr;
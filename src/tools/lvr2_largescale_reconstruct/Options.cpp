@@ -60,7 +60,7 @@ Options::Options(int argc, char** argv)
     // Create option descriptions
     m_descr.add_options()
         ("help", "Produce help message")
-        ("inputFile", value< vector<string> >(), "Input file name. Supported formats are ASCII (.pts, .xyz) and .ply")
+        ("inputFile", value< vector<string> >(), "Input file name. Supported formats are ASCII (.pts, .xyz), .ply and .las/.laz")
         ("outputFile", value< vector<string> >()->multitoken()->default_value(vector<string>{"triangle_mesh.ply", "triangle_mesh.obj"}), "Output file name. Supported formats are ASCII (.pts, .xyz) and .ply")
         ("voxelsize,v", value<float>(&m_voxelsize)->default_value(10), "Voxelsize of grid used for reconstruction.")
         ("noExtrusion", "Do not extend grid. Can be used  to avoid artefacts in dense data sets but. Disabling will possibly create additional holes in sparse data sets.")
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * Main.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include <iostream>
+#include <stdlib.h>
+
+#include <boost/filesystem.hpp>
+
+#include "Options.hpp"
+
+#include "lvr2/io/Model.hpp"
+#include "lvr2/io/ModelFactory.hpp"
+#include "lvr2/io/PointCloudLODBuilder.hpp"
+#include "lvr2/io/PointStream.hpp"
+#include "lvr2/io/Timestamp.hpp"
+
+int main(int argc, char** argv)
+{
+    lodbuilder::Options options(argc, argv);
+
+    // Exit if options had to generate a usage message
+    // (this means required parameters are missing)
+    if (options.printUsage())
+    {
+        return EXIT_SUCCESS;
+    }
+    std::cout << options << std::endl;
+
+    std::string inputFile = options.getInputFileName();
+
+    lvr2::PointStreamPtr stream;
+    if (boost::filesystem::path(inputFile).extension() == ".h5")
+    {
+        stream = lvr2::PointStreamPtr(new lvr2::HDF5ScanStream(inputFile));
+    }
+    else
+    {
+        lvr2::ModelPtr model = lvr2::ModelFactory::readModel(inputFile);
+        if (!model || !model->m_pointCloud)
+        {
+            std::cout << lvr2::timestamp << "Unable to read points from " << inputFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        stream = lvr2::PointStreamPtr(new lvr2::PointBufferStream(model->m_pointCloud));
+    }
+
+    lvr2::PointCloudLODBuilder builder(
+        options.getTmpDir(),
+        options.getChunkPoints(),
+        options.getNodePoints(),
+        options.getGridSize());
+    builder.build(*stream, options.getOutputFileName());
+
+    std::cout << lvr2::timestamp << "Program end." << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * Options.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "Options.hpp"
+
+namespace lodbuilder
+{
+
+using namespace boost::program_options;
+
+Options::Options(int argc, char** argv)
+    : BaseOption(argc, argv)
+{
+    // Create option descriptions
+    m_descr.add_options()
+        ("help", "Produce help message")
+        ("inputFile", value< vector<string> >(), "Input point cloud. HDF5 files are streamed scan by scan, other formats are loaded completely.")
+        ("output,o", value<string>()->default_value("pointcloud.lod"), "Output .lod file")
+        ("tmpDir", value<string>()->default_value("."), "Directory for temporary files. Needs space for a copy of the input.")
+        ("chunkPoints", value<size_t>()->default_value(1 << 23), "Maximum number of points that are processed in memory at once")
+        ("nodePoints", value<size_t>()->default_value(20000), "Nodes with at most this many points are not subdivided")
+        ("gridSize", value<unsigned int>()->default_value(128), "Resolution of the sampling grid of each node")
+    ;
+    setup();
+}
+
+string Options::getInputFileName() const
+{
+    return (m_variables["inputFile"].as< vector<string> >())[0];
+}
+
+string Options::getOutputFileName() const
+{
+    return m_variables["output"].as<string>();
+}
+
+string Options::getTmpDir() const
+{
+    return m_variables["tmpDir"].as<string>();
+}
+
+size_t Options::getChunkPoints() const
+{
+    return m_variables["chunkPoints"].as<size_t>();
+}
+
+size_t Options::getNodePoints() const
+{
+    return m_variables["nodePoints"].as<size_t>();
+}
+
+unsigned int Options::getGridSize() const
+{
+    return m_variables["gridSize"].as<unsigned int>();
+}
+
+bool Options::printUsage() const
+{
+    if (m_variables.count("help"))
+    {
+        cout << endl;
+        cout << m_descr << endl;
+        return true;
+    }
+    else if (!m_variables.count("inputFile"))
+    {
+        cout << "Error: You must specify an input file." << endl;
+        cout << endl;
+        cout << m_descr << endl;
+        return true;
+    }
+    return false;
+}
+
+Options::~Options()
+{
+}
+
+} // namespace lodbuilder
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * Options.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#ifndef LVR2_LOD_BUILDER_OPTIONS_H_
+#define LVR2_LOD_BUILDER_OPTIONS_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+
+#include <lvr2/config/BaseOption.hpp>
+
+using std::ostream;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+namespace lodbuilder
+{
+
+/**
+ * @brief A class to parse the program options for the level-of-detail builder
+ */
+class Options : public lvr2::BaseOption
+{
+public:
+
+    /**
+     * @brief   Ctor. Parses the command parameters given to the main
+     *          function of the program
+     */
+    Options(int argc, char** argv);
+    virtual ~Options();
+
+    /// Returns the name of the input point cloud
+    string getInputFileName() const;
+
+    /// Returns the name of the output .lod file
+    string getOutputFileName() const;
+
+    /// Returns the directory for temporary files
+    string getTmpDir() const;
+
+    /// Returns the maximum number of points that are processed in memory at once
+    size_t getChunkPoints() const;
+
+    /// Returns the number of points up to which a node is not subdivided
+    size_t getNodePoints() const;
+
+    /// Returns the resolution of the sampling grid of each node
+    unsigned int getGridSize() const;
+
+    bool printUsage() const;
+};
+
+inline ostream& operator<<(ostream& os, const Options& o)
+{
+    cout << "##### Input\t\t: " << o.getInputFileName() << endl;
+    cout << "##### Output\t\t: " << o.getOutputFileName() << endl;
+    cout << "##### Temp. dir\t\t: " << o.getTmpDir() << endl;
+    cout << "##### Chunk points\t: " << o.getChunkPoints() << endl;
+    cout << "##### Node points\t: " << o.getNodePoints() << endl;
+    cout << "##### Grid size\t\t: " << o.getGridSize() << endl;
+    return os;
+}
+
+} // namespace lodbuilder
+
+#endif /* LVR2_LOD_BUILDER_OPTIONS_H_ */
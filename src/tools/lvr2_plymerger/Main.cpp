@@ -30,6 +30,7 @@
 #include <rply.h>
 
 #include "lvr2/io/ModelFactory.hpp"
+#include "lvr2/io/PLYWriter.hpp"
 #include "lvr2/io/Progress.hpp"
 
 #include <boost/filesystem.hpp>
@@ -181,94 +182,83 @@ void parsePLYHeader(
 }
 
 
-void writePLYHeader(ofstream& outfile, size_t numPoints, bool writeColors, bool writeNormals)
+void declareLayout(PLYWriter& writer, bool writeColors, bool writeNormals)
 {
-    outfile << "ply" << endl;
-    outfile << "format binary_little_endian 1.0" << endl;
-    outfile << "element vertex " << numPoints << endl;
-    outfile << "property float x" << endl;
-    outfile << "property float y" << endl;
-    outfile << "property float z" << endl;
+    writer.addElement("vertex");
+    writer.addProperties({"x", "y", "z"}, PLYType::FLOAT);
     if(writeColors)
     {
-        outfile << "property uchar red" << endl;
-        outfile << "property uchar green" << endl;
-        outfile << "property uchar blue" << endl;
+        writer.addProperties({"red", "green", "blue"}, PLYType::UCHAR);
     }
 
     if(writeNormals)
     {
-        outfile << "property float nx" << endl;
-        outfile << "property float ny" << endl;
-        outfile << "property float nz" << endl;
+        writer.addProperties({"nx", "ny", "nz"}, PLYType::FLOAT);
     }
-    outfile << "end_header" << endl;
 }
 
-void addToFile(ofstream& out, string filename)
+void addToFile(PLYWriter& writer, string filename, bool writeColors, bool writeNormals)
 {
     ModelPtr model = ModelFactory::readModel(filename);
+    if(!model || !model->m_pointCloud)
+    {
+        cout << timestamp << "Could not read points from '" << filename << "'." << endl;
+        return;
+    }
     PointBufferPtr pointBuffer = model->m_pointCloud;
 
-    size_t np, nn, nc;
+    size_t np = pointBuffer->numPoints();
     size_t w_color;
-    np = pointBuffer->numPoints();
-    nc = nn = np;
 
     floatArr points = pointBuffer->getPointArray();
     ucharArr colors = pointBuffer->getColorArray(w_color);
     floatArr normals = pointBuffer->getNormalArray();
 
-    // Determine size of single point
-    size_t buffer_size = 3 * sizeof(float);
-
-    if(colors)
+    // The header may announce channels that could not be read. The number of
+    // written points is only fixed when the writer is closed, so the file can
+    // be skipped as a whole.
+    if(!points)
     {
-        buffer_size += w_color * sizeof(unsigned char);
+        cout << timestamp << "Warning: No points in '" << filename << "'. Skipping file." << endl;
+        return;
     }
 
-    if(normals)
+    if(writeColors && (!colors || w_color < 3))
     {
-        buffer_size += 3 * sizeof(float);
+        cout << timestamp << "Warning: Could not read colors from '" << filename << "'. Skipping file." << endl;
+        return;
     }
 
-    char* buffer = new char[buffer_size];
-
-    for(size_t i = 0; i < np; i++)
+    if(writeNormals && !normals)
     {
-        char* ptr = &buffer[0];
-
-        // Write coordinates to buffer
-        *((float*)ptr) = points[3*i];
-        ptr += sizeof(float);
-        *((float*)ptr) = points[3*i+1];
-        ptr += sizeof(float);
-        *((float*)ptr) = points[3*i+2];
-
-        // Write colors to buffer
-        if(colors)
-        {
-            ptr += sizeof(float);
-            *((unsigned char*)ptr) = colors[3 * i];
-            ptr += sizeof(unsigned char);
-            *((unsigned char*)ptr) = colors[3 * i + 1];
-            ptr += sizeof(unsigned char);
-            *((unsigned char*)ptr) = colors[3 * i + 2];
-        }
+        cout << timestamp << "Warning: Could not read normals from '" << filename << "'. Skipping file." << endl;
+        return;
+    }
 
-        if(normals)
+    // Colors may be stored with an alpha channel, only rgb is written
+    ucharArr rgb = colors;
+    if(writeColors && w_color != 3)
+    {
+        rgb = ucharArr(new unsigned char[3 * np]);
+        for(size_t i = 0; i < np; i++)
         {
-            ptr += sizeof(unsigned char);
-            *((float*)ptr) = normals[3*i];
-            ptr += sizeof(float);
-            *((float*)ptr) = normals[3*i+1];
-            ptr += sizeof(float);
-            *((float*)ptr) = normals[3*i+2];
+            rgb[3 * i    ] = colors[w_color * i    ];
+            rgb[3 * i + 1] = colors[w_color * i + 1];
+            rgb[3 * i + 2] = colors[w_color * i + 2];
         }
-        out.write((const char*)buffer, buffer_size);
     }
 
-    delete[] buffer;
+    // Stream the channels of the file directly into the output
+    std::vector<const void*> sources = {points.get()};
+    if(writeColors)
+    {
+        sources.push_back(rgb.get());
+    }
+    if(writeNormals)
+    {
+        sources.push_back(normals.get());
+    }
+    writer.write("vertex", sources, np);
 }
 
 /**
@@ -354,10 +344,16 @@ int main(int argc, char** argv)
         std::cout << timestamp << options.inputDir() << " does not exist or is not a directory." << std::endl;
     }
 
+    // The number of points that can actually be read is only known at the end,
+    // it is filled into the header when the writer is closed
     string outfile_name = options.outputFile();
-    ofstream out;
-    out.open(outfile_name.c_str(), std::ios::binary);
-    writePLYHeader(out, totalNumPoints, mergeColors, mergeNormals);
+    PLYWriter writer(outfile_name);
+    declareLayout(writer, mergeColors, mergeNormals);
+    if(!writer.writeHeader())
+    {
+        cout << timestamp << "Could not write header to '" << outfile_name << "'." << endl;
+        return 1;
+    }
 
     size_t maxChunkPoints = 1e7;
     auto it = ply_file_names.begin();
@@ -379,7 +375,7 @@ int main(int argc, char** argv)
 
         for(auto chunkIt: filesInChunk)
         {
-            addToFile(out, chunkIt);
+            addToFile(writer, chunkIt, mergeColors, mergeNormals);
         }
 
         for(size_t c = 0; c < filesInChunk.size(); c++)
@@ -388,6 +384,12 @@ int main(int argc, char** argv)
         }
     }
 
+    if(!writer.close())
+    {
+        cout << timestamp << "Error while writing '" << outfile_name << "'." << endl;
+        return 1;
+    }
+
 	return 0;
 }
 
@@ -38,6 +38,7 @@
 #include "lvr2/geometry/HalfEdgeMesh.hpp"
 #include "lvr2/geometry/BaseVector.hpp"
 #include "lvr2/geometry/Normal.hpp"
+#include "lvr2/geometry/CompactMesh.hpp"
 #include "lvr2/attrmaps/StableVector.hpp"
 #include "lvr2/attrmaps/VectorMap.hpp"
 #include "lvr2/algorithm/FinalizeAlgorithms.hpp"
@@ -52,6 +53,8 @@
 #include "lvr2/algorithm/Materializer.hpp"
 #include "lvr2/algorithm/Texturizer.hpp"
 #include "lvr2/algorithm/ImageTexturizer.hpp"
+#include "lvr2/algorithm/raycasting/BVHRaycaster.hpp"
+#include "lvr2/texture/TextureAtlas.hpp"
 
 #include "lvr2/reconstruction/AdaptiveKSearchSurface.hpp"
 #include "lvr2/reconstruction/BilinearFastBox.hpp"
@@ -86,6 +89,12 @@
 
     #include "lvr2/reconstruction/opencl/ClSurface.hpp"
     typedef lvr2::ClSurface GpuSurface;
+#else
+    // Same LBKdTree based normal estimation on the CPU
+    #define GPU_FOUND
+
+    #include "lvr2/reconstruction/CpuSurface.hpp"
+    typedef lvr2::CpuSurface GpuSurface;
 #endif
 
 
@@ -419,8 +428,9 @@ int main(int argc, char** argv)
     auto clusterColors = boost::optional<DenseClusterMap<Rgb8Color>>(painter.simpsons(mesh));
     auto vertexColors = calcColorFromPointCloud(mesh, surface);
 
-    // Calc normals for vertices
-    auto vertexNormals = calcVertexNormals(mesh, faceNormals, *surface);
+    // Calc normals for vertices. The mesh isn't modified anymore, so the
+    // normals are computed in parallel on a compact snapshot of it.
+    auto vertexNormals = calcVertexNormals(CompactMesh<Vec>(mesh), faceNormals, *surface);
 
     // Prepare finalize algorithm
     TextureFinalizer<Vec> finalize(clusterBiMap);
@@ -464,6 +474,7 @@ int main(int argc, char** argv)
         options.getTexMinClusterSize(),
         options.getTexMaxClusterSize()
     );
+    texturizer.setTexelNeighbors(options.getTexKn());
 
     // When using textures ...
     if (options.generateTextures())
@@ -486,6 +497,13 @@ int main(int argc, char** argv)
             }
 
             img_texter.set_project(project.get_project());
+            img_texter.setImageMemoryLimit(static_cast<size_t>(options.getTexImageMemory()) * 1024 * 1024);
+
+            // Raycaster on the current mesh for occlusion tests
+            SimpleFinalizer<Vec> occlusionFinalizer;
+            img_texter.setRaycaster(RaycasterBasePtr<Vec, Normal<float>>(
+                new BVHRaycaster<Vec, Normal<float>>(occlusionFinalizer.apply(mesh))
+            ));
 
             materializer.setTexturizer(img_texter);
         }
@@ -494,6 +512,15 @@ int main(int argc, char** argv)
     // Generate materials
     MaterializerResult<Vec> matResult = materializer.generateMaterials();
 
+    // Pack cluster textures into atlas pages
+    if (options.generateTextures() && options.getTexAtlasSize() > 0)
+    {
+        // The size was checked to fit into 16 bits by the options
+        TextureAtlas atlas(static_cast<unsigned short>(options.getTexAtlasSize()));
+        atlas.setMemoryLimit(static_cast<size_t>(options.getTexAtlasMemory()) * 1024 * 1024);
+        finalize.setTextureAtlas(atlas);
+    }
+
     // Add material data to finalize algorithm
     finalize.setMaterializerResult(matResult);
     // Run finalize algorithm
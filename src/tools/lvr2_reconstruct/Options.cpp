@@ -92,6 +92,10 @@ Options::Options(int argc, char** argv)
         ("texMaxClusterSize", value<int>(&m_texMaxClusterSize)->default_value(0), "Maximum number of faces of a cluster to create a texture from (0 = no limit)")
         ("textureAnalysis", "Enable texture analysis features for texture matchung.")
         ("texelSize", value<float>(&m_texelSize)->default_value(1), "Texel size that determines texture resolution.")
+        ("texKn", value<int>(&m_texKn)->default_value(1), "Number of nearest points whose colors are averaged for each texel.")
+        ("texAtlasSize", value<int>(&m_texAtlasSize)->default_value(0), "Pack textures into atlas pages of this edge length in texels (0 = one texture per cluster).")
+        ("texAtlasMemory", value<int>(&m_texAtlasMemory)->default_value(0), "Memory budget in MB for composing atlas pages (0 = no limit).")
+        ("texImageMemory", value<int>(&m_texImageMemory)->default_value(4096), "Memory budget in MB for images kept in memory when texturizing from images (0 = no limit).")
         ("classifier", value<string>(&m_classifier)->default_value("PlaneSimpsons"),"Classfier object used to color the mesh.")
         ("recalcNormals,r", "Always estimate normals, even if given in .ply file.")
         ("threads", value<int>(&m_numThreads)->default_value( lvr2::OpenMPConfig::getNumThreads() ), "Number of threads")
@@ -235,6 +239,13 @@ bool Options::printUsage() const
         cout << m_descr << endl;
         return true;
     }
+  else if (getTexAtlasSize() < 0 || getTexAtlasSize() > 65535)
+    {
+        cout << "Error: The texture atlas size has to be between 1 and 65535, or 0 to disable the atlas." << endl;
+        cout << endl;
+        cout << m_descr << endl;
+        return true;
+    }
   return false;
 }
 
@@ -434,6 +445,26 @@ int Options::getTexMaxClusterSize() const
     return m_variables["texMaxClusterSize"].as<int>();
 }
 
+int Options::getTexKn() const
+{
+    return m_variables["texKn"].as<int>();
+}
+
+int Options::getTexAtlasSize() const
+{
+    return m_variables["texAtlasSize"].as<int>();
+}
+
+int Options::getTexAtlasMemory() const
+{
+    return m_variables["texAtlasMemory"].as<int>();
+}
+
+int Options::getTexImageMemory() const
+{
+    return m_variables["texImageMemory"].as<int>();
+}
+
 bool Options::vertexColorsFromPointcloud() const
 {
     return m_variables.count("vcfp");
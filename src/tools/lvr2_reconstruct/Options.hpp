@@ -320,6 +320,14 @@ public:
 
     int getTexMaxClusterSize() const;
 
+    int getTexKn() const;
+
+    int getTexAtlasSize() const;
+
+    int getTexAtlasMemory() const;
+
+    int getTexImageMemory() const;
+
     bool vertexColorsFromPointcloud() const;
 
     bool useGPU() const;
@@ -446,6 +454,18 @@ private:
 
     int m_texMaxClusterSize;
 
+    /// Number of neighbors that are averaged for each texel
+    int m_texKn;
+
+    /// Edge length of texture atlas pages
+    int m_texAtlasSize;
+
+    /// Memory budget for texture atlas generation in MB
+    int m_texAtlasMemory;
+
+    /// Memory budget for images used for texturizing in MB
+    int m_texImageMemory;
+
     ///Use pointcloud colors to paint vertices
     bool m_vertexColorsFromPointcloud;
 
@@ -561,6 +581,11 @@ inline ostream& operator<<(ostream& os, const Options &o)
         cout << "##### Texel size \t\t: " << o.getTexelSize() << endl;
         cout << "##### Texture Min#Cluster \t: " << o.getTexMinClusterSize() << endl;
         cout << "##### Texture Max#Cluster \t: " << o.getTexMaxClusterSize() << endl;
+        cout << "##### Texel neighbors \t\t: " << o.getTexKn() << endl;
+        if(o.getTexAtlasSize() > 0)
+        {
+            cout << "##### Texture atlas size \t: " << o.getTexAtlasSize() << endl;
+        }
 
         if(o.doTextureAnalysis())
         {
@@ -432,10 +432,34 @@ int main(int argc, char** argv)
         // case for not using HDF5
         // TODO: change to ScanDirectoryParser once that is done
 
+        // getTransformationFromFile() throws for unknown extensions, which
+        // would terminate the program inside of the parallel loop
+        string pose_extension = path("pose").replace_extension(pose_format).extension().string();
+        if (pose_extension != ".dat" && pose_extension != ".pose" && pose_extension != ".frames")
+        {
+            cerr << "Unknown pose format: " << pose_format << endl;
+            return EXIT_FAILURE;
+        }
+
+        // Load scans and poses in parallel, the HDF5 library is not thread safe
+        vector<ModelPtr> models(count);
+        vector<Transformd> poses(count);
+        bool parallel = path(format).extension() != ".h5";
+
+        #pragma omp parallel for schedule(dynamic) if(parallel)
+        for (int i = 0; i < count; i++)
+        {
+            path file = dir / format_name(format, start + i);
+            models[i] = ModelFactory::readModel(file.string());
+
+            file.replace_extension(pose_format);
+            poses[i] = getTransformationFromFile<double>(file);
+        }
+
         for (int i = 0; i < count; i++)
         {
             path file = dir / format_name(format, start + i);
-            auto model = ModelFactory::readModel(file.string());
+            auto& model = models[i];
 
             if (!model)
             {
@@ -448,12 +472,9 @@ int main(int argc, char** argv)
                 return EXIT_FAILURE;
             }
 
-            file.replace_extension(pose_format);
-            Transformd pose = getTransformationFromFile<double>(file);
-
             ScanPtr scan = ScanPtr(new Scan());
             scan->m_points = model->m_pointCloud;
-            scan->m_poseEstimation = pose;
+            scan->m_poseEstimation = poses[i];
 
             SLAMScanPtr slamScan = SLAMScanPtr(new SLAMScanWrapper(scan));
             scans.push_back(slamScan);
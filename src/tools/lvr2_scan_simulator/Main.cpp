@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Main.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <vector>
+
+#include "Options.hpp"
+
+#include "lvr2/algorithm/raycasting/ScanPattern.hpp"
+#include "lvr2/algorithm/raycasting/ScanSimulator.hpp"
+#include "lvr2/geometry/BaseVector.hpp"
+#include "lvr2/geometry/Normal.hpp"
+#include "lvr2/io/ChunkedScanWriter.hpp"
+#include "lvr2/io/Model.hpp"
+#include "lvr2/io/ModelFactory.hpp"
+#include "lvr2/io/Timestamp.hpp"
+#include "lvr2/registration/TransformUtils.hpp"
+
+using Vec = lvr2::BaseVector<float>;
+using Norm = lvr2::Normal<float>;
+
+/**
+ * @brief Reads one pose per line: x y z roll pitch yaw (angles in degrees)
+ */
+std::vector<lvr2::Transformf> readPoses(const std::string& filename)
+{
+    std::vector<lvr2::Transformf> poses;
+    std::ifstream in(filename);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream ss(line);
+        lvr2::Vector3f position;
+        lvr2::Vector3f angles;
+        if (ss >> position.x() >> position.y() >> position.z() >> angles.x() >> angles.y() >> angles.z())
+        {
+            poses.push_back(lvr2::poseToMatrix<float>(position, angles * static_cast<float>(M_PI / 180.0)));
+        }
+    }
+    return poses;
+}
+
+int main(int argc, char** argv)
+{
+    scansimulator::Options options(argc, argv);
+
+    // Exit if options had to generate a usage message
+    // (this means required parameters are missing)
+    if (options.printUsage())
+    {
+        return EXIT_SUCCESS;
+    }
+    std::cout << options << std::endl;
+
+    std::vector<lvr2::Transformf> poses = readPoses(options.getPoseFileName());
+    if (poses.empty())
+    {
+        std::cout << lvr2::timestamp << "No poses found in " << options.getPoseFileName() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    lvr2::ModelPtr model = lvr2::ModelFactory::readModel(options.getInputFileName());
+    if (!model || !model->m_mesh)
+    {
+        std::cout << lvr2::timestamp << "Unable to read mesh from " << options.getInputFileName() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    lvr2::ScanPattern pattern = options.getPattern() == "line"
+        ? lvr2::ScanPattern::line(options.getVMin(), options.getVMax(), options.getVRes())
+        : lvr2::ScanPattern::spherical(options.getHMin(), options.getHMax(), options.getHRes(),
+                                       options.getVMin(), options.getVMax(), options.getVRes());
+
+    std::cout << lvr2::timestamp << "Building BVH for " << model->m_mesh->numFaces() << " faces" << std::endl;
+    lvr2::ScanSimulator<Vec, Norm> simulator(model->m_mesh, pattern);
+    simulator.setChunkSize(options.getChunkSize());
+    simulator.setMaxRange(options.getMaxRange());
+
+    lvr2::ChunkedScanWriter writer(options.getOutputFileName());
+
+    std::cout << lvr2::timestamp << "Simulating " << poses.size() << " scans with "
+              << pattern.size() << " rays each" << std::endl;
+
+    simulator.simulate(poses, [&writer](size_t scanNr, const lvr2::Transformf& pose, lvr2::PointBufferPtr chunk)
+    {
+        writer.write(scanNr, pose, chunk);
+    });
+
+    std::cout << lvr2::timestamp << "Program end." << std::endl;
+
+    return EXIT_SUCCESS;
+}
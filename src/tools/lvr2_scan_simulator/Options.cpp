@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Options.cpp
+ *
+ *  @date 19.10.2026
+ */
+
+#include "Options.hpp"
+
+#include <limits>
+
+namespace scansimulator
+{
+
+using namespace boost::program_options;
+
+Options::Options(int argc, char** argv)
+    : BaseOption(argc, argv)
+{
+    // Create option descriptions
+    m_descr.add_options()
+        ("help", "Produce help message")
+        ("inputFile", value< vector<string> >(), "Mesh to scan. Supported formats are .obj and .ply")
+        ("poses,p", value<string>(), "Text file with one scanner pose per line: x y z roll pitch yaw (angles in degrees)")
+        ("output,o", value<string>()->default_value("simulated_scans.h5"), "Output HDF5 file")
+        ("pattern", value<string>()->default_value("spherical"), "Scan pattern: spherical or line")
+        ("hMin", value<float>()->default_value(0.0f), "Start of the horizontal field of view in degrees")
+        ("hMax", value<float>()->default_value(360.0f), "End of the horizontal field of view in degrees")
+        ("hRes", value<float>()->default_value(0.1f), "Horizontal resolution in degrees")
+        ("vMin", value<float>()->default_value(-40.0f), "Start of the vertical field of view in degrees")
+        ("vMax", value<float>()->default_value(60.0f), "End of the vertical field of view in degrees")
+        ("vRes", value<float>()->default_value(0.1f), "Vertical resolution in degrees")
+        ("maxRange", value<float>()->default_value(std::numeric_limits<float>::max()), "Maximum range of the scanner")
+        ("chunkSize", value<size_t>()->default_value(1 << 20), "Number of rays cast at once. Bounds the memory usage.")
+    ;
+    setup();
+}
+
+string Options::getInputFileName() const
+{
+    return (m_variables["inputFile"].as< vector<string> >())[0];
+}
+
+string Options::getPoseFileName() const
+{
+    return m_variables["poses"].as<string>();
+}
+
+string Options::getOutputFileName() const
+{
+    return m_variables["output"].as<string>();
+}
+
+string Options::getPattern() const
+{
+    return m_variables["pattern"].as<string>();
+}
+
+float Options::getHMin() const
+{
+    return m_variables["hMin"].as<float>();
+}
+
+float Options::getHMax() const
+{
+    return m_variables["hMax"].as<float>();
+}
+
+float Options::getHRes() const
+{
+    return m_variables["hRes"].as<float>();
+}
+
+float Options::getVMin() const
+{
+    return m_variables["vMin"].as<float>();
+}
+
+float Options::getVMax() const
+{
+    return m_variables["vMax"].as<float>();
+}
+
+float Options::getVRes() const
+{
+    return m_variables["vRes"].as<float>();
+}
+
+float Options::getMaxRange() const
+{
+    return m_variables["maxRange"].as<float>();
+}
+
+size_t Options::getChunkSize() const
+{
+    return m_variables["chunkSize"].as<size_t>();
+}
+
+bool Options::printUsage() const
+{
+    if (m_variables.count("help"))
+    {
+        cout << endl;
+        cout << m_descr << endl;
+        return true;
+    }
+    else if (!m_variables.count("inputFile") || !m_variables.count("poses"))
+    {
+        cout << "Error: You must specify a mesh and a pose file." << endl;
+        cout << endl;
+        cout << m_descr << endl;
+        return true;
+    }
+    else if (getHRes() <= 0 || getVRes() <= 0)
+    {
+        cout << "Error: The resolution has to be greater than 0." << endl;
+        cout << endl;
+        cout << m_descr << endl;
+        return true;
+    }
+    else if (getChunkSize() == 0)
+    {
+        cout << "Error: The chunk size has to be at least 1." << endl;
+        cout << endl;
+        cout << m_descr << endl;
+        return true;
+    }
+    return false;
+}
+
+Options::~Options()
+{
+}
+
+} // namespace scansimulator
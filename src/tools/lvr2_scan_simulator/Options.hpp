@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Options.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#ifndef LVR2_SCAN_SIMULATOR_OPTIONS_H_
+#define LVR2_SCAN_SIMULATOR_OPTIONS_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+
+#include <lvr2/config/BaseOption.hpp>
+
+using std::ostream;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+namespace scansimulator
+{
+
+/**
+ * @brief A class to parse the program options for the scan simulator
+ */
+class Options : public lvr2::BaseOption
+{
+public:
+
+    /**
+     * @brief   Ctor. Parses the command parameters given to the main
+     *          function of the program
+     */
+    Options(int argc, char** argv);
+    virtual ~Options();
+
+    /// Returns the name of the mesh to scan
+    string getInputFileName() const;
+
+    /// Returns the name of the file with the scanner poses
+    string getPoseFileName() const;
+
+    /// Returns the name of the output HDF5 file
+    string getOutputFileName() const;
+
+    /// Returns the scan pattern, either "spherical" or "line"
+    string getPattern() const;
+
+    /// Horizontal field of view and resolution in degrees
+    float getHMin() const;
+    float getHMax() const;
+    float getHRes() const;
+
+    /// Vertical field of view and resolution in degrees
+    float getVMin() const;
+    float getVMax() const;
+    float getVRes() const;
+
+    /// Returns the maximum range of the scanner
+    float getMaxRange() const;
+
+    /// Returns the number of rays that are cast at once
+    size_t getChunkSize() const;
+
+    bool printUsage() const;
+};
+
+inline ostream& operator<<(ostream& os, const Options& o)
+{
+    cout << "##### Mesh\t\t: " << o.getInputFileName() << endl;
+    cout << "##### Poses\t\t: " << o.getPoseFileName() << endl;
+    cout << "##### Output\t\t: " << o.getOutputFileName() << endl;
+    cout << "##### Pattern\t\t: " << o.getPattern() << endl;
+    if (o.getPattern() == "spherical")
+    {
+        cout << "##### Horizontal\t: " << o.getHMin() << " to " << o.getHMax() << " by " << o.getHRes() << endl;
+    }
+    cout << "##### Vertical\t\t: " << o.getVMin() << " to " << o.getVMax() << " by " << o.getVRes() << endl;
+    cout << "##### Max. range\t: " << o.getMaxRange() << endl;
+    cout << "##### Chunk size\t: " << o.getChunkSize() << endl;
+    return os;
+}
+
+} // namespace scansimulator
+
+#endif /* LVR2_SCAN_SIMULATOR_OPTIONS_H_ */